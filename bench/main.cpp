@@ -0,0 +1,497 @@
+/*
+ * HLSL Translator benchmark main file
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <HT/Translator.h>
+#include "HLSLScanner.h"
+#include "HLSLParser.h"
+#include "HLSLAnalyzer.h"
+#include "GLSLGenerator.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <functional>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+
+using namespace HTLib;
+
+/* --- Classes --- */
+
+//! Logger which only keeps the first error message.
+class ErrorLog : public Logger
+{
+    
+    public:
+        
+        void Error(const std::string& message) override
+        {
+            if (firstError.empty())
+                firstError = message;
+        }
+
+        std::string firstError;
+
+};
+
+//! Shader of the benchmark corpus.
+struct BenchShader
+{
+    std::string     name;
+    std::string     source;
+    std::string     entryPoint;
+    ShaderTargets   shaderTarget = ShaderTargets::GLSLVertexShader;
+};
+
+//! Results of all benchmarks of a single shader (durations in seconds for a single iteration).
+struct BenchResult
+{
+    std::string name;
+    std::size_t sourceSize  = 0;
+    std::size_t numTokens   = 0;
+    std::size_t numNodes    = 0;
+    std::size_t outputSize  = 0;
+    double      scanTime    = 0.0;
+    double      parseTime   = 0.0;
+    double      analyzeTime = 0.0;
+    double      generateTime= 0.0;
+};
+
+
+/* --- Globals --- */
+
+double minTime = 0.25;
+int minIterations = 5;
+double tolerance = 10.0;
+std::string baselineFile;
+std::string saveFile;
+
+
+/* --- Synthetic shaders --- */
+
+//! Returns a vertex shader with deeply nested brackets and a long chain of binary expressions.
+static BenchShader DeepExpressionShader(int depth, int chainLength)
+{
+    std::ostringstream s;
+
+    s << "float4 VS(float4 pos : POSITION) : SV_Position\n{\n";
+    s << "    float x = pos.x;\n";
+
+    s << "    float y = ";
+    for (int i = 0; i < depth; ++i)
+        s << "(";
+    s << "x";
+    for (int i = 0; i < depth; ++i)
+        s << " * " << (i % 7 + 1) << ".0 + 0.5)";
+    s << ";\n";
+
+    s << "    float z = x";
+    for (int i = 0; i < chainLength; ++i)
+        s << (i % 3 == 0 ? " + " : (i % 3 == 1 ? " * " : " - ")) << "(y * " << i << ".0)";
+    s << ";\n";
+
+    s << "    return float4(y, z, 0.0, 1.0);\n}\n";
+
+    return { "deep-expressions", s.str(), "VS", ShaderTargets::GLSLVertexShader };
+}
+
+//! Returns a vertex shader with thousands of functions (each calling another function).
+static BenchShader ManyFunctionsShader(int numFunctions)
+{
+    std::ostringstream s;
+
+    s << "float F0(float x)\n{\n    return x;\n}\n\n";
+
+    for (int i = 1; i < numFunctions; ++i)
+    {
+        s << "float F" << i << "(float x)\n{\n";
+        s << "    float y = x * " << i << ".0;\n";
+        s << "    if (y > 10.0)\n        y = y - 1.0;\n";
+        s << "    return F" << (i / 2) << "(y) + 0.5;\n}\n\n";
+    }
+
+    s << "float4 VS(float4 pos : POSITION) : SV_Position\n{\n";
+    s << "    float sum = 0.0;\n";
+    for (int i = std::max(0, numFunctions - 64); i < numFunctions; ++i)
+        s << "    sum += F" << i << "(pos.x);\n";
+    s << "    return float4(sum, pos.yzw);\n}\n";
+
+    return { "many-functions", s.str(), "VS", ShaderTargets::GLSLVertexShader };
+}
+
+//! Returns a vertex shader with several huge constant buffers.
+static BenchShader HugeConstantBufferShader(int numBuffers, int numMembers)
+{
+    std::ostringstream s;
+
+    for (int i = 0; i < numBuffers; ++i)
+    {
+        s << "cbuffer Buffer" << i << " : register(b" << i << ")\n{\n";
+        for (int j = 0; j < numMembers; ++j)
+        {
+            switch (j % 4)
+            {
+                case 0: s << "    float4 v" << i << "_" << j << ";\n"; break;
+                case 1: s << "    float4x4 m" << i << "_" << j << ";\n"; break;
+                case 2: s << "    float3 a" << i << "_" << j << "[4];\n"; break;
+                case 3: s << "    int2 n" << i << "_" << j << ";\n"; break;
+            }
+        }
+        s << "};\n\n";
+    }
+
+    s << "float4 VS(float4 pos : POSITION) : SV_Position\n{\n";
+    s << "    float4 p = pos;\n";
+    for (int i = 0; i < numBuffers; ++i)
+        s << "    p = mul(m" << i << "_1, p) + v" << i << "_0;\n";
+    s << "    return p;\n}\n";
+
+    return { "huge-cbuffers", s.str(), "VS", ShaderTargets::GLSLVertexShader };
+}
+
+
+/* --- Functions --- */
+
+static void ShowHelp()
+{
+    std::cout
+        << "usage:" << std::endl
+        << "  HLSLBenchmark [OPTIONS] [-shader FILE ENTRY TARGET]..." << std::endl
+        << "options:" << std::endl
+        << "  -shader FILE ENTRY TARGET . Adds a shader to the corpus; TARGET is vertex, fragment, geometry," << std::endl
+        << "                              tess-control, tess-evaluation or compute" << std::endl
+        << "  -no-default ............... Removes the synthetic and test shaders from the corpus" << std::endl
+        << "  -time SECONDS ............. Minimal measuring time of each benchmark; by default 0.25" << std::endl
+        << "  -save FILE ................ Stores the results as baseline in FILE" << std::endl
+        << "  -baseline FILE ............ Compares the results with the baseline in FILE" << std::endl
+        << "  -tolerance PERCENT ........ Allowed slowdown against the baseline; by default 10" << std::endl
+        << "  --help, help, -h .......... Prints this help reference" << std::endl;
+}
+
+static ShaderTargets TargetFromString(const std::string& target)
+{
+    if (target == "vertex")
+        return ShaderTargets::GLSLVertexShader;
+    if (target == "fragment")
+        return ShaderTargets::GLSLFragmentShader;
+    if (target == "geometry")
+        return ShaderTargets::GLSLGeometryShader;
+    if (target == "tess-control")
+        return ShaderTargets::GLSLTessControlShader;
+    if (target == "tess-evaluation")
+        return ShaderTargets::GLSLTessEvaluationShader;
+    if (target == "compute")
+        return ShaderTargets::GLSLComputeShader;
+
+    throw std::runtime_error("invalid shader target \"" + target + "\"");
+}
+
+static std::string NextArg(int& i, int argc, char** argv, const std::string& flag)
+{
+    if (i + 1 >= argc)
+        throw std::runtime_error("missing next argument after flag \"" + flag + "\"");
+    return argv[++i];
+}
+
+static BenchShader LoadShader(const std::string& filename, const std::string& entryPoint, ShaderTargets shaderTarget)
+{
+    std::ifstream file(filename);
+    if (!file.good())
+        throw std::runtime_error("failed to read file \"" + filename + "\"");
+
+    std::string source { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+    auto pos = filename.find_last_of("/\\");
+    auto name = (pos == std::string::npos ? filename : filename.substr(pos + 1)) + ":" + entryPoint;
+
+    return { name, source, entryPoint, shaderTarget };
+}
+
+//! Returns the minimal duration (in seconds) of a single call to the specified function.
+static double Measure(const std::function<void()>& func)
+{
+    /* Warm up caches and allocators */
+    func();
+
+    auto bestTime = std::numeric_limits<double>::max();
+    auto totalTime = 0.0;
+
+    for (int iterations = 0; iterations < minIterations || totalTime < minTime; ++iterations)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        func();
+        auto time = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        bestTime = std::min(bestTime, time);
+        totalTime += time;
+    }
+
+    return bestTime;
+}
+
+static BenchResult RunBenchmark(const BenchShader& shader)
+{
+    static const HLSLAnalyzer::Tables analyzerTables;
+    static const GLSLGenerator::Tables generatorTables;
+
+    BenchResult result;
+    result.name         = shader.name;
+    result.sourceSize   = shader.source.size();
+
+    Options options;
+    options.timeStamp = false;
+
+    /* Benchmark scanner */
+    result.scanTime = Measure(
+        [&]()
+        {
+            StringPool stringPool;
+            HLSLScanner scanner;
+            scanner.ScanSource(std::make_shared<SourceCode>(shader.source.data(), shader.source.size()), stringPool);
+
+            result.numTokens = 0;
+            while (scanner.Next().Type() != Token::Types::EndOfStream)
+                ++result.numTokens;
+        }
+    );
+
+    /* Benchmark parser */
+    ErrorLog log;
+    ProgramPtr program;
+
+    result.parseTime = Measure(
+        [&]()
+        {
+            HLSLParser parser(&log);
+            program = parser.ParseSource(std::make_shared<SourceCode>(shader.source.data(), shader.source.size()));
+        }
+    );
+
+    if (!program)
+        throw std::runtime_error("parsing shader \"" + shader.name + "\" failed: " + log.firstError);
+
+    result.numNodes = program->arena.Nodes().size();
+
+    /* Benchmark context analyzer (the decorations are renewed with each call) */
+    bool analyzed = false;
+
+    result.analyzeTime = Measure(
+        [&]()
+        {
+            HLSLAnalyzer analyzer(analyzerTables, &log);
+            analyzed = analyzer.DecorateAST(
+                program.get(), shader.entryPoint, shader.shaderTarget,
+                InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, options
+            );
+        }
+    );
+
+    if (!analyzed)
+        throw std::runtime_error("analyzing shader \"" + shader.name + "\" failed: " + log.firstError);
+
+    /* Benchmark code generator */
+    std::string output;
+    bool generated = false;
+
+    result.generateTime = Measure(
+        [&]()
+        {
+            output.clear();
+            GLSLGenerator generator(generatorTables, &log, nullptr, options);
+            generated = generator.GenerateCode(
+                program.get(), output, shader.entryPoint, shader.shaderTarget,
+                InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330
+            );
+        }
+    );
+
+    if (!generated)
+        throw std::runtime_error("generating shader \"" + shader.name + "\" failed: " + log.firstError);
+
+    result.outputSize = output.size();
+
+    return result;
+}
+
+static void PrintResult(const BenchResult& result)
+{
+    auto MBPerSec = [](std::size_t bytes, double time)
+    {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0) / time;
+    };
+
+    std::cout << result.name << " (" << result.sourceSize << " bytes, " << result.numTokens << " tokens, " << result.numNodes << " nodes)" << std::endl;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  scan     " << std::setw(10) << result.scanTime * 1000.0 << " ms  " << std::setw(10) << MBPerSec(result.sourceSize, result.scanTime) << " MB/s" << std::endl;
+    std::cout << "  parse    " << std::setw(10) << result.parseTime * 1000.0 << " ms  " << std::setw(10) << result.numNodes / result.parseTime / 1000.0 << " knodes/s" << std::endl;
+    std::cout << "  analyze  " << std::setw(10) << result.analyzeTime * 1000.0 << " ms  " << std::setw(10) << result.numNodes / result.analyzeTime / 1000.0 << " knodes/s" << std::endl;
+    std::cout << "  generate " << std::setw(10) << result.generateTime * 1000.0 << " ms  " << std::setw(10) << MBPerSec(result.outputSize, result.generateTime) << " MB/s" << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+}
+
+//! Returns the list of all (benchmark, phase, duration) records of the specified results.
+static std::map<std::string, double> ResultRecords(const std::vector<BenchResult>& results)
+{
+    std::map<std::string, double> records;
+
+    for (const auto& result : results)
+    {
+        records[result.name + " scan"]      = result.scanTime;
+        records[result.name + " parse"]     = result.parseTime;
+        records[result.name + " analyze"]   = result.analyzeTime;
+        records[result.name + " generate"]  = result.generateTime;
+    }
+
+    return records;
+}
+
+static void SaveBaseline(const std::vector<BenchResult>& results)
+{
+    std::ofstream file(saveFile);
+    if (!file.good())
+        throw std::runtime_error("failed to write baseline file \"" + saveFile + "\"");
+
+    file << std::setprecision(9);
+    for (const auto& record : ResultRecords(results))
+        file << record.first << " " << record.second << std::endl;
+
+    std::cout << "baseline saved to " << saveFile << std::endl;
+}
+
+//! Compares the results with the baseline and returns the number of regressions.
+static int CompareBaseline(const std::vector<BenchResult>& results)
+{
+    std::ifstream file(baselineFile);
+    if (!file.good())
+        throw std::runtime_error("failed to read baseline file \"" + baselineFile + "\"");
+
+    /* Read baseline records (one "NAME PHASE SECONDS" record per line) */
+    std::map<std::string, double> baseline;
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        auto pos = line.find_last_of(' ');
+        if (pos != std::string::npos)
+            baseline[line.substr(0, pos)] = std::atof(line.substr(pos + 1).c_str());
+    }
+
+    /* Compare results */
+    int regressions = 0;
+
+    std::cout << "comparison with baseline " << baselineFile << " (tolerance " << tolerance << "%):" << std::endl;
+
+    for (const auto& record : ResultRecords(results))
+    {
+        auto it = baseline.find(record.first);
+        if (it == baseline.end() || it->second <= 0.0)
+        {
+            std::cout << "  " << record.first << ": not in baseline" << std::endl;
+            continue;
+        }
+
+        auto change = (record.second / it->second - 1.0) * 100.0;
+        auto isRegression = (change > tolerance);
+
+        std::cout << "  " << record.first << ": " << std::showpos << std::fixed << std::setprecision(1) << change << "%";
+        std::cout << std::noshowpos << (isRegression ? "  REGRESSION" : "") << std::endl;
+        std::cout.unsetf(std::ios_base::floatfield);
+
+        if (isRegression)
+            ++regressions;
+    }
+
+    return regressions;
+}
+
+
+/* --- Main function --- */
+
+int main(int argc, char** argv)
+{
+    std::vector<BenchShader> shaders;
+    bool defaultCorpus = true;
+
+    try
+    {
+        /* Parse program arguments */
+        for (int i = 1; i < argc; ++i)
+        {
+            auto arg = std::string(argv[i]);
+
+            if (arg == "help" || arg == "--help" || arg == "-h")
+            {
+                ShowHelp();
+                return 0;
+            }
+            else if (arg == "-shader")
+            {
+                auto filename = NextArg(i, argc, argv, arg);
+                auto entryPoint = NextArg(i, argc, argv, arg);
+                auto target = NextArg(i, argc, argv, arg);
+                shaders.push_back(LoadShader(filename, entryPoint, TargetFromString(target)));
+            }
+            else if (arg == "-no-default")
+                defaultCorpus = false;
+            else if (arg == "-time")
+                minTime = std::atof(NextArg(i, argc, argv, arg).c_str());
+            else if (arg == "-save")
+                saveFile = NextArg(i, argc, argv, arg);
+            else if (arg == "-baseline")
+                baselineFile = NextArg(i, argc, argv, arg);
+            else if (arg == "-tolerance")
+                tolerance = std::atof(NextArg(i, argc, argv, arg).c_str());
+            else
+                throw std::runtime_error("unknown argument \"" + arg + "\" (enter \"HLSLBenchmark help\")");
+        }
+
+        /* Setup default corpus (synthetic shaders and the shaders of the test folder) */
+        if (defaultCorpus)
+        {
+            shaders.push_back(DeepExpressionShader(200, 1000));
+            shaders.push_back(ManyFunctionsShader(3000));
+            shaders.push_back(HugeConstantBufferShader(8, 1000));
+
+            #ifdef HT_BENCH_TEST_DIR
+            const std::string testDir = HT_BENCH_TEST_DIR;
+            shaders.push_back(LoadShader(testDir + "/TestShader1.hlsl", "VS", ShaderTargets::GLSLVertexShader));
+            shaders.push_back(LoadShader(testDir + "/TestShader1.hlsl", "PS", ShaderTargets::GLSLFragmentShader));
+            shaders.push_back(LoadShader(testDir + "/TestShader1.hlsl", "CS", ShaderTargets::GLSLComputeShader));
+            shaders.push_back(LoadShader(testDir + "/TestShader2.hlsl", "VS", ShaderTargets::GLSLVertexShader));
+            #endif
+        }
+
+        /* Run all benchmarks */
+        std::vector<BenchResult> results;
+
+        for (const auto& shader : shaders)
+        {
+            results.push_back(RunBenchmark(shader));
+            PrintResult(results.back());
+        }
+
+        if (!saveFile.empty())
+            SaveBaseline(results);
+
+        if (!baselineFile.empty() && CompareBaseline(results) > 0)
+            return 1;
+    }
+    catch (const std::exception& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,329 @@
+/*
+ * HLSL Translator serializer fuzz test main file
+ *
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <HT/Translator.h>
+#include "ASTSerializer.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <stdexcept>
+
+
+using namespace HTLib;
+
+/* --- Classes --- */
+
+//! Logger which ignores all messages (most of the corrupted programs can not be translated).
+class NullLog : public Logger
+{
+
+    public:
+
+        void Error(const std::string& message) override
+        {
+        }
+
+};
+
+//! Shader of the fuzz corpus.
+struct FuzzShader
+{
+    std::string     name;
+    std::string     source;
+    std::string     entryPoint;
+    ShaderTargets   shaderTarget = ShaderTargets::GLSLVertexShader;
+};
+
+/**
+Builder for a hand-made serialized program (see "ASTWriter").
+\remarks The header is taken from a serialized empty program, so it always matches the current format version.
+*/
+class BufferBuilder
+{
+
+    public:
+
+        BufferBuilder()
+        {
+            /* Remove the counts of the strings, nodes and global declarations of the empty program */
+            Program program(SourcePosition::ignore);
+            ASTWriter writer;
+            writer.WriteProgram(program, data);
+            data.resize(data.size() - 3);
+        }
+
+        BufferBuilder& UInt(std::uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                data.push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            data.push_back(static_cast<char>(value));
+            return *this;
+        }
+
+        BufferBuilder& Node(AST::Types type)
+        {
+            data.push_back(static_cast<char>(type));
+            return UInt(0).UInt(0).UInt(0);
+        }
+
+        std::string data;
+
+};
+
+//! Regression case with a hand-made buffer and the expected result.
+struct BufferCase
+{
+    std::string name;
+    std::string data;
+    bool        valid;
+};
+
+/* --- Global functions --- */
+
+static int numFailures = 0;
+
+static void Fail(const std::string& msg)
+{
+    std::cerr << "FAILED: " << msg << std::endl;
+    ++numFailures;
+}
+
+static FuzzShader LoadShader(const std::string& filename, const std::string& entryPoint, ShaderTargets shaderTarget)
+{
+    std::ifstream file(filename);
+    if (!file.good())
+        throw std::runtime_error("failed to read file: \"" + filename + "\"");
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+
+    FuzzShader shader;
+    shader.name         = filename + " (" + entryPoint + ")";
+    shader.source       = stream.str();
+    shader.entryPoint   = entryPoint;
+    shader.shaderTarget = shaderTarget;
+    return shader;
+}
+
+/**
+Returns the regression cases for the validation of the node references.
+The program is a function "f" with a code block statement: "void f() { { } }".
+*/
+static std::vector<BufferCase> RegressionBuffers()
+{
+    /* Writes the string table and the node table */
+    auto header = [](std::uint32_t numExtraNodes) -> BufferBuilder
+    {
+        BufferBuilder buf;
+        buf.UInt(3).UInt(4).data += "void";
+        buf.UInt(1).data += "f";
+        buf.UInt(0);
+        buf.UInt(4 + numExtraNodes);
+        buf.Node(AST::Types::FunctionDecl);
+        buf.Node(AST::Types::VarType);
+        buf.Node(AST::Types::CodeBlock);
+        buf.Node(AST::Types::CodeBlockStmnt);
+        for (std::uint32_t i = 0; i < numExtraNodes; ++i)
+            buf.Node(AST::Types::NullStmnt);
+        return buf;
+    };
+
+    /* Writes the global declarations and the fields of the function and its return type */
+    auto function = [](BufferBuilder& buf)
+    {
+        buf.UInt(1).UInt(1);                                    // Program: globalDecls = { FunctionDecl }
+        buf.UInt(0).UInt(1).UInt(1).UInt(0).UInt(2).UInt(2);    // FunctionDecl: no attribs, returnType, name, no parameters, no semantic, codeBlock
+        buf.data.push_back('\0');                               // FunctionDecl: no lazy body
+        buf.UInt(0).UInt(0);                                    // VarType: baseType, no structType
+    };
+
+    std::vector<BufferCase> cases;
+
+    {
+        auto buf = header(0);
+        function(buf);
+        buf.UInt(1).UInt(1);    // CodeBlock: stmnts = { CodeBlockStmnt }
+        buf.UInt(0);            // CodeBlockStmnt: empty
+        cases.push_back({ "valid program", buf.data, true });
+    }
+    {
+        auto buf = header(0);
+        function(buf);
+        buf.UInt(1).UInt(1);
+        buf.UInt(1);            // CodeBlockStmnt: reference beyond the last node
+        cases.push_back({ "reference out of range", buf.data, false });
+    }
+    {
+        auto buf = header(0);
+        function(buf);
+        buf.UInt(1).UInt(1);
+        buf.UInt(~0u);          // CodeBlockStmnt: reference to its parent code block with a wrapped distance
+        cases.push_back({ "reference to an ancestor", buf.data, false });
+    }
+    {
+        auto buf = header(0);
+        buf.UInt(1).UInt(1);
+        buf.UInt(0).UInt(1).UInt(1).UInt(0).UInt(2).UInt(~0u); // FunctionDecl: code block refers to the function itself
+        buf.data.push_back('\0');
+        buf.UInt(0).UInt(0);
+        buf.UInt(1).UInt(1);
+        buf.UInt(0);
+        cases.push_back({ "reference to the function itself", buf.data, false });
+    }
+    {
+        auto buf = header(0);
+        function(buf);
+        buf.UInt(2).UInt(1).UInt(1);    // CodeBlock: stmnts = { CodeBlockStmnt, CodeBlockStmnt }
+        buf.UInt(0);
+        cases.push_back({ "node owned twice", buf.data, false });
+    }
+    {
+        auto buf = header(1);
+        function(buf);
+        buf.UInt(1).UInt(1);
+        buf.UInt(0);            // NullStmnt is never referenced
+        cases.push_back({ "node without owner", buf.data, false });
+    }
+
+    return cases;
+}
+
+//! Checks that the reader accepts exactly the valid regression buffers.
+static void RunRegressionTests()
+{
+    for (const auto& testCase : RegressionBuffers())
+    {
+        bool valid = true;
+
+        try
+        {
+            ASTReader reader;
+            reader.ReadProgram(testCase.data.data(), testCase.data.size());
+        }
+        catch (const std::exception&)
+        {
+            valid = false;
+        }
+
+        if (valid != testCase.valid)
+            Fail(testCase.name + (testCase.valid ? " is rejected" : " is accepted"));
+    }
+}
+
+/**
+Reads randomly corrupted copies of the serialized program of the specified shader.
+\remarks Each program which is read successfully must be a tree (i.e. it can be written again),
+and it must be possible to translate it without a crash.
+*/
+static void RunFuzzTest(const FuzzShader& shader, std::mt19937& rng, int iterations)
+{
+    Translator translator;
+    NullLog log;
+
+    Options options;
+    options.timeStamp = false;
+
+    auto program = translator.Parse(shader.source.data(), shader.source.size(), &log);
+    if (!program)
+    {
+        Fail(shader.name + " can not be parsed");
+        return;
+    }
+
+    std::string data;
+    translator.WriteProgram(*program, data);
+
+    int numAccepted = 0;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        /* Flip one to four random bytes, and truncate the buffer sometimes */
+        auto corrupted = data;
+
+        auto numFlips = std::uniform_int_distribution<int>(1, 4)(rng);
+        for (int j = 0; j < numFlips; ++j)
+        {
+            auto pos = std::uniform_int_distribution<std::size_t>(0, corrupted.size() - 1)(rng);
+            corrupted[pos] = static_cast<char>(std::uniform_int_distribution<int>(0, 255)(rng));
+        }
+
+        if (std::uniform_int_distribution<int>(0, 15)(rng) == 0)
+            corrupted.resize(std::uniform_int_distribution<std::size_t>(0, corrupted.size())(rng));
+
+        auto corruptedProgram = translator.ReadProgram(corrupted.data(), corrupted.size(), &log);
+        if (!corruptedProgram)
+            continue;
+
+        ++numAccepted;
+
+        try
+        {
+            std::string rewritten;
+            ASTWriter writer;
+            writer.WriteProgram(*corruptedProgram, rewritten);
+        }
+        catch (const std::exception& err)
+        {
+            Fail(shader.name + ": accepted program is not a tree (" + err.what() + ")");
+            continue;
+        }
+
+        std::string output;
+        translator.Generate(
+            *corruptedProgram, output, shader.entryPoint, shader.shaderTarget,
+            InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+        );
+    }
+
+    std::cout << shader.name << ": " << numAccepted << " of " << iterations << " corrupted programs accepted" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        int iterations = (argc > 1 ? std::stoi(argv[1]) : 2000);
+
+        RunRegressionTests();
+
+        /* Fuzz the serialized programs of the test folder (with a fixed seed, so failures can be reproduced) */
+        #ifdef HT_FUZZ_TEST_DIR
+        const std::string testDir = HT_FUZZ_TEST_DIR;
+
+        std::mt19937 rng(1234);
+        RunFuzzTest(LoadShader(testDir + "/TestShader1.hlsl", "VS", ShaderTargets::GLSLVertexShader), rng, iterations);
+        RunFuzzTest(LoadShader(testDir + "/TestShader1.hlsl", "PS", ShaderTargets::GLSLFragmentShader), rng, iterations);
+        RunFuzzTest(LoadShader(testDir + "/TestShader2.hlsl", "VS", ShaderTargets::GLSLVertexShader), rng, iterations);
+        #endif
+    }
+    catch (const std::exception& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
+    if (numFailures > 0)
+    {
+        std::cerr << numFailures << " failure(s)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "all tests passed" << std::endl;
+    return 0;
+}
+
+
+
+// ================================================================================
\ No newline at end of file
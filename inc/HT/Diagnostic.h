@@ -0,0 +1,101 @@
+/*
+ * Diagnostic.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_DIAGNOSTIC_H__
+#define __HT_DIAGNOSTIC_H__
+
+
+#include "HT/Export.h"
+
+#include <string>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+//! Diagnostic severities.
+enum class DiagnosticSeverities
+{
+    Info,
+    Warning,
+    Error,
+};
+
+/**
+Diagnostic codes. Each code has a message template (see "DiagnosticTemplate"),
+where "%0" and "%1" are replaced by the arguments of the diagnostic.
+*/
+enum class DiagnosticCodes
+{
+    /* --- Generic --- */
+    Message,                            //!< Already formatted message (e.g. syntax errors): "%0"
+
+    /* --- Context analyzer --- */
+    ContextError,                       //!< "%0"
+    UndeclaredIdent,                    //!< "undeclared identifier \"%0\""
+    EmptyStmntBody,                     //!< "<%0> statement with empty body"
+    EntryPointNotFound,                 //!< "entry point \"%0\" not found"
+    InvalidNumArgsMul,                  //!< "\"mul\" intrinsic must have exactly 2 arguments"
+    InvalidNumArgsInterlocked,          //!< "interlocked intrinsics must have at least 2 arguments"
+    MissingVarType,                     //!< "missing variable type"
+
+    /* --- Code generator --- */
+    InvalidRegisterPrefix,              //!< "invalid register prefix '%0' (expected '%1')"
+    InvalidNumArgs,                     //!< "invalid number of arguments for %0"
+    UnsupportedTexFunc,                 //!< "texture member function \"%0\" is not supported"
+    UnknownInterlockedIntrinsic,        //!< "unknown interlocked intrinsic \"%0\""
+    UnsupportedTextureType,             //!< "texture type \"%0\" not supported yet"
+    InvalidEntryPointParamVars,         //!< "invalid number of variables inside parameter of entry point"
+    InvalidEntryPointParamSemantics,    //!< "invalid number of semantics inside parameter fo entry point"
+    InvalidPixelShaderOutputSemantic,   //!< "invalid output semantic for pixel shader: \"%0\""
+    UnknownOutputSemantic,              //!< "unknown shader output semantic: \"%0\""
+    InvalidParamVars,                   //!< "invalid number of variables in function parameter"
+    UnsupportedESSLType,                //!< "type \"%0\" is not supported in GLSL ES"
+};
+
+/**
+Structured diagnostic, which is reported to a logger before it is formatted (see "Logger::Report").
+\remarks The argument strings are only valid during the call to "Logger::Report".
+Use a "DiagnosticBuffer" to keep the diagnostics of a translation.
+\see FormatDiagnostic
+*/
+struct Diagnostic
+{
+    static const std::size_t maxArgs = 2;
+
+    DiagnosticCodes         code            = DiagnosticCodes::Message;
+    DiagnosticSeverities    severity        = DiagnosticSeverities::Error;
+    bool                    hasPos          = false;    //!< Specifies whether the diagnostic has a source position.
+    unsigned int            row             = 0;        //!< Source row (only if "hasPos" is true).
+    unsigned int            column          = 0;        //!< Source column as it appears in the formatted message (only if "hasPos" is true).
+    std::size_t             numArgs         = 0;        //!< Number of arguments (at most "maxArgs").
+    const std::string*      args[maxArgs]   = { nullptr, nullptr };
+};
+
+
+/* === Functions === */
+
+//! Returns the message template of the specified diagnostic code, e.g. "entry point \"%0\" not found".
+_HT_EXPORT_ const char* DiagnosticTemplate(const DiagnosticCodes code);
+
+/**
+Formats the specified diagnostic, e.g. "context error (12:4) : entry point \"main\" not found".
+\remarks This is the message which is passed to "Logger::Warning" or "Logger::Error" by default.
+*/
+_HT_EXPORT_ std::string FormatDiagnostic(const Diagnostic& diagnostic);
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,102 @@
+/*
+ * DiagnosticBuffer.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_DIAGNOSTIC_BUFFER_H__
+#define __HT_DIAGNOSTIC_BUFFER_H__
+
+
+#include "HT/Export.h"
+#include "HT/Logger.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+/**
+Logger which records all diagnostics as compact records, without formatting any message.
+\remarks The argument strings (e.g. identifiers) are interned, so each distinct argument is only stored once.
+Messages are only formatted when they are requested (see "Message" and "WriteTo").
+Messages which are passed to "Info", "Warning" or "Error" (e.g. syntax errors) are recorded with the code "DiagnosticCodes::Message".
+\see Logger::Report
+*/
+class _HT_EXPORT_ DiagnosticBuffer : public Logger
+{
+
+    public:
+
+        //! Recorded diagnostic, which refers to its arguments by their IDs (see "Argument").
+        struct Record
+        {
+            DiagnosticCodes         code;
+            DiagnosticSeverities    severity;
+            bool                    hasPos;
+            unsigned int            row;
+            unsigned int            column;
+            std::size_t             numArgs;
+            std::size_t             args[Diagnostic::maxArgs];
+        };
+
+        void Info(const std::string& message) override;
+        void Warning(const std::string& message) override;
+        void Error(const std::string& message) override;
+
+        void Report(const Diagnostic& diagnostic) override;
+
+        //! Returns the diagnostic of the specified record. Its arguments refer to the strings inside this buffer.
+        Diagnostic GetDiagnostic(const Record& record) const;
+
+        //! Returns the formatted message of the specified record.
+        std::string Message(const Record& record) const;
+
+        //! Reports all recorded diagnostics to the specified log (in the order they have been recorded).
+        void WriteTo(Logger& log) const;
+
+        //! Removes all records and arguments.
+        void Clear();
+
+        //! Returns the number of records with the specified severity.
+        std::size_t Count(const DiagnosticSeverities severity) const;
+
+        //! Returns all records in the order they have been recorded.
+        inline const std::vector<Record>& Records() const
+        {
+            return records_;
+        }
+
+        //! Returns the argument with the specified ID.
+        inline const std::string& Argument(std::size_t id) const
+        {
+            return arguments_[id];
+        }
+
+    private:
+
+        void RecordMessage(const DiagnosticSeverities severity, const std::string& message);
+
+        std::size_t Intern(const std::string& argument);
+
+        std::vector<Record>                             records_;
+        std::vector<std::string>                        arguments_;
+        std::unordered_map<std::string, std::size_t>    argumentIDs_;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,109 @@
+/*
+ * IncrementalTranslator.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_INCREMENTAL_TRANSLATOR_H__
+#define __HT_INCREMENTAL_TRANSLATOR_H__
+
+
+#include "HT/Export.h"
+#include "HT/Translator.h"
+
+#include <string>
+#include <memory>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+/**
+Translator for live shader editing, which re-uses the parsed global declarations and their output of previous translations.
+\remarks The source is split into its top-level declarations (functions, structures, buffers, textures, samplers and directives).
+Only those declarations whose text has changed (or which are new) are scanned and parsed again;
+all other declarations are taken from the previous translations. The context analysis always runs for the entire program,
+because the symbol table and the reference marking are global. The output of each declaration is kept for the next translation,
+and only the edited declarations, all declarations which refer to them (directly or indirectly, e.g. the callers of an edited function),
+and the entry point are generated again. The output of a declaration is also generated again, if the analysis of another declaration
+has changed its decorations, e.g. if a function is no longer reachable from the entry point.
+So the output is identical to the output of "Translator::Translate".
+\note If "Options::preprocess" is enabled, the entire source is translated with the translator,
+because macros and conditionals may affect any declaration after them.
+In the minified mode and with explicit bindings, all declarations are generated again (see "Options::minify" and "Options::explicitBinding").
+This class is not thread-safe; use one instance for each shader that is edited.
+\see Translator::Translate
+*/
+class _HT_EXPORT_ IncrementalTranslator
+{
+    
+    public:
+        
+        IncrementalTranslator();
+        ~IncrementalTranslator();
+
+        IncrementalTranslator(const IncrementalTranslator&) = delete;
+        IncrementalTranslator& operator = (const IncrementalTranslator&) = delete;
+
+        /**
+        Translates the HLSL code from the specified character buffer and appends the GLSL code to the specified string.
+        \param[in] translator Specifies the translator which is used to parse the changed declarations and to generate the output.
+        \param[out] stats Optional pointer to the translation statistics.
+        The parse time includes the time to split the source into its declarations, and "numTokens" only counts the tokens of the parsed declarations.
+        \remarks Only the declarations of successful translations are kept for the next translation,
+        and only the outputs of successful code generations. The global declarations are always generated by a single thread.
+        \see Translator::Translate
+        */
+        bool Translate(
+            const Translator&                       translator,
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            std::string&                            output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            TranslationStats*                       stats = nullptr
+        );
+
+        //! Releases all declarations and outputs of the previous translations.
+        void Clear();
+
+        //! Returns the number of declarations which have been re-used by the previous translation.
+        std::size_t NumReusedDecls() const;
+
+        //! Returns the number of declarations which have been parsed by the previous translation.
+        std::size_t NumParsedDecls() const;
+
+        //! Returns the number of global declarations whose output has been re-used by the previous translation.
+        std::size_t NumReusedOutputs() const;
+
+        /**
+        Returns the number of global declarations whose output has been generated by the previous translation.
+        \remarks This does not include the entry point, which is always generated.
+        */
+        std::size_t NumGeneratedOutputs() const;
+
+    private:
+        
+        struct State;
+
+        std::unique_ptr<State> state_;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 
 #include "Export.h"
+#include "Diagnostic.h"
 
 #include <string>
 
@@ -46,6 +47,27 @@ class _HT_EXPORT_ Logger
             // dummy
         }
 
+        /**
+        Reports a structured diagnostic, e.g. a context error or a warning.
+        \remarks By default the diagnostic is formatted (see "FormatDiagnostic") and passed to "Info", "Warning" or "Error".
+        Override this function to record diagnostics without formatting them (see "DiagnosticBuffer").
+        */
+        virtual void Report(const Diagnostic& diagnostic)
+        {
+            switch (diagnostic.severity)
+            {
+                case DiagnosticSeverities::Info:
+                    Info(FormatDiagnostic(diagnostic));
+                    break;
+                case DiagnosticSeverities::Warning:
+                    Warning(FormatDiagnostic(diagnostic));
+                    break;
+                case DiagnosticSeverities::Error:
+                    Error(FormatDiagnostic(diagnostic));
+                    break;
+            }
+        }
+
         //! Increments the indentation.
         virtual void IncIndent()
         {
@@ -0,0 +1,106 @@
+/*
+ * Reflection.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_REFLECTION_H__
+#define __HT_REFLECTION_H__
+
+
+#include "HT/Export.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+//! Reflection of a member of a uniform buffer.
+struct ReflectionUniform
+{
+    std::string     name;
+    std::string     type;               //!< GLSL type name (e.g. "mat4") or structure name.
+    unsigned int    arraySize   = 0;    //!< Number of array elements (product of all dimensions), or 0 if this is not an array.
+    unsigned int    offset      = 0;    //!< Byte offset within the uniform buffer (in the "std140" layout of the generated code).
+    unsigned int    size        = 0;    //!< Size in bytes (in the "std140" layout, including the padding of all array elements).
+    std::string     packOffset;         //!< HLSL pack offset (e.g. "c2.y"); may be empty. This is not used by the generated code.
+};
+
+//! Reflection of a uniform buffer (cbuffer, tbuffer).
+struct ReflectionUniformBuffer
+{
+    std::string                     name;
+    int                             binding         = -1;       //!< Binding point (from the "b" register), or -1 if no register is specified or this is a push constant block.
+    unsigned int                    size            = 0;        //!< Size in bytes (in the "std140" layout).
+    bool                            pushConstant    = false;    //!< True if this buffer is written as push constant block (Vulkan GLSL only, see "Options::pushConstantSize").
+    std::vector<ReflectionUniform>  members;
+};
+
+//! Reflection of a texture or sampler state.
+struct ReflectionResource
+{
+    std::string     name;
+    std::string     type;           //!< GLSL sampler type of a texture (e.g. "sampler2D") or HLSL type of a sampler state (e.g. "SamplerState").
+    int             binding = -1;   //!< Binding point (from the "t" or "s" register), or -1 if no register is specified.
+};
+
+//! Reflection of a shader input or output variable.
+struct ReflectionAttribute
+{
+    std::string     name;               //!< Name of the variable in the interface of the program (e.g. "_IVertexOut.texCoord" for interface blocks).
+    std::string     type;               //!< GLSL type name.
+    std::string     semantic;           //!< HLSL semantic (e.g. "TEXCOORD0"); may be empty.
+    int             location    = -1;   //!< Explicit location, or -1 if the location is assigned by the linker.
+};
+
+/**
+Reflection of a translated shader, i.e. the resources and interface variables of the generated code.
+\remarks Only resources which are referenced by the entry point are listed (all resources for a common shader),
+in the order of their declaration. Built-in variables (e.g. "gl_Position") are not listed.
+\see Translator::Translate
+*/
+struct ShaderReflection
+{
+    std::vector<ReflectionUniformBuffer>    uniformBuffers;
+    std::vector<ReflectionResource>         textures;
+    std::vector<ReflectionResource>         samplers;
+    std::vector<ReflectionAttribute>        inputs;
+    std::vector<ReflectionAttribute>        outputs;
+    unsigned int                            numThreads[3] = { 0, 0, 0 };    //!< Number of threads of a compute shader (from the "numthreads" attribute), or zeros.
+};
+
+
+/* === Functions === */
+
+//! Appends the specified reflection as JSON object to the output string.
+_HT_EXPORT_ void WriteReflectionJSON(const ShaderReflection& reflection, std::string& output);
+
+/**
+Appends the specified reflection in a compact binary format to the output buffer.
+\remarks All integers are stored with a variable length and all strings are stored once in a string table.
+The format is independent of the platform.
+\see ReadReflectionBinary
+*/
+_HT_EXPORT_ void WriteReflectionBinary(const ShaderReflection& reflection, std::string& output);
+
+/**
+Reads a reflection from the binary format which has been written by "WriteReflectionBinary".
+\return True on success, or false if the data is invalid.
+\see WriteReflectionBinary
+*/
+_HT_EXPORT_ bool ReadReflectionBinary(const char* data, std::size_t size, ShaderReflection& reflection);
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
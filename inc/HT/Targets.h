@@ -51,8 +51,52 @@ enum class OutputShaderVersions
     GLSL430 = 430, //!< GLSL 4.30 (OpenGL 4.3).
     GLSL440 = 440, //!< GLSL 4.40 (OpenGL 4.4).
     GLSL450 = 450, //!< GLSL 4.50 (OpenGL 4.5).
+
+    /* --- Vulkan GLSL versions --- */
+    VKSL450 = 0x10000 | 450, //!< GLSL 4.50 for Vulkan (GL_KHR_vulkan_glsl), which can be compiled to SPIR-V (e.g. with "glslangValidator -V").
+
+    /* --- GLSL ES versions --- */
+    ESSL300 = 0x20000 | 300, //!< GLSL ES 3.00 (OpenGL ES 3.0).
+    ESSL310 = 0x20000 | 310, //!< GLSL ES 3.10 (OpenGL ES 3.1).
 };
 
+//! Precision qualifiers of GLSL ES.
+enum class Precisions
+{
+    Low,    //!< "lowp" (at least 10 bits for floating-point types, e.g. HLSL "min10float").
+    Medium, //!< "mediump" (at least 16 bits, e.g. HLSL "half" and "min16float").
+    High,   //!< "highp" (32 bits).
+};
+
+//! Returns the GLSL version number of the specified output shader version (e.g. 450 for 'OutputShaderVersions::VKSL450').
+inline int GLSLVersionNumber(const OutputShaderVersions version)
+{
+    return (static_cast<int>(version) & 0xffff);
+}
+
+//! Returns true if the specified output shader version is a GLSL version for Vulkan.
+inline bool IsVulkanGLSL(const OutputShaderVersions version)
+{
+    return ((static_cast<int>(version) & ~0xffff) == 0x10000);
+}
+
+//! Returns true if the specified output shader version is a GLSL ES version.
+inline bool IsESSL(const OutputShaderVersions version)
+{
+    return ((static_cast<int>(version) & ~0xffff) == 0x20000);
+}
+
+/**
+Returns the desktop GLSL version number, whose features are supported by the specified output shader version.
+\remarks GLSL ES 3.00 corresponds to GLSL 3.30, and GLSL ES 3.10 corresponds to GLSL 4.20 (e.g. for explicit bindings).
+*/
+inline int GLSLFeatureVersion(const OutputShaderVersions version)
+{
+    if (IsESSL(version))
+        return (GLSLVersionNumber(version) >= 310 ? 420 : 330);
+    return GLSLVersionNumber(version);
+}
+
 
 } // /namespace HTLib
 
@@ -0,0 +1,120 @@
+/*
+ * TranslationCache.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_TRANSLATION_CACHE_H__
+#define __HT_TRANSLATION_CACHE_H__
+
+
+#include "HT/Export.h"
+#include "HT/Translator.h"
+
+#include <string>
+#include <ostream>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+/**
+Persistent on-disk cache for translated shaders.
+\remarks Each entry is stored as a single file inside the cache directory.
+Its name is a 128-bit hash of everything the output depends on: the source code, the contents of all files which are
+included (and reached through the include handler), the entry point, the shader target, the shader versions and all options
+which can change the output. With the preprocessor, the files of "#include MACRO" directives are found through all definitions of the macro.
+A cache hit skips the entire translation (scanning, parsing, analysis and code generation).
+\note No log messages (e.g. warnings) are reported for a cache hit. Disable "Options::timeStamp" to get
+the same output for a cache hit as for a new translation.
+Entries are written to a temporary file first, which is then renamed, so several processes can share the same cache directory.
+\see Options::timeStamp
+*/
+class _HT_EXPORT_ TranslationCache
+{
+    
+    public:
+        
+        /**
+        Creates a translation cache for the specified directory.
+        \param[in] directory Specifies the cache directory. This directory must already exist.
+        */
+        TranslationCache(const std::string& directory);
+
+        /**
+        Translates the HLSL code from the specified character buffer, or loads the output from the cache.
+        \param[in] translator Specifies the translator which is used when the shader is not in the cache.
+        \param[out] cacheHit Optional pointer to a boolean, which receives true if the output has been loaded from the cache.
+        \param[out] stats Optional pointer to the translation statistics. For a cache hit, only "outputBytes" is set.
+        \remarks Only successful translations are stored in the cache.
+        \see Translator::Translate
+        */
+        bool Translate(
+            const Translator&                       translator,
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            std::ostream&                           output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            bool*                                   cacheHit = nullptr,
+            TranslationStats*                       stats = nullptr
+        ) const;
+
+        /**
+        Returns the key (as hex string with 32 characters) for the specified translation.
+        \remarks The include handler is used to read all files, which are included by an "#include" directive.
+        */
+        std::string Key(
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {}
+        ) const;
+
+        /**
+        Loads the output of the specified cache entry.
+        \return True if the entry exists.
+        */
+        bool Load(const std::string& key, std::string& output) const;
+
+        /**
+        Stores the output for the specified cache entry.
+        \return True if the entry has been written successfully.
+        */
+        bool Store(const std::string& key, const std::string& output) const;
+
+        //! Returns the cache directory.
+        inline const std::string& Directory() const
+        {
+            return directory_;
+        }
+
+    private:
+        
+        std::string EntryFilename(const std::string& key) const;
+
+        std::string directory_;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -11,20 +11,39 @@
 
 #include "HT/Export.h"
 #include "HT/Logger.h"
+#include "HT/DiagnosticBuffer.h"
 #include "HT/Targets.h"
 #include "HT/Version.h"
+#include "HT/Reflection.h"
 
 #include <string>
+#include <map>
 #include <istream>
 #include <ostream>
 #include <memory>
+#include <vector>
+#include <cstddef>
 
 
 namespace HTLib
 {
 
 
-//! Structure for additional translation options.
+class SourceCode;
+struct Program;
+struct StageVaryings;
+class HLSLAnalyzer;
+class FunctionBodyStream;
+class TemporaryFunctionBodies;
+class DeclOutputCache;
+class IncrementalTranslator;
+
+/**
+Structure for additional translation options.
+\remarks All fields, which can change the output, are part of the key of the "TranslationCache".
+This excludes "generatorThreads", "parserThreads" and "streamOutput", since they only change how the output is produced.
+\see TranslationCache
+*/
 struct Options
 {
     //! Indentation string for code generation. By default std::string(4, ' ').
@@ -39,7 +58,10 @@ struct Options
     */
     std::string prefix      = "_";
 
-    //! True if warnings are allowed. By default false.
+    /**
+    True if warnings are allowed. By default false.
+    \remarks If false, warnings are not created at all (no message is formatted).
+    */
     bool        warnings    = false;
 
     //! True if blanks are allowed. By default true.
@@ -50,6 +72,126 @@ struct Options
 
     //! If true, the abstract syntax tree (AST) will be printed as debug output. By default false.
     bool        dumpAST     = false;
+
+    /**
+    True if the time stamp of the translation is written into the header comment. By default true.
+    \remarks Disable this to get a deterministic output, e.g. for a translation cache or build systems which compare the output.
+    */
+    bool        timeStamp   = true;
+
+    /**
+    True if the built-in preprocessor is used. By default false.
+    \remarks The preprocessor resolves all macros (including "__LINE__"), conditionals and include directives (through the include handler)
+    before the source is parsed, and drops the pragmas which are only meant for the HLSL compiler (e.g. "#pragma pack_matrix").
+    Otherwise all directives are passed through to the output code.
+    */
+    bool        preprocess  = false;
+
+    //! Predefined macros for the preprocessor (name and value). Only used if "preprocess" is true.
+    std::map<std::string, std::string> macros;
+
+    /**
+    True if dead code is removed from the output. By default false.
+    \remarks This removes unused local variables, statements after 'return', 'discard', 'break' and 'continue',
+    and branches with a constant literal condition (e.g. "if (false)"). Functions which are only called from such dead code are removed, too.
+    */
+    bool        eliminateDeadCode = false;
+
+    /**
+    True if constant expressions are folded. By default false.
+    \remarks This evaluates scalar and vector arithmetic over literals (e.g. "float3(1, 1, 1) * 0.5" becomes "vec3(0.5)"),
+    a set of intrinsics with constant arguments (e.g. "sqrt(2.0)"), and propagates the values of "const" local variables.
+    Conditions which are folded to a constant are also considered by the dead code elimination.
+    */
+    bool        foldConstants = false;
+
+    /**
+    True if function bodies are only parsed when they are reachable from the entry point. By default false.
+    \remarks The parser only matches the braces of each function body and keeps its source code.
+    The bodies are parsed on demand before the context analysis, beginning with the entry point and following all function calls.
+    Syntax errors and warnings inside unreachable functions are not reported in this mode,
+    and extensions which are only required by unreachable functions are omitted from the output.
+    This is not supported together with the preprocessor (i.e. it has no effect if "preprocess" is true).
+    */
+    bool        lazyFunctionBodies = false;
+
+    /**
+    Number of threads which generate the global declarations concurrently. By default 1.
+    \remarks If this is 0, the number of hardware threads is used. The output is identical for any number of threads.
+    This is meant for single large shaders, since "Translator::TranslateBatch" already translates its jobs concurrently.
+    */
+    unsigned int generatorThreads = 1;
+
+    /**
+    Number of threads which scan and parse the top-level declarations of a large source concurrently. By default 1.
+    \remarks If this is 0, the number of hardware threads is used. The source is split into chunks of whole declarations
+    with a fast bracket matching pass, and each chunk is parsed by its own parser. Small sources are always parsed by a single thread.
+    If any chunk reports a message (e.g. a lexical or syntax error), the entire source is parsed again by a single thread,
+    so the log is identical for any number of threads.
+    This is not supported together with the preprocessor (i.e. it has no effect if "preprocess" is true).
+    */
+    unsigned int parserThreads = 1;
+
+    /**
+    True if the output code is streamed and each function body only exists while it is analyzed or generated. By default false.
+    \remarks The output is written to the output stream after each global declaration, instead of being collected in a single buffer.
+    When "Translator::Translate" parses the source itself, the function bodies are skipped by the parser (see "lazyFunctionBodies"),
+    and each body is parsed, analyzed and released on its own, while only the signatures and the global declarations are kept.
+    The code generation parses each referenced body again, decorates it and writes its code, and then releases it right away.
+    The peak memory usage then depends on the largest function instead of the entire program. The output is identical to the default mode.
+    Programs which are shared by several translations (i.e. "Generate", "TranslatePermutations" and "TranslatePipeline") are never released,
+    and the bodies can only be skipped without the preprocessor,
+    the minified mode and the AST dump; otherwise only the output is streamed.
+    In this mode, the global declarations are always generated by a single thread (see "generatorThreads").
+    */
+    bool        streamOutput = false;
+
+    /**
+    True if the output is minified. By default false.
+    \remarks This drops the header comment, the indentation and all white spaces which are not required between two tokens,
+    and redundant brackets of expressions. Local variables, function parameters and functions (except in a common shader) are renamed to short names,
+    which do not collide with any other identifier. The names of all interface variables, uniforms, structures and global variables are not changed.
+    Preprocessor directives are written unchanged on their own lines. The "indent", "prefix" and "blanks" fields are ignored in this mode.
+    */
+    bool        minify = false;
+
+    /**
+    True if explicit bindings and locations are written for GLSL 4.20 and above. By default false.
+    \remarks Every uniform buffer and texture gets a "layout(binding = N)" qualifier, where N is the register index plus the offset
+    of its register class (see "bindingOffsets"). Resources without a register get the lowest free index of their class in the
+    order of their declaration. These bindings only depend on the source (not on the entry point), so they are identical for all stages.
+    All shader inputs and outputs get a "layout(location = N)" qualifier: members of vertex inputs and fragment outputs in the order
+    of their declaration (fragment outputs with an "SV_Target" semantic use its index), and interface blocks in the order of their declaration.
+    So the stages of a shader can be used in separable programs without querying the locations of the linked program.
+    For Vulkan GLSL (see "OutputShaderVersions::VKSL450"), the bindings and locations are always written.
+    */
+    bool        explicitBinding = false;
+
+    /**
+    Binding offsets of the HLSL register classes, which are added to the register indices (see "explicitBinding").
+    \remarks The key is the register prefix: 'b' for uniform buffers and 't' for textures, e.g. { { 't', 8 } } maps the register "t0" to the binding 8.
+    For Vulkan GLSL, all resources of a descriptor set share the same bindings, so each register class without an offset
+    starts right after the highest binding of the previous classes (i.e. the textures follow the uniform buffers).
+    */
+    std::map<char, unsigned int> bindingOffsets;
+
+    //! Descriptor set of all uniform buffers and textures for Vulkan GLSL, i.e. "layout(set = N, binding = M)". By default 0.
+    unsigned int descriptorSet = 0;
+
+    /**
+    Maximal size (in bytes) of a uniform buffer, which is written as push constant block for Vulkan GLSL. By default 0 (disabled).
+    \remarks Only the first uniform buffer in the order of their declaration, whose size in the "std140" layout does not exceed this value,
+    is written as "layout(push_constant, std140) uniform" block, since a shader can only have a single push constant block.
+    This only depends on the source (not on the entry point), so the same buffer is used for all stages. Vulkan guarantees at least 128 bytes.
+    */
+    unsigned int pushConstantSize = 0;
+
+    /**
+    Default precision of the floating-point, integer and sampler types for GLSL ES (see "OutputShaderVersions::ESSL300"). By default Precisions::High.
+    \remarks The HLSL half and minimum precision types (e.g. "half" and "min16float") are written with their own precision qualifier,
+    so "Precisions::High" keeps the full precision of all other types, while "Precisions::Medium" trades it for speed on mobile GPUs.
+    */
+    Precisions defaultPrecision = Precisions::High;
 };
 
 //! Interface for handling new include streams.
@@ -84,6 +226,496 @@ class _HT_EXPORT_ IncludeHandler
 };
 
 
+//! Single translation job for a batch translation.
+struct TranslationJob
+{
+    //! HLSL source code.
+    std::string             source;
+
+    //! HLSL shader entry point.
+    std::string             entryPoint;
+
+    //! Target shader (Vertex, Fragment etc.).
+    ShaderTargets           shaderTarget        = ShaderTargets::CommonShader;
+
+    //! Input shader version. By default InputShaderVersions::HLSL5.
+    InputShaderVersions     inputShaderVersion  = InputShaderVersions::HLSL5;
+
+    //! Output shader version. By default OutputShaderVersions::GLSL330.
+    OutputShaderVersions    outputShaderVersion = OutputShaderVersions::GLSL330;
+
+    //! Additional translation options.
+    Options                 options;
+
+    /**
+    Optional include handler. By default null.
+    \remarks If several jobs share the same include handler, it must be thread-safe.
+    */
+    IncludeHandler*         includeHandler      = nullptr;
+
+    /**
+    Optional output log. By default null.
+    \remarks If several jobs share the same log, it must be thread-safe.
+    */
+    Logger*                 log                 = nullptr;
+};
+
+/**
+Statistics of a single translation (for profiling).
+\remarks All durations are in seconds. The scanner runs interleaved with the parser,
+so "scanTime" is the accumulated time of all scanner calls and it is not included in "parseTime".
+*/
+struct TranslationStats
+{
+    //! Time to scan the source code (and all include files, if the preprocessor is used).
+    double                              scanTime            = 0.0;
+
+    //! Time to preprocess the token stream (without scanning). Only used if the preprocessor is used.
+    double                              preprocessTime      = 0.0;
+
+    //! Time to parse the token stream (without scanning and preprocessing).
+    double                              parseTime           = 0.0;
+
+    //! Time of the context analysis (without the reference analysis).
+    double                              analyzeTime         = 0.0;
+
+    //! Time to mark all references from the entry point.
+    double                              referenceTime       = 0.0;
+
+    //! Time to generate the output code.
+    double                              generateTime        = 0.0;
+
+    //! Number of tokens which have been parsed.
+    std::size_t                         numTokens           = 0;
+
+    //! Number of AST nodes.
+    std::size_t                         numNodes            = 0;
+
+    //! Number of AST nodes for each node type (e.g. "FunctionDecl").
+    std::map<std::string, std::size_t>  numNodesByType;
+
+    //! Number of bytes which are used by all AST nodes in the arena.
+    std::size_t                         arenaBytes          = 0;
+
+    //! Number of bytes which are reserved by the arena (i.e. the size of all memory blocks).
+    std::size_t                         arenaReservedBytes  = 0;
+
+    //! Number of bytes of the generated output code.
+    std::size_t                         outputBytes         = 0;
+};
+
+//! Result of a single translation job.
+struct TranslationResult
+{
+    //! True if the code has been translated correctly.
+    bool                succeeded   = false;
+
+    //! Output GLSL code.
+    std::string         output;
+
+    //! Statistics of this translation.
+    TranslationStats    stats;
+
+    //! Reflection of the output code (only valid if the translation succeeded).
+    ShaderReflection    reflection;
+
+    /**
+    All messages of this translation (errors, warnings and infos), in the order they have been reported.
+    \remarks These are kept separately for each result, also if several jobs share the same log (or have no log at all).
+    */
+    DiagnosticBuffer    messages;
+};
+
+//! Single shader stage of a pipeline translation.
+struct PipelineStage
+{
+    //! HLSL shader entry point.
+    std::string     entryPoint;
+
+    //! Target shader (Vertex, Geometry, Fragment etc.).
+    ShaderTargets   shaderTarget    = ShaderTargets::GLSLVertexShader;
+};
+
+/**
+Reusable translator context.
+\remarks All immutable lookup tables (keyword, type, intrinsic, modifier and semantic maps)
+are built once when this object is constructed and are shared by all translations made with it.
+This avoids rebuilding them for every shader, which dominates the cost of translating many small shaders.
+\par Thread safety
+The "Translate" function is const and creates all per-shader state (scanner, parser, analyzer, generator)
+on each call, so a single Translator instance can be used by several threads concurrently.
+The streams, include handler and logger passed to "Translate" are not synchronized by the translator;
+each concurrent call must use its own objects or objects which are thread-safe on their own.
+*/
+class _HT_EXPORT_ Translator
+{
+    
+    public:
+        
+        Translator();
+        ~Translator();
+
+        Translator(const Translator&) = delete;
+        Translator& operator = (const Translator&) = delete;
+
+        /**
+        Translates the HLSL code from the specified input stream into GLSL code.
+        \param[out] stats Optional pointer to the translation statistics. If this is non-null, the duration of each phase is measured.
+        \param[out] reflection Optional pointer to the reflection of the generated code. This is only written on success.
+        \see TranslateHLSLtoGLSL
+        \see TranslationStats
+        */
+        bool Translate(
+            const std::shared_ptr<std::istream>&    input,
+            std::ostream&                           output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            TranslationStats*                       stats = nullptr,
+            ShaderReflection*                       reflection = nullptr
+        ) const;
+
+        /**
+        Translates the HLSL code from the specified character buffer into GLSL code.
+        \see TranslateHLSLtoGLSL
+        */
+        bool Translate(
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            std::ostream&                           output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            TranslationStats*                       stats = nullptr,
+            ShaderReflection*                       reflection = nullptr
+        ) const;
+
+        /**
+        Translates the HLSL code from the specified character buffer into GLSL code and appends it to the specified string.
+        \remarks This avoids any output stream. The output string can be reused for several translations to reuse its memory.
+        \see TranslateHLSLtoGLSL
+        */
+        bool Translate(
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            std::string&                            output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            TranslationStats*                       stats = nullptr,
+            ShaderReflection*                       reflection = nullptr
+        ) const;
+
+        /**
+        Parses the HLSL code from the specified input stream.
+        \param[in] input Specifies the input stream. This must be valid HLSL code.
+        \param[in] log Optional pointer to an output log.
+        \return Shared pointer to the parsed program or null if parsing failed.
+        \remarks The returned program can be passed to "Generate" several times,
+        e.g. once for each entry point of an effect file, so the source is only scanned and parsed once.
+        \see Generate
+        */
+        std::shared_ptr<Program> Parse(
+            const std::shared_ptr<std::istream>&    input,
+            Logger*                                 log = nullptr
+        ) const;
+
+        /**
+        Parses the HLSL code from the specified character buffer.
+        \remarks The buffer only needs to be valid until this function returns.
+        \see Parse
+        */
+        std::shared_ptr<Program> Parse(
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            Logger*                                 log = nullptr
+        ) const;
+
+        /**
+        Parses the HLSL code from the specified input stream and runs the preprocessor first, if "options.preprocess" is true.
+        \param[in] includeHandler Optional pointer to the include handler for the preprocessor.
+        \remarks Tokenized include files are cached inside this translator,
+        so they are only scanned again if their content has changed.
+        \see Options::preprocess
+        */
+        std::shared_ptr<Program> Parse(
+            const std::shared_ptr<std::istream>&    input,
+            IncludeHandler*                         includeHandler,
+            const Options&                          options,
+            Logger*                                 log = nullptr
+        ) const;
+
+        /**
+        Parses the HLSL code from the specified character buffer and runs the preprocessor first, if "options.preprocess" is true.
+        \see Parse
+        */
+        std::shared_ptr<Program> Parse(
+            const char*                             inputSource,
+            std::size_t                             inputSourceSize,
+            IncludeHandler*                         includeHandler,
+            const Options&                          options,
+            Logger*                                 log = nullptr
+        ) const;
+
+        /**
+        Analyzes the specified parsed program and generates the GLSL code for the specified entry point and shader target.
+        \param[in] program Specifies the program which has been returned by "Parse".
+        \remarks The decorations of the context analysis are renewed with each call,
+        so the same program can be generated with different entry points, shader targets and options.
+        A program must not be used by several threads at the same time; use one program per thread instead.
+        \see Parse
+        \see TranslateHLSLtoGLSL
+        */
+        bool Generate(
+            Program&                                program,
+            std::ostream&                           output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            TranslationStats*                       stats = nullptr,
+            ShaderReflection*                       reflection = nullptr
+        ) const;
+
+        /**
+        Analyzes the specified parsed program and appends the generated GLSL code to the specified string.
+        \see Generate
+        */
+        bool Generate(
+            Program&                                program,
+            std::string&                            output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler = nullptr,
+            const Options&                          options = {},
+            Logger*                                 log = nullptr,
+            TranslationStats*                       stats = nullptr,
+            ShaderReflection*                       reflection = nullptr
+        ) const;
+
+        /**
+        Writes the specified parsed program into a compact binary format (e.g. to store a precompiled include file).
+        \param[in] program Specifies the program which has been returned by "Parse", "ReadProgram" or "LinkPrograms".
+        \param[out] data Specifies the output buffer. The serialized program is appended to this buffer.
+        \remarks Only the syntax tree is stored (node types, fields, source positions and flags),
+        but not the decorations of a previous context analysis. The format is independent of the platform (all integers are stored byte by byte),
+        but it is only valid for the same version of this library.
+        \see ReadProgram
+        */
+        void WriteProgram(const Program& program, std::string& data) const;
+
+        /**
+        Reads a program from the binary format which has been written by "WriteProgram".
+        \param[in] data Pointer to the serialized program. This can also be a memory mapped file.
+        The buffer only needs to be valid until this function returns.
+        \param[in] size Specifies the size (in bytes) of the serialized program.
+        \param[in] log Optional pointer to an output log.
+        \return Shared pointer to the program or null if the data is invalid.
+        \remarks The returned program can be used like a program which has been returned by "Parse".
+        \see WriteProgram
+        \see LinkPrograms
+        */
+        std::shared_ptr<Program> ReadProgram(
+            const char*                             data,
+            std::size_t                             size,
+            Logger*                                 log = nullptr
+        ) const;
+
+        /**
+        Links precompiled modules into the specified program, where they are included.
+        \param[in] program Specifies the main program.
+        \param[in] modules Specifies the programs of the precompiled include files. The key is the include filename,
+        e.g. "CoreShader.hlsl" for the directive '#include "CoreShader.hlsl"' (or '#include <CoreShader.hlsl>').
+        \return Shared pointer to the new program. Every global '#include' directive which refers to a module is replaced by
+        the global declarations of that module (modules can include other modules). Each module is only linked once,
+        so further directives which refer to the same module are removed like with an include guard.
+        All other directives are kept unchanged.
+        \remarks The new program shares the nodes of the main program and all modules (and keeps them alive),
+        so the source is not scanned and parsed again. Because the decorations are stored inside the nodes,
+        a module must not be generated by several threads at the same time; read a separate module for each thread instead.
+        \see ReadProgram
+        \see Generate
+        */
+        std::shared_ptr<Program> LinkPrograms(
+            const std::shared_ptr<Program>&                         program,
+            const std::map<std::string, std::shared_ptr<Program>>&  modules
+        ) const;
+
+        /**
+        Translates all specified jobs concurrently.
+        \param[in] jobs Specifies the translation jobs.
+        \param[in] numThreads Specifies the number of worker threads.
+        If this is 0, the number of hardware threads is used. By default 0.
+        \return List of translation results; one for each job in the same order as the jobs.
+        \remarks The jobs are distributed over a work-stealing thread pool, so a few large shaders
+        do not hold back the remaining jobs. Each job is translated independently,
+        i.e. the output is identical to calling "Translate" for each job sequentially.
+        The messages of each job are recorded in its result (see "TranslationResult::messages") and also written to the log of the job.
+        \see TranslationJob
+        */
+        std::vector<TranslationResult> TranslateBatch(
+            const std::vector<TranslationJob>&      jobs,
+            unsigned int                            numThreads = 0
+        ) const;
+
+        /**
+        Translates the specified HLSL code once for each set of macro definitions (shader permutations).
+        \param[in] macroSets Specifies the macro definitions for each permutation (name and value).
+        These macros are defined in addition to "options.macros" and replace them if they have the same name.
+        \param[in] numThreads Specifies the number of worker threads. If this is 0, the number of hardware threads is used. By default 0.
+        \return List of translation results; one for each macro set in the same order as the macro sets.
+        \remarks The preprocessor is always used for permutations (independent of "options.preprocess").
+        The source is scanned only once and each include file is only requested once from the include handler.
+        Permutations which result in the same preprocessed token stream are only parsed and generated once.
+        If their tokens have other source positions (e.g. the same code in another conditional block), they are only translated on their own,
+        if the messages of the first permutation (which refer to the source positions) are not empty, or if "Options::lineMarks" is enabled.
+        All messages are written to the log in the order of the permutations, and recorded in the result of each permutation.
+        \see Options::macros
+        */
+        std::vector<TranslationResult> TranslatePermutations(
+            const char*                                         inputSource,
+            std::size_t                                         inputSourceSize,
+            const std::vector<std::map<std::string, std::string>>& macroSets,
+            const std::string&                                  entryPoint,
+            const ShaderTargets                                 shaderTarget,
+            const InputShaderVersions                           inputShaderVersion,
+            const OutputShaderVersions                          outputShaderVersion,
+            IncludeHandler*                                     includeHandler = nullptr,
+            const Options&                                      options = {},
+            Logger*                                             log = nullptr,
+            unsigned int                                        numThreads = 0
+        ) const;
+
+        /**
+        Translates the specified HLSL code for all stages of a shader pipeline together, and removes the unused varyings.
+        \param[in] stages Specifies the stages in the order of the pipeline, e.g. vertex, geometry and fragment shader.
+        \return List of translation results; one for each stage in the same order as the stages.
+        \remarks The outputs of each stage are matched with the inputs of the next stage by their semantics.
+        Outputs which are not read by the next stage are removed (except system values), together with all assignments to them,
+        and the computations which only feed these assignments are removed by the dead code elimination, which is always enabled here.
+        Inputs which are not read are removed from the interface blocks of the stages after the first one,
+        so the remaining varyings of adjacent stages still match and use consecutive locations (see "Options::explicitBinding").
+        Input parameters of the entry points which are not read are not copied from their built-in variables (e.g. "gl_FragCoord").
+        The source is only parsed once. The stages are generated in reverse order, so the messages are written to the log in reverse order, too.
+        The messages of the code generation of each stage are also recorded in its result (see "TranslationResult::messages").
+        If a stage fails, the stages before it are not translated.
+        \see Options::eliminateDeadCode
+        */
+        std::vector<TranslationResult> TranslatePipeline(
+            const char*                                         inputSource,
+            std::size_t                                         inputSourceSize,
+            const std::vector<PipelineStage>&                   stages,
+            const InputShaderVersions                           inputShaderVersion,
+            const OutputShaderVersions                          outputShaderVersion,
+            IncludeHandler*                                     includeHandler = nullptr,
+            const Options&                                      options = {},
+            Logger*                                             log = nullptr
+        ) const;
+
+    private:
+        
+        friend class IncrementalTranslator;
+
+        struct Tables;
+
+        std::shared_ptr<Program> Parse(
+            const std::shared_ptr<SourceCode>&      source,
+            IncludeHandler*                         includeHandler,
+            const Options&                          options,
+            Logger*                                 log,
+            TranslationStats*                       stats
+        ) const;
+
+        bool Analyze(
+            HLSLAnalyzer&                           analyzer,
+            Program&                                program,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            const Options&                          options,
+            Logger*                                 log,
+            TranslationStats*                       stats,
+            StageVaryings*                          varyings,
+            FunctionBodyStream*                     bodyStream,
+            TemporaryFunctionBodies*                temporaryBodies
+        ) const;
+
+        /**
+        Analyzes the program and generates the code into the specified output (a stream or a string).
+        \param[in] releaseFunctionBodies Specifies whether the program is only used for this translation,
+        so that its function bodies may be released (see "Options::streamOutput").
+        Otherwise, the skipped bodies which are parsed for this translation are released afterwards (see "Options::lazyFunctionBodies"),
+        so that the output does not depend on previous translations of the same program.
+        \param[in] outputCache Optional pointer to the output cache of an incremental translation (see "IncrementalTranslator").
+        */
+        template <typename Output> bool GenerateOutput(
+            Program&                                program,
+            Output&                                 output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler,
+            const Options&                          options,
+            Logger*                                 log,
+            TranslationStats*                       stats,
+            ShaderReflection*                       reflection,
+            StageVaryings*                          varyings,
+            DeclOutputCache*                        outputCache,
+            bool                                    releaseFunctionBodies
+        ) const;
+
+        //! Analyzes the specified program and generates its code with the output cache of an incremental translation.
+        bool GenerateCached(
+            Program&                                program,
+            std::string&                            output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler,
+            const Options&                          options,
+            Logger*                                 log,
+            TranslationStats*                       stats,
+            DeclOutputCache*                        outputCache
+        ) const;
+
+        bool Translate(
+            const std::shared_ptr<SourceCode>&      source,
+            std::ostream&                           output,
+            const std::string&                      entryPoint,
+            const ShaderTargets                     shaderTarget,
+            const InputShaderVersions               inputShaderVersion,
+            const OutputShaderVersions              outputShaderVersion,
+            IncludeHandler*                         includeHandler,
+            const Options&                          options,
+            Logger*                                 log,
+            TranslationStats*                       stats,
+            ShaderReflection*                       reflection
+        ) const;
+
+        std::unique_ptr<Tables> tables_;
+
+};
+
 /**
 Translates the HLSL code from the specified input stream into GLSL code.
 \param[in] input Specifies the input stream. This must be valid HLSL code.
@@ -98,12 +730,14 @@ and this parameter is null, the code generation will fail! By default null.
 \param[in] options Additional options to configure the code generation.
 \param[in] log Optional pointer to an output log. Inherit from the "Logger" class interface.
 \return True if the code has been translated correctly.
+\remarks This uses a process wide "Translator" instance, so the lookup tables are only built once.
 \note This translator makes a minimum of contextual analysis.
 Therefore wrong HLSL code may be translated into wrong GLSL code!
 \see InputShaderVersions
 \see OutputShaderVersions
 \see IncludeHandler
 \see Options
+\see Translator
 \see Logger
 */
 _HT_EXPORT_ bool TranslateHLSLtoGLSL(
@@ -118,6 +752,28 @@ _HT_EXPORT_ bool TranslateHLSLtoGLSL(
     Logger*                                 log = nullptr
 );
 
+/**
+Translates the HLSL code from the specified character buffer into GLSL code.
+\param[in] inputSource Pointer to the HLSL source code. This does not need to be null terminated.
+The buffer is read in place (it is not copied) and must remain valid until this function returns.
+\param[in] inputSourceSize Specifies the size (in bytes) of the HLSL source code.
+\remarks This is equivalent to the stream based version of "TranslateHLSLtoGLSL",
+but avoids wrapping sources, which are already in memory, into an input stream.
+\see TranslateHLSLtoGLSL
+*/
+_HT_EXPORT_ bool TranslateHLSLtoGLSL(
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler = nullptr,
+    const Options&                          options = {},
+    Logger*                                 log = nullptr
+);
+
 
 } // /namespace HTLib
 
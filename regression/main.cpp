@@ -0,0 +1,491 @@
+/*
+ * HLSL Translator regression test main file
+ *
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <HT/Translator.h>
+#include <HT/IncrementalTranslator.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+
+
+using namespace HTLib;
+
+/* --- Classes --- */
+
+//! Logger which records all messages with their severity, so the logs of two translations can be compared.
+class RecordLog : public Logger
+{
+
+    public:
+
+        void Info(const std::string& message) override
+        {
+            messages.push_back("info: " + message);
+        }
+
+        void Warning(const std::string& message) override
+        {
+            messages.push_back("warning: " + message);
+        }
+
+        void Error(const std::string& message) override
+        {
+            messages.push_back("error: " + message);
+        }
+
+        void IncIndent() override
+        {
+            maxIndent = std::max(maxIndent, ++indent);
+        }
+
+        void DecIndent() override
+        {
+            --indent;
+        }
+
+        std::vector<std::string>    messages;
+        int                         indent      = 0;
+        int                         maxIndent   = 0;
+
+};
+
+//! Regression test case. The test function throws an exception if the test failed.
+struct TestCase
+{
+    std::string             name;
+    std::function<void()>   func;
+};
+
+/* --- Global functions --- */
+
+static void Check(bool condition, const std::string& msg)
+{
+    if (!condition)
+        throw std::runtime_error(msg);
+}
+
+static std::string Join(const std::vector<std::string>& lines)
+{
+    std::string str;
+    for (const auto& line : lines)
+        str += "  " + line + "\n";
+    return str;
+}
+
+//! Returns a shader with the specified number of functions and the specified code inside the function in the middle.
+static std::string LargeShader(int numFunctions, const std::string& faultyCode)
+{
+    std::stringstream s;
+
+    for (int i = 0; i < numFunctions; ++i)
+    {
+        s << "float4 Func" << i << "(float4 v)\n{\n";
+        if (i == numFunctions / 2)
+            s << "    " << faultyCode << "\n";
+        s << "    return v * " << i << ".0 + float4(1, 2, 3, 4);\n}\n\n";
+    }
+
+    s << "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    return Func0(pos);\n}\n";
+
+    return s.str();
+}
+
+//! Translates the specified shader with the specified number of parser threads, and returns the log.
+static std::vector<std::string> TranslateWithParserThreads(const std::string& source, unsigned int parserThreads, bool& result)
+{
+    Translator translator;
+    RecordLog log;
+
+    Options options;
+    options.timeStamp       = false;
+    options.parserThreads   = parserThreads;
+
+    std::string output;
+    result = translator.Translate(
+        source.data(), source.size(), output, "VS", ShaderTargets::GLSLVertexShader,
+        InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+    );
+
+    return log.messages;
+}
+
+//! The log of a concurrent parse must be identical to the log of a single-threaded parse (see "Options::parserThreads").
+static void TestParserThreadsLog()
+{
+    const std::vector<std::string> faultyCodes
+    {
+        "float x = 1 + $ 2;",   // Lexical error (the parser skips the character and continues)
+        "float x = (1 + ;",     // Syntax error
+    };
+
+    for (const auto& faultyCode : faultyCodes)
+    {
+        const auto source = LargeShader(3000, faultyCode);
+
+        bool serialResult = false, concurrentResult = false;
+        auto serialLog      = TranslateWithParserThreads(source, 1, serialResult);
+        auto concurrentLog  = TranslateWithParserThreads(source, 4, concurrentResult);
+
+        Check(!serialLog.empty(), "no message for \"" + faultyCode + "\"");
+        Check(
+            serialLog == concurrentLog && serialResult == concurrentResult,
+            "logs for \"" + faultyCode + "\" differ:\n1 thread:\n" + Join(serialLog) + "4 threads:\n" + Join(concurrentLog)
+        );
+    }
+}
+
+//! The operands of a binary expression chain must be printed as siblings in the AST dump (see "Options::dumpAST").
+static void TestDumpASTChain()
+{
+    std::string source = "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    float x = pos.x";
+    for (int i = 0; i < 10000; ++i)
+        source += " + pos.x";
+    source += ";\n    return pos * x;\n}\n";
+
+    Translator translator;
+    RecordLog log;
+
+    Options options;
+    options.timeStamp   = false;
+    options.dumpAST     = true;
+
+    std::string output;
+    auto result = translator.Translate(
+        source.data(), source.size(), output, "VS", ShaderTargets::GLSLVertexShader,
+        InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+    );
+
+    Check(result, "translation failed:\n" + Join(log.messages));
+    Check(log.maxIndent < 20, "AST dump is indented " + std::to_string(log.maxIndent) + " levels deep");
+}
+
+/**
+Returns a shader with the specified number of functions, which are all called by the entry point,
+and a helper function, which is only called by the first function. The specified code is inserted into the function with the specified index.
+*/
+static std::string IncrementalShader(int numFunctions, const std::string& helperFactor, int editedFunction, const std::string& editedCode)
+{
+    std::stringstream s;
+
+    s << "float4 Helper(float4 v)\n{\n    return v * " << helperFactor << ";\n}\n\n";
+
+    for (int i = 0; i < numFunctions; ++i)
+    {
+        s << "float4 Func" << i << "(float4 v)\n{\n";
+        if (i == editedFunction)
+            s << "    " << editedCode << "\n";
+        s << "    return " << (i == 0 ? "Helper(v)" : "v") << " * " << i << ".0 + float4(1, 2, 3, 4);\n}\n\n";
+    }
+
+    s << "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    return pos";
+    for (int i = 0; i < numFunctions; ++i)
+        s << " + Func" << i << "(pos)";
+    s << ";\n}\n";
+
+    return s.str();
+}
+
+//! Editing a function must only generate the output of that function and its callers again (see "IncrementalTranslator").
+static void TestIncrementalOutput()
+{
+    const int numFunctions = 20;
+
+    Translator translator;
+    IncrementalTranslator incrementalTranslator;
+
+    Options options;
+    options.timeStamp = false;
+
+    auto translate = [&](const std::string& source, std::size_t numGenerated)
+    {
+        RecordLog log;
+
+        std::string incrementalOutput, output;
+        auto result = incrementalTranslator.Translate(
+            translator, source.data(), source.size(), incrementalOutput, "VS", ShaderTargets::GLSLVertexShader,
+            InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+        );
+        Check(result, "incremental translation failed:\n" + Join(log.messages));
+
+        translator.Translate(
+            source.data(), source.size(), output, "VS", ShaderTargets::GLSLVertexShader,
+            InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options
+        );
+        Check(incrementalOutput == output, "incremental output differs from the output of a full translation");
+
+        /* All functions except the entry point are either generated or re-used */
+        const auto numReused = static_cast<std::size_t>(numFunctions + 1) - numGenerated;
+        Check(
+            incrementalTranslator.NumGeneratedOutputs() == numGenerated && incrementalTranslator.NumReusedOutputs() == numReused,
+            std::to_string(incrementalTranslator.NumGeneratedOutputs()) + " outputs generated and " +
+            std::to_string(incrementalTranslator.NumReusedOutputs()) + " re-used (expected " +
+            std::to_string(numGenerated) + " and " + std::to_string(numReused) + ")"
+        );
+    };
+
+    translate(IncrementalShader(numFunctions, "2.0", -1, ""), numFunctions + 1);
+    translate(IncrementalShader(numFunctions, "2.0", -1, ""), 0);
+
+    /* Edit a single function, which is only called by the entry point */
+    translate(IncrementalShader(numFunctions, "2.0", 5, "v.x += 1.0;"), 1);
+    translate(IncrementalShader(numFunctions, "2.0", 5, "v.y += 1.0;"), 1);
+
+    /* Edit the helper function, which is also generated again for its caller */
+    translate(IncrementalShader(numFunctions, "3.0", 5, "v.y += 1.0;"), 2);
+}
+
+//! The messages of each permutation must refer to its own source positions (see "Translator::TranslatePermutations").
+static void TestPermutationPositions()
+{
+    /* Both branches contain the same code (with a syntax error), so both permutations have the same token stream */
+    const std::string code = "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    return pos + ;\n}\n";
+    const std::string source = "#ifdef FIRST\n" + code + "#else\n\n\n" + code + "#endif\n";
+
+    Translator translator;
+
+    Options options;
+    options.timeStamp = false;
+
+    auto results = translator.TranslatePermutations(
+        source.data(), source.size(), { { { "FIRST", "" } }, {} }, "VS", ShaderTargets::GLSLVertexShader,
+        InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options
+    );
+
+    Check(results.size() == 2, "wrong number of results");
+
+    const std::vector<int> expectedRows { 4, 11 };
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        std::vector<std::string> messages;
+        for (const auto& record : results[i].messages.Records())
+            messages.push_back(results[i].messages.Message(record));
+
+        auto found = std::any_of(
+            messages.begin(), messages.end(),
+            [&](const std::string& message)
+            {
+                return message.find("(" + std::to_string(expectedRows[i]) + ":") != std::string::npos;
+            }
+        );
+        Check(
+            !results[i].succeeded && found,
+            "permutation " + std::to_string(i) + " has no error in row " + std::to_string(expectedRows[i]) + ":\n" + Join(messages)
+        );
+    }
+}
+
+//! Folded values must be written in the type of the variable they are assigned to (see "Options::foldConstants").
+static void TestFoldedConversion()
+{
+    const std::string source =
+        "float4 VS(float4 pos : POSITION) : SV_Position\n{\n"
+        "    float f = 1/2;\n    int i = 1.5*3.0;\n    uint u = 2*3;\n    float3 v = int3(1, 2, 3)*2;\n    f += 1+1;\n"
+        "    return pos * f * i * u * v.x;\n}\n";
+
+    Translator translator;
+    RecordLog log;
+
+    Options options;
+    options.timeStamp       = false;
+    options.foldConstants   = true;
+
+    std::string output;
+    auto result = translator.Translate(
+        source.data(), source.size(), output, "VS", ShaderTargets::GLSLVertexShader,
+        InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+    );
+
+    Check(result, "translation failed:\n" + Join(log.messages));
+
+    const std::vector<std::string> expectedCodes
+    {
+        "f = 0.0;", "i = 4;", "u = 6u;", "v = vec3(2.0, 4.0, 6.0);", "f += 2.0;"
+    };
+
+    for (const auto& code : expectedCodes)
+        Check(output.find(code) != std::string::npos, "\"" + code + "\" not found in output:\n" + output);
+}
+
+//! The preprocessor must expand "__LINE__" and drop the pragmas for the HLSL compiler (see "Options::preprocess").
+static void TestPreprocessorDirectives()
+{
+    const std::string source =
+        "#pragma pack_matrix(column_major)\n#pragma warning(disable : 3206)\n#pragma optimize(off)\n#define ROW __LINE__\n"
+        "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    float x = ROW;\n#line 100\n    float y = __LINE__;\n"
+        "    return pos * x * y;\n}\n";
+
+    Translator translator;
+    RecordLog log;
+
+    Options options;
+    options.timeStamp   = false;
+    options.preprocess  = true;
+
+    std::string output;
+    auto result = translator.Translate(
+        source.data(), source.size(), output, "VS", ShaderTargets::GLSLVertexShader,
+        InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+    );
+
+    Check(result, "translation failed:\n" + Join(log.messages));
+
+    for (const auto& code : { "x = 7;", "y = 100;", "#pragma optimize(off)" })
+        Check(output.find(code) != std::string::npos, "\"" + std::string(code) + "\" not found in output:\n" + output);
+
+    for (const auto& code : { "pack_matrix", "warning", "__LINE__" })
+        Check(output.find(code) == std::string::npos, "\"" + std::string(code) + "\" found in output:\n" + output);
+}
+
+//! GLSL ES output must not contain double precision types (see "OutputShaderVersions::ESSL300").
+static void TestESSLDouble()
+{
+    Translator translator;
+
+    Options options;
+    options.timeStamp = false;
+
+    auto translate = [&](const std::string& source, std::string& output, RecordLog& log)
+    {
+        return translator.Translate(
+            source.data(), source.size(), output, "VS", ShaderTargets::GLSLVertexShader,
+            InputShaderVersions::HLSL5, OutputShaderVersions::ESSL300, nullptr, options, &log
+        );
+    };
+
+    /* Double precision variables are reported as error */
+    {
+        const std::string source =
+            "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    double2 d = double2(1, 2);\n    return pos * (float)d.x;\n}\n";
+
+        RecordLog log;
+        std::string output;
+        auto result = translate(source, output, log);
+
+        auto reported = std::any_of(
+            log.messages.begin(), log.messages.end(),
+            [](const std::string& message)
+            {
+                return message.find("type \"double2\" is not supported in GLSL ES") != std::string::npos;
+            }
+        );
+        Check(!result && reported, "double precision type is not reported:\n" + Join(log.messages));
+    }
+
+    /* The helper functions have no double precision overloads */
+    {
+        const std::string source =
+            "float4 VS(float4 pos : POSITION) : SV_Position\n{\n    return pos * rcp(pos.w);\n}\n";
+
+        RecordLog log;
+        std::string output;
+        auto result = translate(source, output, log);
+
+        Check(result, "translation failed:\n" + Join(log.messages));
+        Check(output.find("double") == std::string::npos && output.find("dvec") == std::string::npos, "double precision type in output:\n" + output);
+    }
+}
+
+//! Unused input parameters of the entry points must not be copied in a pipeline translation (see "Translator::TranslatePipeline").
+static void TestPipelineUnusedParams()
+{
+    const std::string source =
+        "struct VOut\n{\n    float4 pos : SV_Position;\n    float2 uv : TEXCOORD0;\n};\n\n"
+        "VOut VS(float4 pos : POSITION, uint id : SV_VertexID)\n{\n    VOut o;\n    o.pos = pos;\n    o.uv = pos.xy;\n    return o;\n}\n\n"
+        "float4 PS(float4 pos : SV_Position, float4 color : COLOR0, bool front : SV_IsFrontFace) : SV_Target\n{\n"
+        "    return (front ? color : pos);\n}\n\n"
+        "float4 PS2(float4 pos : SV_Position, float4 color : COLOR0) : SV_Target\n{\n    return color;\n}\n";
+
+    Translator translator;
+    RecordLog log;
+
+    Options options;
+    options.timeStamp = false;
+
+    auto translate = [&](const std::string& fragmentEntryPoint) -> std::vector<TranslationResult>
+    {
+        auto results = translator.TranslatePipeline(
+            source.data(), source.size(),
+            { { "VS", ShaderTargets::GLSLVertexShader }, { fragmentEntryPoint, ShaderTargets::GLSLFragmentShader } },
+            InputShaderVersions::HLSL5, OutputShaderVersions::GLSL330, nullptr, options, &log
+        );
+        Check(results.size() == 2 && results[0].succeeded && results[1].succeeded, "translation failed:\n" + Join(log.messages));
+        return results;
+    };
+
+    /* Used parameters are copied */
+    auto results = translate("PS");
+    Check(results[1].output.find("= gl_FragCoord;") != std::string::npos, "used parameter is not copied:\n" + results[1].output);
+    Check(results[1].output.find("= gl_FrontFacing;") != std::string::npos, "used parameter is not copied:\n" + results[1].output);
+    Check(results[0].output.find("gl_VertexID") == std::string::npos, "unused parameter is copied:\n" + results[0].output);
+
+    /* Unused parameters are not copied */
+    results = translate("PS2");
+    Check(results[1].output.find("= gl_FragCoord;") == std::string::npos, "unused parameter is copied:\n" + results[1].output);
+}
+
+static const std::vector<TestCase>& TestCases()
+{
+    static const std::vector<TestCase> testCases
+    {
+        { "ParserThreadsLog",       TestParserThreadsLog       },
+        { "DumpASTChain",           TestDumpASTChain           },
+        { "IncrementalOutput",      TestIncrementalOutput      },
+        { "PermutationPositions",   TestPermutationPositions   },
+        { "FoldedConversion",       TestFoldedConversion       },
+        { "PreprocessorDirectives", TestPreprocessorDirectives },
+        { "ESSLDouble",             TestESSLDouble             },
+        { "PipelineUnusedParams",   TestPipelineUnusedParams   },
+    };
+    return testCases;
+}
+
+/**
+Runs the test cases with the specified names (or all test cases).
+\return Exit code 0 if all tests passed, or 1 otherwise.
+*/
+int main(int argc, char** argv)
+{
+    std::vector<std::string> names(argv + 1, argv + argc);
+    int numFailures = 0, numTests = 0;
+
+    for (const auto& testCase : TestCases())
+    {
+        if (!names.empty() && std::find(names.begin(), names.end(), testCase.name) == names.end())
+            continue;
+
+        ++numTests;
+
+        try
+        {
+            testCase.func();
+            std::cout << "passed: " << testCase.name << std::endl;
+        }
+        catch (const std::exception& err)
+        {
+            std::cerr << "FAILED: " << testCase.name << ": " << err.what() << std::endl;
+            ++numFailures;
+        }
+    }
+
+    if (numTests == 0)
+    {
+        std::cerr << "no test case found" << std::endl;
+        return 1;
+    }
+
+    return (numFailures > 0 ? 1 : 0);
+}
+
+
+
+// ================================================================================
\ No newline at end of file
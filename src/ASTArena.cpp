@@ -0,0 +1,83 @@
+/*
+ * ASTArena.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ASTArena.h"
+#include "HLSLTree.h"
+
+
+namespace HTLib
+{
+
+
+static const std::size_t nodeAlignment = alignof(std::max_align_t);
+
+ASTArena::ASTArena(std::size_t maxBlockSize) :
+    maxBlockSize_ { maxBlockSize > minBlockSize ? maxBlockSize : minBlockSize }
+{
+}
+
+ASTArena::~ASTArena()
+{
+    Clear();
+}
+
+void ASTArena::Clear()
+{
+    /* Destroy nodes in reverse order of their construction */
+    for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it)
+        (*it)->~AST();
+
+    nodes_.clear();
+    blocks_.clear();
+
+    blockPtr_       = nullptr;
+    blockFree_      = 0;
+    usedBytes_      = 0;
+    reservedBytes_  = 0;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void* ASTArena::Allocate(std::size_t size)
+{
+    /* Round up size to the node alignment */
+    size = (size + nodeAlignment - 1) & ~(nodeAlignment - 1);
+
+    if (size > blockFree_)
+    {
+        /*
+        Allocate new block (nodes which are larger than a block get their own block).
+        The block size grows up to the maximum, so small programs (e.g. single declarations) don't reserve a large block.
+        */
+        auto blockSize = (blocks_.size() < 6 ? (minBlockSize << blocks_.size()) : maxBlockSize_);
+        if (blockSize > maxBlockSize_)
+            blockSize = maxBlockSize_;
+        auto newBlockSize = (size > blockSize ? size : blockSize);
+        blocks_.emplace_back(new char[newBlockSize]);
+        blockPtr_       = blocks_.back().get();
+        blockFree_      = newBlockSize;
+        reservedBytes_  += newBlockSize;
+    }
+
+    auto ptr = blockPtr_;
+
+    blockPtr_   += size;
+    blockFree_  -= size;
+    usedBytes_  += size;
+
+    return ptr;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
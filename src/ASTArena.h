@@ -0,0 +1,98 @@
+/*
+ * ASTArena.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_AST_ARENA_H__
+#define __HT_AST_ARENA_H__
+
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <new>
+
+
+namespace HTLib
+{
+
+
+struct AST;
+
+/**
+Bump allocator for AST nodes.
+\remarks All nodes are allocated contiguously in large memory blocks and are destroyed
+together with the arena, i.e. there is no per-node reference counting or heap block.
+Pointers to the nodes stay valid for the entire lifetime of the arena.
+*/
+class ASTArena
+{
+    
+    public:
+        
+        //! \param[in] maxBlockSize Specifies the maximal size of the memory blocks (small arenas waste less memory with small blocks).
+        explicit ASTArena(std::size_t maxBlockSize = defaultMaxBlockSize);
+        ~ASTArena();
+
+        ASTArena(const ASTArena&) = delete;
+        ASTArena& operator = (const ASTArena&) = delete;
+
+        //! Allocates and constructs a new AST node of the specified class.
+        template <typename T, typename... Args> T* New(Args&&... args)
+        {
+            auto node = new (Allocate(sizeof(T))) T(std::forward<Args>(args)...);
+            nodes_.push_back(node);
+            return node;
+        }
+
+        //! Destroys all nodes and releases all memory blocks.
+        void Clear();
+
+        //! Returns the list of all allocated nodes (in allocation order).
+        inline const std::vector<AST*>& Nodes() const
+        {
+            return nodes_;
+        }
+
+        //! Returns the number of bytes which are used by all nodes.
+        inline std::size_t UsedBytes() const
+        {
+            return usedBytes_;
+        }
+
+        //! Returns the number of bytes of all memory blocks.
+        inline std::size_t ReservedBytes() const
+        {
+            return reservedBytes_;
+        }
+
+        static const std::size_t defaultMaxBlockSize = 64 * 1024;
+
+    private:
+        
+        void* Allocate(std::size_t size);
+
+        static const std::size_t minBlockSize = 2 * 1024;
+
+        std::size_t                             maxBlockSize_   = defaultMaxBlockSize;
+        std::vector<std::unique_ptr<char[]>>    blocks_;
+        char*                                   blockPtr_       = nullptr;
+        std::size_t                             blockFree_      = 0;
+        std::size_t                             usedBytes_      = 0;
+        std::size_t                             reservedBytes_  = 0;
+
+        std::vector<AST*>                       nodes_;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -10,11 +10,9 @@
 
 
 #include "HT/Translator.h"
-#include "CodeWriter.h"
-#include "Visitor.h"
-#include "Token.h"
+#include "FlatTree.h"
 
-#include <map>
+#include <string>
 #include <vector>
 
 
@@ -22,8 +20,13 @@ namespace HTLib
 {
 
 
-//! AST debug printer.
-class ASTPrinter : private Visitor
+/**
+AST debug printer.
+\remarks The printer runs linearly over the flat layout of the AST (see "FlatTree"), i.e. the nodes are printed in pre-order
+and the indentation of each node is its depth in the tree, so no recursive traversal of the node pointers is required.
+Binary expression chains are the exception: their operands are printed as siblings (see "DumpAST").
+*/
+class ASTPrinter
 {
     
     public:
@@ -32,68 +35,21 @@ class ASTPrinter : private Visitor
 
     private:
         
-        /* --- Visitor implementation --- */
-
-        DECL_VISIT_PROC( Program           );
-        DECL_VISIT_PROC( CodeBlock         );
-        DECL_VISIT_PROC( BufferDeclIdent   );
-        DECL_VISIT_PROC( FunctionCall      );
-        DECL_VISIT_PROC( Structure         );
-        DECL_VISIT_PROC( SwitchCase        );
-
-        DECL_VISIT_PROC( FunctionDecl      );
-        DECL_VISIT_PROC( UniformBufferDecl );
-        DECL_VISIT_PROC( TextureDecl       );
-        DECL_VISIT_PROC( SamplerDecl       );
-        DECL_VISIT_PROC( StructDecl        );
-        DECL_VISIT_PROC( DirectiveDecl     );
-
-        DECL_VISIT_PROC( NullStmnt         );
-        DECL_VISIT_PROC( DirectiveStmnt    );
-        DECL_VISIT_PROC( CodeBlockStmnt    );
-        DECL_VISIT_PROC( ForLoopStmnt      );
-        DECL_VISIT_PROC( WhileLoopStmnt    );
-        DECL_VISIT_PROC( DoWhileLoopStmnt  );
-        DECL_VISIT_PROC( IfStmnt           );
-        DECL_VISIT_PROC( ElseStmnt         );
-        DECL_VISIT_PROC( SwitchStmnt       );
-        DECL_VISIT_PROC( VarDeclStmnt      );
-        DECL_VISIT_PROC( AssignStmnt       );
-        DECL_VISIT_PROC( ExprStmnt         );
-        DECL_VISIT_PROC( FunctionCallStmnt );
-        DECL_VISIT_PROC( ReturnStmnt       );
-        DECL_VISIT_PROC( StructDeclStmnt   );
-        DECL_VISIT_PROC( CtrlTransferStmnt );
-
-        DECL_VISIT_PROC( ListExpr          );
-        DECL_VISIT_PROC( LiteralExpr       );
-        DECL_VISIT_PROC( TypeNameExpr      );
-        DECL_VISIT_PROC( TernaryExpr       );
-        DECL_VISIT_PROC( BinaryExpr        );
-        DECL_VISIT_PROC( UnaryExpr         );
-        DECL_VISIT_PROC( PostUnaryExpr     );
-        DECL_VISIT_PROC( FunctionCallExpr  );
-        DECL_VISIT_PROC( BracketExpr       );
-        DECL_VISIT_PROC( CastExpr          );
-        DECL_VISIT_PROC( VarAccessExpr     );
-        DECL_VISIT_PROC( InitializerExpr   );
-
-        DECL_VISIT_PROC( PackOffset        );
-        DECL_VISIT_PROC( VarSemantic       );
-        DECL_VISIT_PROC( VarType           );
-        DECL_VISIT_PROC( VarIdent          );
-        DECL_VISIT_PROC( VarDecl           );
-
-        /* --- Helper functions --- */
-
-        void Print(AST* ast, const std::string& astName, const std::string& info = "");
-
-        void IncIndent();
-        void DecIndent();
+        //! Prints the specified node of the flat tree.
+        void Print(FlatTree::Index node);
+
+        //! Returns true if the specified node is the right-hand-side of a binary expression (i.e. the next link of a chain).
+        bool IsChainOperand(FlatTree::Index node) const;
+
+        //! Returns the secondary spelling of the specified node (e.g. the buffer type of a uniform buffer), or null.
+        const std::string* SecondaryName(FlatTree::Index node) const;
 
         /* === Members === */
 
-        Logger* log_ = nullptr;
+        Logger*                     log_ = nullptr;
+        FlatTree                    tree_;
+        std::string                 msg_;       //!< Message buffer, which is reused for each node.
+        std::vector<unsigned int>   indents_;   //!< Indentation of each node of the flat tree.
 
 };
 
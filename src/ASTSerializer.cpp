@@ -0,0 +1,852 @@
+/*
+ * ASTSerializer.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ASTSerializer.h"
+
+#include <stdexcept>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Magic number at the beginning of each serialized program.
+static const char formatMagic[8] = { 'H', 'T', 'A', 'S', 'T', '\0', '\0', '\0' };
+
+//! Version of the binary format. This must be increased whenever the node classes change.
+static const std::uint32_t formatVersion = 3;
+
+//! Maps signed integers to unsigned integers, so that values with a small magnitude remain small (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...).
+static std::uint32_t ZigZagEncode(std::int32_t value)
+{
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+static std::int32_t ZigZagDecode(std::uint32_t value)
+{
+    return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+}
+
+/* --- Node class validation --- */
+
+#define IMPLEMENT_NODE_CLASS(className)                                     \
+    template <> bool IsNodeOfClass<className>(const AST::Types type)        \
+    {                                                                       \
+        return type == AST::Types::className;                               \
+    }
+
+#define IMPLEMENT_NODE_BASE_CLASS(className, firstType, lastType)           \
+    template <> bool IsNodeOfClass<className>(const AST::Types type)        \
+    {                                                                       \
+        return type >= AST::Types::firstType && type <= AST::Types::lastType; \
+    }
+
+IMPLEMENT_NODE_BASE_CLASS( GlobalDecl, FunctionDecl, DirectiveDecl     )
+IMPLEMENT_NODE_BASE_CLASS( Stmnt,      NullStmnt,    CtrlTransferStmnt )
+IMPLEMENT_NODE_BASE_CLASS( Expr,       ListExpr,     InitializerExpr   )
+
+IMPLEMENT_NODE_CLASS( CodeBlock       )
+IMPLEMENT_NODE_CLASS( BufferDeclIdent )
+IMPLEMENT_NODE_CLASS( FunctionCall    )
+IMPLEMENT_NODE_CLASS( Structure       )
+IMPLEMENT_NODE_CLASS( ElseStmnt       )
+IMPLEMENT_NODE_CLASS( VarDeclStmnt    )
+IMPLEMENT_NODE_CLASS( SwitchCase      )
+IMPLEMENT_NODE_CLASS( PackOffset      )
+IMPLEMENT_NODE_CLASS( VarSemantic     )
+IMPLEMENT_NODE_CLASS( VarType         )
+IMPLEMENT_NODE_CLASS( VarIdent        )
+IMPLEMENT_NODE_CLASS( VarDecl         )
+
+#undef IMPLEMENT_NODE_CLASS
+#undef IMPLEMENT_NODE_BASE_CLASS
+
+/* --- Field transfer functions (used for reading and writing) --- */
+
+template <typename A> void TransferFields(A& ar, CodeBlock& ast)
+{
+    ar.Refs(ast.stmnts);
+}
+
+template <typename A> void TransferFields(A& ar, BufferDeclIdent& ast)
+{
+    ar.String(ast.ident);
+    ar.String(ast.registerName);
+}
+
+template <typename A> void TransferFields(A& ar, FunctionCall& ast)
+{
+    ar.Ref(ast.name);
+    ar.Refs(ast.arguments);
+}
+
+template <typename A> void TransferFields(A& ar, Structure& ast)
+{
+    ar.String(ast.name);
+    ar.Refs(ast.members);
+}
+
+template <typename A> void TransferFields(A& ar, FunctionDecl::LazyBody& body)
+{
+    ar.String(body.source);
+    ar.UInt(body.offset);
+    ar.UInt(body.row);
+    ar.Strings(body.calledNames);
+}
+
+template <typename A> void TransferFields(A& ar, FunctionDecl& ast)
+{
+    ar.Refs(ast.attribs);
+    ar.Ref(ast.returnType);
+    ar.String(ast.name);
+    ar.Refs(ast.parameters);
+    ar.String(ast.semantic);
+    ar.Ref(ast.codeBlock);
+    ar.Optional(ast.lazyBody);
+}
+
+template <typename A> void TransferFields(A& ar, UniformBufferDecl& ast)
+{
+    ar.String(ast.bufferType);
+    ar.String(ast.name);
+    ar.String(ast.registerName);
+    ar.Refs(ast.members);
+}
+
+template <typename A> void TransferFields(A& ar, TextureDecl& ast)
+{
+    ar.String(ast.textureType);
+    ar.String(ast.colorType);
+    ar.Refs(ast.names);
+}
+
+template <typename A> void TransferFields(A& ar, SamplerDecl& ast)
+{
+    ar.String(ast.samplerType);
+    ar.Refs(ast.names);
+}
+
+template <typename A> void TransferFields(A& ar, StructDecl& ast)
+{
+    ar.Ref(ast.structure);
+}
+
+template <typename A> void TransferFields(A& ar, DirectiveDecl& ast)
+{
+    ar.String(ast.line);
+}
+
+template <typename A> void TransferFields(A& ar, PackOffset& ast)
+{
+    ar.String(ast.registerName);
+    ar.String(ast.vectorComponent);
+}
+
+template <typename A> void TransferFields(A& ar, VarSemantic& ast)
+{
+    ar.String(ast.semantic);
+    ar.Ref(ast.packOffset);
+    ar.String(ast.registerName);
+}
+
+template <typename A> void TransferFields(A& ar, VarType& ast)
+{
+    ar.String(ast.baseType);
+    ar.Ref(ast.structType);
+}
+
+template <typename A> void TransferFields(A& ar, VarIdent& ast)
+{
+    ar.String(ast.ident);
+    ar.Refs(ast.arrayIndices);
+    ar.Ref(ast.next);
+}
+
+template <typename A> void TransferFields(A& ar, VarDecl& ast)
+{
+    ar.String(ast.name);
+    ar.Refs(ast.arrayDims);
+    ar.Refs(ast.semantics);
+    ar.Ref(ast.initializer);
+    ar.OwnerRef(ast.declStmntRef); // Set by the parser, so it's part of the syntax tree
+}
+
+template <typename A> void TransferFields(A& ar, NullStmnt& ast)
+{
+}
+
+template <typename A> void TransferFields(A& ar, DirectiveStmnt& ast)
+{
+    ar.String(ast.line);
+}
+
+template <typename A> void TransferFields(A& ar, CodeBlockStmnt& ast)
+{
+    ar.Ref(ast.codeBlock);
+}
+
+template <typename A> void TransferFields(A& ar, ForLoopStmnt& ast)
+{
+    ar.Refs(ast.attribs);
+    ar.Ref(ast.initSmnt);
+    ar.Ref(ast.condition);
+    ar.Ref(ast.iteration);
+    ar.Ref(ast.bodyStmnt);
+}
+
+template <typename A> void TransferFields(A& ar, WhileLoopStmnt& ast)
+{
+    ar.Refs(ast.attribs);
+    ar.Ref(ast.condition);
+    ar.Ref(ast.bodyStmnt);
+}
+
+template <typename A> void TransferFields(A& ar, DoWhileLoopStmnt& ast)
+{
+    ar.Refs(ast.attribs);
+    ar.Ref(ast.bodyStmnt);
+    ar.Ref(ast.condition);
+}
+
+template <typename A> void TransferFields(A& ar, IfStmnt& ast)
+{
+    ar.Refs(ast.attribs);
+    ar.Ref(ast.condition);
+    ar.Ref(ast.bodyStmnt);
+    ar.Ref(ast.elseStmnt);
+}
+
+template <typename A> void TransferFields(A& ar, ElseStmnt& ast)
+{
+    ar.Ref(ast.bodyStmnt);
+}
+
+template <typename A> void TransferFields(A& ar, SwitchStmnt& ast)
+{
+    ar.Refs(ast.attribs);
+    ar.Ref(ast.selector);
+    ar.Refs(ast.cases);
+}
+
+template <typename A> void TransferFields(A& ar, VarDeclStmnt& ast)
+{
+    ar.String(ast.inputModifier);
+    ar.Strings(ast.storageModifiers);
+    ar.Strings(ast.typeModifiers);
+    ar.Ref(ast.varType);
+    ar.Refs(ast.varDecls);
+}
+
+template <typename A> void TransferFields(A& ar, AssignStmnt& ast)
+{
+    ar.Ref(ast.varIdent);
+    ar.String(ast.op);
+    ar.Ref(ast.expr);
+}
+
+template <typename A> void TransferFields(A& ar, ExprStmnt& ast)
+{
+    ar.Ref(ast.expr);
+}
+
+template <typename A> void TransferFields(A& ar, FunctionCallStmnt& ast)
+{
+    ar.Ref(ast.call);
+}
+
+template <typename A> void TransferFields(A& ar, ReturnStmnt& ast)
+{
+    ar.Ref(ast.expr);
+}
+
+template <typename A> void TransferFields(A& ar, StructDeclStmnt& ast)
+{
+    ar.Ref(ast.structure);
+}
+
+template <typename A> void TransferFields(A& ar, CtrlTransferStmnt& ast)
+{
+    ar.String(ast.instruction);
+}
+
+template <typename A> void TransferFields(A& ar, ListExpr& ast)
+{
+    ar.Ref(ast.firstExpr);
+    ar.Ref(ast.nextExpr);
+}
+
+template <typename A> void TransferFields(A& ar, LiteralExpr& ast)
+{
+    ar.String(ast.literal);
+}
+
+template <typename A> void TransferFields(A& ar, TypeNameExpr& ast)
+{
+    ar.String(ast.typeName);
+}
+
+template <typename A> void TransferFields(A& ar, TernaryExpr& ast)
+{
+    ar.Ref(ast.condition);
+    ar.Ref(ast.ifExpr);
+    ar.Ref(ast.elseExpr);
+}
+
+template <typename A> void TransferFields(A& ar, BinaryExpr& ast)
+{
+    ar.Ref(ast.lhsExpr);
+    ar.String(ast.op);
+    ar.Ref(ast.rhsExpr);
+}
+
+template <typename A> void TransferFields(A& ar, UnaryExpr& ast)
+{
+    ar.String(ast.op);
+    ar.Ref(ast.expr);
+}
+
+template <typename A> void TransferFields(A& ar, PostUnaryExpr& ast)
+{
+    ar.Ref(ast.expr);
+    ar.String(ast.op);
+}
+
+template <typename A> void TransferFields(A& ar, FunctionCallExpr& ast)
+{
+    ar.Ref(ast.call);
+}
+
+template <typename A> void TransferFields(A& ar, BracketExpr& ast)
+{
+    ar.Ref(ast.expr);
+}
+
+template <typename A> void TransferFields(A& ar, CastExpr& ast)
+{
+    ar.Ref(ast.typeExpr);
+    ar.Ref(ast.expr);
+}
+
+template <typename A> void TransferFields(A& ar, VarAccessExpr& ast)
+{
+    ar.Ref(ast.varIdent);
+    ar.String(ast.assignOp);
+    ar.Ref(ast.assignExpr);
+}
+
+template <typename A> void TransferFields(A& ar, InitializerExpr& ast)
+{
+    ar.Refs(ast.exprs);
+}
+
+template <typename A> void TransferFields(A& ar, SwitchCase& ast)
+{
+    ar.Ref(ast.expr);
+    ar.Refs(ast.stmnts);
+}
+
+//! Calls the field transfer function for the class of the specified node.
+template <typename A> bool TransferNodeFields(A& ar, AST* ast)
+{
+    #define TRANSFER_NODE(className)                                \
+        case AST::Types::className:                                 \
+            TransferFields(ar, *static_cast<className*>(ast));      \
+            return true
+
+    switch (ast->Type())
+    {
+        TRANSFER_NODE( CodeBlock         );
+        TRANSFER_NODE( BufferDeclIdent   );
+        TRANSFER_NODE( FunctionCall      );
+        TRANSFER_NODE( Structure         );
+        TRANSFER_NODE( FunctionDecl      );
+        TRANSFER_NODE( UniformBufferDecl );
+        TRANSFER_NODE( TextureDecl       );
+        TRANSFER_NODE( SamplerDecl       );
+        TRANSFER_NODE( StructDecl        );
+        TRANSFER_NODE( DirectiveDecl     );
+        TRANSFER_NODE( NullStmnt         );
+        TRANSFER_NODE( DirectiveStmnt    );
+        TRANSFER_NODE( CodeBlockStmnt    );
+        TRANSFER_NODE( ForLoopStmnt      );
+        TRANSFER_NODE( WhileLoopStmnt    );
+        TRANSFER_NODE( DoWhileLoopStmnt  );
+        TRANSFER_NODE( IfStmnt           );
+        TRANSFER_NODE( ElseStmnt         );
+        TRANSFER_NODE( SwitchStmnt       );
+        TRANSFER_NODE( VarDeclStmnt      );
+        TRANSFER_NODE( AssignStmnt       );
+        TRANSFER_NODE( ExprStmnt         );
+        TRANSFER_NODE( FunctionCallStmnt );
+        TRANSFER_NODE( ReturnStmnt       );
+        TRANSFER_NODE( StructDeclStmnt   );
+        TRANSFER_NODE( CtrlTransferStmnt );
+        TRANSFER_NODE( ListExpr          );
+        TRANSFER_NODE( LiteralExpr       );
+        TRANSFER_NODE( TypeNameExpr      );
+        TRANSFER_NODE( TernaryExpr       );
+        TRANSFER_NODE( BinaryExpr        );
+        TRANSFER_NODE( UnaryExpr         );
+        TRANSFER_NODE( PostUnaryExpr     );
+        TRANSFER_NODE( FunctionCallExpr  );
+        TRANSFER_NODE( BracketExpr       );
+        TRANSFER_NODE( CastExpr          );
+        TRANSFER_NODE( VarAccessExpr     );
+        TRANSFER_NODE( InitializerExpr   );
+        TRANSFER_NODE( SwitchCase        );
+        TRANSFER_NODE( PackOffset        );
+        TRANSFER_NODE( VarSemantic       );
+        TRANSFER_NODE( VarType           );
+        TRANSFER_NODE( VarIdent          );
+        TRANSFER_NODE( VarDecl           );
+        default:
+            return false;
+    }
+
+    #undef TRANSFER_NODE
+}
+
+/*
+Collects the child nodes of a single node with the field transfer functions.
+\remarks Owner references (see "ASTWriter::OwnerRef") are not collected, because they point back to the parent node.
+*/
+class ChildNodeCollector
+{
+
+    public:
+
+        void String(const std::string&) {}
+        void Strings(const std::vector<std::string>&) {}
+        void Strings(const std::vector<Ident>&) {}
+        template <typename T> void UInt(const T&) {}
+        template <typename T> void Optional(const std::unique_ptr<T>&) {}
+        template <typename T> void OwnerRef(T* const&) {}
+
+        template <typename T> void Ref(T* const& ast)
+        {
+            if (ast)
+                children.push_back(ast);
+        }
+
+        template <typename T> void Refs(const std::vector<T*>& asts)
+        {
+            for (auto ast : asts)
+                Ref(ast);
+        }
+
+        std::vector<AST*> children;
+
+};
+
+
+/*
+ * ASTWriter class
+ */
+
+void ASTWriter::WriteProgram(const Program& program, std::string& output)
+{
+    output_ = &output;
+    nodeIndices_.clear();
+    ownerIndices_.clear();
+    stringIndices_.clear();
+    strings_.clear();
+
+    /* Enumerate all nodes of the syntax tree in pre-order (each node before its children), starting with the global declarations */
+    std::vector<AST*> nodes;
+    std::vector<std::pair<AST*, std::uint32_t>> nodeStack;
+    ChildNodeCollector collector;
+
+    for (auto it = program.globalDecls.rbegin(); it != program.globalDecls.rend(); ++it)
+        nodeStack.push_back({ *it, 0 });
+
+    while (!nodeStack.empty())
+    {
+        auto ast = nodeStack.back().first;
+        auto owner = nodeStack.back().second;
+        nodeStack.pop_back();
+
+        /* Position of a node is its index plus one (the program itself has position zero) */
+        auto position = static_cast<std::uint32_t>(nodes.size() + 1);
+        if (!nodeIndices_.insert({ ast, position }).second)
+            throw std::runtime_error("node of type \"" + std::string(ASTTypeToString(ast->Type())) + "\" is owned more than once");
+
+        nodes.push_back(ast);
+        ownerIndices_.push_back(owner);
+
+        collector.children.clear();
+        TransferNodeFields(collector, ast);
+
+        for (auto child = collector.children.rbegin(); child != collector.children.rend(); ++child)
+            nodeStack.push_back({ *child, position });
+    }
+
+    /* Write fields into a temporary buffer first (to collect all strings for the string table) */
+    std::string fields;
+    output_ = &fields;
+
+    currentIndex_ = 0;
+    Refs(program.globalDecls);
+
+    for (currentIndex_ = 1; currentIndex_ <= nodes.size(); ++currentIndex_)
+        TransferNodeFields(*this, nodes[currentIndex_ - 1]);
+
+    /* Write header, string table, node table and fields */
+    output_ = &output;
+    output.append(formatMagic, sizeof(formatMagic));
+    WriteUInt(formatVersion);
+
+    WriteUInt(static_cast<std::uint32_t>(strings_.size()));
+    for (auto str : strings_)
+    {
+        WriteUInt(static_cast<std::uint32_t>(str->size()));
+        output.append(*str);
+    }
+
+    WriteUInt(static_cast<std::uint32_t>(nodes.size()));
+
+    unsigned int prevRow = 0;
+    for (auto ast : nodes)
+    {
+        /* Write row relative to the previous node */
+        WriteByte(static_cast<unsigned char>(ast->Type()));
+        WriteUInt(ZigZagEncode(static_cast<std::int32_t>(ast->pos.Row() - prevRow)));
+        WriteUInt(ast->pos.Column());
+        WriteUInt(ast->flags);
+        prevRow = ast->pos.Row();
+    }
+
+    output.append(fields);
+    output_ = nullptr;
+}
+
+void ASTWriter::String(const std::string& str)
+{
+    WriteUInt(StringIndex(str));
+}
+
+void ASTWriter::Strings(const std::vector<std::string>& strs)
+{
+    WriteUInt(static_cast<std::uint32_t>(strs.size()));
+    for (const auto& str : strs)
+        String(str);
+}
+
+void ASTWriter::Strings(const std::vector<Ident>& idents)
+{
+    WriteUInt(static_cast<std::uint32_t>(idents.size()));
+    for (const auto& ident : idents)
+        String(ident);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ASTWriter::WriteUInt(std::uint32_t value)
+{
+    /* Write variable-length integer (7 bits per byte, starting with the lowest bits), so small values take only one byte */
+    while (value >= 0x80)
+    {
+        output_->push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    output_->push_back(static_cast<char>(value));
+}
+
+void ASTWriter::WriteByte(unsigned char value)
+{
+    output_->push_back(static_cast<char>(value));
+}
+
+std::uint32_t ASTWriter::NodeRef(const AST* ast) const
+{
+    if (!ast)
+        return 0;
+
+    /* Child nodes are enumerated after their parent, so the distance is always positive */
+    auto it = nodeIndices_.find(ast);
+    if (it == nodeIndices_.end())
+        throw std::runtime_error("node of type \"" + std::string(ASTTypeToString(ast->Type())) + "\" is not owned by the program");
+
+    return it->second - currentIndex_;
+}
+
+unsigned char ASTWriter::OwnerNodeRef(const AST* ast) const
+{
+    if (!ast)
+        return 0;
+
+    auto it = nodeIndices_.find(ast);
+    if (it == nodeIndices_.end() || it->second != ownerIndices_[currentIndex_ - 1])
+        throw std::runtime_error("node of type \"" + std::string(ASTTypeToString(ast->Type())) + "\" is referenced, but it's not the owner");
+
+    return 1;
+}
+
+std::uint32_t ASTWriter::StringIndex(const std::string& str)
+{
+    auto it = stringIndices_.find(str);
+    if (it != stringIndices_.end())
+        return it->second;
+
+    auto index = static_cast<std::uint32_t>(strings_.size());
+    auto result = stringIndices_.insert({ str, index });
+    strings_.push_back(&(result.first->first));
+
+    return index;
+}
+
+
+/*
+ * ASTReader class
+ */
+
+const std::size_t ASTReader::noOwner;
+
+ProgramPtr ASTReader::ReadProgram(const char* data, std::size_t size)
+{
+    data_ = data;
+    size_ = size;
+    pos_ = 0;
+    strings_.clear();
+    idents_.clear();
+    nodes_.clear();
+    ownerIndices_.clear();
+
+    /* Read header */
+    if (size_ < sizeof(formatMagic) || std::string(data_, sizeof(formatMagic)) != std::string(formatMagic, sizeof(formatMagic)))
+        Error("invalid magic number");
+    pos_ = sizeof(formatMagic);
+
+    if (ReadUInt() != formatVersion)
+        Error("unsupported format version");
+
+    /* Read string table */
+    strings_.resize(ReadCount());
+    for (auto& str : strings_)
+    {
+        auto length = ReadUInt();
+        if (length > size_ - pos_)
+            Error("string out of range");
+        str.assign(data_ + pos_, length);
+        pos_ += length;
+    }
+
+    idents_.assign(strings_.size(), Ident());
+
+    /* Read node table and allocate all nodes */
+    auto program = std::make_shared<Program>(SourcePosition::ignore);
+
+    nodes_.resize(ReadCount());
+
+    unsigned int row = 0;
+    for (auto& ast : nodes_)
+    {
+        auto type = static_cast<AST::Types>(ReadByte());
+        row += static_cast<unsigned int>(ZigZagDecode(ReadUInt()));
+        auto column = ReadUInt();
+
+        ast = MakeNode(program->arena, type, SourcePosition(row, column));
+        ast->flags = Flags(ReadUInt());
+    }
+
+    /* Read global declarations and node fields (see ASTWriter::WriteProgram) */
+    ownerIndices_.resize(nodes_.size(), noOwner);
+
+    currentIndex_ = 0;
+    Refs(program->globalDecls);
+
+    for (currentIndex_ = 1; currentIndex_ <= nodes_.size(); ++currentIndex_)
+        TransferNodeFields(*this, nodes_[currentIndex_ - 1]);
+
+    if (pos_ != size_)
+        Error("unexpected data after the end of the program");
+
+    /* Each node must be owned exactly once (either by the program or by another node), so the nodes form a tree */
+    for (auto owner : ownerIndices_)
+    {
+        if (owner == noOwner)
+            Error("node without owner");
+    }
+
+    return program;
+}
+
+void ASTReader::String(std::string& str)
+{
+    auto index = ReadUInt();
+    if (index >= strings_.size())
+        Error("string index out of range");
+    str = strings_[index];
+}
+
+void ASTReader::String(Ident& ident)
+{
+    auto index = ReadUInt();
+    if (index >= strings_.size())
+        Error("string index out of range");
+
+    /* Intern each string of the table only once */
+    auto& interned = idents_[index];
+    if (interned.empty())
+        interned = Ident(strings_[index]);
+
+    ident = interned;
+}
+
+void ASTReader::Strings(std::vector<std::string>& strs)
+{
+    strs.resize(ReadCount());
+    for (auto& str : strs)
+        String(str);
+}
+
+void ASTReader::Strings(std::vector<Ident>& idents)
+{
+    idents.resize(ReadCount());
+    for (auto& ident : idents)
+        String(ident);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ASTReader::Error(const std::string& msg)
+{
+    throw std::runtime_error("invalid serialized program (at byte " + std::to_string(pos_) + ") : " + msg);
+}
+
+std::uint32_t ASTReader::ReadUInt()
+{
+    /* Read variable-length integer (see ASTWriter::WriteUInt) */
+    std::uint32_t value = 0;
+
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        auto byte = ReadByte();
+        value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+
+    Error("integer out of range");
+    return 0;
+}
+
+unsigned char ASTReader::ReadByte()
+{
+    if (pos_ >= size_)
+        Error("unexpected end of data");
+    return static_cast<unsigned char>(data_[pos_++]);
+}
+
+std::uint32_t ASTReader::ReadCount()
+{
+    /* Each element takes at least one byte, so larger counts can only come from a corrupted buffer */
+    auto count = ReadUInt();
+    if (count > size_ - pos_)
+        Error("element count out of range");
+    return count;
+}
+
+std::size_t ASTReader::NodeIndex(std::uint32_t ref)
+{
+    /* Only references to subsequent nodes are valid (see ASTWriter::NodeRef), so the current node and its ancestors are rejected */
+    if (ref > nodes_.size() - currentIndex_)
+        Error("node reference out of range");
+
+    auto index = currentIndex_ + ref - 1;
+    if (ownerIndices_[index] != noOwner)
+        Error("node is owned more than once");
+
+    ownerIndices_[index] = currentIndex_;
+    return index;
+}
+
+std::size_t ASTReader::OwnerNodeIndex(std::uint32_t ref)
+{
+    /* Only the owner of the current node can be referenced (see ASTWriter::OwnerNodeRef) */
+    auto owner = ownerIndices_[currentIndex_ - 1];
+    if (ref != 1 || owner == 0 || owner == noOwner)
+        Error("invalid owner reference");
+    return owner - 1;
+}
+
+AST* ASTReader::MakeNode(ASTArena& arena, AST::Types type, const SourcePosition& pos)
+{
+    #define MAKE_NODE(className) \
+        case AST::Types::className: return arena.New<className>(pos)
+
+    switch (type)
+    {
+        MAKE_NODE( CodeBlock         );
+        MAKE_NODE( BufferDeclIdent   );
+        MAKE_NODE( FunctionCall      );
+        MAKE_NODE( Structure         );
+        MAKE_NODE( FunctionDecl      );
+        MAKE_NODE( UniformBufferDecl );
+        MAKE_NODE( TextureDecl       );
+        MAKE_NODE( SamplerDecl       );
+        MAKE_NODE( StructDecl        );
+        MAKE_NODE( DirectiveDecl     );
+        MAKE_NODE( NullStmnt         );
+        MAKE_NODE( DirectiveStmnt    );
+        MAKE_NODE( CodeBlockStmnt    );
+        MAKE_NODE( ForLoopStmnt      );
+        MAKE_NODE( WhileLoopStmnt    );
+        MAKE_NODE( DoWhileLoopStmnt  );
+        MAKE_NODE( IfStmnt           );
+        MAKE_NODE( ElseStmnt         );
+        MAKE_NODE( SwitchStmnt       );
+        MAKE_NODE( VarDeclStmnt      );
+        MAKE_NODE( AssignStmnt       );
+        MAKE_NODE( ExprStmnt         );
+        MAKE_NODE( FunctionCallStmnt );
+        MAKE_NODE( ReturnStmnt       );
+        MAKE_NODE( StructDeclStmnt   );
+        MAKE_NODE( CtrlTransferStmnt );
+        MAKE_NODE( ListExpr          );
+        MAKE_NODE( LiteralExpr       );
+        MAKE_NODE( TypeNameExpr      );
+        MAKE_NODE( TernaryExpr       );
+        MAKE_NODE( BinaryExpr        );
+        MAKE_NODE( UnaryExpr         );
+        MAKE_NODE( PostUnaryExpr     );
+        MAKE_NODE( FunctionCallExpr  );
+        MAKE_NODE( BracketExpr       );
+        MAKE_NODE( CastExpr          );
+        MAKE_NODE( VarAccessExpr     );
+        MAKE_NODE( InitializerExpr   );
+        MAKE_NODE( SwitchCase        );
+        MAKE_NODE( PackOffset        );
+        MAKE_NODE( VarSemantic       );
+        MAKE_NODE( VarType           );
+        MAKE_NODE( VarIdent          );
+        MAKE_NODE( VarDecl           );
+        default:
+            break;
+    }
+
+    #undef MAKE_NODE
+
+    Error("invalid node type");
+    return nullptr;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
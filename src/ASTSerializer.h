@@ -0,0 +1,233 @@
+/*
+ * ASTSerializer.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_AST_SERIALIZER_H__
+#define __HT_AST_SERIALIZER_H__
+
+
+#include "HLSLTree.h"
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+/**
+Returns true if a node of the specified type can be referenced by a pointer to the class T.
+\remarks This is used to validate node references, which are read from a buffer, without a "dynamic_cast".
+*/
+template <typename T> bool IsNodeOfClass(const AST::Types type);
+
+/**
+Writes a parsed program into a compact binary format.
+\remarks The format consists of a header, a string table (each distinct string is stored once),
+a node table (node type, source position and flags of each node) and the fields of all nodes
+(strings as indices into the string table and child nodes as indices into the node table).
+The nodes are stored in pre-order, i.e. each node is stored before its child nodes, so every child reference points forward.
+All integers are stored with a variable length, so most fields take a single byte.
+Only the syntax tree is stored; the decorations of the context analysis (e.g. symbol references) are not stored,
+because they are computed again for each translation.
+\see ASTReader
+*/
+class ASTWriter
+{
+    
+    public:
+        
+        //! Writes the specified program (including all linked programs) into the output buffer.
+        void WriteProgram(const Program& program, std::string& output);
+
+        /* --- Field transfer functions (see "TransferFields") --- */
+
+        void String(const std::string& str);
+        void Strings(const std::vector<std::string>& strs);
+        void Strings(const std::vector<Ident>& idents);
+
+        template <typename T> void UInt(const T& value)
+        {
+            WriteUInt(static_cast<std::uint32_t>(value));
+        }
+
+        //! Writes the object of the specified pointer (if it's non-null) with its "TransferFields" function.
+        template <typename T> void Optional(const std::unique_ptr<T>& obj)
+        {
+            WriteByte(obj ? 1 : 0);
+            if (obj)
+                TransferFields(*this, *obj);
+        }
+
+        //! Writes the reference to the specified child node (the child is owned by the current node).
+        template <typename T> void Ref(T* const& ast)
+        {
+            WriteUInt(NodeRef(ast));
+        }
+
+        template <typename T> void Refs(const std::vector<T*>& asts)
+        {
+            WriteUInt(static_cast<std::uint32_t>(asts.size()));
+            for (auto ast : asts)
+                Ref(ast);
+        }
+
+        //! Writes the reference to the owner of the current node (e.g. "VarDecl::declStmntRef"), which must be null or the owner.
+        template <typename T> void OwnerRef(T* const& ast)
+        {
+            WriteByte(OwnerNodeRef(ast));
+        }
+
+    private:
+        
+        void WriteUInt(std::uint32_t value);
+        void WriteByte(unsigned char value);
+
+        /**
+        Returns the reference to the specified child node, which is zero for a null pointer,
+        or otherwise the distance from the current node.
+        \remarks Child nodes are mostly stored right after their parent nodes, so most references are small numbers.
+        */
+        std::uint32_t NodeRef(const AST* ast) const;
+
+        //! Returns zero for a null pointer or one for the owner of the current node. Otherwise, an exception is thrown.
+        unsigned char OwnerNodeRef(const AST* ast) const;
+
+        std::uint32_t StringIndex(const std::string& str);
+
+        std::string*                                    output_ = nullptr;
+        std::unordered_map<const AST*, std::uint32_t>   nodeIndices_;   //!< Position of each node (the index plus one).
+        std::vector<std::uint32_t>                      ownerIndices_;  //!< Position of the owner of each node (zero for the program).
+        std::unordered_map<std::string, std::uint32_t>  stringIndices_;
+        std::vector<const std::string*>                 strings_;
+        std::uint32_t                                   currentIndex_   = 0; //!< Position of the node whose fields are written (zero for the program).
+
+};
+
+/**
+Reads a program from the binary format of the "ASTWriter".
+\remarks All nodes are allocated in the arena of the new program with a single linear pass over the input buffer,
+so the input can also be a memory mapped file. The input is validated, i.e. a corrupted or truncated buffer
+(or a buffer with references to nodes of the wrong type) results in an error instead of an invalid tree.
+Each node must be owned exactly once, and only by a preceding node, so a corrupted buffer can not result in a cyclic tree.
+\see ASTWriter
+*/
+class ASTReader
+{
+    
+    public:
+        
+        /**
+        Reads the program from the specified buffer.
+        \throws std::runtime_error If the buffer is not a valid serialized program.
+        */
+        ProgramPtr ReadProgram(const char* data, std::size_t size);
+
+        /* --- Field transfer functions (see "TransferFields") --- */
+
+        void String(std::string& str);
+        void String(Ident& ident);
+        void Strings(std::vector<std::string>& strs);
+        void Strings(std::vector<Ident>& idents);
+
+        template <typename T> void UInt(T& value)
+        {
+            value = static_cast<T>(ReadUInt());
+        }
+
+        template <typename T> void Optional(std::unique_ptr<T>& obj)
+        {
+            if (ReadByte() != 0)
+            {
+                obj = std::unique_ptr<T>(new T());
+                TransferFields(*this, *obj);
+            }
+            else
+                obj.reset();
+        }
+
+        template <typename T> void Ref(T*& ast)
+        {
+            auto ref = ReadUInt();
+            if (ref == 0)
+                ast = nullptr;
+            else
+            {
+                auto node = nodes_[NodeIndex(ref)];
+                if (!IsNodeOfClass<T>(node->Type()))
+                    Error("node reference of invalid type");
+                ast = static_cast<T*>(node);
+            }
+        }
+
+        template <typename T> void OwnerRef(T*& ast)
+        {
+            auto ref = ReadByte();
+            if (ref == 0)
+                ast = nullptr;
+            else
+            {
+                auto node = nodes_[OwnerNodeIndex(ref)];
+                if (!IsNodeOfClass<T>(node->Type()))
+                    Error("owner reference of invalid type");
+                ast = static_cast<T*>(node);
+            }
+        }
+
+        template <typename T> void Refs(std::vector<T*>& asts)
+        {
+            auto count = ReadCount();
+            asts.resize(count);
+            for (auto& ast : asts)
+                Ref(ast);
+        }
+
+    private:
+        
+        void Error(const std::string& msg);
+
+        std::uint32_t ReadUInt();
+        unsigned char ReadByte();
+
+        //! Reads a number of elements, which is checked against the remaining size of the buffer.
+        std::uint32_t ReadCount();
+
+        //! Returns the node index of the specified (non-zero) reference and marks the node as owned by the current node (see ASTWriter::NodeRef).
+        std::size_t NodeIndex(std::uint32_t ref);
+
+        //! Returns the node index of the owner of the current node for the specified (non-zero) reference (see ASTWriter::OwnerNodeRef).
+        std::size_t OwnerNodeIndex(std::uint32_t ref);
+
+        AST* MakeNode(ASTArena& arena, AST::Types type, const SourcePosition& pos);
+
+        const char*                 data_   = nullptr;
+        std::size_t                 size_   = 0;
+        std::size_t                 pos_    = 0;
+
+        std::vector<std::string>    strings_;
+        std::vector<Ident>          idents_;            //!< Identifiers of the string table, which are interned when they are read the first time.
+        std::vector<AST*>           nodes_;
+        std::vector<std::size_t>    ownerIndices_;      //!< Position of the owner of each node (zero for the program; "noOwner" if it's not owned yet).
+        std::size_t                 currentIndex_   = 0; //!< Position of the node whose fields are read (the index plus one, or zero for the program).
+
+        static const std::size_t    noOwner         = ~static_cast<std::size_t>(0);
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,264 @@
+/*
+ * CharScan.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "CharScan.h"
+
+#include <cstring>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define _HT_CHAR_SCAN_SSE2_
+#   include <emmintrin.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   endif
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#   define _HT_CHAR_SCAN_NEON_
+#   include <arm_neon.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   endif
+#endif
+
+
+namespace HTLib
+{
+
+
+/*
+ * Character classification table
+ */
+
+namespace CharClass
+{
+
+#define S Space
+#define L Letter
+#define D Digit
+#define U Underscore
+
+const unsigned char table[256] =
+{
+ // 0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F
+    0, 0, 0, 0, 0, 0, 0, 0, 0, S, S, S, S, S, 0, 0, // 0x00
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x10
+    S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, // 0x20
+    D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0, // 0x30
+    0, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L, // 0x40
+    L, L, L, L, L, L, L, L, L, L, L, 0, 0, 0, 0, U, // 0x50
+    0, L, L, L, L, L, L, L, L, L, L, L, L, L, L, L, // 0x60
+    L, L, L, L, L, L, L, L, L, L, L, 0, 0, 0, 0, 0, // 0x70
+    // 0x80 - 0xFF: no classes
+};
+
+#undef S
+#undef L
+#undef D
+#undef U
+
+} // /namespace CharClass
+
+
+/*
+ * Internal functions
+ */
+
+//! Skips all characters of the specified classes with the classification table.
+static const char* SkipClasses(const char* begin, const char* end, unsigned char classes)
+{
+    while (begin < end && CharClass::Is(*begin, classes))
+        ++begin;
+    return begin;
+}
+
+#if defined _HT_CHAR_SCAN_SSE2_
+
+//! Returns the index of the lowest bit which is set (the mask must not be 0).
+static inline unsigned int LowestBit(unsigned int mask)
+{
+    #ifdef _MSC_VER
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned int>(index);
+    #else
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+    #endif
+}
+
+//! Returns 0xFF for each byte in the range [first, last] and 0 otherwise.
+static inline __m128i InRange(__m128i chars, char first, char last)
+{
+    auto offset = _mm_sub_epi8(chars, _mm_set1_epi8(first));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(static_cast<char>(last - first))), offset);
+}
+
+static inline __m128i SpaceMask(__m128i chars)
+{
+    return _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), InRange(chars, '\t', '\r'));
+}
+
+static inline __m128i DigitMask(__m128i chars)
+{
+    return InRange(chars, '0', '9');
+}
+
+static inline __m128i IdentMask(__m128i chars)
+{
+    /* Setting bit 5 maps upper case letters to lower case letters (but no other character into 'a'-'z') */
+    auto letters = InRange(_mm_or_si128(chars, _mm_set1_epi8(0x20)), 'a', 'z');
+    return _mm_or_si128(_mm_or_si128(letters, DigitMask(chars)), _mm_cmpeq_epi8(chars, _mm_set1_epi8('_')));
+}
+
+//! Skips all characters, for which the mask function returns 0xFF, 16 characters at once.
+template <typename MaskFunc>
+static const char* SkipBlocks(const char* begin, const char* end, MaskFunc maskFunc)
+{
+    while (end - begin >= 16)
+    {
+        auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        auto mask = static_cast<unsigned int>(_mm_movemask_epi8(maskFunc(chars)));
+        if (mask != 0xFFFF)
+            return begin + LowestBit(~mask & 0xFFFF);
+        begin += 16;
+    }
+    return begin;
+}
+
+#elif defined _HT_CHAR_SCAN_NEON_
+
+//! Returns 0xFF for each byte in the range [first, last] and 0 otherwise.
+static inline uint8x16_t InRange(uint8x16_t chars, char first, char last)
+{
+    auto offset = vsubq_u8(chars, vdupq_n_u8(static_cast<uint8_t>(first)));
+    return vcleq_u8(offset, vdupq_n_u8(static_cast<uint8_t>(last - first)));
+}
+
+static inline uint8x16_t SpaceMask(uint8x16_t chars)
+{
+    return vorrq_u8(vceqq_u8(chars, vdupq_n_u8(' ')), InRange(chars, '\t', '\r'));
+}
+
+static inline uint8x16_t DigitMask(uint8x16_t chars)
+{
+    return InRange(chars, '0', '9');
+}
+
+static inline uint8x16_t IdentMask(uint8x16_t chars)
+{
+    /* Setting bit 5 maps upper case letters to lower case letters (but no other character into 'a'-'z') */
+    auto letters = InRange(vorrq_u8(chars, vdupq_n_u8(0x20)), 'a', 'z');
+    return vorrq_u8(vorrq_u8(letters, DigitMask(chars)), vceqq_u8(chars, vdupq_n_u8('_')));
+}
+
+//! Skips all characters, for which the mask function returns 0xFF, 16 characters at once.
+template <typename MaskFunc>
+static const char* SkipBlocks(const char* begin, const char* end, MaskFunc maskFunc)
+{
+    while (end - begin >= 16)
+    {
+        auto chars = vld1q_u8(reinterpret_cast<const uint8_t*>(begin));
+        auto mismatch = vmvnq_u8(maskFunc(chars));
+        if (vmaxvq_u8(mismatch) != 0)
+        {
+            /* Narrow each byte of the mask to 4 bits, to find the first mismatch with a 64-bit integer */
+            auto nibbles = vshrn_n_u16(vreinterpretq_u16_u8(mismatch), 4);
+            auto bits = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+            #ifdef _MSC_VER
+            unsigned long index = 0;
+            _BitScanForward64(&index, bits);
+            return begin + (index >> 2);
+            #else
+            return begin + (__builtin_ctzll(bits) >> 2);
+            #endif
+        }
+        begin += 16;
+    }
+    return begin;
+}
+
+#endif
+
+#if defined _HT_CHAR_SCAN_SSE2_ || defined _HT_CHAR_SCAN_NEON_
+
+static const char* SkipSpaceBlocks(const char* begin, const char* end)
+{
+    return SkipBlocks(begin, end, SpaceMask);
+}
+
+static const char* SkipIdentBlocks(const char* begin, const char* end)
+{
+    return SkipBlocks(begin, end, IdentMask);
+}
+
+static const char* SkipDigitBlocks(const char* begin, const char* end)
+{
+    return SkipBlocks(begin, end, DigitMask);
+}
+
+#else
+
+/* Without SIMD instructions, all characters are classified by the table */
+
+static inline const char* SkipSpaceBlocks(const char* begin, const char*)
+{
+    return begin;
+}
+
+static inline const char* SkipIdentBlocks(const char* begin, const char*)
+{
+    return begin;
+}
+
+static inline const char* SkipDigitBlocks(const char* begin, const char*)
+{
+    return begin;
+}
+
+#endif
+
+
+/*
+ * Global functions
+ */
+
+const char* SkipSpaces(const char* begin, const char* end)
+{
+    /* Most runs are only a single space, so check the first character before the blocks */
+    if (begin < end && !CharClass::IsSpace(*begin))
+        return begin;
+
+    begin = SkipSpaceBlocks(begin, end);
+    return SkipClasses(begin, end, CharClass::Space);
+}
+
+const char* SkipIdentChars(const char* begin, const char* end)
+{
+    begin = SkipIdentBlocks(begin, end);
+    return SkipClasses(begin, end, CharClass::Letter | CharClass::Digit | CharClass::Underscore);
+}
+
+const char* SkipDigits(const char* begin, const char* end)
+{
+    begin = SkipDigitBlocks(begin, end);
+    return SkipClasses(begin, end, CharClass::Digit);
+}
+
+const char* FindChar(const char* begin, const char* end, char chr)
+{
+    /* The standard library already searches single characters with SIMD instructions */
+    if (begin >= end)
+        return end;
+    auto pos = std::memchr(begin, chr, static_cast<std::size_t>(end - begin));
+    return (pos != nullptr ? static_cast<const char*>(pos) : end);
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,95 @@
+/*
+ * CharScan.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_CHAR_SCAN_H__
+#define __HT_CHAR_SCAN_H__
+
+
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+/**
+Character classification for the scanner.
+\remarks In contrast to the functions of <cctype>, this does not depend on the locale:
+Only ASCII letters, digits and the white spaces of the "C" locale are classified.
+*/
+namespace CharClass
+{
+
+//! Character class flags.
+enum : unsigned char
+{
+    Space       = (1 << 0), //!< ' ', '\t', '\n', '\v', '\f', '\r'
+    Letter      = (1 << 1), //!< 'a'-'z', 'A'-'Z'
+    Digit       = (1 << 2), //!< '0'-'9'
+    Underscore  = (1 << 3), //!< '_'
+};
+
+//! Classification table with the class flags of each character.
+extern const unsigned char table[256];
+
+inline bool Is(char chr, unsigned char classes)
+{
+    return (table[static_cast<unsigned char>(chr)] & classes) != 0;
+}
+
+inline bool IsSpace(char chr)
+{
+    return Is(chr, Space);
+}
+
+inline bool IsDigit(char chr)
+{
+    return Is(chr, Digit);
+}
+
+//! Returns true if the specified character can begin an identifier, i.e. a letter or an underscore.
+inline bool IsIdentBegin(char chr)
+{
+    return Is(chr, Letter | Underscore);
+}
+
+//! Returns true if the specified character can be part of an identifier, i.e. a letter, a digit or an underscore.
+inline bool IsIdent(char chr)
+{
+    return Is(chr, Letter | Digit | Underscore);
+}
+
+} // /namespace CharClass
+
+
+/*
+The following functions search the character range [begin, end) and return a pointer to the first character
+which does not belong to the respective class, or "end" if all characters belong to it.
+They examine 16 characters at once with SSE2 or NEON (if available), and use the classification table otherwise.
+*/
+
+//! Skips all white spaces.
+const char* SkipSpaces(const char* begin, const char* end);
+
+//! Skips all identifier characters (letters, digits and underscores).
+const char* SkipIdentChars(const char* begin, const char* end);
+
+//! Skips all decimal digits.
+const char* SkipDigits(const char* begin, const char* end);
+
+//! Returns a pointer to the first occurrence of the specified character in the range [begin, end), or "end" if there is none.
+const char* FindChar(const char* begin, const char* end, char chr);
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
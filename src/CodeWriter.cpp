@@ -7,60 +7,132 @@
 
 #include "CodeWriter.h"
 
+#include <stdexcept>
+#include <cctype>
+
 
 namespace HTLib
 {
 
 
-CodeWriter::CodeWriter(const std::string& indentTab) :
-    indentTab_{ indentTab }
+/*
+ * Internal functions
+ */
+
+static bool IsTokenChar(char chr)
+{
+    return (std::isalnum(static_cast<unsigned char>(chr)) || chr == '_' || chr == '.');
+}
+
+//! Returns true if the two characters would be scanned as one token when no space is written between them (e.g. "++" or "int").
+static bool NeedsSpace(char prev, char next)
+{
+    if (IsTokenChar(prev) && IsTokenChar(next))
+        return true;
+
+    switch (prev)
+    {
+        case '+': return (next == '+' || next == '=');
+        case '-': return (next == '-' || next == '=');
+        case '*': return (next == '=' || next == '/');
+        case '/': return (next == '=' || next == '/' || next == '*');
+        case '%': return (next == '=');
+        case '<': return (next == '<' || next == '=');
+        case '>': return (next == '>' || next == '=');
+        case '=': return (next == '=');
+        case '!': return (next == '=');
+        case '&': return (next == '&' || next == '=');
+        case '|': return (next == '|' || next == '=');
+        case '^': return (next == '^' || next == '=');
+    }
+
+    return false;
+}
+
+
+/*
+ * CodeWriter class
+ */
+
+CodeWriter::CodeWriter(const std::string& indentTab, bool minify) :
+    buffer_     { &streamBuffer_ },
+    indentTab_  { indentTab      },
+    minify_     { minify         }
 {
 }
 
+void CodeWriter::OutputBuffer(std::string& buffer)
+{
+    buffer_ = &buffer;
+    stream_ = nullptr;
+}
+
 void CodeWriter::OutputStream(std::ostream& stream)
 {
+    buffer_ = &streamBuffer_;
     stream_ = &stream;
     if (!stream_->good())
         throw std::runtime_error("invalid output stream");
 }
 
+void CodeWriter::Flush()
+{
+    if (stream_ && buffer_ == &streamBuffer_)
+    {
+        stream_->write(streamBuffer_.data(), streamBuffer_.size());
+        streamBuffer_.clear();
+    }
+}
+
 void CodeWriter::PushIndent()
 {
-    indent_ += indentTab_;
+    indentSize_ += indentTab_.size();
+    if (indentRun_.size() < indentSize_)
+        indentRun_ += indentTab_;
 }
 
 void CodeWriter::PopIndent()
 {
-    if (!indent_.empty())
-        indent_.resize(indent_.size() - indentTab_.size());
+    if (indentSize_ >= indentTab_.size())
+        indentSize_ -= indentTab_.size();
 }
 
 void CodeWriter::PushOptions(const Options& options)
 {
     optionsStack_.push(options);
+    currentOptions_ = options;
 }
 
 void CodeWriter::PopOptions()
 {
     if (!optionsStack_.empty())
+    {
         optionsStack_.pop();
+        currentOptions_ = (!optionsStack_.empty() ? optionsStack_.top() : Options());
+    }
 }
 
 void CodeWriter::BeginLine()
 {
-    if (CurrentOptions().enableTabs)
-        stream_->write(indent_.c_str(), indent_.size());
+    if (currentOptions_.enableTabs && !minify_)
+        buffer_->append(indentRun_.data(), indentSize_);
 }
 
 void CodeWriter::EndLine()
 {
-    if (CurrentOptions().enableNewLine)
-        (*stream_) << '\n';
-}
-
-void CodeWriter::Write(const std::string& text)
-{
-    stream_->write(text.c_str(), text.size());
+    if (minify_)
+    {
+        /* Only preprocessor directives must be terminated by a new-line character */
+        if (inDirective_)
+        {
+            inDirective_ = (buffer_->back() == '\\');
+            buffer_->push_back('\n');
+        }
+        else
+            pendingSpace_ = true;
+    }
+    else if (currentOptions_.enableNewLine)
+        buffer_->push_back('\n');
 }
 
 void CodeWriter::WriteLine(const std::string& text)
@@ -70,9 +142,41 @@ void CodeWriter::WriteLine(const std::string& text)
     EndLine();
 }
 
-CodeWriter::Options CodeWriter::CurrentOptions() const
+
+/*
+ * ======= Private: =======
+ */
+
+void CodeWriter::WriteMinified(const std::string& text)
 {
-    return !optionsStack_.empty() ? optionsStack_.top() : Options();
+    for (auto chr : text)
+    {
+        if (inDirective_)
+        {
+            /* Write preprocessor directives unchanged (also with line continuations) */
+            if (chr == '\n' && buffer_->back() != '\\')
+                inDirective_ = false;
+            buffer_->push_back(chr);
+        }
+        else if (chr == ' ' || chr == '\t' || chr == '\n' || chr == '\r')
+            pendingSpace_ = true;
+        else if (chr == '#')
+        {
+            /* Begin preprocessor directive on a new line */
+            if (!buffer_->empty() && buffer_->back() != '\n')
+                buffer_->push_back('\n');
+            buffer_->push_back(chr);
+            inDirective_    = true;
+            pendingSpace_   = false;
+        }
+        else
+        {
+            if (pendingSpace_ && !buffer_->empty() && NeedsSpace(buffer_->back(), chr))
+                buffer_->push_back(' ');
+            buffer_->push_back(chr);
+            pendingSpace_ = false;
+        }
+    }
 }
 
 
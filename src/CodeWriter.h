@@ -10,6 +10,7 @@
 
 
 #include <ostream>
+#include <string>
 #include <stack>
 
 
@@ -17,7 +18,14 @@ namespace HTLib
 {
 
 
-//! Output code writer.
+/**
+Output code writer.
+\remarks All code is appended to a single contiguous string buffer.
+When an output stream is used, the buffer is written to the stream only once with "Flush".
+In the minified mode, no indentation is written and all white spaces (also the line ends) are dropped,
+except a single space between two tokens which would otherwise be merged (e.g. "int x" or "a - -b").
+Preprocessor directives are written unchanged on their own lines.
+*/
 class CodeWriter
 {
     
@@ -36,11 +44,32 @@ class CodeWriter
             bool enableTabs     = true;
         };
 
-        CodeWriter(const std::string& indentTab);
+        CodeWriter(const std::string& indentTab, bool minify = false);
 
-        //! \throws std::runtime_error If stream is invalid.
+        //! Sets the output buffer. All code is appended to the specified string.
+        void OutputBuffer(std::string& buffer);
+
+        /**
+        Sets the output stream. All code is collected in an internal buffer until "Flush" is called.
+        \throws std::runtime_error If stream is invalid.
+        */
         void OutputStream(std::ostream& stream);
 
+        //! Writes the internal buffer to the output stream (if an output stream is used) and clears the buffer.
+        void Flush();
+
+        //! Returns the number of bytes in the current output buffer.
+        inline std::size_t BufferSize() const
+        {
+            return buffer_->size();
+        }
+
+        //! Returns the current output buffer.
+        inline const std::string& Buffer() const
+        {
+            return *buffer_;
+        }
+
         void PushIndent();
         void PopIndent();
 
@@ -50,18 +79,39 @@ class CodeWriter
         void BeginLine();
         void EndLine();
 
-        void Write(const std::string& text);
+        inline void Write(const std::string& text)
+        {
+            if (minify_)
+                WriteMinified(text);
+            else
+                buffer_->append(text);
+        }
+
         void WriteLine(const std::string& text);
 
-        Options CurrentOptions() const;
+        inline const Options& CurrentOptions() const
+        {
+            return currentOptions_;
+        }
 
     private:
         
-        std::ostream*   stream_ = nullptr;
-        std::string     indentTab_;
-        std::string     indent_;
+        void WriteMinified(const std::string& text);
+
+        std::string*        buffer_         = nullptr;
+        std::string         streamBuffer_;
+        std::ostream*       stream_         = nullptr;
+
+        std::string         indentTab_;
+        std::string         indentRun_;         //!< Precomputed indentation for the deepest level so far.
+        std::size_t         indentSize_     = 0;    //!< Size of the current indentation (prefix of "indentRun_").
 
         std::stack<Options> optionsStack_;
+        Options             currentOptions_;
+
+        bool                minify_         = false;
+        bool                pendingSpace_   = false;    //!< Specifies whether white spaces have been dropped since the last character (minified mode only).
+        bool                inDirective_    = false;    //!< Specifies whether a preprocessor directive is being written (minified mode only).
 
 };
 
@@ -0,0 +1,974 @@
+/*
+ * ConstantFolder.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ConstantFolder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <functional>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+typedef ConstValue::Types ConstTypes;
+
+static bool IsExprType(const AST::Types type)
+{
+    return (type >= AST::Types::ListExpr && type <= AST::Types::InitializerExpr);
+}
+
+//! Parses the specified scalar or vector type name (e.g. "float" or "int3").
+static bool ParseTypeName(const std::string& typeName, ConstTypes& type, std::size_t& dim)
+{
+    static const struct
+    {
+        const char* name;
+        ConstTypes  type;
+    }
+    baseTypes[] =
+    {
+        { "bool",       ConstTypes::Bool  },
+        { "int",        ConstTypes::Int   },
+        { "uint",       ConstTypes::UInt  },
+        { "dword",      ConstTypes::UInt  },
+        { "half",       ConstTypes::Float },
+        { "float",      ConstTypes::Float },
+        { "min16float", ConstTypes::Float },
+        { "min10float", ConstTypes::Float },
+        { "min16int",   ConstTypes::Int   },
+        { "min12int",   ConstTypes::Int   },
+        { "min16uint",  ConstTypes::UInt  },
+    };
+
+    for (const auto& baseType : baseTypes)
+    {
+        const std::string name = baseType.name;
+        if (typeName.compare(0, name.size(), name) == 0)
+        {
+            auto suffix = typeName.substr(name.size());
+            if (suffix.empty())
+                dim = 1;
+            else if (suffix.size() == 1 && suffix[0] >= '1' && suffix[0] <= '4')
+                dim = static_cast<std::size_t>(suffix[0] - '0');
+            else
+                return false;
+
+            type = baseType.type;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//! Rounds the specified component to the precision of the specified type (32-bit integers and single precision floats).
+static bool RoundComponent(double& c, const ConstTypes type)
+{
+    switch (type)
+    {
+        case ConstTypes::Bool:
+            c = (c != 0.0 ? 1.0 : 0.0);
+            break;
+        case ConstTypes::Int:
+            c = static_cast<double>(static_cast<std::int32_t>(static_cast<std::uint32_t>(static_cast<std::int64_t>(c))));
+            break;
+        case ConstTypes::UInt:
+            c = static_cast<double>(static_cast<std::uint32_t>(static_cast<std::int64_t>(c)));
+            break;
+        case ConstTypes::Float:
+            c = static_cast<double>(static_cast<float>(c));
+            break;
+        default:
+            return false;
+    }
+    return std::isfinite(c);
+}
+
+//! Converts the specified value into the specified type.
+static bool ConvertValue(ConstValue& value, const ConstTypes type)
+{
+    for (auto& c : value.components)
+    {
+        if (value.type == ConstTypes::Float && (type == ConstTypes::Int || type == ConstTypes::UInt))
+        {
+            /* Float-to-integer conversion truncates towards zero (out of range values are undefined) */
+            c = std::trunc(c);
+            if (c < (type == ConstTypes::Int ? -2147483648.0 : 0.0) || c > (type == ConstTypes::Int ? 2147483647.0 : 4294967295.0))
+                return false;
+        }
+        if (!RoundComponent(c, type))
+            return false;
+    }
+    value.type = type;
+    return true;
+}
+
+static ConstTypes CommonType(const ConstTypes lhs, const ConstTypes rhs)
+{
+    /* Boolean operands are promoted to integers */
+    return std::max(ConstTypes::Int, std::max(lhs, rhs));
+}
+
+//! Returns the operator precedence (higher binds tighter) or 0 if the operator can not be folded.
+static int OperatorPrecedence(const std::string& op)
+{
+    if (op == "*" || op == "/" || op == "%")
+        return 10;
+    if (op == "+" || op == "-")
+        return 9;
+    if (op == "<<" || op == ">>")
+        return 8;
+    if (op == "<" || op == ">" || op == "<=" || op == ">=")
+        return 7;
+    if (op == "==" || op == "!=")
+        return 6;
+    if (op == "&")
+        return 5;
+    if (op == "^")
+        return 4;
+    if (op == "|")
+        return 3;
+    if (op == "&&")
+        return 2;
+    if (op == "||")
+        return 1;
+    return 0;
+}
+
+//! Applies the specified function to each component pair (with broadcasting of scalars).
+static bool ApplyComponentWise(
+    const ConstValue& lhs, const ConstValue& rhs, const ConstTypes resultType,
+    const std::function<bool(double, double, double&)>& func, ConstValue& result)
+{
+    auto lhsDim = lhs.components.size();
+    auto rhsDim = rhs.components.size();
+
+    if (lhsDim != rhsDim && lhsDim != 1 && rhsDim != 1)
+        return false;
+
+    auto dim = std::max(lhsDim, rhsDim);
+
+    result.type = resultType;
+    result.components.resize(dim);
+
+    for (std::size_t i = 0; i < dim; ++i)
+    {
+        auto a = lhs.components[lhsDim == 1 ? 0 : i];
+        auto b = rhs.components[rhsDim == 1 ? 0 : i];
+        if (!func(a, b, result.components[i]) || !RoundComponent(result.components[i], resultType))
+            return false;
+    }
+
+    return true;
+}
+
+static bool EvaluateBinaryOp(ConstValue lhs, const std::string& op, ConstValue rhs, ConstValue& result)
+{
+    /* Logical operators */
+    if (op == "&&" || op == "||")
+    {
+        bool isAnd = (op == "&&");
+        return ApplyComponentWise(
+            lhs, rhs, ConstTypes::Bool,
+            [isAnd](double a, double b, double& c)
+            {
+                c = (isAnd ? (a != 0.0 && b != 0.0) : (a != 0.0 || b != 0.0));
+                return true;
+            },
+            result
+        );
+    }
+
+    /* Convert both operands to their common type */
+    auto type = CommonType(lhs.type, rhs.type);
+    if (!ConvertValue(lhs, type) || !ConvertValue(rhs, type))
+        return false;
+
+    bool isFloat = (type == ConstTypes::Float);
+
+    /* Comparison operators */
+    if (OperatorPrecedence(op) == 7 || OperatorPrecedence(op) == 6)
+    {
+        return ApplyComponentWise(
+            lhs, rhs, ConstTypes::Bool,
+            [&op](double a, double b, double& c)
+            {
+                if (op == "<")
+                    c = (a < b);
+                else if (op == ">")
+                    c = (a > b);
+                else if (op == "<=")
+                    c = (a <= b);
+                else if (op == ">=")
+                    c = (a >= b);
+                else if (op == "==")
+                    c = (a == b);
+                else
+                    c = (a != b);
+                return true;
+            },
+            result
+        );
+    }
+
+    /* Arithmetic operators */
+    if (op == "+" || op == "-" || op == "*" || op == "/" || op == "%")
+    {
+        return ApplyComponentWise(
+            lhs, rhs, type,
+            [&op, isFloat, type](double a, double b, double& c)
+            {
+                if (op == "+")
+                    c = a + b;
+                else if (op == "-")
+                    c = a - b;
+                else if (op == "*")
+                {
+                    /* Integer multiplication wraps around (like any other 32-bit integer arithmetic) */
+                    c = (isFloat ? a * b : static_cast<double>(static_cast<std::uint32_t>(
+                        static_cast<std::uint64_t>(static_cast<std::int64_t>(a)) * static_cast<std::uint64_t>(static_cast<std::int64_t>(b))
+                    )));
+                }
+                else if (isFloat)
+                    c = (op == "/" ? a / b : std::fmod(a, b));
+                else
+                {
+                    /* Integer division by zero (and its overflow) is undefined */
+                    if (b == 0.0 || (type == ConstTypes::Int && a == -2147483648.0 && b == -1.0))
+                        return false;
+                    auto x = static_cast<std::int64_t>(a);
+                    auto y = static_cast<std::int64_t>(b);
+                    c = static_cast<double>(op == "/" ? x / y : x % y);
+                }
+                if (isFloat)
+                    c = static_cast<double>(static_cast<float>(c));
+                return true;
+            },
+            result
+        );
+    }
+
+    /* Bitwise and shift operators (only for integers) */
+    if (isFloat || OperatorPrecedence(op) == 0)
+        return false;
+
+    return ApplyComponentWise(
+        lhs, rhs, type,
+        [&op, type](double a, double b, double& c)
+        {
+            auto x = static_cast<std::uint32_t>(static_cast<std::int64_t>(a));
+            auto y = static_cast<std::uint32_t>(static_cast<std::int64_t>(b));
+
+            if (op == "&")
+                c = static_cast<double>(x & y);
+            else if (op == "|")
+                c = static_cast<double>(x | y);
+            else if (op == "^")
+                c = static_cast<double>(x ^ y);
+            else if (op == "<<")
+                c = static_cast<double>(static_cast<std::uint32_t>(x << (y & 31u)));
+            else if (type == ConstTypes::Int)
+                c = static_cast<double>(static_cast<std::int32_t>(x) >> (y & 31u));
+            else
+                c = static_cast<double>(x >> (y & 31u));
+            return true;
+        },
+        result
+    );
+}
+
+/**
+Evaluates the specified operand and operator lists with the operator precedence.
+\remarks The parser generates binary expressions as right-recursive chains (without operator precedence),
+i.e. "a*b+c" is stored as "a*(b+c)", and the code generator writes them in the same order again.
+*/
+static bool EvaluateChain(
+    std::vector<ConstValue>::const_iterator values, std::vector<std::string>::const_iterator ops,
+    std::vector<std::string>::const_iterator opsEnd, ConstValue& result)
+{
+    std::vector<ConstValue> valueStack { *values++ };
+    std::vector<std::string> opStack;
+
+    auto Reduce = [&]() -> bool
+    {
+        auto rhs = valueStack.back();
+        valueStack.pop_back();
+        auto lhs = valueStack.back();
+        valueStack.pop_back();
+
+        ConstValue value;
+        if (!EvaluateBinaryOp(lhs, opStack.back(), rhs, value))
+            return false;
+
+        opStack.pop_back();
+        valueStack.push_back(value);
+        return true;
+    };
+
+    for (; ops != opsEnd; ++ops, ++values)
+    {
+        /* Operators are left-associative */
+        while (!opStack.empty() && OperatorPrecedence(opStack.back()) >= OperatorPrecedence(*ops))
+        {
+            if (!Reduce())
+                return false;
+        }
+        opStack.push_back(*ops);
+        valueStack.push_back(*values);
+    }
+
+    while (!opStack.empty())
+    {
+        if (!Reduce())
+            return false;
+    }
+
+    result = valueStack.back();
+    return true;
+}
+
+static bool HasModifier(const std::vector<std::string>& modifiers, const std::string& modifier)
+{
+    return (std::find(modifiers.begin(), modifiers.end(), modifier) != modifiers.end());
+}
+
+
+/*
+ * ConstantFolder class
+ */
+
+void ConstantFolder::FoldConstants(Program* program)
+{
+    values_.clear();
+    chainTails_.clear();
+    functionNames_.clear();
+
+    /*
+    Collect all tails of binary expression chains (they can only be folded from the head of their chain),
+    and the names of all user defined functions
+    */
+    ForEachNode(
+        *program,
+        [this](AST* node)
+        {
+            CollectChainTail(node);
+            if (node->Type() == AST::Types::FunctionDecl)
+                functionNames_.insert(static_cast<FunctionDecl*>(node)->name);
+        }
+    );
+
+    /* Fold all expressions (the arenas own every node of the program) */
+    ForEachNode(
+        *program,
+        [this](AST* node)
+        {
+            FoldNode(node);
+        }
+    );
+}
+
+void ConstantFolder::FoldConstants(FunctionDecl* ast)
+{
+    if (!ast->bodyArena)
+        return;
+
+    values_.clear();
+    chainTails_.clear();
+
+    /* Fold all expressions of the body (its arena owns every node of the body) */
+    const auto& nodes = ast->bodyArena->Nodes();
+
+    for (auto node : nodes)
+        CollectChainTail(node);
+    for (auto node : nodes)
+        FoldNode(node);
+
+    /* Drop the folded values, since the memory of this body may be reused for the next one */
+    values_.clear();
+    chainTails_.clear();
+}
+
+void ConstantFolder::CollectFunctionNames(Program* program)
+{
+    functionNames_.clear();
+
+    ForEachNode(
+        *program,
+        [this](AST* node)
+        {
+            if (node->Type() == AST::Types::FunctionDecl)
+                functionNames_.insert(static_cast<FunctionDecl*>(node)->name);
+        }
+    );
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ConstantFolder::CollectChainTail(AST* node)
+{
+    if (node->Type() == AST::Types::BinaryExpr)
+        chainTails_.insert(static_cast<BinaryExpr*>(node)->rhsExpr);
+}
+
+void ConstantFolder::FoldNode(AST* node)
+{
+    switch (node->Type())
+    {
+        case AST::Types::VarDecl:
+        {
+            /* Convert initializer into the type of the variable */
+            auto varDecl = static_cast<VarDecl*>(node);
+            if (varDecl->declStmntRef && varDecl->arrayDims.empty())
+                ConvertToVarType(varDecl->initializer, varDecl->declStmntRef->varType->baseType);
+        }
+        break;
+
+        case AST::Types::AssignStmnt:
+        {
+            auto assignStmnt = static_cast<AssignStmnt*>(node);
+            ConvertToVarType(assignStmnt->expr, assignStmnt->varIdent);
+        }
+        break;
+
+        case AST::Types::VarAccessExpr:
+        {
+            auto varAccessExpr = static_cast<VarAccessExpr*>(node);
+            ConvertToVarType(varAccessExpr->assignExpr, varAccessExpr->varIdent);
+        }
+        break;
+
+        default:
+            break;
+    }
+
+    if (IsExprType(node->Type()))
+    {
+        auto expr = static_cast<Expr*>(node);
+        if (chainTails_.find(expr) == chainTails_.end())
+        {
+            ConstValue value;
+            Fold(expr, value);
+        }
+    }
+}
+
+void ConstantFolder::ConvertToVarType(Expr* ast, const std::string& typeName)
+{
+    /* Literals are not decorated, i.e. they are written unchanged */
+    ConstValue value;
+    if (!Fold(ast, value) || ast->constValue.type == Types::None)
+        return;
+
+    Types type;
+    std::size_t dim;
+
+    if (!ParseTypeName(typeName, type, dim) || ast->constValue.type == type)
+        return;
+
+    /* Write the expression itself, if its value can not be converted */
+    if (!ConvertValue(ast->constValue, type))
+        ast->constValue = ConstValue();
+}
+
+void ConstantFolder::ConvertToVarType(Expr* ast, const VarIdent* varIdent)
+{
+    if (!ast || varIdent->next || !varIdent->arrayIndices.empty())
+        return;
+
+    auto symbol = varIdent->symbolRef;
+    if (!symbol || symbol->Type() != AST::Types::VarDecl)
+        return;
+
+    auto varDecl = static_cast<VarDecl*>(symbol);
+    if (varDecl->declStmntRef && varDecl->arrayDims.empty())
+        ConvertToVarType(ast, varDecl->declStmntRef->varType->baseType);
+}
+
+bool ConstantFolder::Fold(Expr* ast, ConstValue& value)
+{
+    if (!ast)
+        return false;
+
+    /* Check if this expression has already been folded */
+    auto it = values_.find(ast);
+    if (it != values_.end())
+    {
+        value = it->second;
+        return (value.type != Types::None);
+    }
+
+    /* Insert a non-constant entry first (in case of a cyclic reference) */
+    values_[ast] = ConstValue();
+
+    if (!FoldExpr(ast, value))
+    {
+        value = ConstValue();
+        return false;
+    }
+
+    values_[ast] = value;
+
+    /*
+    Decorate expression with its constant value, except literals (which are already constant),
+    and variables of vector type (to avoid that vectors are copied into each expression)
+    */
+    auto type = ast->Type();
+    if (type != AST::Types::LiteralExpr && !(type == AST::Types::VarAccessExpr && value.components.size() > 1))
+        ast->constValue = value;
+
+    return true;
+}
+
+bool ConstantFolder::FoldExpr(Expr* ast, ConstValue& value)
+{
+    switch (ast->Type())
+    {
+        case AST::Types::LiteralExpr:
+            return FoldLiteral(static_cast<LiteralExpr*>(ast), value);
+        case AST::Types::BinaryExpr:
+            return FoldBinaryChain(static_cast<BinaryExpr*>(ast), value);
+        case AST::Types::UnaryExpr:
+            return FoldUnary(static_cast<UnaryExpr*>(ast), value);
+        case AST::Types::TernaryExpr:
+            return FoldTernary(static_cast<TernaryExpr*>(ast), value);
+        case AST::Types::CastExpr:
+            return FoldCast(static_cast<CastExpr*>(ast), value);
+        case AST::Types::FunctionCallExpr:
+            return FoldFunctionCall(static_cast<FunctionCallExpr*>(ast)->call, value);
+        case AST::Types::VarAccessExpr:
+            return FoldVarAccess(static_cast<VarAccessExpr*>(ast), value);
+        case AST::Types::BracketExpr:
+            return Fold(static_cast<BracketExpr*>(ast)->expr, value);
+        default:
+            return false;
+    }
+}
+
+bool ConstantFolder::FoldLiteral(LiteralExpr* ast, ConstValue& value)
+{
+    const auto& literal = ast->literal;
+
+    if (literal == "true" || literal == "false")
+    {
+        value.type = Types::Bool;
+        value.components = { literal == "true" ? 1.0 : 0.0 };
+        return true;
+    }
+
+    /* Decimal literals with leading zeros may be interpreted as octal literals */
+    if (literal.empty() || (literal.size() > 1 && literal[0] == '0' && literal[1] != '.'))
+        return false;
+
+    const char* begin = literal.c_str();
+    char* end = nullptr;
+    auto number = std::strtod(begin, &end);
+
+    if (*end != '\0')
+        return false;
+
+    if (literal.find('.') != std::string::npos)
+        value.type = Types::Float;
+    else if (number <= 2147483647.0)
+        value.type = Types::Int;
+    else
+        return false;
+
+    value.components = { number };
+    return RoundComponent(value.components[0], value.type);
+}
+
+bool ConstantFolder::FoldBinaryChain(BinaryExpr* ast, ConstValue& value)
+{
+    /* Flatten binary expression chain */
+    std::vector<BinaryExpr*>    nodes;
+    std::vector<Expr*>          operands;
+    std::vector<std::string>    ops;
+
+    Expr* expr = ast;
+    while (expr->Type() == AST::Types::BinaryExpr)
+    {
+        auto binExpr = static_cast<BinaryExpr*>(expr);
+        nodes.push_back(binExpr);
+        operands.push_back(binExpr->lhsExpr);
+        ops.push_back(binExpr->op);
+        expr = binExpr->rhsExpr;
+    }
+
+    /*
+    Chains which end with a ternary or list expression are not folded,
+    because these expressions have a lower precedence than the chain
+    */
+    if (expr->Type() == AST::Types::TernaryExpr || expr->Type() == AST::Types::ListExpr)
+        return false;
+
+    operands.push_back(expr);
+
+    /* Fold all operands */
+    std::vector<ConstValue> values(operands.size());
+    std::vector<bool> isConst(operands.size());
+
+    for (std::size_t i = 0; i < operands.size(); ++i)
+        isConst[i] = Fold(operands[i], values[i]);
+
+    for (const auto& op : ops)
+    {
+        if (OperatorPrecedence(op) == 0)
+            return false;
+    }
+
+    /*
+    Find the largest constant tail of this chain, which is a sub expression on its own,
+    i.e. all its operators bind tighter than the operator in front of it (e.g. "2*3" in "x+2*3")
+    */
+    auto numOps = ops.size();
+    std::size_t firstConst = operands.size();
+
+    while (firstConst > 0 && isConst[firstConst - 1])
+        --firstConst;
+
+    /* Determine the lowest operator precedence of each tail once, so long chains are folded in linear time */
+    std::vector<int> tailPrecedence(numOps);
+    for (auto i = numOps; i-- > firstConst;)
+    {
+        tailPrecedence[i] = OperatorPrecedence(ops[i]);
+        if (i + 1 < numOps)
+            tailPrecedence[i] = std::min(tailPrecedence[i], tailPrecedence[i + 1]);
+    }
+
+    for (auto i = firstConst; i < numOps; ++i)
+    {
+        if (i > 0 && tailPrecedence[i] <= OperatorPrecedence(ops[i - 1]))
+            continue;
+
+        ConstValue tailValue;
+        if (EvaluateChain(values.begin() + i, ops.begin() + i, ops.end(), tailValue))
+        {
+            if (i == 0)
+            {
+                /* The entire chain is constant */
+                value = tailValue;
+                return true;
+            }
+
+            nodes[i]->constValue = tailValue;
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool ConstantFolder::FoldUnary(UnaryExpr* ast, ConstValue& value)
+{
+    if (!Fold(ast->expr, value))
+        return false;
+
+    const auto& op = ast->op;
+
+    if (op == "!")
+    {
+        for (auto& c : value.components)
+            c = (c == 0.0 ? 1.0 : 0.0);
+        value.type = Types::Bool;
+        return true;
+    }
+
+    if (op == "-" || op == "+")
+    {
+        if (!ConvertValue(value, std::max(Types::Int, value.type)))
+            return false;
+        if (op == "-")
+        {
+            for (auto& c : value.components)
+            {
+                c = -c;
+                if (!RoundComponent(c, value.type))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    if (op == "~" && value.type != Types::Float)
+    {
+        if (!ConvertValue(value, std::max(Types::Int, value.type)))
+            return false;
+        for (auto& c : value.components)
+        {
+            c = static_cast<double>(~static_cast<std::uint32_t>(static_cast<std::int64_t>(c)));
+            if (!RoundComponent(c, value.type))
+                return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool ConstantFolder::FoldTernary(TernaryExpr* ast, ConstValue& value)
+{
+    ConstValue condition, ifValue, elseValue;
+
+    if (!Fold(ast->condition, condition) || !Fold(ast->ifExpr, ifValue) || !Fold(ast->elseExpr, elseValue))
+        return false;
+
+    if (condition.components.size() != 1)
+        return false;
+
+    value = (condition.components[0] != 0.0 ? ifValue : elseValue);
+    return true;
+}
+
+bool ConstantFolder::FoldCast(CastExpr* ast, ConstValue& value)
+{
+    if (ast->typeExpr->Type() != AST::Types::TypeNameExpr)
+        return false;
+
+    Types type;
+    std::size_t dim;
+
+    if (!ParseTypeName(static_cast<TypeNameExpr*>(ast->typeExpr)->typeName, type, dim))
+        return false;
+
+    if (!Fold(ast->expr, value) || !ConvertValue(value, type))
+        return false;
+
+    /* Scalars are broadcasted to vectors, and vectors are truncated */
+    if (value.components.size() == 1)
+        value.components.resize(dim, value.components[0]);
+    else if (value.components.size() >= dim)
+        value.components.resize(dim);
+    else
+        return false;
+
+    return true;
+}
+
+bool ConstantFolder::FoldFunctionCall(FunctionCall* ast, ConstValue& value)
+{
+    if (ast->name->next || !ast->name->arrayIndices.empty())
+        return false;
+
+    /* Fold all arguments */
+    std::vector<ConstValue> args(ast->arguments.size());
+    for (std::size_t i = 0; i < args.size(); ++i)
+    {
+        if (!Fold(ast->arguments[i], args[i]))
+            return false;
+    }
+
+    const auto& name = ast->name->ident;
+
+    /* Fold type constructor (e.g. "float3(1, 2, 3)") */
+    Types type;
+    std::size_t dim;
+
+    if (ParseTypeName(name, type, dim))
+    {
+        value.type = type;
+        value.components.clear();
+
+        for (auto& arg : args)
+        {
+            if (!ConvertValue(arg, type))
+                return false;
+            value.components.insert(value.components.end(), arg.components.begin(), arg.components.end());
+        }
+
+        if (value.components.size() == 1)
+            value.components.resize(dim, value.components[0]);
+
+        return (value.components.size() == dim);
+    }
+
+    if (functionNames_.find(name) != functionNames_.end())
+        return false;
+
+    /* Fold intrinsics with floating-point arguments */
+    auto FoldFloatArgs = [&](std::size_t numArgs, const std::function<double(const std::vector<double>&)>& func) -> bool
+    {
+        if (args.size() != numArgs)
+            return false;
+
+        std::size_t resultDim = 1;
+        for (auto& arg : args)
+        {
+            if (!ConvertValue(arg, Types::Float))
+                return false;
+            if (arg.components.size() != 1)
+            {
+                if (resultDim != 1 && resultDim != arg.components.size())
+                    return false;
+                resultDim = arg.components.size();
+            }
+        }
+
+        value.type = Types::Float;
+        value.components.resize(resultDim);
+
+        std::vector<double> x(numArgs);
+        for (std::size_t i = 0; i < resultDim; ++i)
+        {
+            for (std::size_t j = 0; j < numArgs; ++j)
+                x[j] = args[j].components[args[j].components.size() == 1 ? 0 : i];
+            value.components[i] = func(x);
+            if (!RoundComponent(value.components[i], Types::Float))
+                return false;
+        }
+
+        return true;
+    };
+
+    typedef const std::vector<double>& Args;
+
+    if (name == "sqrt")
+        return FoldFloatArgs(1, [](Args x) { return std::sqrt(x[0]); });
+    if (name == "rsqrt")
+        return FoldFloatArgs(1, [](Args x) { return 1.0 / std::sqrt(x[0]); });
+    if (name == "rcp")
+        return FoldFloatArgs(1, [](Args x) { return 1.0 / x[0]; });
+    if (name == "floor")
+        return FoldFloatArgs(1, [](Args x) { return std::floor(x[0]); });
+    if (name == "ceil")
+        return FoldFloatArgs(1, [](Args x) { return std::ceil(x[0]); });
+    if (name == "trunc")
+        return FoldFloatArgs(1, [](Args x) { return std::trunc(x[0]); });
+    if (name == "frac")
+        return FoldFloatArgs(1, [](Args x) { return x[0] - std::floor(x[0]); });
+    if (name == "saturate")
+        return FoldFloatArgs(1, [](Args x) { return std::min(std::max(x[0], 0.0), 1.0); });
+    if (name == "exp")
+        return FoldFloatArgs(1, [](Args x) { return std::exp(x[0]); });
+    if (name == "exp2")
+        return FoldFloatArgs(1, [](Args x) { return std::exp2(x[0]); });
+    if (name == "log")
+        return FoldFloatArgs(1, [](Args x) { return std::log(x[0]); });
+    if (name == "log2")
+        return FoldFloatArgs(1, [](Args x) { return std::log2(x[0]); });
+    if (name == "sin")
+        return FoldFloatArgs(1, [](Args x) { return std::sin(x[0]); });
+    if (name == "cos")
+        return FoldFloatArgs(1, [](Args x) { return std::cos(x[0]); });
+    if (name == "tan")
+        return FoldFloatArgs(1, [](Args x) { return std::tan(x[0]); });
+    if (name == "radians")
+        return FoldFloatArgs(1, [](Args x) { return x[0] * 0.017453292519943295; });
+    if (name == "degrees")
+        return FoldFloatArgs(1, [](Args x) { return x[0] * 57.295779513082323; });
+    if (name == "pow")
+        return FoldFloatArgs(2, [](Args x) { return std::pow(x[0], x[1]); });
+    if (name == "step")
+        return FoldFloatArgs(2, [](Args x) { return (x[1] >= x[0] ? 1.0 : 0.0); });
+    if (name == "lerp")
+        return FoldFloatArgs(3, [](Args x) { return x[0] + (x[1] - x[0]) * x[2]; });
+
+    /* Fold intrinsics which keep the type of their arguments */
+    if ((name == "abs" && args.size() == 1) || ((name == "min" || name == "max") && args.size() == 2) || (name == "clamp" && args.size() == 3))
+    {
+        type = Types::Int;
+        for (const auto& arg : args)
+            type = std::max(type, arg.type);
+
+        value = args[0];
+        if (!ConvertValue(value, type))
+            return false;
+
+        if (name == "abs")
+        {
+            for (auto& c : value.components)
+            {
+                c = std::abs(c);
+                if (!RoundComponent(c, type))
+                    return false;
+            }
+            return true;
+        }
+
+        for (std::size_t i = 1; i < args.size(); ++i)
+        {
+            auto useMin = (name == "min" || (name == "clamp" && i == 2));
+            ConstValue result;
+            if (!ApplyComponentWise(value, args[i], type, [useMin](double a, double b, double& c) { c = (useMin ? std::min(a, b) : std::max(a, b)); return true; }, result))
+                return false;
+            value = result;
+        }
+
+        return true;
+    }
+
+    if (name == "dot" && args.size() == 2 && args[0].components.size() == args[1].components.size())
+    {
+        type = CommonType(args[0].type, args[1].type);
+        if (!ConvertValue(args[0], type) || !ConvertValue(args[1], type))
+            return false;
+
+        double sum = 0.0;
+        for (std::size_t i = 0; i < args[0].components.size(); ++i)
+            sum += args[0].components[i] * args[1].components[i];
+
+        value.type = type;
+        value.components = { sum };
+        return RoundComponent(value.components[0], type);
+    }
+
+    return false;
+}
+
+bool ConstantFolder::FoldVarAccess(VarAccessExpr* ast, ConstValue& value)
+{
+    auto varIdent = ast->varIdent;
+    if (!ast->assignOp.empty() || varIdent->next || !varIdent->arrayIndices.empty())
+        return false;
+
+    auto symbol = varIdent->symbolRef;
+    if (!symbol || symbol->Type() != AST::Types::VarDecl)
+        return false;
+
+    /*
+    Only propagate the values of constant local variables with a constant initializer
+    (global variables are only declared inside of constant buffers, i.e. they are uniforms, which can be set by the application)
+    */
+    auto varDecl = static_cast<VarDecl*>(symbol);
+    auto declStmnt = varDecl->declStmntRef;
+
+    if (!declStmnt || !varDecl->initializer || !varDecl->arrayDims.empty() || !varDecl->flags(VarDecl::isInsideFunc))
+        return false;
+    if (!HasModifier(declStmnt->typeModifiers, "const"))
+        return false;
+
+    Types type;
+    std::size_t dim;
+
+    if (!ParseTypeName(declStmnt->varType->baseType, type, dim))
+        return false;
+
+    if (!Fold(varDecl->initializer, value) || !ConvertValue(value, type))
+        return false;
+
+    if (value.components.size() == 1)
+        value.components.resize(dim, value.components[0]);
+
+    return (value.components.size() == dim);
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,100 @@
+/*
+ * ConstantFolder.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_CONSTANT_FOLDER_H__
+#define __HT_CONSTANT_FOLDER_H__
+
+
+#include "HLSLTree.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace HTLib
+{
+
+
+/**
+Constant folder.
+This helper class for the context analyzer evaluates all expressions with constant operands,
+i.e. scalar and vector arithmetic over literals, a set of intrinsics with constant arguments,
+and the values of constant local variables.
+\remarks The AST itself is not modified, only its decorations (see "Expr::constValue"),
+so that the same program can be generated many times. The code generator writes the folded value
+instead of the expression. Thus this pass must be applied after the AST has been decorated with its symbol references.
+*/
+class ConstantFolder
+{
+    
+    public:
+        
+        void FoldConstants(Program* program);
+
+        /**
+        Folds the constant expressions of the body of the specified function only (see "Options::streamOutput").
+        \remarks The names of all user defined functions must have been collected first (see "CollectFunctionNames").
+        The body must be owned by its own arena (see "FunctionDecl::bodyArena"), otherwise nothing is folded.
+        */
+        void FoldConstants(FunctionDecl* ast);
+
+        //! Collects the names of all user defined functions of the specified program, which may overload intrinsics.
+        void CollectFunctionNames(Program* program);
+
+    private:
+        
+        typedef ConstValue::Types Types;
+
+        /* === Functions === */
+
+        //! Stores the tail of the specified node, if it is a binary expression.
+        void CollectChainTail(AST* node);
+
+        //! Folds the specified node, if it is an expression which is not the tail of a binary expression chain.
+        void FoldNode(AST* node);
+
+        /**
+        Converts the folded value of the specified expression, which is assigned to a variable of the specified type (e.g. "float3"),
+        into the base type of that variable, because the generator writes the value instead of the implicitly converted expression,
+        e.g. "float f = 1/2;" is written as "float f = 0.0;".
+        */
+        void ConvertToVarType(Expr* ast, const std::string& typeName);
+
+        //! Converts the folded value which is assigned to the specified variable (see "ConvertToVarType").
+        void ConvertToVarType(Expr* ast, const VarIdent* varIdent);
+
+        //! Folds the specified expression (only once) and returns true if it is constant.
+        bool Fold(Expr* ast, ConstValue& value);
+
+        bool FoldExpr(Expr* ast, ConstValue& value);
+        bool FoldLiteral(LiteralExpr* ast, ConstValue& value);
+        bool FoldBinaryChain(BinaryExpr* ast, ConstValue& value);
+        bool FoldUnary(UnaryExpr* ast, ConstValue& value);
+        bool FoldTernary(TernaryExpr* ast, ConstValue& value);
+        bool FoldCast(CastExpr* ast, ConstValue& value);
+        bool FoldFunctionCall(FunctionCall* ast, ConstValue& value);
+        bool FoldVarAccess(VarAccessExpr* ast, ConstValue& value);
+
+        /* === Members === */
+
+        std::unordered_map<const Expr*, ConstValue>   values_;        //!< Folded values (also for the expressions which are not constant).
+        std::unordered_set<const Expr*>               chainTails_;    //!< Right-hand-side expressions of binary expression chains.
+        std::unordered_set<Ident>                     functionNames_; //!< Names of all user defined functions (which may overload intrinsics).
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
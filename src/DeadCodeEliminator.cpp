@@ -0,0 +1,1233 @@
+/*
+ * DeadCodeEliminator.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "DeadCodeEliminator.h"
+#include "HLSLTree.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Returns true if the specified expression is a constant (e.g. "true", "0" or "(1.0f)") and stores its boolean value.
+static bool EvaluateConstCondition(Expr* ast, bool& value)
+{
+    /* Skip bracket expressions */
+    while (ast && ast->Type() == AST::Types::BracketExpr)
+        ast = static_cast<BracketExpr*>(ast)->expr;
+
+    if (!ast)
+        return false;
+
+    /* Check for a folded scalar constant (see "ConstantFolder") */
+    const auto& constValue = ast->constValue;
+    if (constValue.type != ConstValue::Types::None && constValue.components.size() == 1)
+    {
+        value = (constValue.components[0] != 0.0);
+        return true;
+    }
+
+    if (ast->Type() != AST::Types::LiteralExpr)
+        return false;
+
+    const auto& literal = static_cast<LiteralExpr*>(ast)->literal;
+
+    if (literal == "true" || literal == "false")
+    {
+        value = (literal == "true");
+        return true;
+    }
+
+    /* Parse numeric literal (with optional type suffix) */
+    const char* begin = literal.c_str();
+    char* end = nullptr;
+    auto number = std::strtod(begin, &end);
+
+    if (end == begin)
+        return false;
+
+    for (; *end != '\0'; ++end)
+    {
+        switch (*end)
+        {
+            case 'f': case 'F': case 'h': case 'H':
+            case 'l': case 'L': case 'u': case 'U':
+                break;
+            default:
+                return false;
+        }
+    }
+
+    value = (number != 0.0);
+    return true;
+}
+
+static bool IsConstFalseLoop(Stmnt* ast)
+{
+    bool value = true;
+    return
+    (
+        ast->Type() == AST::Types::WhileLoopStmnt &&
+        EvaluateConstCondition(static_cast<WhileLoopStmnt*>(ast)->condition, value) &&
+        !value
+    );
+}
+
+//! Returns true if the specified expression has been folded to a constant, i.e. its sub expressions are not generated.
+static bool IsFolded(const Expr* ast)
+{
+    return (ast->constValue.type != ConstValue::Types::None);
+}
+
+static bool IsIntrinsicWithSideEffects(const std::string& name)
+{
+    return
+    (
+        name == "clip"                                          ||
+        name == "sincos"                                        ||
+        name == "abort"                                         ||
+        name == "errorf"                                        ||
+        name == "printf"                                        ||
+        name.compare(0, 18, "GroupMemoryBarrier") == 0          ||
+        name.compare(0, 16, "AllMemoryBarrier") == 0            ||
+        name.compare(0, 19, "DeviceMemoryBarrier") == 0
+    );
+}
+
+
+//! Returns the structure type of the specified variable type, or null if it is not a structure type.
+static const Structure* StructType(const VarType* varType)
+{
+    if (varType->symbolRef && varType->symbolRef->Type() == AST::Types::Structure)
+        return static_cast<const Structure*>(varType->symbolRef);
+    return nullptr;
+}
+
+/**
+Returns the structure type of the specified variable symbol, or null if it is not a variable of a structure type.
+\remarks Function parameters have no reference to their declaration statement, so they always return null.
+*/
+static const Structure* VarStructType(const AST* symbol)
+{
+    if (symbol && symbol->Type() == AST::Types::VarDecl)
+    {
+        auto declStmnt = static_cast<const VarDecl*>(symbol)->declStmntRef;
+        if (declStmnt)
+            return StructType(declStmnt->varType);
+    }
+    return nullptr;
+}
+
+static VarDecl* FindStructMember(const Structure* structure, const std::string& ident)
+{
+    for (const auto& member : structure->members)
+    {
+        for (const auto& varDecl : member->varDecls)
+        {
+            if (varDecl->name == ident)
+                return varDecl;
+        }
+    }
+    return nullptr;
+}
+
+/**
+Returns the semantic of the specified shader input or output in upper case and with its index (e.g. "TEXCOORD0" for "TexCoord"),
+or an empty string if it has no semantic.
+*/
+static std::string VaryingSemantic(const VarDecl* varDecl)
+{
+    if (varDecl->semantics.empty())
+        return "";
+
+    auto semantic = varDecl->semantics.front()->semantic;
+    for (auto& chr : semantic)
+        chr = static_cast<char>(std::toupper(static_cast<unsigned char>(chr)));
+
+    if (semantic.empty() || !std::isdigit(static_cast<unsigned char>(semantic.back())))
+        semantic += '0';
+
+    return semantic;
+}
+
+//! Returns true if the specified varying semantic is a system value (e.g. "SV_POSITION0"), which is never removed.
+static bool IsSystemValueVarying(const std::string& semantic)
+{
+    return (semantic.compare(0, 3, "SV_") == 0);
+}
+
+
+/*
+ * DeadCodeEliminator class
+ */
+
+void DeadCodeEliminator::MarkDeadCode(Program* program, StageVaryings* varyings)
+{
+    /* Unused members of the output structure can only be removed if the inputs of the next stage are known */
+    varyings_ = varyings;
+    outputStruct_ = nullptr;
+
+    if (varyings && varyings->nextStageInputs)
+    {
+        auto returnType = program->outputSemantics.returnType;
+        if (returnType && returnType->symbolRef && returnType->symbolRef->Type() == AST::Types::Structure)
+            outputStruct_ = static_cast<const Structure*>(returnType->symbolRef);
+    }
+
+    Visit(program);
+
+    varyings_ = nullptr;
+    outputStruct_ = nullptr;
+}
+
+void DeadCodeEliminator::MarkDeadCode(FunctionDecl* ast)
+{
+    Visit(ast);
+}
+
+void DeadCodeEliminator::CollectFunctionNames(Program* program)
+{
+    functionNames_.clear();
+    pureFunctionNames_.clear();
+    impureFunctionNames_.clear();
+
+    for (auto& globDecl : program->globalDecls)
+    {
+        if (globDecl->Type() == AST::Types::FunctionDecl)
+            functionNames_.insert(static_cast<FunctionDecl*>(globDecl)->name);
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+/* ------- Visit functions ------- */
+
+#define IMPLEMENT_VISIT_PROC(className) \
+    void DeadCodeEliminator::Visit##className(className* ast, void* args)
+
+IMPLEMENT_VISIT_PROC(Program)
+{
+    CollectFunctionNames(ast);
+
+    for (auto& globDecl : ast->globalDecls)
+    {
+        if (globDecl->Type() == AST::Types::FunctionDecl)
+            Visit(globDecl);
+    }
+}
+
+IMPLEMENT_VISIT_PROC(CodeBlock)
+{
+    VisitStmntList(ast->stmnts);
+}
+
+IMPLEMENT_VISIT_PROC(FunctionCall)
+{
+    Visit(ast->name);
+    for (auto& arg : ast->arguments)
+        Visit(arg);
+}
+
+IMPLEMENT_VISIT_PROC(SwitchCase)
+{
+    Visit(ast->expr);
+    VisitStmntList(ast->stmnts);
+}
+
+/* --- Global declarations --- */
+
+IMPLEMENT_VISIT_PROC(FunctionDecl)
+{
+    if (!ast->codeBlock)
+        return;
+
+    localVars_.clear();
+    useCount_.clear();
+    localAssignments_.clear();
+    outputAssignments_.clear();
+    usedVaryings_.clear();
+    hasUnresolvedIdents_ = false;
+    isOutputUsedEntirely_ = false;
+
+    /* Track the shader inputs and outputs of the entry point for a pipeline translation */
+    isEntryPoint_ = (varyings_ != nullptr && ast->flags(FunctionDecl::isEntryPoint));
+
+    inputParams_.clear();
+    if (isEntryPoint_)
+    {
+        for (const auto& param : ast->parameters)
+        {
+            for (const auto& varDecl : param->varDecls)
+                inputParams_[varDecl] = StructType(param->varType);
+        }
+    }
+
+    Visit(ast->codeBlock);
+
+    if (isEntryPoint_)
+    {
+        DisableUnusedVaryings(ast);
+        isEntryPoint_ = false;
+    }
+
+    /*
+    Only remove unused variables if all identifiers could be resolved,
+    otherwise a variable might be referenced by a pass-through macro for instance
+    */
+    if (!hasUnresolvedIdents_)
+        DisableUnusedVariables();
+
+    /*
+    Calls of the following functions to this function have no side effects, if all of its overloads up to here are pure.
+    The functions are visited in the order of their declaration, which is the same for the streaming output
+    */
+    if (IsPureFunction(ast) && impureFunctionNames_.find(ast->name) == impureFunctionNames_.end())
+        pureFunctionNames_.insert(ast->name);
+    else
+    {
+        pureFunctionNames_.erase(ast->name);
+        impureFunctionNames_.insert(ast->name);
+    }
+}
+
+/* --- Statements --- */
+
+IMPLEMENT_VISIT_PROC(CodeBlockStmnt)
+{
+    Visit(ast->codeBlock);
+}
+
+IMPLEMENT_VISIT_PROC(ForLoopStmnt)
+{
+    Visit(ast->initSmnt);
+    Visit(ast->condition);
+    Visit(ast->iteration);
+    Visit(ast->bodyStmnt);
+    stmntTerminates_ = false;
+}
+
+IMPLEMENT_VISIT_PROC(WhileLoopStmnt)
+{
+    Visit(ast->condition);
+    Visit(ast->bodyStmnt);
+    stmntTerminates_ = false;
+}
+
+IMPLEMENT_VISIT_PROC(DoWhileLoopStmnt)
+{
+    Visit(ast->bodyStmnt);
+    Visit(ast->condition);
+    stmntTerminates_ = false;
+}
+
+IMPLEMENT_VISIT_PROC(IfStmnt)
+{
+    /* Only fold statements which can be replaced by their branch (i.e. no body of another statement) */
+    bool isFoldable = (args != nullptr);
+    bool value = false;
+
+    if (isFoldable && EvaluateConstCondition(ast->condition, value))
+    {
+        /* The branch replaces this statement, so it is a list statement if this statement is one */
+        if (value)
+        {
+            /* Only the 'if' branch will be generated */
+            ast->flags << IfStmnt::isConstTrue;
+            stmntTerminates_ = VisitStmnt(ast->bodyStmnt, args);
+        }
+        else
+        {
+            /* Only the 'else' branch (if any) will be generated */
+            ast->flags << IfStmnt::isConstFalse;
+            stmntTerminates_ = (ast->elseStmnt != nullptr && VisitStmnt(ast->elseStmnt->bodyStmnt, args));
+        }
+    }
+    else
+    {
+        Visit(ast->condition);
+
+        auto bodyTerminates = VisitStmnt(ast->bodyStmnt);
+        auto elseTerminates = (ast->elseStmnt != nullptr && VisitStmnt(ast->elseStmnt));
+
+        stmntTerminates_ = (bodyTerminates && elseTerminates);
+    }
+}
+
+IMPLEMENT_VISIT_PROC(ElseStmnt)
+{
+    /* An 'else if' statement can be folded, too (but its branch is not a list statement, which could be removed) */
+    if (ast->bodyStmnt->Type() == AST::Types::IfStmnt)
+    {
+        bool isListStmnt = false;
+        Visit(ast->bodyStmnt, &isListStmnt);
+    }
+    else
+        Visit(ast->bodyStmnt);
+}
+
+IMPLEMENT_VISIT_PROC(SwitchStmnt)
+{
+    Visit(ast->selector);
+    for (auto& switchCase : ast->cases)
+        Visit(switchCase);
+    stmntTerminates_ = false;
+}
+
+IMPLEMENT_VISIT_PROC(VarDeclStmnt)
+{
+    /*
+    Only variables of a statement list can be removed,
+    and never the entry point in/out variables or a variable with an inline structure declaration
+    */
+    bool isRemovable =
+    (
+        args != nullptr &&
+        !ast->varType->structType &&
+        !ast->flags(VarDeclStmnt::isShaderInput) &&
+        !ast->flags(VarDeclStmnt::isShaderOutput)
+    );
+
+    for (auto& varDecl : ast->varDecls)
+    {
+        Visit(varDecl);
+        if (isRemovable)
+            localVars_.push_back(varDecl);
+    }
+}
+
+IMPLEMENT_VISIT_PROC(AssignStmnt)
+{
+    /* Only assignments of a statement list without side effects can be removed (see "VisitStmntList") */
+    bool isRemovable =
+    (
+        args != nullptr &&
+        *reinterpret_cast<bool*>(args) &&
+        !HasSideEffects(ast->varIdent) &&
+        !HasSideEffects(ast->expr)
+    );
+
+    auto symbol = ast->varIdent->symbolRef;
+
+    if (IsShaderOutputVar(symbol))
+    {
+        /* Assignments to shader output members are only counted if the members are not removed (see "DisableUnusedVaryings") */
+        auto member = (ast->varIdent->next ? FindStructMember(outputStruct_, ast->varIdent->next->ident) : nullptr);
+        if (!member)
+            isOutputUsedEntirely_ = true;
+        else if (isRemovable)
+        {
+            outputAssignments_[member].push_back(ast);
+            return;
+        }
+        else
+            usedVaryings_.insert(member);
+    }
+    else if (symbol && symbol->Type() == AST::Types::VarDecl && symbol->flags(VarDecl::isInsideFunc))
+    {
+        /* A local variable, which is assigned by a statement that can not be removed, is used */
+        if (isRemovable)
+            localAssignments_[symbol].push_back(ast);
+        else
+            CountReference(ast->varIdent);
+    }
+
+    /* Writing to an input parameter keeps it, too */
+    if (isEntryPoint_)
+        MarkVaryingReference(ast->varIdent);
+
+    Visit(ast->varIdent);
+    Visit(ast->expr);
+}
+
+IMPLEMENT_VISIT_PROC(ExprStmnt)
+{
+    Visit(ast->expr);
+}
+
+IMPLEMENT_VISIT_PROC(FunctionCallStmnt)
+{
+    Visit(ast->call);
+}
+
+IMPLEMENT_VISIT_PROC(ReturnStmnt)
+{
+    /* Returning the shader output variable does not use its members */
+    auto varAccessExpr = (ast->expr && ast->expr->Type() == AST::Types::VarAccessExpr ? static_cast<VarAccessExpr*>(ast->expr) : nullptr);
+    if ( !varAccessExpr || varAccessExpr->assignExpr || varAccessExpr->varIdent->next ||
+         !IsShaderOutputVar(varAccessExpr->varIdent->symbolRef) )
+    {
+        Visit(ast->expr);
+    }
+    stmntTerminates_ = true;
+}
+
+IMPLEMENT_VISIT_PROC(CtrlTransferStmnt)
+{
+    /* 'break', 'continue' and 'discard' never fall through */
+    stmntTerminates_ = true;
+}
+
+/* --- Expressions --- */
+
+IMPLEMENT_VISIT_PROC(ListExpr)
+{
+    Visit(ast->firstExpr);
+    Visit(ast->nextExpr);
+}
+
+IMPLEMENT_VISIT_PROC(TernaryExpr)
+{
+    if (IsFolded(ast))
+        return;
+
+    Visit(ast->condition);
+    Visit(ast->ifExpr);
+    Visit(ast->elseExpr);
+}
+
+IMPLEMENT_VISIT_PROC(BinaryExpr)
+{
+    /* Visit the binary expression chain iteratively (see HLSLParser::ParseExpr) */
+    ExprPtr expr = ast;
+    while (expr && expr->Type() == AST::Types::BinaryExpr)
+    {
+        auto binExpr = static_cast<BinaryExpr*>(expr);
+
+        if (IsFolded(binExpr))
+            return;
+
+        Visit(binExpr->lhsExpr);
+        expr = binExpr->rhsExpr;
+    }
+    Visit(expr);
+}
+
+IMPLEMENT_VISIT_PROC(UnaryExpr)
+{
+    if (IsFolded(ast))
+        return;
+
+    Visit(ast->expr);
+}
+
+IMPLEMENT_VISIT_PROC(PostUnaryExpr)
+{
+    Visit(ast->expr);
+}
+
+IMPLEMENT_VISIT_PROC(FunctionCallExpr)
+{
+    if (IsFolded(ast))
+        return;
+
+    Visit(ast->call);
+}
+
+IMPLEMENT_VISIT_PROC(BracketExpr)
+{
+    if (IsFolded(ast))
+        return;
+
+    Visit(ast->expr);
+}
+
+IMPLEMENT_VISIT_PROC(CastExpr)
+{
+    if (IsFolded(ast))
+        return;
+
+    /* Skip type expression (it never references a variable) */
+    Visit(ast->expr);
+}
+
+IMPLEMENT_VISIT_PROC(VarAccessExpr)
+{
+    if (IsFolded(ast))
+        return;
+
+    CountReference(ast->varIdent);
+    if (isEntryPoint_)
+        MarkVaryingReference(ast->varIdent);
+
+    Visit(ast->varIdent);
+    Visit(ast->assignExpr);
+}
+
+IMPLEMENT_VISIT_PROC(InitializerExpr)
+{
+    for (auto& expr : ast->exprs)
+        Visit(expr);
+}
+
+/* --- Variables --- */
+
+IMPLEMENT_VISIT_PROC(VarIdent)
+{
+    for (auto& index : ast->arrayIndices)
+        Visit(index);
+    Visit(ast->next);
+}
+
+IMPLEMENT_VISIT_PROC(VarDecl)
+{
+    for (auto& dim : ast->arrayDims)
+        Visit(dim);
+    Visit(ast->initializer);
+}
+
+#undef IMPLEMENT_VISIT_PROC
+
+/* --- Helper functions for dead code elimination --- */
+
+bool DeadCodeEliminator::VisitStmnt(Stmnt* ast, void* args)
+{
+    stmntTerminates_ = false;
+    Visit(ast, args);
+    return stmntTerminates_;
+}
+
+void DeadCodeEliminator::VisitStmntList(const std::vector<StmntPtr>& stmnts)
+{
+    bool isListStmnt = true;
+    bool terminated = false;
+
+    for (auto& stmnt : stmnts)
+    {
+        if (stmnt->Type() == AST::Types::DirectiveStmnt)
+        {
+            /* Pass-through directives (e.g. "#else") may enclose alternative code paths */
+            terminated = false;
+        }
+        else if (terminated || IsConstFalseLoop(stmnt))
+        {
+            /* This statement can never be executed */
+            stmnt->flags << Stmnt::isDeadCode;
+        }
+        else
+            terminated = VisitStmnt(stmnt, &isListStmnt);
+    }
+
+    stmntTerminates_ = terminated;
+}
+
+void DeadCodeEliminator::CountReference(VarIdent* varIdent)
+{
+    auto symbol = varIdent->symbolRef;
+    if (symbol)
+    {
+        if (symbol->Type() == AST::Types::VarDecl && symbol->flags(VarDecl::isInsideFunc))
+            useCount_[symbol] += refDelta_;
+    }
+    else
+        hasUnresolvedIdents_ = true;
+}
+
+void DeadCodeEliminator::DisableUnusedVariables()
+{
+    for (bool hasChanged = true; hasChanged;)
+    {
+        hasChanged = false;
+
+        /* Visit variables in reverse order, so that a chain of unused variables is mostly removed in a single iteration */
+        for (auto it = localVars_.rbegin(); it != localVars_.rend(); ++it)
+        {
+            auto varDecl = *it;
+
+            if (varDecl->flags(VarDecl::disableCodeGen) || useCount_[varDecl] > 0 || HasSideEffects(varDecl->initializer))
+                continue;
+
+            bool hasSideEffects = false;
+            for (auto& dim : varDecl->arrayDims)
+                hasSideEffects = (hasSideEffects || HasSideEffects(dim));
+
+            if (hasSideEffects)
+                continue;
+
+            /* Disable this variable and its assignments, and uncount all references from its declaration and assignments */
+            varDecl->flags << VarDecl::disableCodeGen;
+
+            refDelta_ = -1;
+            {
+                Visit(varDecl);
+                for (auto assignment : localAssignments_[varDecl])
+                {
+                    assignment->flags << Stmnt::isDeadCode;
+                    Visit(assignment->varIdent);
+                    Visit(assignment->expr);
+                }
+            }
+            refDelta_ = 1;
+
+            hasChanged = true;
+        }
+    }
+}
+
+void DeadCodeEliminator::MarkVaryingReference(VarIdent* varIdent)
+{
+    auto symbol = varIdent->symbolRef;
+
+    if (IsShaderOutputVar(symbol))
+    {
+        /* Output members, which are read by the entry point itself, are used */
+        auto member = (varIdent->next ? FindStructMember(outputStruct_, varIdent->next->ident) : nullptr);
+        if (member)
+            usedVaryings_.insert(member);
+        else
+            isOutputUsedEntirely_ = true;
+    }
+    else
+    {
+        auto it = inputParams_.find(symbol);
+        if (it != inputParams_.end())
+        {
+            /* The input parameter is either used by one of its members or entirely */
+            auto structure = it->second;
+            auto member = (structure && varIdent->next ? FindStructMember(structure, varIdent->next->ident) : nullptr);
+            usedVaryings_.insert(member ? static_cast<AST*>(member) : symbol);
+        }
+    }
+}
+
+void DeadCodeEliminator::DisableUnusedVaryings(FunctionDecl* ast)
+{
+    /*
+    Varyings can only be removed if all identifiers could be resolved (see "FunctionDecl"),
+    and if the output structure is not used as input as well (e.g. for a pass-through stage)
+    */
+    bool canRemoveOutputs = (outputStruct_ != nullptr && !hasUnresolvedIdents_ && !isOutputUsedEntirely_);
+
+    /* Collect the semantics of all used inputs */
+    for (const auto& param : ast->parameters)
+    {
+        auto structure = StructType(param->varType);
+        auto isOutputParam = (param->inputModifier == "out" || param->inputModifier == "inout");
+
+        if (structure == outputStruct_)
+            canRemoveOutputs = false;
+
+        for (const auto& paramDecl : param->varDecls)
+        {
+            const bool isParamUsed = (isOutputParam || hasUnresolvedIdents_ || usedVaryings_.count(paramDecl) > 0);
+
+            /*
+            Disable the local copy of an unused input parameter (e.g. "vec4 pos = gl_FragCoord;"), if neither the parameter
+            nor any of its members is used. This only removes the copy, the interface is kept unless the inputs are pruned
+            */
+            auto isMemberUsed = [&]() -> bool
+            {
+                for (const auto& member : structure->members)
+                {
+                    for (const auto& varDecl : member->varDecls)
+                    {
+                        if (usedVaryings_.count(varDecl) > 0)
+                            return true;
+                    }
+                }
+                return false;
+            };
+
+            if (!isParamUsed && (!structure || !isMemberUsed()))
+                paramDecl->flags << VarDecl::disableCodeGen;
+
+            if (!structure)
+            {
+                auto semantic = VaryingSemantic(paramDecl);
+                if (!semantic.empty() && (isParamUsed || !varyings_->pruneInputs || IsSystemValueVarying(semantic)))
+                    varyings_->inputs.insert(semantic);
+                continue;
+            }
+
+            for (const auto& member : structure->members)
+            {
+                for (const auto& varDecl : member->varDecls)
+                {
+                    auto semantic = VaryingSemantic(varDecl);
+                    if (isParamUsed || usedVaryings_.count(varDecl) > 0 || semantic.empty() || IsSystemValueVarying(semantic))
+                        varyings_->inputs.insert(semantic);
+                    else if (varyings_->pruneInputs)
+                        varDecl->flags << VarDecl::disableCodeGen;
+                }
+            }
+        }
+    }
+
+    varyings_->inputs.erase("");
+
+    /* Disable all output members, which are neither read by the next stage nor by the entry point itself */
+    if (!outputStruct_)
+        return;
+
+    for (const auto& member : outputStruct_->members)
+    {
+        for (const auto& varDecl : member->varDecls)
+        {
+            auto semantic = VaryingSemantic(varDecl);
+            auto& assignments = outputAssignments_[varDecl];
+
+            if ( canRemoveOutputs && !semantic.empty() && !IsSystemValueVarying(semantic) &&
+                 usedVaryings_.count(varDecl) == 0 && varyings_->nextStageInputs->count(semantic) == 0 )
+            {
+                varDecl->flags << VarDecl::disableCodeGen;
+                for (auto assignment : assignments)
+                    assignment->flags << Stmnt::isDeadCode;
+            }
+            else
+            {
+                /* Count the references of the assignments to this output member */
+                for (auto assignment : assignments)
+                {
+                    Visit(assignment->varIdent);
+                    Visit(assignment->expr);
+                }
+            }
+        }
+    }
+}
+
+bool DeadCodeEliminator::IsShaderOutputVar(const AST* symbol) const
+{
+    /* The analyzer disables the code generation for the returned output variable, because it is the interface block */
+    return
+    (
+        isEntryPoint_ &&
+        outputStruct_ != nullptr &&
+        VarStructType(symbol) == outputStruct_ &&
+        symbol->flags(VarDecl::isInsideFunc) &&
+        symbol->flags(VarDecl::disableCodeGen)
+    );
+}
+
+bool DeadCodeEliminator::HasSideEffects(Expr* ast) const
+{
+    if (!ast)
+        return false;
+
+    switch (ast->Type())
+    {
+        case AST::Types::ListExpr:
+        {
+            auto expr = static_cast<ListExpr*>(ast);
+            return HasSideEffects(expr->firstExpr) || HasSideEffects(expr->nextExpr);
+        }
+
+        case AST::Types::TernaryExpr:
+        {
+            auto expr = static_cast<TernaryExpr*>(ast);
+            return HasSideEffects(expr->condition) || HasSideEffects(expr->ifExpr) || HasSideEffects(expr->elseExpr);
+        }
+
+        case AST::Types::BinaryExpr:
+        {
+            /* Search the binary expression chain iteratively */
+            while (ast && ast->Type() == AST::Types::BinaryExpr)
+            {
+                auto expr = static_cast<BinaryExpr*>(ast);
+                if (HasSideEffects(expr->lhsExpr))
+                    return true;
+                ast = expr->rhsExpr;
+            }
+            return HasSideEffects(ast);
+        }
+
+        case AST::Types::UnaryExpr:
+        {
+            auto expr = static_cast<UnaryExpr*>(ast);
+            return expr->op == "++" || expr->op == "--" || HasSideEffects(expr->expr);
+        }
+
+        case AST::Types::PostUnaryExpr:
+        {
+            auto expr = static_cast<PostUnaryExpr*>(ast);
+            return expr->op == "++" || expr->op == "--" || HasSideEffects(expr->expr);
+        }
+
+        case AST::Types::FunctionCallExpr:
+            return HasSideEffects(static_cast<FunctionCallExpr*>(ast)->call);
+
+        case AST::Types::BracketExpr:
+            return HasSideEffects(static_cast<BracketExpr*>(ast)->expr);
+
+        case AST::Types::CastExpr:
+            return HasSideEffects(static_cast<CastExpr*>(ast)->expr);
+
+        case AST::Types::VarAccessExpr:
+        {
+            auto expr = static_cast<VarAccessExpr*>(ast);
+            return !expr->assignOp.empty() || HasSideEffects(expr->varIdent);
+        }
+
+        case AST::Types::InitializerExpr:
+        {
+            for (auto& expr : static_cast<InitializerExpr*>(ast)->exprs)
+            {
+                if (HasSideEffects(expr))
+                    return true;
+            }
+            return false;
+        }
+
+        default:
+            return false;
+    }
+}
+
+bool DeadCodeEliminator::HasSideEffects(VarIdent* ast) const
+{
+    for (; ast; ast = ast->next)
+    {
+        for (auto& index : ast->arrayIndices)
+        {
+            if (HasSideEffects(index))
+                return true;
+        }
+    }
+    return false;
+}
+
+bool DeadCodeEliminator::HasSideEffects(FunctionCall* ast) const
+{
+    if (ast->name->next)
+    {
+        /* Only texture functions (except "GetDimensions" with its output parameters) are free of side effects */
+        if (!ast->flags(FunctionCall::isTexFunc) || LastVarIdent(ast->name)->ident == "GetDimensions")
+            return true;
+    }
+    else
+    {
+        /* Calls to user defined functions (which are not pure) and a few intrinsics may have side effects */
+        const auto& name = ast->name->ident;
+        if (functionNames_.find(name) != functionNames_.end())
+        {
+            if (pureFunctionNames_.find(name) == pureFunctionNames_.end())
+                return true;
+        }
+        else if (ast->flags(FunctionCall::isAtomicFunc) || IsIntrinsicWithSideEffects(name))
+            return true;
+    }
+
+    for (auto& arg : ast->arguments)
+    {
+        if (HasSideEffects(arg))
+            return true;
+    }
+
+    return false;
+}
+
+bool DeadCodeEliminator::IsPureFunction(FunctionDecl* ast) const
+{
+    if (!ast->codeBlock)
+        return false;
+
+    for (const auto& param : ast->parameters)
+    {
+        if (param->inputModifier == "out" || param->inputModifier == "inout")
+            return false;
+    }
+
+    for (auto& stmnt : ast->codeBlock->stmnts)
+    {
+        if (!IsPure(stmnt, ast))
+            return false;
+    }
+
+    return true;
+}
+
+bool DeadCodeEliminator::IsLocalVar(VarIdent* ast, const FunctionDecl* func) const
+{
+    auto symbol = ast->symbolRef;
+    if (!symbol || symbol->Type() != AST::Types::VarDecl)
+        return false;
+
+    /* Static local variables keep their values between the calls */
+    auto varDecl = static_cast<const VarDecl*>(symbol);
+    if (varDecl->flags(VarDecl::isInsideFunc))
+    {
+        auto declStmnt = varDecl->declStmntRef;
+        return
+        (
+            declStmnt != nullptr &&
+            std::find(declStmnt->storageModifiers.begin(), declStmnt->storageModifiers.end(), "static") == declStmnt->storageModifiers.end()
+        );
+    }
+
+    /* Function parameters have no reference to their declaration statement */
+    for (const auto& param : func->parameters)
+    {
+        if (std::find(param->varDecls.begin(), param->varDecls.end(), varDecl) != param->varDecls.end())
+            return true;
+    }
+
+    return false;
+}
+
+bool DeadCodeEliminator::IsPure(Stmnt* ast, const FunctionDecl* func) const
+{
+    if (!ast)
+        return true;
+
+    switch (ast->Type())
+    {
+        case AST::Types::NullStmnt:
+        case AST::Types::DirectiveStmnt:
+        case AST::Types::StructDeclStmnt:
+            return true;
+
+        case AST::Types::CodeBlockStmnt:
+        {
+            for (auto& stmnt : static_cast<CodeBlockStmnt*>(ast)->codeBlock->stmnts)
+            {
+                if (!IsPure(stmnt, func))
+                    return false;
+            }
+            return true;
+        }
+
+        case AST::Types::ForLoopStmnt:
+        {
+            auto stmnt = static_cast<ForLoopStmnt*>(ast);
+            return IsPure(stmnt->initSmnt, func) && IsPure(stmnt->condition, func) && IsPure(stmnt->iteration, func) && IsPure(stmnt->bodyStmnt, func);
+        }
+
+        case AST::Types::WhileLoopStmnt:
+        {
+            auto stmnt = static_cast<WhileLoopStmnt*>(ast);
+            return IsPure(stmnt->condition, func) && IsPure(stmnt->bodyStmnt, func);
+        }
+
+        case AST::Types::DoWhileLoopStmnt:
+        {
+            auto stmnt = static_cast<DoWhileLoopStmnt*>(ast);
+            return IsPure(stmnt->bodyStmnt, func) && IsPure(stmnt->condition, func);
+        }
+
+        case AST::Types::IfStmnt:
+        {
+            auto stmnt = static_cast<IfStmnt*>(ast);
+            return
+            (
+                IsPure(stmnt->condition, func) &&
+                IsPure(stmnt->bodyStmnt, func) &&
+                (!stmnt->elseStmnt || IsPure(stmnt->elseStmnt->bodyStmnt, func))
+            );
+        }
+
+        case AST::Types::SwitchStmnt:
+        {
+            auto stmnt = static_cast<SwitchStmnt*>(ast);
+            if (!IsPure(stmnt->selector, func))
+                return false;
+
+            for (auto& switchCase : stmnt->cases)
+            {
+                if (!IsPure(switchCase->expr, func))
+                    return false;
+
+                for (auto& caseStmnt : switchCase->stmnts)
+                {
+                    if (!IsPure(caseStmnt, func))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        case AST::Types::VarDeclStmnt:
+        {
+            for (auto& varDecl : static_cast<VarDeclStmnt*>(ast)->varDecls)
+            {
+                for (auto& dim : varDecl->arrayDims)
+                {
+                    if (!IsPure(dim, func))
+                        return false;
+                }
+                if (!IsPure(varDecl->initializer, func))
+                    return false;
+            }
+            return true;
+        }
+
+        case AST::Types::AssignStmnt:
+        {
+            auto stmnt = static_cast<AssignStmnt*>(ast);
+            return IsLocalVar(stmnt->varIdent, func) && IsPure(stmnt->varIdent, func) && IsPure(stmnt->expr, func);
+        }
+
+        case AST::Types::ExprStmnt:
+            return IsPure(static_cast<ExprStmnt*>(ast)->expr, func);
+
+        case AST::Types::FunctionCallStmnt:
+            return IsPure(static_cast<FunctionCallStmnt*>(ast)->call, func);
+
+        case AST::Types::ReturnStmnt:
+            return IsPure(static_cast<ReturnStmnt*>(ast)->expr, func);
+
+        case AST::Types::CtrlTransferStmnt:
+            return (static_cast<CtrlTransferStmnt*>(ast)->instruction != "discard");
+
+        default:
+            return false;
+    }
+}
+
+bool DeadCodeEliminator::IsPure(Expr* ast, const FunctionDecl* func) const
+{
+    if (!ast)
+        return true;
+
+    /* Increments and decrements are only allowed for local variables */
+    auto IsPureModification = [&](Expr* expr) -> bool
+    {
+        if (expr && expr->Type() == AST::Types::VarAccessExpr)
+        {
+            auto varIdent = static_cast<VarAccessExpr*>(expr)->varIdent;
+            return IsLocalVar(varIdent, func) && IsPure(expr, func);
+        }
+        return false;
+    };
+
+    switch (ast->Type())
+    {
+        case AST::Types::LiteralExpr:
+        case AST::Types::TypeNameExpr:
+            return true;
+
+        case AST::Types::ListExpr:
+        {
+            auto expr = static_cast<ListExpr*>(ast);
+            return IsPure(expr->firstExpr, func) && IsPure(expr->nextExpr, func);
+        }
+
+        case AST::Types::TernaryExpr:
+        {
+            auto expr = static_cast<TernaryExpr*>(ast);
+            return IsPure(expr->condition, func) && IsPure(expr->ifExpr, func) && IsPure(expr->elseExpr, func);
+        }
+
+        case AST::Types::BinaryExpr:
+        {
+            /* Search the binary expression chain iteratively */
+            while (ast && ast->Type() == AST::Types::BinaryExpr)
+            {
+                auto expr = static_cast<BinaryExpr*>(ast);
+                if (!IsPure(expr->lhsExpr, func))
+                    return false;
+                ast = expr->rhsExpr;
+            }
+            return IsPure(ast, func);
+        }
+
+        case AST::Types::UnaryExpr:
+        {
+            auto expr = static_cast<UnaryExpr*>(ast);
+            if (expr->op == "++" || expr->op == "--")
+                return IsPureModification(expr->expr);
+            return IsPure(expr->expr, func);
+        }
+
+        case AST::Types::PostUnaryExpr:
+        {
+            auto expr = static_cast<PostUnaryExpr*>(ast);
+            if (expr->op == "++" || expr->op == "--")
+                return IsPureModification(expr->expr);
+            return IsPure(expr->expr, func);
+        }
+
+        case AST::Types::FunctionCallExpr:
+            return IsPure(static_cast<FunctionCallExpr*>(ast)->call, func);
+
+        case AST::Types::BracketExpr:
+            return IsPure(static_cast<BracketExpr*>(ast)->expr, func);
+
+        case AST::Types::CastExpr:
+            return IsPure(static_cast<CastExpr*>(ast)->expr, func);
+
+        case AST::Types::VarAccessExpr:
+        {
+            auto expr = static_cast<VarAccessExpr*>(ast);
+            if (!expr->assignOp.empty() && !IsLocalVar(expr->varIdent, func))
+                return false;
+            return IsPure(expr->varIdent, func) && IsPure(expr->assignExpr, func);
+        }
+
+        case AST::Types::InitializerExpr:
+        {
+            for (auto& expr : static_cast<InitializerExpr*>(ast)->exprs)
+            {
+                if (!IsPure(expr, func))
+                    return false;
+            }
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+bool DeadCodeEliminator::IsPure(VarIdent* ast, const FunctionDecl* func) const
+{
+    for (; ast; ast = ast->next)
+    {
+        for (auto& index : ast->arrayIndices)
+        {
+            if (!IsPure(index, func))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool DeadCodeEliminator::IsPure(FunctionCall* ast, const FunctionDecl* func) const
+{
+    const auto& name = ast->name->ident;
+
+    if (ast->name->next)
+    {
+        /* Only texture functions (except "GetDimensions" with its output parameters) are pure */
+        if (!ast->flags(FunctionCall::isTexFunc) || LastVarIdent(ast->name)->ident == "GetDimensions")
+            return false;
+    }
+    else if (functionNames_.find(name) != functionNames_.end())
+    {
+        if (pureFunctionNames_.find(name) == pureFunctionNames_.end())
+            return false;
+    }
+    else if (ast->flags(FunctionCall::isAtomicFunc) || IsIntrinsicWithSideEffects(name) || name == "modf" || name == "frexp")
+    {
+        /* Intrinsics with output parameters are not pure either */
+        return false;
+    }
+
+    for (auto& arg : ast->arguments)
+    {
+        if (!IsPure(arg, func))
+            return false;
+    }
+
+    return true;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,184 @@
+/*
+ * DeadCodeEliminator.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_DEAD_CODE_ELIMINATOR_H__
+#define __HT_DEAD_CODE_ELIMINATOR_H__
+
+
+#include "Visitor.h"
+#include "Ident.h"
+
+#include <vector>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace HTLib
+{
+
+
+/**
+Shader inputs and outputs of a single stage of a pipeline translation (see "Translator::TranslatePipeline").
+\remarks All semantics are stored in upper case and with their index, e.g. "TEXCOORD0" for the semantic "TexCoord".
+*/
+struct StageVaryings
+{
+    //! Semantics which are read by the next stage, or null to keep all outputs. All other outputs (except system values) are removed.
+    const std::set<std::string>*    nextStageInputs = nullptr;
+
+    //! True if the inputs, which are not read by this stage, are removed. This must be false for vertex attributes.
+    bool                            pruneInputs     = false;
+
+    //! [out] Semantics of all inputs, which are read by this stage.
+    std::set<std::string>           inputs;
+};
+
+/**
+Dead code eliminator.
+This helper class for the context analyzer marks all statements which can never be executed
+(statements after 'return', 'discard', 'break' and 'continue', and branches with a constant literal condition)
+and all local variables which are never used. These nodes will be removed from the code generation.
+Assignments to removed local variables are removed, too, if they have no side effects.
+For a pipeline translation, the unused shader outputs of the entry point are removed with all their assignments.
+\remarks The AST itself is not modified, only its decorations (see "Stmnt::isDeadCode",
+"IfStmnt::isConstTrue", "IfStmnt::isConstFalse" and "VarDecl::disableCodeGen").
+Thus this pass must be applied after the AST has been decorated with its symbol references.
+*/
+class DeadCodeEliminator : private Visitor
+{
+    
+    public:
+        
+        void MarkDeadCode(Program* program, StageVaryings* varyings = nullptr);
+
+        /**
+        Marks the dead code of the specified function only (see "Options::streamOutput").
+        \remarks The names of all user defined functions must have been collected first (see "CollectFunctionNames").
+        */
+        void MarkDeadCode(FunctionDecl* ast);
+
+        /**
+        Collects the names of all user defined functions of the specified program (calls to these functions may have side effects).
+        \remarks Functions without output parameters, whose bodies only write to local variables, are free of side effects,
+        so unused results of their calls are removed, too. This is determined when the dead code of these functions is marked,
+        i.e. calls to functions, whose bodies have not been visited before, are treated as having side effects.
+        */
+        void CollectFunctionNames(Program* program);
+
+    private:
+        
+        /* === Visitor implementation === */
+
+        DECL_VISIT_PROC( Program           );
+        DECL_VISIT_PROC( CodeBlock         );
+        DECL_VISIT_PROC( FunctionCall      );
+        DECL_VISIT_PROC( SwitchCase        );
+
+        DECL_VISIT_PROC( FunctionDecl      );
+
+        DECL_VISIT_PROC( CodeBlockStmnt    );
+        DECL_VISIT_PROC( ForLoopStmnt      );
+        DECL_VISIT_PROC( WhileLoopStmnt    );
+        DECL_VISIT_PROC( DoWhileLoopStmnt  );
+        DECL_VISIT_PROC( IfStmnt           );
+        DECL_VISIT_PROC( ElseStmnt         );
+        DECL_VISIT_PROC( SwitchStmnt       );
+        DECL_VISIT_PROC( VarDeclStmnt      );
+        DECL_VISIT_PROC( AssignStmnt       );
+        DECL_VISIT_PROC( ExprStmnt         );
+        DECL_VISIT_PROC( FunctionCallStmnt );
+        DECL_VISIT_PROC( ReturnStmnt       );
+        DECL_VISIT_PROC( CtrlTransferStmnt );
+
+        DECL_VISIT_PROC( ListExpr          );
+        DECL_VISIT_PROC( TernaryExpr       );
+        DECL_VISIT_PROC( BinaryExpr        );
+        DECL_VISIT_PROC( UnaryExpr         );
+        DECL_VISIT_PROC( PostUnaryExpr     );
+        DECL_VISIT_PROC( FunctionCallExpr  );
+        DECL_VISIT_PROC( BracketExpr       );
+        DECL_VISIT_PROC( CastExpr          );
+        DECL_VISIT_PROC( VarAccessExpr     );
+        DECL_VISIT_PROC( InitializerExpr   );
+
+        DECL_VISIT_PROC( VarIdent          );
+        DECL_VISIT_PROC( VarDecl           );
+
+        /* --- Helper functions for dead code elimination --- */
+
+        //! Visits the specified statement and returns true if this statement never falls through.
+        bool VisitStmnt(Stmnt* ast, void* args = nullptr);
+
+        //! Visits the specified statement list and marks all statements after an unconditional control transfer.
+        void VisitStmntList(const std::vector<StmntPtr>& stmnts);
+
+        //! Counts (or rather uncounts) the reference to the local variable of the specified identifier.
+        void CountReference(VarIdent* varIdent);
+
+        //! Disables all unused local variables (without side effects in their initializer) until no more variable becomes unused.
+        void DisableUnusedVariables();
+
+        //! Marks the shader input or output of the entry point, which is referenced by the specified identifier, as used.
+        void MarkVaryingReference(VarIdent* varIdent);
+
+        //! Disables all shader inputs and outputs of the entry point, which are not used by this or the next stage.
+        void DisableUnusedVaryings(FunctionDecl* ast);
+
+        //! Returns true if the specified symbol is a local variable, which is returned by the entry point as shader output.
+        bool IsShaderOutputVar(const AST* symbol) const;
+
+        bool HasSideEffects(Expr* ast) const;
+        bool HasSideEffects(VarIdent* ast) const;
+        bool HasSideEffects(FunctionCall* ast) const;
+
+        //! Returns true if the specified function has a parsed body without side effects and no output parameters.
+        bool IsPureFunction(FunctionDecl* ast) const;
+
+        //! Returns true if the specified identifier refers to a (non-static) local variable or an input parameter of the specified function.
+        bool IsLocalVar(VarIdent* ast, const FunctionDecl* func) const;
+
+        bool IsPure(Stmnt* ast, const FunctionDecl* func) const;
+        bool IsPure(Expr* ast, const FunctionDecl* func) const;
+        bool IsPure(VarIdent* ast, const FunctionDecl* func) const;
+        bool IsPure(FunctionCall* ast, const FunctionDecl* func) const;
+
+        /* === Members === */
+
+        typedef std::unordered_map<const AST*, std::vector<AssignStmnt*>> AssignmentMap;
+
+        std::unordered_set<Ident>           functionNames_;                 //!< Names of all user defined functions.
+        std::unordered_set<Ident>           pureFunctionNames_;             //!< Names of the visited user defined functions, whose calls have no side effects (all overloads).
+        std::unordered_set<Ident>           impureFunctionNames_;           //!< Names of the visited user defined functions with side effects (in any overload).
+        std::vector<VarDecl*>               localVars_;                     //!< Local variables of the current function which may be removed.
+        std::unordered_map<const AST*, int> useCount_;                      //!< Number of references to each local variable (from live code only).
+        AssignmentMap                       localAssignments_;              //!< Removable assignments to each local variable.
+        AssignmentMap                       outputAssignments_;             //!< Removable assignments to each shader output member (not counted yet).
+
+        StageVaryings*                      varyings_               = nullptr;  //!< Shader interface of a pipeline translation; may be null.
+        const Structure*                    outputStruct_           = nullptr;  //!< Output structure of the entry point, whose unused members can be removed.
+        std::unordered_map<const AST*, const Structure*> inputParams_;          //!< Input parameters of the entry point and their structure types (may be null).
+        std::set<const AST*>                usedVaryings_;                      //!< Inputs (members or entire parameters) and output members, which are used by the entry point.
+        bool                                isOutputUsedEntirely_   = false;    //!< True if the output variable is used as a whole (not only its members).
+
+        int                                 refDelta_               = 1;    //!< Reference count delta (+1 to count references, -1 to uncount references).
+        bool                                stmntTerminates_        = false; //!< True if the previously visited statement never falls through.
+        bool                                hasUnresolvedIdents_    = false; //!< True if the current function contains unresolved identifiers.
+        bool                                isEntryPoint_           = false; //!< True if the current function is the entry point of a pipeline translation.
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
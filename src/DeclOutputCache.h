@@ -0,0 +1,52 @@
+/*
+ * DeclOutputCache.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_DECL_OUTPUT_CACHE_H__
+#define __HT_DECL_OUTPUT_CACHE_H__
+
+
+#include "Visitor.h"
+
+#include <string>
+
+
+namespace HTLib
+{
+
+
+/**
+Output cache interface for the incremental translation (see "IncrementalTranslator").
+The code generator asks this cache for the output of each global declaration right before it would be generated,
+and passes the output of each declaration, which has been generated instead, to the cache.
+\see GLSLGenerator::SetOutputCache
+*/
+class DeclOutputCache
+{
+
+    public:
+
+        virtual ~DeclOutputCache()
+        {
+        }
+
+        //! Returns the output of the specified global declaration, which can be re-used, or null if it must be generated.
+        virtual const std::string* CachedOutput(const GlobalDecl* ast) = 0;
+
+        //! Stores the output of the specified global declaration, which has just been generated.
+        virtual void StoreOutput(const GlobalDecl* ast, std::string&& output) = 0;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
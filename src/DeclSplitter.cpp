@@ -0,0 +1,244 @@
+/*
+ * DeclSplitter.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "DeclSplitter.h"
+
+#include <cctype>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal classes
+ */
+
+//! Character reader for the declaration splitter, which keeps track of the source position.
+class DeclReader
+{
+    
+    public:
+        
+        DeclReader(const char* source, std::size_t size) :
+            source_ { source },
+            size_   { size   }
+        {
+        }
+
+        inline bool End() const
+        {
+            return (pos_ >= size_);
+        }
+
+        inline char Chr(std::size_t offset = 0) const
+        {
+            return (pos_ + offset < size_ ? source_[pos_ + offset] : '\0');
+        }
+
+        void Next()
+        {
+            if (source_[pos_] == '\n')
+            {
+                ++row_;
+                column_ = 1;
+                lineBegin_ = pos_ + 1;
+                lineStart_ = true;
+            }
+            else
+            {
+                ++column_;
+                if (!std::isspace(static_cast<unsigned char>(source_[pos_])))
+                    lineStart_ = false;
+            }
+            ++pos_;
+        }
+
+        //! Skips the comment at the current position and returns true, or returns false if there is no comment.
+        bool SkipComment()
+        {
+            if (Chr() == '/' && Chr(1) == '/')
+            {
+                while (!End() && Chr() != '\n')
+                    Next();
+                return true;
+            }
+            if (Chr() == '/' && Chr(1) == '*')
+            {
+                Next();
+                Next();
+                while (!End() && !(Chr() == '*' && Chr(1) == '/'))
+                    Next();
+                if (!End())
+                {
+                    Next();
+                    Next();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void SkipWhiteSpacesAndComments()
+        {
+            while (!End())
+            {
+                if (std::isspace(static_cast<unsigned char>(Chr())))
+                    Next();
+                else if (!SkipComment())
+                    break;
+            }
+        }
+
+        //! Skips the line (including line continuations) until the new-line character.
+        void SkipLine()
+        {
+            while (!End() && Chr() != '\n')
+            {
+                if (Chr() == '\\' && Chr(1) == '\n')
+                    Next();
+                Next();
+            }
+        }
+
+        void SkipStringLiteral()
+        {
+            Next();
+            while (!End() && Chr() != '"' && Chr() != '\n')
+            {
+                if (Chr() == '\\')
+                    Next();
+                if (!End())
+                    Next();
+            }
+            if (Chr() == '"')
+                Next();
+        }
+
+        //! Returns true if the current character is the first non-white-space character in its line.
+        inline bool IsLineStart() const
+        {
+            return lineStart_;
+        }
+
+        DeclSpan Span() const
+        {
+            DeclSpan span;
+            {
+                span.begin      = pos_;
+                span.end        = pos_;
+                span.lineBegin  = lineBegin_;
+                span.row        = row_;
+                span.column     = column_;
+            }
+            return span;
+        }
+
+        //! Resets the reader to the beginning of the specified span.
+        void Reset(const DeclSpan& span)
+        {
+            pos_        = span.begin;
+            lineBegin_  = span.lineBegin;
+            row_        = span.row;
+            column_     = span.column;
+            lineStart_  = false;
+        }
+
+        inline std::size_t Pos() const
+        {
+            return pos_;
+        }
+
+    private:
+        
+        const char*     source_     = nullptr;
+        std::size_t     size_       = 0;
+        std::size_t     pos_        = 0;
+        std::size_t     lineBegin_  = 0;
+        unsigned int    row_        = 1;
+        unsigned int    column_     = 1;
+        bool            lineStart_  = true;
+
+};
+
+
+/*
+ * Global functions
+ */
+
+void SplitGlobalDecls(const char* source, std::size_t size, std::vector<DeclSpan>& spans)
+{
+    DeclReader reader(source, size);
+
+    while (true)
+    {
+        reader.SkipWhiteSpacesAndComments();
+        if (reader.End())
+            break;
+
+        auto span = reader.Span();
+
+        if (reader.Chr() == '#')
+            reader.SkipLine();
+        else
+        {
+            int depth = 0;
+
+            while (!reader.End())
+            {
+                auto chr = reader.Chr();
+
+                if (reader.SkipComment())
+                    continue;
+                if (chr == '"')
+                {
+                    reader.SkipStringLiteral();
+                    continue;
+                }
+                if (chr == '#' && reader.IsLineStart())
+                {
+                    /* Skip directive inside a declaration (e.g. "#if" inside a function body) */
+                    reader.SkipLine();
+                    continue;
+                }
+
+                reader.Next();
+
+                if (chr == '(' || chr == '[' || chr == '{')
+                    ++depth;
+                else if (chr == ')' || chr == ']' || chr == '}')
+                {
+                    if (depth > 0)
+                        --depth;
+                    if (chr == '}' && depth == 0)
+                    {
+                        /* Include optional semicolon after the closing curly bracket */
+                        auto bodyEnd = reader.Span();
+                        reader.SkipWhiteSpacesAndComments();
+                        if (reader.Chr() == ';')
+                            reader.Next();
+                        else
+                            reader.Reset(bodyEnd);
+                        break;
+                    }
+                }
+                else if (chr == ';' && depth == 0)
+                    break;
+            }
+        }
+
+        span.end = reader.Pos();
+        spans.push_back(span);
+    }
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
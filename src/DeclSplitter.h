@@ -0,0 +1,46 @@
+/*
+ * DeclSplitter.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_DECL_SPLITTER_H__
+#define __HT_DECL_SPLITTER_H__
+
+
+#include <vector>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+//! Source span of a top-level declaration.
+struct DeclSpan
+{
+    std::size_t     begin       = 0;
+    std::size_t     end         = 0;
+    std::size_t     lineBegin   = 0;
+    unsigned int    row         = 1;
+    unsigned int    column      = 1;
+};
+
+/**
+Splits the specified source into its top-level declarations. A declaration ends with a semicolon outside of any brackets,
+or with the closing curly bracket of a body (including an optional semicolon after it, e.g. "struct S { ... };").
+Pre-processor directives at the top level are declarations of their own.
+Comments between two declarations are not part of any declaration.
+*/
+void SplitGlobalDecls(const char* source, std::size_t size, std::vector<DeclSpan>& spans);
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,117 @@
+/*
+ * Diagnostic.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "HT/Diagnostic.h"
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Returns the prefix of the formatted message of the specified diagnostic, e.g. "context error".
+static const char* DiagnosticPrefix(const Diagnostic& diagnostic)
+{
+    if (diagnostic.severity == DiagnosticSeverities::Warning)
+        return "warning";
+
+    switch (diagnostic.code)
+    {
+        case DiagnosticCodes::Message:
+            return nullptr;
+
+        case DiagnosticCodes::ContextError:
+        case DiagnosticCodes::UndeclaredIdent:
+        case DiagnosticCodes::EmptyStmntBody:
+        case DiagnosticCodes::EntryPointNotFound:
+        case DiagnosticCodes::InvalidNumArgsMul:
+        case DiagnosticCodes::InvalidNumArgsInterlocked:
+        case DiagnosticCodes::MissingVarType:
+            return "context error";
+
+        default:
+            return "code generation error";
+    }
+}
+
+
+/*
+ * Global functions
+ */
+
+const char* DiagnosticTemplate(const DiagnosticCodes code)
+{
+    switch (code)
+    {
+        case DiagnosticCodes::Message:                          return "%0";
+        case DiagnosticCodes::ContextError:                     return "%0";
+        case DiagnosticCodes::UndeclaredIdent:                  return "undeclared identifier \"%0\"";
+        case DiagnosticCodes::EmptyStmntBody:                   return "<%0> statement with empty body";
+        case DiagnosticCodes::EntryPointNotFound:               return "entry point \"%0\" not found";
+        case DiagnosticCodes::InvalidNumArgsMul:                return "\"mul\" intrinsic must have exactly 2 arguments";
+        case DiagnosticCodes::InvalidNumArgsInterlocked:        return "interlocked intrinsics must have at least 2 arguments";
+        case DiagnosticCodes::MissingVarType:                   return "missing variable type";
+        case DiagnosticCodes::InvalidRegisterPrefix:            return "invalid register prefix '%0' (expected '%1')";
+        case DiagnosticCodes::InvalidNumArgs:                   return "invalid number of arguments for %0";
+        case DiagnosticCodes::UnsupportedTexFunc:               return "texture member function \"%0\" is not supported";
+        case DiagnosticCodes::UnknownInterlockedIntrinsic:      return "unknown interlocked intrinsic \"%0\"";
+        case DiagnosticCodes::UnsupportedTextureType:           return "texture type \"%0\" not supported yet";
+        case DiagnosticCodes::InvalidEntryPointParamVars:       return "invalid number of variables inside parameter of entry point";
+        case DiagnosticCodes::InvalidEntryPointParamSemantics:  return "invalid number of semantics inside parameter fo entry point";
+        case DiagnosticCodes::InvalidPixelShaderOutputSemantic: return "invalid output semantic for pixel shader: \"%0\"";
+        case DiagnosticCodes::UnknownOutputSemantic:            return "unknown shader output semantic: \"%0\"";
+        case DiagnosticCodes::InvalidParamVars:                 return "invalid number of variables in function parameter";
+        case DiagnosticCodes::UnsupportedESSLType:              return "type \"%0\" is not supported in GLSL ES";
+    }
+    return "";
+}
+
+std::string FormatDiagnostic(const Diagnostic& diagnostic)
+{
+    std::string s;
+
+    /* Write prefix and source position */
+    if (auto prefix = DiagnosticPrefix(diagnostic))
+    {
+        s += prefix;
+        if (diagnostic.hasPos)
+        {
+            s += " (";
+            s += std::to_string(diagnostic.row);
+            s += ':';
+            s += std::to_string(diagnostic.column);
+            s += ')';
+        }
+        s += " : ";
+    }
+
+    /* Write message template and replace "%0" and "%1" by the arguments */
+    for (auto chr = DiagnosticTemplate(diagnostic.code); *chr != '\0'; ++chr)
+    {
+        if (chr[0] == '%' && chr[1] >= '0' && chr[1] < '0' + static_cast<int>(Diagnostic::maxArgs))
+        {
+            auto index = static_cast<std::size_t>(chr[1] - '0');
+            if (index < diagnostic.numArgs && diagnostic.args[index])
+                s += *diagnostic.args[index];
+            ++chr;
+        }
+        else
+            s += *chr;
+    }
+
+    return s;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,125 @@
+/*
+ * DiagnosticBuffer.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "HT/DiagnosticBuffer.h"
+
+
+namespace HTLib
+{
+
+
+void DiagnosticBuffer::Info(const std::string& message)
+{
+    RecordMessage(DiagnosticSeverities::Info, message);
+}
+
+void DiagnosticBuffer::Warning(const std::string& message)
+{
+    RecordMessage(DiagnosticSeverities::Warning, message);
+}
+
+void DiagnosticBuffer::Error(const std::string& message)
+{
+    RecordMessage(DiagnosticSeverities::Error, message);
+}
+
+void DiagnosticBuffer::Report(const Diagnostic& diagnostic)
+{
+    Record record;
+    {
+        record.code     = diagnostic.code;
+        record.severity = diagnostic.severity;
+        record.hasPos   = diagnostic.hasPos;
+        record.row      = diagnostic.row;
+        record.column   = diagnostic.column;
+        record.numArgs  = 0;
+    }
+    for (std::size_t i = 0; i < diagnostic.numArgs && i < Diagnostic::maxArgs; ++i)
+        record.args[record.numArgs++] = Intern(diagnostic.args[i] != nullptr ? *diagnostic.args[i] : std::string());
+    records_.push_back(record);
+}
+
+Diagnostic DiagnosticBuffer::GetDiagnostic(const Record& record) const
+{
+    Diagnostic diagnostic;
+    {
+        diagnostic.code     = record.code;
+        diagnostic.severity = record.severity;
+        diagnostic.hasPos   = record.hasPos;
+        diagnostic.row      = record.row;
+        diagnostic.column   = record.column;
+        diagnostic.numArgs  = record.numArgs;
+    }
+    for (std::size_t i = 0; i < record.numArgs; ++i)
+        diagnostic.args[i] = &(arguments_[record.args[i]]);
+    return diagnostic;
+}
+
+std::string DiagnosticBuffer::Message(const Record& record) const
+{
+    return FormatDiagnostic(GetDiagnostic(record));
+}
+
+void DiagnosticBuffer::WriteTo(Logger& log) const
+{
+    for (const auto& record : records_)
+        log.Report(GetDiagnostic(record));
+}
+
+void DiagnosticBuffer::Clear()
+{
+    records_.clear();
+    arguments_.clear();
+    argumentIDs_.clear();
+}
+
+std::size_t DiagnosticBuffer::Count(const DiagnosticSeverities severity) const
+{
+    std::size_t n = 0;
+    for (const auto& record : records_)
+    {
+        if (record.severity == severity)
+            ++n;
+    }
+    return n;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void DiagnosticBuffer::RecordMessage(const DiagnosticSeverities severity, const std::string& message)
+{
+    Diagnostic diagnostic;
+    {
+        diagnostic.code     = DiagnosticCodes::Message;
+        diagnostic.severity = severity;
+        diagnostic.numArgs  = 1;
+        diagnostic.args[0]  = &message;
+    }
+    Report(diagnostic);
+}
+
+std::size_t DiagnosticBuffer::Intern(const std::string& argument)
+{
+    auto it = argumentIDs_.find(argument);
+    if (it != argumentIDs_.end())
+        return it->second;
+
+    auto id = arguments_.size();
+    arguments_.push_back(argument);
+    argumentIDs_[argument] = id;
+    return id;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,112 @@
+/*
+ * DiagnosticError.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "DiagnosticError.h"
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Returns the number of arguments, which are used by the message template of the specified code.
+static std::size_t NumTemplateArgs(const DiagnosticCodes code)
+{
+    std::size_t n = 0;
+    for (auto chr = DiagnosticTemplate(code); *chr != '\0'; ++chr)
+    {
+        if (chr[0] == '%' && chr[1] >= '0' && chr[1] < '0' + static_cast<int>(Diagnostic::maxArgs))
+        {
+            auto index = static_cast<std::size_t>(chr[1] - '0');
+            if (n < index + 1)
+                n = index + 1;
+            ++chr;
+        }
+    }
+    return n;
+}
+
+static void SetDiagnosticPos(Diagnostic& diagnostic, const SourcePosition& pos)
+{
+    diagnostic.hasPos   = true;
+    diagnostic.row      = pos.Row();
+    diagnostic.column   = (pos.Column() > 0 ? pos.Column() - 1 : 0);
+}
+
+
+/*
+ * Global functions
+ */
+
+Diagnostic MakeDiagnostic(
+    const DiagnosticCodes       code,
+    const DiagnosticSeverities  severity,
+    const SourcePosition*       pos,
+    const std::string*          arg0,
+    const std::string*          arg1)
+{
+    Diagnostic diagnostic;
+    {
+        diagnostic.code     = code;
+        diagnostic.severity = severity;
+        diagnostic.numArgs  = NumTemplateArgs(code);
+        diagnostic.args[0]  = arg0;
+        diagnostic.args[1]  = arg1;
+    }
+    if (pos)
+        SetDiagnosticPos(diagnostic, *pos);
+    return diagnostic;
+}
+
+
+/*
+ * DiagnosticError class
+ */
+
+DiagnosticError::DiagnosticError(
+    const DiagnosticCodes   code,
+    const SourcePosition*   pos,
+    const std::string&      arg0,
+    const std::string&      arg1) :
+        code_   { code },
+        hasPos_ { pos != nullptr },
+        args_   { arg0, arg1 }
+{
+    if (pos)
+        pos_ = *pos;
+}
+
+const char* DiagnosticError::what() const throw()
+{
+    try
+    {
+        if (message_.empty())
+            message_ = FormatDiagnostic(GetDiagnostic());
+        return message_.c_str();
+    }
+    catch (const std::exception&)
+    {
+        return "code generation error";
+    }
+}
+
+Diagnostic DiagnosticError::GetDiagnostic() const
+{
+    return MakeDiagnostic(
+        code_, DiagnosticSeverities::Error, (hasPos_ ? &pos_ : nullptr), &args_[0], &args_[1]
+    );
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
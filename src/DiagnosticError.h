@@ -0,0 +1,74 @@
+/*
+ * DiagnosticError.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_DIAGNOSTIC_ERROR_H__
+#define __HT_DIAGNOSTIC_ERROR_H__
+
+
+#include "HT/Diagnostic.h"
+#include "SourcePosition.h"
+
+#include <exception>
+#include <string>
+
+
+namespace HTLib
+{
+
+
+/**
+Returns a diagnostic with the specified source position (may be null) and arguments (may be null).
+\remarks The diagnostic only refers to the argument strings, so they must be alive while it is reported.
+*/
+Diagnostic MakeDiagnostic(
+    const DiagnosticCodes       code,
+    const DiagnosticSeverities  severity,
+    const SourcePosition*       pos,
+    const std::string*          arg0 = nullptr,
+    const std::string*          arg1 = nullptr
+);
+
+/**
+Exception which carries a diagnostic, so that it can be reported by the handler without being formatted.
+\remarks The message of "what" is only formatted when it is requested.
+*/
+class DiagnosticError : public std::exception
+{
+
+    public:
+
+        DiagnosticError(
+            const DiagnosticCodes   code,
+            const SourcePosition*   pos,
+            const std::string&      arg0 = "",
+            const std::string&      arg1 = ""
+        );
+
+        const char* what() const throw() override;
+
+        //! Returns the diagnostic, which refers to the argument strings of this exception.
+        Diagnostic GetDiagnostic() const;
+
+    private:
+
+        DiagnosticCodes     code_;
+        bool                hasPos_     = false;
+        SourcePosition      pos_;
+        std::string         args_[Diagnostic::maxArgs];
+        mutable std::string message_;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
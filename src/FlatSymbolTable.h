@@ -0,0 +1,209 @@
+/*
+ * FlatSymbolTable.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_FLAT_SYMBOL_TABLE_H__
+#define __HT_FLAT_SYMBOL_TABLE_H__
+
+
+#include "Ident.h"
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+
+
+namespace HTLib
+{
+
+
+/**
+Symbol table with the same interface as "SymbolTable", but with a flat memory layout.
+\remarks Each identifier has a single entry in an open addressing hash table, which holds the symbol of the deepest scope.
+Registering a symbol appends the previous entry to a single undo log, and closing a scope just
+restores and truncates this log. The table is keyed by the identifier handles (see Ident),
+so neither registering nor fetching a symbol hashes or compares any characters.
+*/
+template <typename SymbolType> class FlatSymbolTable
+{
+    
+    public:
+        
+        //! Override symbol callback procedure. Must return true to allow a symbol override.
+        typedef std::function<bool (SymbolType* symbol)> OnOverrideProc;
+
+        FlatSymbolTable() :
+            slots_( 64, 0 )
+        {
+            OpenScope();
+        }
+
+        //! Opens a new scope.
+        void OpenScope()
+        {
+            scopeMarks_.push_back(undoLog_.size());
+        }
+
+        //! Closes the active scope.
+        void CloseScope()
+        {
+            if (!scopeMarks_.empty())
+            {
+                /* Restore all entries which have been changed in the current scope (in reverse order) */
+                const auto mark = scopeMarks_.back();
+
+                for (auto i = undoLog_.size(); i > mark; --i)
+                {
+                    const auto& undo = undoLog_[i - 1];
+                    entries_[undo.entry].symbol = undo.prevSymbol;
+                }
+
+                undoLog_.resize(mark);
+                scopeMarks_.pop_back();
+            }
+        }
+
+        /**
+        Registers the specified symbol in the current scope.
+        At least one scope must be open before symbols can be registered!
+        */
+        void Register(const Ident& ident, SymbolType* symbol, const OnOverrideProc& overrideProc = nullptr)
+        {
+            /* Validate input parameters */
+            if (scopeMarks_.empty())
+                throw std::runtime_error("no active scope to register symbol");
+            if (ident.empty())
+                throw std::runtime_error("can not register unnamed symbol");
+
+            /* Check if identifier was already registered in the current scope */
+            auto entryIndex = FindOrInsertEntry(ident);
+            auto& entry = entries_[entryIndex];
+
+            if (entry.symbol.symbol && entry.symbol.scopeLevel == ScopeLevel())
+            {
+                if (overrideProc && overrideProc(entry.symbol.symbol))
+                {
+                    /* Override symbol in this scope */
+                    entry.symbol.symbol = symbol;
+                    return;
+                }
+                else
+                    throw std::runtime_error("identifier \"" + ident + "\" already declared in the current scope");
+            }
+
+            /* Register new symbol and store previous one in the undo log */
+            undoLog_.push_back({ entryIndex, entry.symbol });
+            entry.symbol = { symbol, ScopeLevel() };
+        }
+
+        /**
+        Returns the symbol with the specified identifer which is in
+        the deepest scope, or null if there is no such symbol.
+        */
+        SymbolType* Fetch(const Ident& ident) const
+        {
+            const auto hash = Hash(ident);
+            const auto mask = slots_.size() - 1;
+
+            for (auto i = hash & mask; slots_[i] != 0; i = (i + 1) & mask)
+            {
+                const auto& entry = entries_[slots_[i] - 1];
+                if (entry.ident == ident)
+                    return entry.symbol.symbol;
+            }
+
+            return nullptr;
+        }
+
+        //! Returns current scope level.
+        size_t ScopeLevel() const
+        {
+            return scopeMarks_.size();
+        }
+
+    private:
+        
+        struct Symbol
+        {
+            SymbolType* symbol;
+            size_t      scopeLevel;
+        };
+
+        struct Entry
+        {
+            Ident   ident;
+            Symbol  symbol;
+        };
+
+        struct Undo
+        {
+            size_t entry;       //!< Index to "entries_".
+            Symbol prevSymbol;  //!< Symbol before it was registered in the current scope.
+        };
+
+        static std::uint32_t Hash(const Ident& ident)
+        {
+            /* Fibonacci hash of the handle (the lower bits of the address are always zero) */
+            const auto handle = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(ident.Handle()));
+            return static_cast<std::uint32_t>((handle * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        size_t FindOrInsertEntry(const Ident& ident)
+        {
+            const auto hash = Hash(ident);
+            const auto mask = slots_.size() - 1;
+
+            auto i = hash & mask;
+            for (; slots_[i] != 0; i = (i + 1) & mask)
+            {
+                if (entries_[slots_[i] - 1].ident == ident)
+                    return slots_[i] - 1;
+            }
+
+            /* Insert new entry */
+            entries_.push_back({ ident, { nullptr, 0 } });
+            slots_[i] = entries_.size();
+
+            /* Keep load factor below 1/2 */
+            if (entries_.size() * 2 > slots_.size())
+                Grow();
+
+            return entries_.size() - 1;
+        }
+
+        void Grow()
+        {
+            slots_.assign(slots_.size() * 2, 0);
+            const auto mask = slots_.size() - 1;
+
+            for (size_t j = 0; j < entries_.size(); ++j)
+            {
+                auto i = Hash(entries_[j].ident) & mask;
+                while (slots_[i] != 0)
+                    i = (i + 1) & mask;
+                slots_[i] = j + 1;
+            }
+        }
+
+        std::vector<Entry>  entries_;       //!< All identifiers which have ever been registered.
+        std::vector<size_t> slots_;         //!< Hash table with indices to "entries_" plus one, or zero for empty slots.
+        std::vector<Undo>   undoLog_;       //!< Previous symbols of all registrations in the open scopes.
+        std::vector<size_t> scopeMarks_;    //!< Size of the undo log when each open scope was opened.
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,387 @@
+/*
+ * FlatTree.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "FlatTree.h"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+template <typename T> void AppendChild(std::vector<AST*>& children, const T& child)
+{
+    if (child)
+        children.push_back(child);
+}
+
+template <typename T> void AppendChildren(std::vector<AST*>& children, const std::vector<T>& list)
+{
+    for (const auto& child : list)
+        AppendChild(children, child);
+}
+
+//! Appends all child nodes of the specified node (in source order) to the list.
+static void AppendChildNodes(AST* ast, std::vector<AST*>& children)
+{
+    switch (ast->Type())
+    {
+        case AST::Types::Program:
+            AppendChildren(children, static_cast<Program*>(ast)->globalDecls);
+            break;
+        case AST::Types::CodeBlock:
+            AppendChildren(children, static_cast<CodeBlock*>(ast)->stmnts);
+            break;
+        case AST::Types::FunctionCall:
+        {
+            auto node = static_cast<FunctionCall*>(ast);
+            AppendChild(children, node->name);
+            AppendChildren(children, node->arguments);
+        }
+        break;
+        case AST::Types::Structure:
+            AppendChildren(children, static_cast<Structure*>(ast)->members);
+            break;
+
+        /* --- Global declarations --- */
+
+        case AST::Types::FunctionDecl:
+        {
+            auto node = static_cast<FunctionDecl*>(ast);
+            AppendChildren(children, node->attribs);
+            AppendChild(children, node->returnType);
+            AppendChildren(children, node->parameters);
+            AppendChild(children, node->codeBlock);
+        }
+        break;
+        case AST::Types::UniformBufferDecl:
+            AppendChildren(children, static_cast<UniformBufferDecl*>(ast)->members);
+            break;
+        case AST::Types::TextureDecl:
+            AppendChildren(children, static_cast<TextureDecl*>(ast)->names);
+            break;
+        case AST::Types::SamplerDecl:
+            AppendChildren(children, static_cast<SamplerDecl*>(ast)->names);
+            break;
+        case AST::Types::StructDecl:
+            AppendChild(children, static_cast<StructDecl*>(ast)->structure);
+            break;
+
+        /* --- Statements --- */
+
+        case AST::Types::CodeBlockStmnt:
+            AppendChild(children, static_cast<CodeBlockStmnt*>(ast)->codeBlock);
+            break;
+        case AST::Types::ForLoopStmnt:
+        {
+            auto node = static_cast<ForLoopStmnt*>(ast);
+            AppendChildren(children, node->attribs);
+            AppendChild(children, node->initSmnt);
+            AppendChild(children, node->condition);
+            AppendChild(children, node->iteration);
+            AppendChild(children, node->bodyStmnt);
+        }
+        break;
+        case AST::Types::WhileLoopStmnt:
+        {
+            auto node = static_cast<WhileLoopStmnt*>(ast);
+            AppendChildren(children, node->attribs);
+            AppendChild(children, node->condition);
+            AppendChild(children, node->bodyStmnt);
+        }
+        break;
+        case AST::Types::DoWhileLoopStmnt:
+        {
+            auto node = static_cast<DoWhileLoopStmnt*>(ast);
+            AppendChildren(children, node->attribs);
+            AppendChild(children, node->bodyStmnt);
+            AppendChild(children, node->condition);
+        }
+        break;
+        case AST::Types::IfStmnt:
+        {
+            auto node = static_cast<IfStmnt*>(ast);
+            AppendChildren(children, node->attribs);
+            AppendChild(children, node->condition);
+            AppendChild(children, node->bodyStmnt);
+            AppendChild(children, node->elseStmnt);
+        }
+        break;
+        case AST::Types::ElseStmnt:
+            AppendChild(children, static_cast<ElseStmnt*>(ast)->bodyStmnt);
+            break;
+        case AST::Types::SwitchStmnt:
+        {
+            auto node = static_cast<SwitchStmnt*>(ast);
+            AppendChildren(children, node->attribs);
+            AppendChild(children, node->selector);
+            AppendChildren(children, node->cases);
+        }
+        break;
+        case AST::Types::VarDeclStmnt:
+        {
+            auto node = static_cast<VarDeclStmnt*>(ast);
+            AppendChild(children, node->varType);
+            AppendChildren(children, node->varDecls);
+        }
+        break;
+        case AST::Types::AssignStmnt:
+        {
+            auto node = static_cast<AssignStmnt*>(ast);
+            AppendChild(children, node->varIdent);
+            AppendChild(children, node->expr);
+        }
+        break;
+        case AST::Types::ExprStmnt:
+            AppendChild(children, static_cast<ExprStmnt*>(ast)->expr);
+            break;
+        case AST::Types::FunctionCallStmnt:
+            AppendChild(children, static_cast<FunctionCallStmnt*>(ast)->call);
+            break;
+        case AST::Types::ReturnStmnt:
+            AppendChild(children, static_cast<ReturnStmnt*>(ast)->expr);
+            break;
+        case AST::Types::StructDeclStmnt:
+            AppendChild(children, static_cast<StructDeclStmnt*>(ast)->structure);
+            break;
+
+        /* --- Expressions --- */
+
+        case AST::Types::ListExpr:
+        {
+            auto node = static_cast<ListExpr*>(ast);
+            AppendChild(children, node->firstExpr);
+            AppendChild(children, node->nextExpr);
+        }
+        break;
+        case AST::Types::TernaryExpr:
+        {
+            auto node = static_cast<TernaryExpr*>(ast);
+            AppendChild(children, node->condition);
+            AppendChild(children, node->ifExpr);
+            AppendChild(children, node->elseExpr);
+        }
+        break;
+        case AST::Types::BinaryExpr:
+        {
+            auto node = static_cast<BinaryExpr*>(ast);
+            AppendChild(children, node->lhsExpr);
+            AppendChild(children, node->rhsExpr);
+        }
+        break;
+        case AST::Types::UnaryExpr:
+            AppendChild(children, static_cast<UnaryExpr*>(ast)->expr);
+            break;
+        case AST::Types::PostUnaryExpr:
+            AppendChild(children, static_cast<PostUnaryExpr*>(ast)->expr);
+            break;
+        case AST::Types::FunctionCallExpr:
+            AppendChild(children, static_cast<FunctionCallExpr*>(ast)->call);
+            break;
+        case AST::Types::BracketExpr:
+            AppendChild(children, static_cast<BracketExpr*>(ast)->expr);
+            break;
+        case AST::Types::CastExpr:
+        {
+            auto node = static_cast<CastExpr*>(ast);
+            AppendChild(children, node->typeExpr);
+            AppendChild(children, node->expr);
+        }
+        break;
+        case AST::Types::VarAccessExpr:
+        {
+            auto node = static_cast<VarAccessExpr*>(ast);
+            AppendChild(children, node->varIdent);
+            AppendChild(children, node->assignExpr);
+        }
+        break;
+        case AST::Types::InitializerExpr:
+            AppendChildren(children, static_cast<InitializerExpr*>(ast)->exprs);
+            break;
+
+        /* --- Others --- */
+
+        case AST::Types::SwitchCase:
+        {
+            auto node = static_cast<SwitchCase*>(ast);
+            AppendChild(children, node->expr);
+            AppendChildren(children, node->stmnts);
+        }
+        break;
+        case AST::Types::VarSemantic:
+            AppendChild(children, static_cast<VarSemantic*>(ast)->packOffset);
+            break;
+        case AST::Types::VarType:
+            AppendChild(children, static_cast<VarType*>(ast)->structType);
+            break;
+        case AST::Types::VarIdent:
+        {
+            auto node = static_cast<VarIdent*>(ast);
+            AppendChildren(children, node->arrayIndices);
+            AppendChild(children, node->next);
+        }
+        break;
+        case AST::Types::VarDecl:
+        {
+            auto node = static_cast<VarDecl*>(ast);
+            AppendChildren(children, node->arrayDims);
+            AppendChildren(children, node->semantics);
+            AppendChild(children, node->initializer);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+//! Returns the spelling of the specified node, or null if the node has no spelling.
+static const std::string* NodeName(AST* ast)
+{
+    switch (ast->Type())
+    {
+        case AST::Types::BufferDeclIdent:   return &(static_cast<BufferDeclIdent*>(ast)->ident.Str());
+        case AST::Types::Structure:         return &(static_cast<Structure*>(ast)->name.Str());
+        case AST::Types::FunctionDecl:      return &(static_cast<FunctionDecl*>(ast)->name.Str());
+        case AST::Types::UniformBufferDecl: return &(static_cast<UniformBufferDecl*>(ast)->name.Str());
+        case AST::Types::TextureDecl:       return &(static_cast<TextureDecl*>(ast)->textureType.Str());
+        case AST::Types::SamplerDecl:       return &(static_cast<SamplerDecl*>(ast)->samplerType.Str());
+        case AST::Types::DirectiveDecl:     return &(static_cast<DirectiveDecl*>(ast)->line);
+        case AST::Types::DirectiveStmnt:    return &(static_cast<DirectiveStmnt*>(ast)->line);
+        case AST::Types::VarDeclStmnt:      return &(static_cast<VarDeclStmnt*>(ast)->inputModifier);
+        case AST::Types::AssignStmnt:       return &(static_cast<AssignStmnt*>(ast)->op);
+        case AST::Types::CtrlTransferStmnt: return &(static_cast<CtrlTransferStmnt*>(ast)->instruction);
+        case AST::Types::LiteralExpr:       return &(static_cast<LiteralExpr*>(ast)->literal);
+        case AST::Types::TypeNameExpr:      return &(static_cast<TypeNameExpr*>(ast)->typeName.Str());
+        case AST::Types::BinaryExpr:        return &(static_cast<BinaryExpr*>(ast)->op);
+        case AST::Types::UnaryExpr:         return &(static_cast<UnaryExpr*>(ast)->op);
+        case AST::Types::PostUnaryExpr:     return &(static_cast<PostUnaryExpr*>(ast)->op);
+        case AST::Types::VarAccessExpr:     return &(static_cast<VarAccessExpr*>(ast)->assignOp);
+        case AST::Types::PackOffset:        return &(static_cast<PackOffset*>(ast)->registerName);
+        case AST::Types::VarSemantic:       return &(static_cast<VarSemantic*>(ast)->semantic);
+        case AST::Types::VarType:           return &(static_cast<VarType*>(ast)->baseType.Str());
+        case AST::Types::VarIdent:          return &(static_cast<VarIdent*>(ast)->ident.Str());
+        case AST::Types::VarDecl:           return &(static_cast<VarDecl*>(ast)->name.Str());
+        default:                            return nullptr;
+    }
+}
+
+
+/*
+ * FlatTree class
+ */
+
+const FlatTree::Index FlatTree::invalidIndex;
+
+void FlatTree::Build(Program& program)
+{
+    types_.clear();
+    flags_.clear();
+    parents_.clear();
+    subtreeEnds_.clear();
+    depths_.clear();
+    nameOffsets_.clear();
+    nodes_.clear();
+
+    nameChars_.assign(1, '\0');
+
+    /* The number of nodes in the arenas is a good upper bound for the number of nodes in the tree */
+    std::size_t numArenaNodes = 1;
+    ForEachNode(program, [&numArenaNodes](AST*) { ++numArenaNodes; });
+
+    types_.reserve(numArenaNodes);
+    flags_.reserve(numArenaNodes);
+    parents_.reserve(numArenaNodes);
+    subtreeEnds_.reserve(numArenaNodes);
+    depths_.reserve(numArenaNodes);
+    nameOffsets_.reserve(numArenaNodes);
+    nodes_.reserve(numArenaNodes);
+
+    /* Add all nodes in pre-order (with an explicit stack, so deeply nested expressions can't overflow the call stack) */
+    std::vector<std::pair<AST*, Index>> stack;
+    std::vector<AST*> children;
+
+    stack.push_back({ &program, invalidIndex });
+
+    while (!stack.empty())
+    {
+        auto entry = stack.back();
+        stack.pop_back();
+
+        auto index = AddNode(entry.first, entry.second);
+
+        children.clear();
+        AppendChildNodes(entry.first, children);
+
+        for (auto it = children.rbegin(); it != children.rend(); ++it)
+            stack.push_back({ *it, index });
+    }
+
+    /* The last node of each sub tree has the highest index, so the sub tree ends can be propagated backwards */
+    for (auto i = NumNodes(); i-- > 1;)
+    {
+        auto& parentEnd = subtreeEnds_[parents_[i]];
+        parentEnd = std::max(parentEnd, subtreeEnds_[i]);
+    }
+}
+
+std::size_t FlatTree::UsedBytes() const
+{
+    return
+    (
+        types_.size()       * sizeof(AST::Types)    +
+        flags_.size()       * sizeof(Flags)         +
+        parents_.size()     * sizeof(Index)         +
+        subtreeEnds_.size() * sizeof(Index)         +
+        depths_.size()      * sizeof(unsigned int)  +
+        nameOffsets_.size() * sizeof(Index)         +
+        nodes_.size()       * sizeof(AST*)          +
+        nameChars_.size()
+    );
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+FlatTree::Index FlatTree::AddNode(AST* ast, Index parent)
+{
+    auto index = NumNodes();
+    auto name = NodeName(ast);
+
+    types_.push_back(ast->Type());
+    flags_.push_back(ast->flags);
+    parents_.push_back(parent);
+    subtreeEnds_.push_back(index + 1);
+    depths_.push_back(parent != invalidIndex ? depths_[parent] + 1 : 0);
+    nodes_.push_back(ast);
+
+    if (name != nullptr && !name->empty())
+    {
+        nameOffsets_.push_back(static_cast<Index>(nameChars_.size()));
+        nameChars_.insert(nameChars_.end(), name->begin(), name->end());
+        nameChars_.push_back('\0');
+    }
+    else
+        nameOffsets_.push_back(0);
+
+    return index;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,134 @@
+/*
+ * FlatTree.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_FLAT_TREE_H__
+#define __HT_FLAT_TREE_H__
+
+
+#include "HLSLTree.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+namespace HTLib
+{
+
+
+/**
+Compact, index-based layout of a program's AST.
+\remarks All nodes are stored in pre-order (i.e. in source order) with their node type, flags, parent index
+and the end of their sub tree in contiguous arrays (structure of arrays). The sub tree of node 'i' consists of all nodes
+in the range [i, SubtreeEnd(i)), and the children of node 'i' are found by jumping from 'i + 1' over the sub trees.
+The spelling of each node (e.g. the identifier of a "VarIdent" or the operator of a "BinaryExpr") is stored in a side table.
+Thus passes that only need the structure of the tree can iterate linearly and dispatch on "AST::Types"
+without any virtual function calls or pointer chasing.
+\note The flat tree is a snapshot: the flags are copied when the tree is built (e.g. after the context analysis),
+and it must be built again when the AST changes. Nodes which are not part of the tree (e.g. forward declaration references)
+are not included.
+*/
+class FlatTree
+{
+    
+    public:
+        
+        typedef std::uint32_t Index;
+
+        //! Invalid index (e.g. the parent of the root node).
+        static const Index invalidIndex = ~0u;
+
+        //! Builds the flat tree for the specified program, which will be the root node (index 0).
+        void Build(Program& program);
+
+        //! Returns the number of nodes.
+        inline Index NumNodes() const
+        {
+            return static_cast<Index>(types_.size());
+        }
+
+        inline AST::Types Type(Index node) const
+        {
+            return types_[node];
+        }
+
+        inline const Flags& NodeFlags(Index node) const
+        {
+            return flags_[node];
+        }
+
+        //! Returns the index of the parent node, or "invalidIndex" for the root node.
+        inline Index Parent(Index node) const
+        {
+            return parents_[node];
+        }
+
+        //! Returns the index after the last node of the sub tree of the specified node.
+        inline Index SubtreeEnd(Index node) const
+        {
+            return subtreeEnds_[node];
+        }
+
+        //! Returns the depth of the specified node (0 for the root node).
+        inline unsigned int Depth(Index node) const
+        {
+            return depths_[node];
+        }
+
+        //! Returns the null-terminated spelling of the specified node (e.g. an identifier or operator), or an empty string.
+        inline const char* Name(Index node) const
+        {
+            return nameChars_.data() + nameOffsets_[node];
+        }
+
+        //! Returns the original AST node (for the decorations which are not part of the flat tree).
+        inline AST* Node(Index node) const
+        {
+            return nodes_[node];
+        }
+
+        //! Returns the first child of the specified node, or "SubtreeEnd(node)" if it has no children.
+        inline Index FirstChild(Index node) const
+        {
+            return node + 1;
+        }
+
+        //! Returns the next sibling of the specified node, i.e. the next child after it.
+        inline Index NextSibling(Index node) const
+        {
+            return subtreeEnds_[node];
+        }
+
+        //! Returns the number of bytes which are used by all arrays (including the side table of the spellings).
+        std::size_t UsedBytes() const;
+
+    private:
+        
+        //! Appends the specified node, returns its index.
+        Index AddNode(AST* ast, Index parent);
+
+        std::vector<AST::Types>                 types_;
+        std::vector<Flags>                      flags_;
+        std::vector<Index>                      parents_;
+        std::vector<Index>                      subtreeEnds_;
+        std::vector<unsigned int>               depths_;
+        std::vector<Index>                      nameOffsets_;
+        std::vector<AST*>                       nodes_;
+
+        std::vector<char>                       nameChars_;     //!< Side table of all null-terminated node spellings (offset 0 is the empty string).
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
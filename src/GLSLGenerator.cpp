@@ -9,12 +9,21 @@
 #include "HLSLAnalyzer.h"
 #include "HLSLTree.h"
 #include "HLSLKeywords.h"
+#include "GLSLKeywords.h"
+#include "ThreadPool.h"
+#include "DiagnosticError.h"
 
 #include <ctime>
 #include <chrono>
 #include <initializer_list>
 #include <algorithm>
+#include <set>
 #include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <thread>
+#include <exception>
 
 
 namespace HTLib
@@ -35,12 +44,18 @@ static const std::string interfaceBlockPrefix = "_I";
 static std::string TimePoint()
 {
     /* Determine current time point */
-    const auto currentTime = std::chrono::high_resolution_clock::now();
-    const auto duration = std::chrono::duration_cast<std::chrono::seconds>(currentTime.time_since_epoch());
-    const auto date = duration.count();
+    const auto date = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
     
-    /* Get time point as string */
-    auto timePoint = std::string(std::ctime(&date));
+    /* Get time point as string (std::ctime is not thread-safe, so use the reentrant variants) */
+    char buffer[64] = { 0 };
+
+    #ifdef _WIN32
+    ctime_s(buffer, sizeof(buffer), &date);
+    #else
+    ctime_r(&date, buffer);
+    #endif
+
+    auto timePoint = std::string(buffer);
 
     /* Remove new-line character at the end */
     if (!timePoint.empty() && timePoint.back() == '\n')
@@ -76,20 +91,287 @@ static inline std::vector<std::string> StringList(const std::initializer_list<st
     return list;
 }
 
+//! Returns the short name with the specified index, i.e. "a" to "Z", then "aa" to "Z9" etc.
+static std::string ShortName(std::size_t index)
+{
+    static const char* chars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+
+    /* First character must not be a digit */
+    std::string name(1, chars[index % 52]);
+    index /= 52;
+
+    while (index > 0)
+    {
+        --index;
+        name += chars[index % 62];
+        index /= 62;
+    }
+
+    return name;
+}
+
+//! Inserts all identifiers of the specified preprocessor directive line into the set.
+static void InsertDirectiveIdents(const std::string& line, std::unordered_set<std::string>& idents)
+{
+    for (std::size_t i = 0; i < line.size();)
+    {
+        auto chr = static_cast<unsigned char>(line[i]);
+        if (std::isalpha(chr) || chr == '_')
+        {
+            auto start = i;
+            while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '_'))
+                ++i;
+            idents.insert(line.substr(start, i - start));
+        }
+        else if (std::isdigit(chr))
+        {
+            /* Skip numbers with suffixes (e.g. "1u") */
+            while (i < line.size() && (std::isalnum(static_cast<unsigned char>(line[i])) || line[i] == '.'))
+                ++i;
+        }
+        else
+            ++i;
+    }
+}
+
+/*
+Returns true if the brackets around the specified expression are redundant in every context,
+because this is already a primary expression (e.g. a literal or a function call).
+*/
+static bool IsPrimaryExprForGLSL(const Expr* ast)
+{
+    if (ast->constValue.type != ConstValue::Types::None)
+        return false; // folded constants may be written as negative numbers
+
+    switch (ast->Type())
+    {
+        case AST::Types::LiteralExpr:
+        case AST::Types::TypeNameExpr:
+        case AST::Types::BracketExpr:
+        case AST::Types::CastExpr:
+            return true;
+        case AST::Types::VarAccessExpr:
+            return (static_cast<const VarAccessExpr*>(ast)->assignExpr == nullptr);
+        case AST::Types::FunctionCallExpr:
+        {
+            /* Interlocked intrinsics with an output argument are written as assignment */
+            auto call = static_cast<const FunctionCallExpr*>(ast)->call;
+            return !(call->flags(FunctionCall::isAtomicFunc) && call->arguments.size() >= 3);
+        }
+        default:
+            return false;
+    }
+}
+
+static std::string ConstComponentToString(double c, const ConstValue::Types type)
+{
+    switch (type)
+    {
+        case ConstValue::Types::Bool:
+            return (c != 0.0 ? "true" : "false");
+        case ConstValue::Types::Int:
+            return std::to_string(static_cast<long long>(c));
+        case ConstValue::Types::UInt:
+            return std::to_string(static_cast<unsigned long long>(c)) + "u";
+        default:
+            break;
+    }
+
+    /* Write integral values without an exponent (e.g. "10.0" instead of "1e+01"), except negative zero */
+    if (c == std::trunc(c) && std::abs(c) < 1.0e9 && (c != 0.0 || !std::signbit(c)))
+        return std::to_string(static_cast<long long>(c)) + ".0";
+
+    /* Find shortest representation which restores the same single precision value */
+    char buffer[32] = { 0 };
+    const auto value = static_cast<float>(c);
+
+    for (int precision = 1; precision <= 9; ++precision)
+    {
+        std::snprintf(buffer, sizeof(buffer), "%.*g", precision, c);
+        if (static_cast<float>(std::strtod(buffer, nullptr)) == value)
+            break;
+    }
+
+    /* Always write floating-point literals with a dot or an exponent */
+    std::string str = buffer;
+    if (str.find_first_of(".e") == std::string::npos)
+        str += ".0";
+
+    return str;
+}
+
+static std::string ConstValueToString(const ConstValue& value)
+{
+    const auto& components = value.components;
+
+    if (components.size() == 1)
+        return ConstComponentToString(components.front(), value.type);
+
+    /* Write vector constructor (with a single argument if all components are equal) */
+    std::string str;
+
+    switch (value.type)
+    {
+        case ConstValue::Types::Bool:
+            str = "bvec";
+            break;
+        case ConstValue::Types::Int:
+            str = "ivec";
+            break;
+        case ConstValue::Types::UInt:
+            str = "uvec";
+            break;
+        default:
+            str = "vec";
+            break;
+    }
+
+    str += std::to_string(components.size()) + "(";
+
+    if (std::all_of(components.begin(), components.end(), [&](double c) { return c == components.front(); }))
+        str += ConstComponentToString(components.front(), value.type);
+    else
+    {
+        for (std::size_t i = 0; i < components.size(); ++i)
+        {
+            if (i > 0)
+                str += ", ";
+            str += ConstComponentToString(components[i], value.type);
+        }
+    }
+
+    return str + ")";
+}
+
+/* --- Resource layouts --- */
+
+static unsigned int RoundUp(unsigned int value, unsigned int alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+//! Returns the binding point of the specified register name (e.g. 2 for "t2"), or -1 if there is no register.
+static int RegisterBinding(const std::string& registerName)
+{
+    if (registerName.size() < 2)
+        return -1;
+
+    for (std::size_t i = 1; i < registerName.size(); ++i)
+    {
+        if (!std::isdigit(static_cast<unsigned char>(registerName[i])))
+            return -1;
+    }
+
+    return std::atoi(registerName.c_str() + 1);
+}
+
+//! Returns the unsigned integral value of the specified expression (a folded constant or a literal), or 0 if it has no such value.
+static unsigned int ExprToUInt(const Expr* ast)
+{
+    if (ast->constValue.type != ConstValue::Types::None && ast->constValue.components.size() == 1)
+    {
+        auto value = ast->constValue.components.front();
+        return (value > 0.0 ? static_cast<unsigned int>(value) : 0u);
+    }
+
+    if (ast->Type() == AST::Types::LiteralExpr)
+    {
+        const auto& literal = static_cast<const LiteralExpr*>(ast)->literal;
+        if (!literal.empty() && std::isdigit(static_cast<unsigned char>(literal.front())))
+            return static_cast<unsigned int>(std::strtoul(literal.c_str(), nullptr, 0));
+    }
+
+    return 0;
+}
+
+//! Returns the number of array elements (the product of all dimensions), or 0 if the variable is not an array.
+static unsigned int ArraySize(const std::vector<ExprPtr>& arrayDims)
+{
+    if (arrayDims.empty())
+        return 0;
+
+    unsigned int size = 1;
+    for (const auto& dim : arrayDims)
+        size *= ExprToUInt(dim);
+
+    return size;
+}
+
+/*
+Returns the alignment and size of the specified GLSL scalar, vector or matrix type in the "std140" layout
+(see GLSL specification 4.50, section 7.6.2.2 "Standard Uniform Block Layout"). Matrices are stored in column-major order.
+*/
+static void Std140BaseTypeLayout(const std::string& typeName, unsigned int& align, unsigned int& size)
+{
+    const unsigned int scalarSize = (typeName.compare(0, 1, "d") == 0 ? 8 : 4);
+
+    auto pos = typeName.find("vec");
+    if (pos != std::string::npos && pos + 3 < typeName.size())
+    {
+        /* Vectors with 3 components are aligned like vectors with 4 components */
+        unsigned int n = static_cast<unsigned int>(typeName[pos + 3] - '0');
+        align   = (n == 3 ? 4 : n) * scalarSize;
+        size    = n * scalarSize;
+        return;
+    }
+
+    pos = typeName.find("mat");
+    if (pos != std::string::npos && pos + 3 < typeName.size())
+    {
+        /* Matrices are stored like an array of column vectors ("matCxR" has C columns and R rows) */
+        unsigned int columns    = static_cast<unsigned int>(typeName[pos + 3] - '0');
+        unsigned int rows       = columns;
+
+        if (pos + 5 < typeName.size() && typeName[pos + 4] == 'x')
+            rows = static_cast<unsigned int>(typeName[pos + 5] - '0');
+
+        align   = RoundUp((rows == 3 ? 4 : rows) * scalarSize, 16);
+        size    = columns * align;
+        return;
+    }
+
+    align   = scalarSize;
+    size    = scalarSize;
+}
+
+//! Returns the number of locations, which are consumed by a shader input or output of the specified GLSL type (see GLSL specification 4.50, section 4.4.1).
+static unsigned int TypeLocationCount(const std::string& typeName)
+{
+    /* Matrices consume one location per column */
+    auto pos = typeName.find("mat");
+    if (pos != std::string::npos && pos + 3 < typeName.size())
+        return static_cast<unsigned int>(typeName[pos + 3] - '0');
+
+    /* Vectors of doubles with 3 or 4 components consume two locations */
+    if (typeName == "dvec3" || typeName == "dvec4")
+        return 2;
+
+    return 1;
+}
+
 
 /*
  * GLSLGenerator class
  */
 
-GLSLGenerator::GLSLGenerator(Logger* log, IncludeHandler* includeHandler, const Options& options) :
-    writer_         { options.indent    },
-    includeHandler_ { includeHandler    },
-    log_            { log               },
-    localVarPrefix_ { options.prefix    },
-    allowBlanks_    { options.blanks    },
-    allowLineMarks_ { options.lineMarks }
+GLSLGenerator::GLSLGenerator(const Tables& tables, Logger* log, IncludeHandler* includeHandler, const Options& options) :
+    tables_          { &tables                           },
+    writer_          { options.indent, options.minify    },
+    includeHandler_  { includeHandler                    },
+    log_             { log                               },
+    localVarPrefix_  { options.prefix                    },
+    allowBlanks_     { options.blanks && !options.minify },
+    allowLineMarks_  { options.lineMarks                 },
+    allowTimeStamp_  { options.timeStamp                 },
+    numThreads_      { options.generatorThreads          },
+    minify_          { options.minify                    },
+    explicitBinding_ { options.explicitBinding           },
+    streamOutput_    { options.streamOutput              },
+    bindingOffsets_  { options.bindingOffsets            },
+    descriptorSet_   { options.descriptorSet             },
+    pushConstantSize_{ options.pushConstantSize          },
+    defaultPrecision_{ options.defaultPrecision          }
 {
-    EstablishMaps();
 }
 
 bool GLSLGenerator::GenerateCode(
@@ -99,6 +381,165 @@ bool GLSLGenerator::GenerateCode(
     const ShaderTargets shaderTarget,
     const InputShaderVersions versionIn,
     const OutputShaderVersions versionOut)
+{
+    try
+    {
+        writer_.OutputStream(output);
+    }
+    catch (const std::exception& err)
+    {
+        if (log_)
+            log_->Error(err.what());
+        return false;
+    }
+
+    /*
+    Generate code into the buffer of the code writer and write it to the stream at once (also on failure),
+    or after each global declaration in the streaming mode
+    */
+    outputSize_ = 0;
+    isStreaming_ = streamOutput_;
+
+    auto result = GenerateCodePrimary(program, entryPoint, shaderTarget, versionIn, versionOut);
+
+    FlushStream();
+    isStreaming_ = false;
+
+    outputSize_ += writer_.BufferSize();
+    writer_.Flush();
+
+    return result;
+}
+
+bool GLSLGenerator::GenerateCode(
+    Program* program,
+    std::string& output,
+    const std::string& entryPoint,
+    const ShaderTargets shaderTarget,
+    const InputShaderVersions versionIn,
+    const OutputShaderVersions versionOut)
+{
+    const auto startSize = output.size();
+
+    writer_.OutputBuffer(output);
+    auto result = GenerateCodePrimary(program, entryPoint, shaderTarget, versionIn, versionOut);
+
+    outputSize_ = output.size() - startSize;
+
+    return result;
+}
+
+
+void GLSLGenerator::Reflect(ShaderReflection& reflection) const
+{
+    reflection = ShaderReflection();
+
+    if (!program_)
+        return;
+
+    const bool isCommonShader = (shaderTarget_ == ShaderTargets::CommonShader);
+
+    /* Reflect single fragment shader output (see "WriteFragmentShaderOutput") */
+    const auto& outp = program_->outputSemantics;
+
+    if (shaderTarget_ == ShaderTargets::GLSLFragmentShader && outp.returnType && !outp.functionSemantic.empty() &&
+        outp.singleOutputVariable == outp.functionSemantic)
+    {
+        SemanticStage semantic;
+        FetchSemantic(outp.functionSemantic, semantic);
+
+        ReflectionAttribute attribute;
+        {
+            attribute.name      = outp.functionSemantic;
+            attribute.type      = ReflectTypeName(outp.returnType);
+            attribute.semantic  = outp.functionSemantic;
+            attribute.location  = semantic.index;
+        }
+        reflection.outputs.push_back(attribute);
+    }
+
+    /* Reflect all global declarations which are written by the code generation */
+    for (const auto& globDecl : program_->globalDecls)
+    {
+        switch (globDecl->Type())
+        {
+            case AST::Types::FunctionDecl:
+            {
+                auto ast = static_cast<const FunctionDecl*>(globDecl);
+                if (ast->flags(FunctionDecl::isReferenced) || isCommonShader)
+                {
+                    for (const auto& attrib : ast->attribs)
+                    {
+                        if (FullVarIdent(attrib->name) == "numthreads")
+                            ReflectAttributeNumThreads(attrib, reflection);
+                    }
+                }
+            }
+            break;
+
+            case AST::Types::UniformBufferDecl:
+            {
+                auto ast = static_cast<const UniformBufferDecl*>(globDecl);
+                if (ast->flags(UniformBufferDecl::isReferenced) || isCommonShader)
+                    ReflectUniformBuffer(ast, reflection);
+            }
+            break;
+
+            case AST::Types::TextureDecl:
+            {
+                auto ast = static_cast<const TextureDecl*>(globDecl);
+                if (ast->flags(TextureDecl::isReferenced) || isCommonShader)
+                {
+                    auto it = tables_->typeMap.find(ast->textureType);
+                    auto samplerType = (it != tables_->typeMap.end() ? it->second : ast->textureType.Str());
+
+                    for (const auto& name : ast->names)
+                    {
+                        if (name->flags(BufferDeclIdent::isReferenced) || isCommonShader)
+                            reflection.textures.push_back({ name->ident, samplerType, ReflectBinding(name, name->registerName) });
+                    }
+                }
+            }
+            break;
+
+            case AST::Types::SamplerDecl:
+            {
+                auto ast = static_cast<const SamplerDecl*>(globDecl);
+                if (ast->flags(SamplerDecl::isReferenced) || isCommonShader)
+                {
+                    for (const auto& name : ast->names)
+                    {
+                        if (name->flags(BufferDeclIdent::isReferenced) || isCommonShader)
+                            reflection.samplers.push_back({ name->ident, ast->samplerType, RegisterBinding(name->registerName) });
+                    }
+                }
+            }
+            break;
+
+            case AST::Types::StructDecl:
+            {
+                auto ast = static_cast<const StructDecl*>(globDecl);
+                if (ast->structure->flags(Structure::isReferenced) || isCommonShader)
+                    ReflectInterface(ast->structure, reflection);
+            }
+            break;
+
+            default:
+            break;
+        }
+    }
+}
+
+/*
+ * ======= Private: =======
+ */
+
+bool GLSLGenerator::GenerateCodePrimary(
+    Program* program,
+    const std::string& entryPoint,
+    const ShaderTargets shaderTarget,
+    const InputShaderVersions versionIn,
+    const OutputShaderVersions versionOut)
 {
     if (!program)
         return false;
@@ -111,28 +552,33 @@ bool GLSLGenerator::GenerateCode(
 
     try
     {
-        writer_.OutputStream(output);
-
         /* Write header */
-        Comment("GLSL " + TargetToString(shaderTarget));
+        Comment((IsVulkanOut() ? "Vulkan GLSL " : (IsESSLOut() ? "GLSL ES " : "GLSL ")) + TargetToString(shaderTarget));
         
         if (entryPoint.empty())
             Comment("Generated from HLSL Shader");
         else
             Comment("Generated from HLSL Shader \"" + entryPoint + "\"");
 
-        Comment(TimePoint());
+        if (allowTimeStamp_)
+            Comment(TimePoint());
         Blank();
 
         if (shaderTarget_ != ShaderTargets::CommonShader)
         {
-            Version(static_cast<int>(versionOut_));
+            Version(GLSLVersionNumber(versionOut_));
             Blank();
         }
 
         /* Visit program AST */
         Visit(program);
     }
+    catch (const DiagnosticError& err)
+    {
+        if (log_)
+            log_->Report(err.GetDiagnostic());
+        return false;
+    }
     catch (const std::exception& err)
     {
         if (log_)
@@ -143,185 +589,14 @@ bool GLSLGenerator::GenerateCode(
     return true;
 }
 
-
-/*
- * ======= Private: =======
- */
-
-void GLSLGenerator::EstablishMaps()
+void GLSLGenerator::Error(const DiagnosticCodes code, const AST* ast, const std::string& arg0, const std::string& arg1)
 {
-    typeMap_ = std::map<std::string, std::string>
-    {
-        /* Scalar types */
-        { "bool",      "bool"   },
-        { "bool1",     "bool"   },
-        { "bool1x1",   "bool"   },
-        { "int",       "int"    },
-        { "int1",      "int"    },
-        { "int1x1",    "int"    },
-        { "uint",      "uint"   },
-        { "uint1",     "uint"   },
-        { "uint1x1",   "uint"   },
-        { "half",      "float"  },
-        { "half1",     "float"  },
-        { "half1x1",   "float"  },
-        { "float",     "float"  },
-        { "float1",    "float"  },
-        { "float1x1",  "float"  },
-        { "double",    "double" },
-        { "double1",   "double" },
-        { "double1x1", "double" },
-
-        /* Vector types */
-        { "bool2",   "bvec2" },
-        { "bool3",   "bvec3" },
-        { "bool4",   "bvec4" },
-        { "int2",    "ivec2" },
-        { "int3",    "ivec3" },
-        { "int4",    "ivec4" },
-        { "uint2",   "uvec2" },
-        { "uint3",   "uvec3" },
-        { "uint4",   "uvec4" },
-        { "half2",   "vec2"  },
-        { "half3",   "vec3"  },
-        { "half4",   "vec4"  },
-        { "float2",  "vec2"  },
-        { "float3",  "vec3"  },
-        { "float4",  "vec4"  },
-        { "double2", "dvec2" },
-        { "double3", "dvec3" },
-        { "double4", "dvec4" },
-
-        /* Matrix types */
-        { "float2x2",  "mat2"   },
-        { "float2x3",  "mat2x3" },
-        { "float2x4",  "mat2x4" },
-        { "float3x2",  "mat3x2" },
-        { "float3x3",  "mat3"   },
-        { "float3x4",  "mat3x4" },
-        { "float4x2",  "mat4x2" },
-        { "float4x3",  "mat4x3" },
-        { "float4x4",  "mat4"   },
-        { "double2x2", "mat2"   },
-        { "double2x3", "mat2x3" },
-        { "double2x4", "mat2x4" },
-        { "double3x2", "mat3x2" },
-        { "double3x3", "mat3"   },
-        { "double3x4", "mat3x4" },
-        { "double4x2", "mat4x2" },
-        { "double4x3", "mat4x3" },
-        { "double4x4", "mat4"   },
-
-        /* Texture types */
-        { "Texture1D",        "sampler1D"        },
-        { "Texture1DArray",   "sampler1DArray"   },
-        { "Texture2D",        "sampler2D"        },
-        { "Texture2DArray",   "sampler2DArray"   },
-        { "Texture3D",        "sampler3D"        },
-        { "TextureCube",      "samplerCube"      },
-        { "TextureCubeArray", "samplerCubeArray" },
-        { "Texture2DMS",      "sampler2DMS"      },
-        { "Texture2DMSArray", "sampler2DMSArray" },
-        /*{ "RWTexture1D",      "" },
-        { "RWTexture1DArray", "" },
-        { "RWTexture2D",      "" },
-        { "RWTexture2DArray", "" },
-        { "RWTexture3D",      "" },*/
-
-        /* Storage class types */
-        { "groupshared", "shared" },
-    };
-
-    intrinsicMap_ = std::map<std::string, std::string>
-    {
-        { "frac",                            "fract"              },
-        { "rsqrt",                           "inversesqrt"        },
-        { "lerp",                            "mix"                },
-        { "saturate",                        "clamp"              },
-        { "ddx",                             "dFdx"               },
-        { "ddy",                             "dFdy"               },
-        { "ddx_coarse",                      "dFdxCoarse"         },
-        { "ddy_coarse",                      "dFdyCoarse"         },
-        { "ddx_fine",                        "dFdxFine"           },
-        { "ddy_fine",                        "dFdyFine"           },
-        { "atan2",                           "atan"               },
-        { "GroupMemoryBarrier",              "groupMemoryBarrier" },
-        { "GroupMemoryBarrierWithGroupSync", "barrier"            },
-        { "AllMemoryBarrier",                "memoryBarrier"      },
-        { "AllMemoryBarrierWithGroupSync",   "barrier"            },
-    };
-
-    atomicIntrinsicMap_ = std::map<std::string, std::string>
-    {
-        { "InterlockedAdd",             "atomicAdd"      },
-        { "InterlockedAnd",             "atomicAnd"      },
-        { "InterlockedOr",              "atomicOr"       },
-        { "InterlockedXor",             "atomicXor"      },
-        { "InterlockedMin",             "atomicMin"      },
-        { "InterlockedMax",             "atomicMax"      },
-        { "InterlockedCompareExchange", "atomicCompSwap" },
-        { "InterlockedExchange",        "atomicExchange" },
-    };
-
-    modifierMap_ = std::map<std::string, std::string>
-    {
-        { "linear",          "smooth"        },
-        { "centroid",        "centroid"      },
-        { "nointerpolation", "flat"          },
-        { "noperspective",   "noperspective" },
-        { "sample",          "sample"        },
-    };
-
-    texFuncMap_ = std::map<std::string, std::string>
-    {
-        { "GetDimensions ",     "textureSize"   },
-        { "Load",               "texelFetch"    },
-        { "Sample",             "texture"       },
-        { "SampleBias",         "textureOffset" },
-        //{ "SampleCmp", "" },
-        //{ "SampleCmpLevelZero", "" },
-        { "SampleGrad",         "textureGrad"   },
-        { "SampleLevel",        "textureLod"    },
-    };
-
-    semanticMap_ = std::map<std::string, SemanticStage>
-    {
-        { "SV_CLIPDISTANCE",            { "gl_ClipDistance"                             } },
-        { "SV_CULLDISTANCE",            { "gl_CullDistance"                             } },
-      //{ "SV_COVERAGE",                { "???"                                         } },
-        { "SV_DEPTH",                   { "gl_FragDepth"                                } },
-        { "SV_DISPATCHTHREADID",        { "gl_GlobalInvocationID"                       } },
-        { "SV_DOMAINLOCATION",          { "gl_TessCoord"                                } },
-        { "SV_GROUPID",                 { "gl_WorkGroupID"                              } },
-        { "SV_GROUPINDEX",              { "gl_LocalInvocationIndex"                     } },
-        { "SV_GROUPTHREADID",           { "gl_LocalInvocationID"                        } },
-        { "SV_GSINSTANCEID",            { "gl_InvocationID"                             } },
-        { "SV_INSIDETESSFACTOR",        { "gl_Position"                                 } },
-        { "SV_ISFRONTFACE",             { "gl_FrontFacing"                              } },
-        { "SV_OUTPUTCONTROLPOINTID",    { "gl_PrimitiveID"                              } },
-        { "SV_POSITION",                { "gl_Position", "", "", "", "gl_FragCoord", "" } },
-      //{ "SV_RENDERTARGETARRAYINDEX",  { "???"                                         } },
-        { "SV_SAMPLEINDEX",             { "gl_SampleID"                                 } },
-        { "SV_TARGET",                  { "gl_FragColor"                                } },
-        { "SV_TESSFACTOR",              { "gl_Position"                                 } },
-        { "SV_VIEWPORTARRAYINDEX",      { "gl_ViewportIndex"                            } },
-        { "SV_INSTANCEID",              { "gl_InstanceID"                               } },
-        { "SV_PRIMITIVEID",             { "gl_PrimitiveID"                              } },
-        { "SV_VERTEXID",                { "gl_VertexID"                                 } },
-    };
-}
-
-void GLSLGenerator::Error(const std::string& msg, const AST* ast)
-{
-    if (ast)
-        throw std::runtime_error("code generation error (" + ast->pos.ToString() + ") : " + msg);
-    else
-        throw std::runtime_error("code generation error : " + msg);
+    throw DiagnosticError(code, (ast ? &(ast->pos) : nullptr), arg0, arg1);
 }
 
 void GLSLGenerator::ErrorInvalidNumArgs(const std::string& functionName, const AST* ast)
 {
-    Error("invalid number of arguments for " + functionName, ast);
+    Error(DiagnosticCodes::InvalidNumArgs, ast, functionName);
 }
 
 void GLSLGenerator::BeginLn()
@@ -339,6 +614,13 @@ void GLSLGenerator::Write(const std::string& text)
     writer_.Write(text);
 }
 
+void GLSLGenerator::WriteTypeName(const std::string& typeName, const std::string& hlslTypeName, const AST* ast)
+{
+    if (IsESSLOut() && (typeName == "double" || typeName.compare(0, 4, "dvec") == 0))
+        Error(DiagnosticCodes::UnsupportedESSLType, ast, hlslTypeName);
+    Write(typeName);
+}
+
 void GLSLGenerator::WriteLn(const std::string& text)
 {
     writer_.WriteLine(text);
@@ -366,12 +648,13 @@ void GLSLGenerator::PopOptions()
 
 void GLSLGenerator::Comment(const std::string& text)
 {
-    WriteLn("// " + text);
+    if (!minify_)
+        WriteLn("// " + text);
 }
 
 void GLSLGenerator::Version(int versionNumber)
 {
-    WriteLn("#version " + std::to_string(versionNumber));
+    WriteLn("#version " + std::to_string(versionNumber) + (IsESSLOut() ? " es" : ""));
 }
 
 void GLSLGenerator::Line(int lineNumber)
@@ -405,6 +688,10 @@ void GLSLGenerator::AppendRequiredExtensions(Program* ast)
 {
     for (const auto& ext : ast->requiredExtensions)
         Extension(ext);
+
+    if (explicitLayout_ && explicitLayout_->hasBlockLocations && !IsVersionOut(440))
+        Extension("GL_ARB_enhanced_layouts");
+
     Blank();
 }
 
@@ -441,17 +728,24 @@ void GLSLGenerator::AppendMulIntrinsics()
 
 void GLSLGenerator::AppendRcpIntrinsics()
 {
+    /* GLSL ES has no double precision types */
+    const bool doubles = !IsESSLOut();
+
     WriteLn("float rcp(float x) { return 1.0 / x; }");
-    WriteLn("double rcp(double x) { return 1.0 / x; }");
+    if (doubles)
+        WriteLn("double rcp(double x) { return 1.0 / x; }");
 
     WriteLn("vec2 rcp(vec2 v) { return vec2(1.0 / v.x, 1.0 / v.y); }");
-    WriteLn("dvec2 rcp(dvec2 v) { return dvec2(1.0 / v.x, 1.0 / v.y); }");
+    if (doubles)
+        WriteLn("dvec2 rcp(dvec2 v) { return dvec2(1.0 / v.x, 1.0 / v.y); }");
 
     WriteLn("vec3 rcp(vec3 v) { return vec3(1.0 / v.x, 1.0 / v.y, 1.0 / v.z); }");
-    WriteLn("dvec3 rcp(dvec4 v) { return dvec3(1.0 / v.x, 1.0 / v.y, 1.0 / v.z); }");
+    if (doubles)
+        WriteLn("dvec3 rcp(dvec4 v) { return dvec3(1.0 / v.x, 1.0 / v.y, 1.0 / v.z); }");
 
     WriteLn("vec4 rcp(vec3 v) { return vec4(1.0 / v.x, 1.0 / v.y, 1.0 / v.z, 1.0 / v.w); }");
-    WriteLn("dvec4 rcp(dvec4 v) { return dvec4(1.0 / v.x, 1.0 / v.y, 1.0 / v.z, 1.0 / v.w); }");
+    if (doubles)
+        WriteLn("dvec4 rcp(dvec4 v) { return dvec4(1.0 / v.x, 1.0 / v.y, 1.0 / v.z, 1.0 / v.w); }");
 
     WriteLn("mat2 rcp(mat2 m) { mat2 r; r[0] = rcp(m[0]); r[1] = rcp(m[1]); return r; }");
     WriteLn("mat3 rcp(mat3 m) { mat3 r; r[0] = rcp(m[0]); r[1] = rcp(m[1]); r[2] = rcp(m[2]); return r; }");
@@ -499,8 +793,8 @@ void GLSLGenerator::ValidateRegisterPrefix(const std::string& registerName, char
     if (registerName.empty() || registerName[0] != prefix)
     {
         Error(
-            "invalid register prefix '" + std::string(1, registerName[0]) +
-            "' (expected '" + std::string(1, prefix) + "')"
+            DiagnosticCodes::InvalidRegisterPrefix, nullptr,
+            std::string(1, registerName[0]), std::string(1, prefix)
         );
     }
 }
@@ -534,17 +828,586 @@ std::string GLSLGenerator::URegister(const std::string& registerName)
     return registerName.substr(1);
 }
 
-bool GLSLGenerator::MustResolveStruct(Structure* ast) const
+bool GLSLGenerator::MustResolveStruct(const Structure* ast) const
+{
+    return
+        ( shaderTarget_ == ShaderTargets::GLSLVertexShader && ast->flags(Structure::isShaderInput) ) ||
+        ( shaderTarget_ == ShaderTargets::GLSLFragmentShader && ast->flags(Structure::isShaderOutput) ) ||
+        ( shaderTarget_ == ShaderTargets::GLSLComputeShader && ( ast->flags(Structure::isShaderInput) || ast->flags(Structure::isShaderOutput) ) ) ||
+        IsFlattenedStruct(ast);
+}
+
+bool GLSLGenerator::IsEmptyInterfaceBlock(const Structure* ast) const
+{
+    for (const auto& member : ast->members)
+    {
+        for (const auto& varDecl : member->varDecls)
+        {
+            if (!varDecl->flags(VarDecl::disableCodeGen) && !HasSystemValueSemantic(varDecl->semantics))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool GLSLGenerator::IsVersionOut(int version) const
+{
+    return GLSLFeatureVersion(versionOut_) >= version;
+}
+
+bool GLSLGenerator::IsVulkanOut() const
+{
+    return IsVulkanGLSL(versionOut_);
+}
+
+bool GLSLGenerator::IsESSLOut() const
+{
+    return IsESSL(versionOut_);
+}
+
+bool GLSLGenerator::IsFlattenedStruct(const Structure* ast) const
+{
+    return
+        IsESSLOut() &&
+        (
+            ( shaderTarget_ == ShaderTargets::GLSLVertexShader && ast->flags(Structure::isShaderOutput) ) ||
+            ( shaderTarget_ == ShaderTargets::GLSLFragmentShader && ast->flags(Structure::isShaderInput) )
+        );
+}
+
+std::string GLSLGenerator::ResolvedVarName(const Structure* structure, const VarDecl* ast) const
+{
+    /* Both stages use the structure name, so the flattened vertex outputs match the flattened fragment inputs */
+    if (IsFlattenedStruct(structure))
+        return interfaceBlockPrefix + structure->name + "_" + ast->name;
+    return ast->name;
+}
+
+void GLSLGenerator::WriteDefaultPrecisions(Program* ast)
+{
+    static const char* precisionNames[] = { "lowp", "mediump", "highp" };
+    const std::string precision = precisionNames[static_cast<int>(defaultPrecision_)];
+
+    WriteLn("precision " + precision + " float;");
+    WriteLn("precision " + precision + " int;");
+
+    /* Only "sampler2D" and "samplerCube" have a default precision, so write it for all other sampler types which are used */
+    std::set<std::string> samplerTypes { "sampler2D", "samplerCube" };
+
+    for (const auto& globDecl : ast->globalDecls)
+    {
+        if (globDecl->Type() != AST::Types::TextureDecl)
+            continue;
+
+        auto textureDecl = static_cast<const TextureDecl*>(globDecl);
+        if (!textureDecl->flags(TextureDecl::isReferenced))
+            continue;
+
+        auto it = tables_->typeMap.find(textureDecl->textureType);
+        if (it != tables_->typeMap.end() && samplerTypes.insert(it->second).second)
+            WriteLn("precision " + precision + " " + it->second + ";");
+    }
+
+    Blank();
+}
+
+void GLSLGenerator::GenerateExplicitLayout(Program* ast)
+{
+    auto layout = std::make_shared<ExplicitLayout>();
+
+    /*
+    Collect all resources of each register class (also unused ones),
+    so that the bindings only depend on the source and are identical for all entry points
+    */
+    std::map<char, std::vector<std::pair<const AST*, const std::string*>>> resources;
+
+    for (const auto& globDecl : ast->globalDecls)
+    {
+        if (globDecl->Type() == AST::Types::UniformBufferDecl)
+        {
+            auto uniformBufferDecl = static_cast<const UniformBufferDecl*>(globDecl);
+            resources['b'].push_back({ uniformBufferDecl, &(uniformBufferDecl->registerName) });
+
+            /* Select the first small uniform buffer as push constant block (it keeps its binding, so the other bindings do not depend on it) */
+            if ( IsVulkanOut() && !layout->pushConstantBuffer && pushConstantSize_ > 0 &&
+                 ReflectUniformBufferSize(uniformBufferDecl) <= pushConstantSize_ )
+            {
+                layout->pushConstantBuffer = uniformBufferDecl;
+            }
+        }
+        else if (globDecl->Type() == AST::Types::TextureDecl)
+        {
+            for (const auto& name : static_cast<const TextureDecl*>(globDecl)->names)
+                resources['t'].push_back({ name, &(name->registerName) });
+        }
+    }
+
+    /* All resources of a descriptor set share the same bindings in Vulkan, so the register classes without an offset follow each other */
+    int nextOffset = 0;
+
+    for (const auto& registerClass : resources)
+    {
+        auto it = bindingOffsets_.find(registerClass.first);
+        const int offset = (it != bindingOffsets_.end() ? static_cast<int>(it->second) : (IsVulkanOut() ? nextOffset : 0));
+
+        /* Reserve all register indices which are specified explicitly */
+        std::set<int> usedIndices;
+
+        for (const auto& resource : registerClass.second)
+        {
+            if (!resource.second->empty())
+            {
+                ValidateRegisterPrefix(*resource.second, registerClass.first);
+                usedIndices.insert(RegisterBinding(*resource.second));
+            }
+        }
+
+        /* Assign the lowest free indices to all resources without a register (in the order of their declaration) */
+        int nextIndex = 0;
+
+        for (const auto& resource : registerClass.second)
+        {
+            auto index = RegisterBinding(*resource.second);
+            if (index < 0)
+            {
+                while (usedIndices.find(nextIndex) != usedIndices.end())
+                    ++nextIndex;
+                index = nextIndex++;
+            }
+            layout->bindings[resource.first] = offset + index;
+            nextOffset = std::max(nextOffset, offset + index + 1);
+        }
+    }
+
+    /* Assign the locations of all shader inputs and outputs which are written (see "Visit(Structure)") */
+    if (shaderTarget_ != ShaderTargets::CommonShader && shaderTarget_ != ShaderTargets::GLSLComputeShader)
+    {
+        int numInputs = 0, numOutputs = 0;
+
+        for (const auto& globDecl : ast->globalDecls)
+        {
+            if (globDecl->Type() != AST::Types::StructDecl)
+                continue;
+
+            auto structure = static_cast<const StructDecl*>(globDecl)->structure;
+
+            const bool isInput = structure->flags(Structure::isShaderInput);
+            if ( !structure->flags(Structure::isReferenced) || ( !isInput && !structure->flags(Structure::isShaderOutput) ) )
+                continue;
+
+            auto& location = (isInput ? numInputs : numOutputs);
+
+            if (MustResolveStruct(structure))
+            {
+                /* Assign a location to each global variable (fragment outputs with an "SV_Target" semantic use its index) */
+                for (const auto& member : structure->members)
+                {
+                    for (const auto& varDecl : member->varDecls)
+                    {
+                        SemanticStage semantic;
+                        if (!varDecl->semantics.empty() && FetchSemantic(varDecl->semantics.front()->semantic, semantic))
+                        {
+                            if (!isInput && shaderTarget_ == ShaderTargets::GLSLFragmentShader && semantic.fragment == "gl_FragColor")
+                                layout->locations[varDecl] = semantic.index;
+                        }
+                        else if (!varDecl->flags(VarDecl::disableCodeGen))
+                        {
+                            layout->locations[varDecl] = location;
+                            location += static_cast<int>(LocationCount(member->varType, varDecl));
+                        }
+                    }
+                }
+            }
+            else if (!IsEmptyInterfaceBlock(structure))
+            {
+                /* Assign the first location to the interface block, its members consume the following locations */
+                layout->locations[structure] = location;
+                layout->hasBlockLocations = true;
+
+                for (const auto& member : structure->members)
+                {
+                    for (const auto& varDecl : member->varDecls)
+                    {
+                        if (!varDecl->flags(VarDecl::disableCodeGen) && !HasSystemValueSemantic(varDecl->semantics))
+                            location += static_cast<int>(LocationCount(member->varType, varDecl));
+                    }
+                }
+            }
+        }
+    }
+
+    explicitLayout_ = layout;
+}
+
+int GLSLGenerator::ExplicitBinding(const AST* ast) const
+{
+    if (explicitLayout_)
+    {
+        auto it = explicitLayout_->bindings.find(ast);
+        if (it != explicitLayout_->bindings.end())
+            return it->second;
+    }
+    return -1;
+}
+
+int GLSLGenerator::ExplicitLocation(const AST* ast) const
+{
+    if (explicitLayout_)
+    {
+        auto it = explicitLayout_->locations.find(ast);
+        if (it != explicitLayout_->locations.end())
+            return it->second;
+    }
+    return -1;
+}
+
+std::string GLSLGenerator::BindingQualifier(const std::string& binding) const
+{
+    if (IsVulkanOut())
+        return "set = " + std::to_string(descriptorSet_) + ", binding = " + binding;
+    return "binding = " + binding;
+}
+
+bool GLSLGenerator::HasBindingQualifiers() const
+{
+    return (!IsESSLOut() || IsVersionOut(420));
+}
+
+bool GLSLGenerator::IsPushConstantBuffer(const UniformBufferDecl* ast) const
+{
+    return (explicitLayout_ && explicitLayout_->pushConstantBuffer == ast);
+}
+
+unsigned int GLSLGenerator::LocationCount(const VarType* typeAST, const VarDecl* ast) const
+{
+    return TypeLocationCount(ReflectTypeName(typeAST)) * std::max(1u, ArraySize(ast->arrayDims));
+}
+
+void GLSLGenerator::GenerateMinifiedNames(Program* ast)
+{
+    auto names = std::make_shared<MinifiedNames>();
+    auto& reserved = names->reserved;
+
+    /* Reserve all identifiers of the program, except local variables (which are always renamed) */
+    std::unordered_set<std::string> directiveIdents;
+
+    ForEachNode(
+        *ast,
+        [&](AST* node)
+        {
+            switch (node->Type())
+            {
+                case AST::Types::VarIdent:
+                {
+                    auto symbolRef = static_cast<VarIdent*>(node)->symbolRef;
+                    if (!symbolRef || symbolRef->Type() != AST::Types::VarDecl || !symbolRef->flags(VarDecl::isInsideFunc))
+                        reserved.insert(static_cast<VarIdent*>(node)->ident);
+                    break;
+                }
+                case AST::Types::VarDecl:
+                    if (!node->flags(VarDecl::isInsideFunc))
+                        reserved.insert(static_cast<VarDecl*>(node)->name);
+                    break;
+                case AST::Types::FunctionDecl:
+                    reserved.insert(static_cast<FunctionDecl*>(node)->name);
+                    break;
+                case AST::Types::Structure:
+                    reserved.insert(static_cast<Structure*>(node)->name);
+                    reserved.insert(static_cast<Structure*>(node)->aliasName);
+                    break;
+                case AST::Types::UniformBufferDecl:
+                    reserved.insert(static_cast<UniformBufferDecl*>(node)->name);
+                    break;
+                case AST::Types::BufferDeclIdent:
+                    reserved.insert(static_cast<BufferDeclIdent*>(node)->ident);
+                    break;
+                case AST::Types::TypeNameExpr:
+                    reserved.insert(static_cast<TypeNameExpr*>(node)->typeName);
+                    break;
+                case AST::Types::VarType:
+                    reserved.insert(static_cast<VarType*>(node)->baseType);
+                    break;
+                case AST::Types::VarSemantic:
+                    reserved.insert(static_cast<VarSemantic*>(node)->semantic);
+                    break;
+                case AST::Types::DirectiveDecl:
+                    InsertDirectiveIdents(static_cast<DirectiveDecl*>(node)->line, directiveIdents);
+                    break;
+                case AST::Types::DirectiveStmnt:
+                    InsertDirectiveIdents(static_cast<DirectiveStmnt*>(node)->line, directiveIdents);
+                    break;
+                default:
+                    break;
+            }
+        }
+    );
+
+    reserved.insert(directiveIdents.begin(), directiveIdents.end());
+
+    /* Reserve all names which are written by this generator (also the parameters of the helper functions) */
+    for (const auto& table : { &tables_->typeMap, &tables_->intrinsicMap, &tables_->atomicIntrinsicMap, &tables_->texFuncMap })
+    {
+        for (const auto& entry : *table)
+            reserved.insert(entry.second);
+    }
+
+    for (const auto& entry : tables_->modifierMap)
+        reserved.insert(entry.second);
+
+    for (const auto& name : StringList({ "rcp", "clip", "sincos", "x", "v", "m", "r", "s", "c" }))
+        reserved.insert(name);
+
+    /*
+    Generate short names for the referenced functions (all overloads share the same name),
+    but not for a common shader, whose functions may be called from another shader,
+    and not for functions which are referred to by a preprocessor directive.
+    The names are generated in source order, so they do not depend on the order of allocation.
+    */
+    if (shaderTarget_ != ShaderTargets::CommonShader)
+    {
+        std::size_t numNames = 0;
+
+        for (auto globDecl : ast->globalDecls)
+        {
+            if (globDecl->Type() != AST::Types::FunctionDecl)
+                continue;
+
+            auto funcDecl = static_cast<FunctionDecl*>(globDecl);
+            if ( !funcDecl->flags(FunctionDecl::isReferenced) || funcDecl->flags(FunctionDecl::isEntryPoint) || funcDecl->name == entryPoint_ ||
+                 directiveIdents.count(funcDecl->name) != 0 ||
+                 names->functions.count(funcDecl->name) != 0 )
+            {
+                continue;
+            }
+
+            std::string shortName;
+            do
+            {
+                shortName = ShortName(numNames++);
+            }
+            while (reserved.count(shortName) != 0 || IsGLSLReservedName(shortName));
+
+            names->functions[funcDecl->name] = shortName;
+        }
+
+        for (const auto& entry : names->functions)
+            reserved.insert(entry.second);
+    }
+
+    minifiedNames_ = names;
+}
+
+const std::string& GLSLGenerator::LocalName(const VarDecl* ast)
+{
+    auto it = localNames_.find(ast);
+    if (it != localNames_.end())
+        return it->second;
+
+    /* Generate next short name, which does not clash with other identifiers */
+    std::string shortName;
+    do
+    {
+        shortName = ShortName(numLocalNames_++);
+    }
+    while (minifiedNames_->reserved.count(shortName) != 0 || IsGLSLReservedName(shortName));
+
+    return (localNames_[ast] = std::move(shortName));
+}
+
+bool GLSLGenerator::HasLocalName(const VarDecl* ast) const
+{
+    /*
+    Variables which are written as interface block keep their names,
+    since the name of the interface block instance has already been determined by the analyzer
+    */
+    return ( minify_ && !ast->flags(VarDecl::disableCodeGen) &&
+             ( ast->flags(VarDecl::isInsideFunc) || localNames_.count(ast) != 0 ) );
+}
+
+const std::string* GLSLGenerator::FunctionName(const Ident& name) const
+{
+    if (minifiedNames_)
+    {
+        auto it = minifiedNames_->functions.find(name);
+        if (it != minifiedNames_->functions.end())
+            return &(it->second);
+    }
+    return nullptr;
+}
+
+/* --- Reflection --- */
+
+std::string GLSLGenerator::ReflectTypeName(const VarType* ast) const
+{
+    if (!ast->baseType.empty())
+    {
+        auto it = tables_->typeMap.find(ast->baseType);
+        return (it != tables_->typeMap.end() ? it->second : ast->baseType.Str());
+    }
+    else if (ast->structType)
+        return ast->structType->name;
+    return "";
+}
+
+GLSLGenerator::Std140Layout GLSLGenerator::ReflectTypeLayout(const VarType* ast) const
+{
+    Std140Layout layout;
+
+    /* Get structure of the type (either declared inside the type or referenced by its name) */
+    const Structure* structure = ast->structType;
+    if (!structure && ast->symbolRef && ast->symbolRef->Type() == AST::Types::Structure)
+        structure = static_cast<const Structure*>(ast->symbolRef);
+
+    if (structure)
+    {
+        /* Structures are aligned to the largest member alignment, rounded up to the size of a vec4 */
+        unsigned int offset = 0, maxAlign = 16;
+
+        for (const auto& member : structure->members)
+        {
+            for (const auto& varDecl : member->varDecls)
+            {
+                auto memberLayout = ReflectVarLayout(member->varType, varDecl);
+                offset      = RoundUp(offset, memberLayout.align) + memberLayout.size;
+                maxAlign    = std::max(maxAlign, memberLayout.align);
+            }
+        }
+
+        layout.align    = RoundUp(maxAlign, 16);
+        layout.size     = RoundUp(offset, layout.align);
+    }
+    else
+        Std140BaseTypeLayout(ReflectTypeName(ast), layout.align, layout.size);
+
+    return layout;
+}
+
+GLSLGenerator::Std140Layout GLSLGenerator::ReflectVarLayout(const VarType* typeAST, const VarDecl* ast) const
+{
+    auto layout = ReflectTypeLayout(typeAST);
+
+    if (!ast->arrayDims.empty())
+    {
+        /* The stride of array elements is rounded up to the size of a vec4 */
+        layout.align    = RoundUp(layout.align, 16);
+        layout.size     = ArraySize(ast->arrayDims) * RoundUp(layout.size, layout.align);
+    }
+
+    return layout;
+}
+
+unsigned int GLSLGenerator::ReflectUniformBufferSize(const UniformBufferDecl* ast) const
+{
+    unsigned int offset = 0;
+
+    for (const auto& member : ast->members)
+    {
+        for (const auto& varDecl : member->varDecls)
+        {
+            auto layout = ReflectVarLayout(member->varType, varDecl);
+            offset = RoundUp(offset, layout.align) + layout.size;
+        }
+    }
+
+    return RoundUp(offset, 16);
+}
+
+void GLSLGenerator::ReflectUniformBuffer(const UniformBufferDecl* ast, ShaderReflection& reflection) const
+{
+    ReflectionUniformBuffer buffer;
+    {
+        buffer.name         = ast->name;
+        buffer.pushConstant = IsPushConstantBuffer(ast);
+        buffer.binding      = (buffer.pushConstant ? -1 : ReflectBinding(ast, ast->registerName));
+    }
+
+    /* Determine member offsets as for the "std140" layout of the generated uniform block */
+    unsigned int offset = 0;
+
+    for (const auto& member : ast->members)
+    {
+        for (const auto& varDecl : member->varDecls)
+        {
+            auto layout = ReflectVarLayout(member->varType, varDecl);
+
+            ReflectionUniform uniform;
+            {
+                uniform.name        = varDecl->name;
+                uniform.type        = ReflectTypeName(member->varType);
+                uniform.arraySize   = ArraySize(varDecl->arrayDims);
+                uniform.offset      = RoundUp(offset, layout.align);
+                uniform.size        = layout.size;
+            }
+
+            for (const auto& semantic : varDecl->semantics)
+            {
+                if (semantic->packOffset)
+                {
+                    uniform.packOffset = semantic->packOffset->registerName;
+                    if (!semantic->packOffset->vectorComponent.empty())
+                        uniform.packOffset += "." + semantic->packOffset->vectorComponent;
+                }
+            }
+
+            offset = uniform.offset + uniform.size;
+            buffer.members.push_back(uniform);
+        }
+    }
+
+    buffer.size = RoundUp(offset, 16);
+
+    reflection.uniformBuffers.push_back(buffer);
+}
+
+void GLSLGenerator::ReflectInterface(const Structure* ast, ShaderReflection& reflection) const
+{
+    const bool isInput = ast->flags(Structure::isShaderInput);
+    if (!isInput && !ast->flags(Structure::isShaderOutput))
+        return;
+
+    /* Members of resolved structures are global variables, otherwise they are members of an interface block (see "Visit(Structure)") */
+    const bool resolveStruct = MustResolveStruct(ast);
+
+    auto& attributes = (isInput ? reflection.inputs : reflection.outputs);
+
+    /* Members of an interface block with an explicit location consume the following locations */
+    auto blockLocation = (resolveStruct ? -1 : ExplicitLocation(ast));
+
+    for (const auto& member : ast->members)
+    {
+        for (const auto& varDecl : member->varDecls)
+        {
+            if (varDecl->flags(VarDecl::disableCodeGen) || ( ( !resolveStruct || isInput || IsFlattenedStruct(ast) ) && HasSystemValueSemantic(varDecl->semantics) ))
+                continue;
+
+            ReflectionAttribute attribute;
+            {
+                attribute.name      = (resolveStruct ? ResolvedVarName(ast, varDecl) : interfaceBlockPrefix + ast->name + "." + varDecl->name);
+                attribute.type      = ReflectTypeName(member->varType);
+                attribute.semantic  = (varDecl->semantics.empty() ? "" : varDecl->semantics.front()->semantic);
+                attribute.location  = (resolveStruct ? ExplicitLocation(varDecl) : blockLocation);
+            }
+            attributes.push_back(attribute);
+
+            if (blockLocation >= 0)
+                blockLocation += static_cast<int>(LocationCount(member->varType, varDecl));
+        }
+    }
+}
+
+int GLSLGenerator::ReflectBinding(const AST* ast, const std::string& registerName) const
 {
-    return
-        ( shaderTarget_ == ShaderTargets::GLSLVertexShader && ast->flags(Structure::isShaderInput) ) ||
-        ( shaderTarget_ == ShaderTargets::GLSLFragmentShader && ast->flags(Structure::isShaderOutput) ) ||
-        ( shaderTarget_ == ShaderTargets::GLSLComputeShader && ( ast->flags(Structure::isShaderInput) || ast->flags(Structure::isShaderOutput) ) );
+    auto binding = ExplicitBinding(ast);
+    return (binding >= 0 ? binding : RegisterBinding(registerName));
 }
 
-bool GLSLGenerator::IsVersionOut(int version) const
+void GLSLGenerator::ReflectAttributeNumThreads(const FunctionCall* ast, ShaderReflection& reflection) const
 {
-    return static_cast<int>(versionOut_) >= version;
+    if (ast->arguments.size() == 3)
+    {
+        for (std::size_t i = 0; i < 3; ++i)
+            reflection.numThreads[i] = ExprToUInt(ast->arguments[i]);
+    }
 }
 
 /* ------- Visit functions ------- */
@@ -556,11 +1419,23 @@ IMPLEMENT_VISIT_PROC(Program)
 {
     program_ = ast;
 
+    if (minify_)
+        GenerateMinifiedNames(ast);
+
+    if ( ( explicitBinding_ && IsVersionOut(420) ) || IsVulkanOut() )
+        GenerateExplicitLayout(ast);
+    else
+        explicitLayout_.reset();
+
     /* Append required extensions first */
     AppendRequiredExtensions(ast);
 
-    /* Write 'gl_FragCoord' layout */
-    if (shaderTarget_ == ShaderTargets::GLSLFragmentShader)
+    /* GLSL ES has no default precision for floating-point types in fragment shaders */
+    if (IsESSLOut() && shaderTarget_ != ShaderTargets::CommonShader)
+        WriteDefaultPrecisions(ast);
+
+    /* Write 'gl_FragCoord' layout (Vulkan only supports the upper-left origin, which is the default, and GLSL ES can not redeclare it) */
+    if (shaderTarget_ == ShaderTargets::GLSLFragmentShader && !IsVulkanOut() && !IsESSLOut())
     {
         BeginLn();
         {
@@ -586,8 +1461,30 @@ IMPLEMENT_VISIT_PROC(Program)
     if (shaderTarget_ == ShaderTargets::GLSLFragmentShader)
         WriteFragmentShaderOutput();
 
-    for (auto& globDecl : ast->globalDecls)
-        Visit(globDecl);
+    /* Short names and explicit bindings are numbered across all declarations, so their output can not be re-used on its own */
+    auto outputCache = (minify_ || explicitLayout_ ? nullptr : outputCache_);
+
+    if (numThreads_ != 1 && !isStreaming_ && !streamHandler_ && !outputCache && ast->globalDecls.size() > 1)
+        VisitGlobalDeclsConcurrent(ast->globalDecls);
+    else
+    {
+        for (auto& globDecl : ast->globalDecls)
+        {
+            /* Let the stream handler prepare each declaration (e.g. parse its function body) and release it afterwards */
+            if (streamHandler_ && !streamHandler_->BeginGlobalDecl(globDecl))
+                throw std::runtime_error("preparing global declaration for code generation failed");
+
+            if (outputCache)
+                VisitGlobalDeclCached(globDecl, *outputCache);
+            else
+                Visit(globDecl);
+
+            if (streamHandler_)
+                streamHandler_->EndGlobalDecl(globDecl);
+
+            FlushStream();
+        }
+    }
 }
 
 IMPLEMENT_VISIT_PROC(CodeBlock)
@@ -598,7 +1495,10 @@ IMPLEMENT_VISIT_PROC(CodeBlock)
         OpenScope();
     
     for (auto& stmnt : ast->stmnts)
-        Visit(stmnt);
+    {
+        if (!stmnt->flags(Stmnt::isDeadCode))
+            Visit(stmnt);
+    }
     
     if (writeScope)
         CloseScope();
@@ -606,23 +1506,58 @@ IMPLEMENT_VISIT_PROC(CodeBlock)
 
 IMPLEMENT_VISIT_PROC(FunctionCall)
 {
+    /* Sampler objects are exchanged by their texture object only inside texture functions */
+    auto prevTexObjectIdent = texObjectIdent_;
+    texObjectIdent_ = (ast->flags(FunctionCall::isTexFunc) ? &ast->name->ident : nullptr);
+
     if (ast->flags(FunctionCall::isMulFunc) && ast->arguments.size() == 2)
     {
         /* Convert this function call into a multiplication */
-        Write("((");
-        Visit(ast->arguments[0]);
-        Write(") * (");
-        Visit(ast->arguments[1]);
-        Write("))");
+        if (minify_)
+        {
+            /* Only write the brackets which are required (none around a full expression, e.g. "p=m*v") */
+            bool isFullExpr = (args != nullptr ? *reinterpret_cast<bool*>(args) : false);
+
+            if (!isFullExpr)
+                Write("(");
+
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                auto arg = ast->arguments[i];
+
+                if (i > 0)
+                    Write(" * ");
+
+                if (IsPrimaryExprForGLSL(arg))
+                    Visit(arg);
+                else
+                {
+                    Write("(");
+                    VisitFullExpr(arg);
+                    Write(")");
+                }
+            }
+
+            if (!isFullExpr)
+                Write(")");
+        }
+        else
+        {
+            Write("((");
+            VisitFullExpr(ast->arguments[0]);
+            Write(") * (");
+            VisitFullExpr(ast->arguments[1]);
+            Write("))");
+        }
     }
     else if (ast->flags(FunctionCall::isTexFunc) && ast->name->next)
     {
         /* Get function name */
         const auto& inFuncName = ast->name->next->ident;
 
-        auto it = texFuncMap_.find(inFuncName);
-        if (it == texFuncMap_.end())
-            Error("texture member function \"" + inFuncName + "\" is not supported", ast);
+        auto it = tables_->texFuncMap.find(inFuncName);
+        if (it == tables_->texFuncMap.end())
+            Error(DiagnosticCodes::UnsupportedTexFunc, ast, inFuncName);
 
         const auto& funcName = it->second;
 
@@ -633,7 +1568,7 @@ IMPLEMENT_VISIT_PROC(FunctionCall)
         {
             const auto& arg = ast->arguments[i];
             
-            Visit(arg);
+            VisitFullExpr(arg);
             if (i + 1 < ast->arguments.size())
                 Write(", ");
         }
@@ -643,8 +1578,8 @@ IMPLEMENT_VISIT_PROC(FunctionCall)
     else if (ast->flags(FunctionCall::isAtomicFunc) && ast->arguments.size() >= 2)
     {
         /* Find atomic intrinsic mapping */
-        auto it = atomicIntrinsicMap_.find(ast->name->ident);
-        if (it != atomicIntrinsicMap_.end())
+        auto it = tables_->atomicIntrinsicMap.find(ast->name->ident);
+        if (it != tables_->atomicIntrinsicMap.end())
         {
             /* Write function call */
             if (ast->arguments.size() >= 3)
@@ -653,53 +1588,52 @@ IMPLEMENT_VISIT_PROC(FunctionCall)
                 Write(" = ");
             }
             Write(it->second + "(");
-            Visit(ast->arguments[0]);
+            VisitFullExpr(ast->arguments[0]);
             Write(", ");
-            Visit(ast->arguments[1]);
+            VisitFullExpr(ast->arguments[1]);
             Write(")");
         }
         else
-            Error("unknown interlocked intrinsic \"" + ast->name->ident + "\"", ast);
+            Error(DiagnosticCodes::UnknownInterlockedIntrinsic, ast, ast->name->ident);
     }
     else
     {
         /* Write function name */
-        auto name = FullVarIdent(ast->name);
+        auto name = FindFullVarIdent(ast->name);
 
-        auto it = intrinsicMap_.find(name);
-        if (it != intrinsicMap_.end())
+        auto it = tables_->intrinsicMap.find(name);
+        if (it != tables_->intrinsicMap.end())
             Write(it->second);
         else
         {
-            auto it = typeMap_.find(name);
-            if (it != typeMap_.end())
-                Write(it->second);
+            auto it = tables_->typeMap.find(name);
+            if (it != tables_->typeMap.end())
+                WriteTypeName(it->second, name, ast);
+            else if (auto shortName = (ast->name->next ? nullptr : FunctionName(ast->name->ident)))
+                Write(*shortName);
             else
                 Visit(ast->name);
         }
 
         /*
-        Remove arguments which contain a sampler state object,
+        Skip arguments which contain a sampler state object,
         since GLSL does not support sampler states.
         --> Only "Texture2D" will be mapped to "sampler2D",
             but "SamplerState" can not be translated.
         */
-        for (auto it = ast->arguments.begin(); it != ast->arguments.end();)
-        {
-            if (ExprContainsSampler(it->get()))
-                it = ast->arguments.erase(it);
-            else
-                ++it;
-        }
-
-        /* Write arguments */
         Write("(");
 
-        for (size_t i = 0; i < ast->arguments.size(); ++i)
+        bool isFirstArg = true;
+        for (auto& arg : ast->arguments)
         {
-            Visit(ast->arguments[i]);
-            if (i + 1 < ast->arguments.size())
+            if (ExprContainsSampler(arg))
+                continue;
+
+            if (!isFirstArg)
                 Write(", ");
+            isFirstArg = false;
+
+            VisitFullExpr(arg);
         }
 
         /* Check for special cases */
@@ -708,6 +1642,8 @@ IMPLEMENT_VISIT_PROC(FunctionCall)
 
         Write(")");
     }
+
+    texObjectIdent_ = prevTexObjectIdent;
 }
 
 IMPLEMENT_VISIT_PROC(Structure)
@@ -729,8 +1665,13 @@ IMPLEMENT_VISIT_PROC(Structure)
 
         OpenScope();
         {
+            auto isInsideStructDecl = isInsideStructDecl_;
+            isInsideStructDecl_ = true;
+
             for (auto& varDecl : ast->members)
                 Visit(varDecl);
+
+            isInsideStructDecl_ = isInsideStructDecl;
         }
         CloseScope(semicolon);
     }
@@ -738,6 +1679,10 @@ IMPLEMENT_VISIT_PROC(Structure)
     /* Write structure members as global input/output variables (if structure must be resolved) */
     if (resolveStruct)
     {
+        /* Flattened structures keep their system values in the structure variable */
+        if (IsFlattenedStruct(ast))
+            flattenedStruct_ = ast;
+
         for (auto& member : ast->members)
         {
             /* Append struct input/output flag to member */
@@ -748,12 +1693,25 @@ IMPLEMENT_VISIT_PROC(Structure)
 
             Visit(member);
         }
+
+        flattenedStruct_ = nullptr;
+
+        /* Write the flattened vertex output structure as global variable, which is copied to the outputs on return */
+        if (IsFlattenedStruct(ast) && ast->flags(Structure::isShaderOutput) && !ast->aliasName.empty())
+        {
+            Blank();
+            WriteLn(ast->name + " " + ast->aliasName + ";");
+        }
     }
-    /* Write this structure as interface block (if structure doesn't need to be resolved) */
-    else if (ast->flags(Structure::isShaderInput) || ast->flags(Structure::isShaderOutput))
+    /* Write this structure as interface block (if structure doesn't need to be resolved and it has any members) */
+    else if ( ( ast->flags(Structure::isShaderInput) || ast->flags(Structure::isShaderOutput) ) && !IsEmptyInterfaceBlock(ast) )
     {
         BeginLn();
         {
+            auto location = ExplicitLocation(ast);
+            if (location >= 0)
+                Write("layout(location = " + std::to_string(location) + ") ");
+
             if (ast->flags(Structure::isShaderInput))
                 Write("in");
             else
@@ -785,7 +1743,7 @@ IMPLEMENT_VISIT_PROC(SwitchCase)
         BeginLn();
         {
             Write("case ");
-            Visit(ast->expr);
+            VisitFullExpr(ast->expr);
             Write(":");
         }
         EndLn();
@@ -797,7 +1755,10 @@ IMPLEMENT_VISIT_PROC(SwitchCase)
     IncTab();
     {
         for (auto& stmnt : ast->stmnts)
-            Visit(stmnt);
+        {
+            if (!stmnt->flags(Stmnt::isDeadCode))
+                Visit(stmnt);
+        }
     }
     DecTab();
 }
@@ -813,7 +1774,11 @@ IMPLEMENT_VISIT_PROC(FunctionDecl)
 
     /* Write attributes */
     for (auto& attrib : ast->attribs)
-        VisitAttribute(attrib.get());
+        VisitAttribute(attrib);
+
+    /* Each function has its own short names for parameters and local variables */
+    localNames_.clear();
+    numLocalNames_ = 0;
 
     /* Write function header */
     BeginLn();
@@ -822,29 +1787,28 @@ IMPLEMENT_VISIT_PROC(FunctionDecl)
             Write("void main()");
         else
         {
+            auto shortName = FunctionName(ast->name);
+
             Visit(ast->returnType);
-            Write(" " + ast->name + "(");
+            Write(" " + (shortName ? *shortName : ast->name.Str()) + "(");
 
             /*
-            Remove parameters which contain a sampler state object,
+            Skip parameters which contain a sampler state object,
             since GLSL does not support sampler states.
             --> Only "Texture2D" will be mapped to "sampler2D",
                 but "SamplerState" can not be translated.
             */
-            for (auto it = ast->parameters.begin(); it != ast->parameters.end();)
+            bool isFirstParam = true;
+            for (auto& param : ast->parameters)
             {
-                if (VarTypeIsSampler((*it)->varType.get()))
-                    it = ast->parameters.erase(it);
-                else
-                    ++it;
-            }
+                if (VarTypeIsSampler(param->varType))
+                    continue;
 
-            /* Write parameters */
-            for (size_t i = 0; i < ast->parameters.size(); ++i)
-            {
-                VisitParameter(ast->parameters[i].get());
-                if (i + 1 < ast->parameters.size())
+                if (!isFirstParam)
                     Write(", ");
+                isFirstParam = false;
+
+                VisitParameter(param);
             }
 
             Write(")");
@@ -901,10 +1865,17 @@ IMPLEMENT_VISIT_PROC(UniformBufferDecl)
 
     BeginLn();
     {
-        Write("layout(std140");
-
-        if (!ast->registerName.empty())
-            Write(", binding = " + BRegister(ast->registerName));
+        auto binding = ExplicitBinding(ast);
+        if (IsPushConstantBuffer(ast))
+            Write("layout(push_constant, std140");
+        else
+        {
+            Write("layout(std140");
+            if (binding >= 0)
+                Write(", " + BindingQualifier(std::to_string(binding)));
+            else if (!ast->registerName.empty() && HasBindingQualifiers())
+                Write(", " + BindingQualifier(BRegister(ast->registerName)));
+        }
 
         Write(") uniform ");
         Write(ast->name);
@@ -927,12 +1898,20 @@ IMPLEMENT_VISIT_PROC(TextureDecl)
         return; // texture not used
 
     /* Determine GLSL sampler type */
-    auto it = typeMap_.find(ast->textureType);
-    if (it == typeMap_.end())
-        Error("texture type \"" + ast->textureType + "\" not supported yet", ast);
+    auto it = tables_->typeMap.find(ast->textureType);
+    if (it == tables_->typeMap.end())
+        Error(DiagnosticCodes::UnsupportedTextureType, ast, ast->textureType);
 
     auto samplerType = it->second;
 
+    /* GLSL ES has no 1D textures, cube map arrays and multi-sampled array textures, and multi-sampled textures require version 3.10 */
+    if ( IsESSLOut() &&
+         ( samplerType == "sampler1D" || samplerType == "sampler1DArray" || samplerType == "samplerCubeArray" ||
+           samplerType == "sampler2DMSArray" || ( samplerType == "sampler2DMS" && !IsVersionOut(420) ) ) )
+    {
+        Error(DiagnosticCodes::UnsupportedTextureType, ast, ast->textureType);
+    }
+
     /* Write texture samplers */
     for (auto& name : ast->names)
     {
@@ -940,8 +1919,11 @@ IMPLEMENT_VISIT_PROC(TextureDecl)
         {
             BeginLn();
             {
-                if (!name->registerName.empty())
-                    Write("layout(binding = " + TRegister(name->registerName) + ") ");
+                auto binding = ExplicitBinding(name);
+                if (binding >= 0)
+                    Write("layout(" + BindingQualifier(std::to_string(binding)) + ") ");
+                else if (!name->registerName.empty() && HasBindingQualifiers())
+                    Write("layout(" + BindingQualifier(TRegister(name->registerName)) + ") ");
                 Write("uniform " + samplerType + " " + name->ident + ";");
             }
             EndLn();
@@ -996,9 +1978,9 @@ IMPLEMENT_VISIT_PROC(ForLoopStmnt)
         {
             Visit(ast->initSmnt);
             Write(" "); // initStmnt already has the ';'!
-            Visit(ast->condition);
+            VisitFullExpr(ast->condition);
             Write("; ");
-            Visit(ast->iteration);
+            VisitFullExpr(ast->iteration);
         }
         PopOptions();
 
@@ -1006,7 +1988,7 @@ IMPLEMENT_VISIT_PROC(ForLoopStmnt)
     }
     EndLn();
 
-    VisitScopedStmnt(ast->bodyStmnt.get());
+    VisitScopedStmnt(ast->bodyStmnt);
 }
 
 IMPLEMENT_VISIT_PROC(WhileLoopStmnt)
@@ -1015,24 +1997,24 @@ IMPLEMENT_VISIT_PROC(WhileLoopStmnt)
     BeginLn();
     {
         Write("while (");
-        Visit(ast->condition);
+        VisitFullExpr(ast->condition);
         Write(")");
     }
     EndLn();
 
-    VisitScopedStmnt(ast->bodyStmnt.get());
+    VisitScopedStmnt(ast->bodyStmnt);
 }
 
 IMPLEMENT_VISIT_PROC(DoWhileLoopStmnt)
 {
     WriteLn("do");
-    VisitScopedStmnt(ast->bodyStmnt.get());
+    VisitScopedStmnt(ast->bodyStmnt);
 
     /* Write loop condition */
     BeginLn();
     {
         Write("while (");
-        Visit(ast->condition);
+        VisitFullExpr(ast->condition);
         Write(");");
     }
     EndLn();
@@ -1042,25 +2024,52 @@ IMPLEMENT_VISIT_PROC(IfStmnt)
 {
     bool hasElseParentNode = (args != nullptr ? *reinterpret_cast<bool*>(&args) : false);
 
+    /* Only write the live branch, if the condition is constant (see "DeadCodeEliminator"); the branch may be a removed assignment */
+    if (ast->flags(IfStmnt::isConstTrue))
+    {
+        if (!ast->bodyStmnt->flags(Stmnt::isDeadCode))
+            Visit(ast->bodyStmnt);
+        return;
+    }
+    if (ast->flags(IfStmnt::isConstFalse))
+    {
+        if (ast->elseStmnt && !ast->elseStmnt->bodyStmnt->flags(Stmnt::isDeadCode))
+            Visit(ast->elseStmnt->bodyStmnt);
+        return;
+    }
+
     /* Write if condition */
     if (!hasElseParentNode)
         BeginLn();
     
     Write("if (");
-    Visit(ast->condition);
+    VisitFullExpr(ast->condition);
     Write(")");
     
     EndLn();
 
     /* Write if body */
-    VisitScopedStmnt(ast->bodyStmnt.get());
+    VisitScopedStmnt(ast->bodyStmnt);
 
     Visit(ast->elseStmnt);
 }
 
 IMPLEMENT_VISIT_PROC(ElseStmnt)
 {
-    if (ast->bodyStmnt->Type() == AST::Types::IfStmnt)
+    auto elseIfStmnt = (ast->bodyStmnt->Type() == AST::Types::IfStmnt ? static_cast<IfStmnt*>(ast->bodyStmnt) : nullptr);
+
+    if (elseIfStmnt && elseIfStmnt->flags(IfStmnt::isConstTrue))
+    {
+        /* Write constant true 'else if' statement as else statement */
+        WriteLn("else");
+        VisitScopedStmnt(elseIfStmnt->bodyStmnt);
+    }
+    else if (elseIfStmnt && elseIfStmnt->flags(IfStmnt::isConstFalse))
+    {
+        /* Skip constant false 'else if' statement */
+        Visit(elseIfStmnt->elseStmnt);
+    }
+    else if (elseIfStmnt)
     {
         /* Write else if statement */
         BeginLn();
@@ -1073,7 +2082,7 @@ IMPLEMENT_VISIT_PROC(ElseStmnt)
     {
         /* Write else statement */
         WriteLn("else");
-        VisitScopedStmnt(ast->bodyStmnt.get());
+        VisitScopedStmnt(ast->bodyStmnt);
     }
 }
 
@@ -1083,7 +2092,7 @@ IMPLEMENT_VISIT_PROC(SwitchStmnt)
     BeginLn();
     {
         Write("switch (");
-        Visit(ast->selector);
+        VisitFullExpr(ast->selector);
         Write(")");
     }
     EndLn();
@@ -1105,10 +2114,11 @@ IMPLEMENT_VISIT_PROC(VarDeclStmnt)
     {
         /*
         First check if code generation is disabled for variable declaration,
-        then check if this is a system value semantic inside an interface block.
+        then check if this is a system value semantic inside an interface block (or a flattened structure),
+        or a system value of a shader input structure (which is read from the GL built-in variable).
         */
         if ( (*it)->flags(VarDecl::disableCodeGen) ||
-             ( isInsideInterfaceBlock_ && HasSystemValueSemantic((*it)->semantics) ) )
+             ( ( isInsideInterfaceBlock_ || flattenedStruct_ || ast->flags(VarDeclStmnt::isShaderInput) ) && HasSystemValueSemantic((*it)->semantics) ) )
         {
             /*
             Code generation is disabled for this variable declaration
@@ -1129,59 +2139,24 @@ IMPLEMENT_VISIT_PROC(VarDeclStmnt)
         return;
     }
 
-    BeginLn();
-
-    /* Write modifiers */
-    if (ast->flags(VarDeclStmnt::isShaderInput))
-        Write("in ");
-    else if (ast->flags(VarDeclStmnt::isShaderOutput))
-        Write("out ");
-
-    for (const auto& modifier : ast->storageModifiers)
-    {
-        auto it = modifierMap_.find(modifier);
-        if (it != modifierMap_.end())
-            Write(it->second + " ");
-    }
-
-    for (const auto& modifier : ast->typeModifiers)
-    {
-        if (modifier == "const")
-            Write(modifier + " ");
-    }
-
-    /* Write variable type */
-    if (ast->varType->structType)
+    if ( explicitLayout_ && varDecls.size() > 1 && !ast->varType->structType &&
+         ( ast->flags(VarDeclStmnt::isShaderInput) || ast->flags(VarDeclStmnt::isShaderOutput) ) )
     {
-        EndLn();
-        Visit(ast->varType);
-        BeginLn();
+        /* Write each shader input/output separately, since a location qualifier applies to all variables of a declaration */
+        for (const auto& varDecl : varDecls)
+            WriteVarDeclStmnt(ast, { varDecl });
     }
     else
-    {
-        Visit(ast->varType);
-        Write(" ");
-    }
-
-    /* Write variable declarations */
-    for (size_t i = 0; i < varDecls.size(); ++i)
-    {
-        Visit(varDecls[i]);
-        if (i + 1 < varDecls.size())
-            Write(", ");
-    }
-
-    Write(";");
-    EndLn();
+        WriteVarDeclStmnt(ast, varDecls);
 }
 
 IMPLEMENT_VISIT_PROC(AssignStmnt)
 {
     BeginLn();
     {
-        WriteVarIdent(ast->varIdent.get());
+        WriteVarIdent(ast->varIdent);
         Write(" " + ast->op + " ");
-        Visit(ast->expr);
+        VisitFullExpr(ast->expr);
         Write(";");
     }
     EndLn();
@@ -1191,7 +2166,7 @@ IMPLEMENT_VISIT_PROC(ExprStmnt)
 {
     BeginLn();
     {
-        Visit(ast->expr);
+        VisitFullExpr(ast->expr);
         Write(";");
     }
     EndLn();
@@ -1215,7 +2190,7 @@ IMPLEMENT_VISIT_PROC(ReturnStmnt)
         {
             OpenScope();
             {
-                WriteEntryPointOutputSemantics(ast->expr.get());
+                WriteEntryPointOutputSemantics(ast->expr);
                 WriteLn("return;");
             }
             CloseScope();
@@ -1232,7 +2207,7 @@ IMPLEMENT_VISIT_PROC(ReturnStmnt)
             if (ast->expr)
             {
                 Write(" ");
-                Visit(ast->expr);
+                VisitFullExpr(ast->expr);
             }
 
             Write(";");
@@ -1262,15 +2237,18 @@ IMPLEMENT_VISIT_PROC(LiteralExpr)
 
 IMPLEMENT_VISIT_PROC(TypeNameExpr)
 {
-    auto it = typeMap_.find(ast->typeName);
-    if (it != typeMap_.end())
-        Write(it->second);
+    auto it = tables_->typeMap.find(ast->typeName);
+    if (it != tables_->typeMap.end())
+        WriteTypeName(it->second, ast->typeName, ast);
     else
         Write(ast->typeName);
 }
 
 IMPLEMENT_VISIT_PROC(TernaryExpr)
 {
+    if (WriteConstValue(ast))
+        return;
+
     Visit(ast->condition);
     Write(" ? ");
     Visit(ast->ifExpr);
@@ -1280,13 +2258,30 @@ IMPLEMENT_VISIT_PROC(TernaryExpr)
 
 IMPLEMENT_VISIT_PROC(BinaryExpr)
 {
-    Visit(ast->lhsExpr);
-    Write(" " + ast->op + " ");
-    Visit(ast->rhsExpr);
+    /* Write the binary expression chain iteratively (see HLSLParser::ParseExpr) */
+    ExprPtr expr = ast;
+
+    while (expr && expr->Type() == AST::Types::BinaryExpr)
+    {
+        auto binExpr = static_cast<BinaryExpr*>(expr);
+
+        if (WriteConstValue(binExpr))
+            return;
+
+        Visit(binExpr->lhsExpr);
+        Write(" " + binExpr->op + " ");
+
+        expr = binExpr->rhsExpr;
+    }
+
+    Visit(expr);
 }
 
 IMPLEMENT_VISIT_PROC(UnaryExpr)
 {
+    if (WriteConstValue(ast))
+        return;
+
     Write(ast->op);
     Visit(ast->expr);
 }
@@ -1299,11 +2294,24 @@ IMPLEMENT_VISIT_PROC(PostUnaryExpr)
 
 IMPLEMENT_VISIT_PROC(FunctionCallExpr)
 {
-    Visit(ast->call);
+    if (WriteConstValue(ast))
+        return;
+
+    Visit(ast->call, args);
 }
 
 IMPLEMENT_VISIT_PROC(BracketExpr)
 {
+    if (WriteConstValue(ast))
+        return;
+
+    if (minify_ && IsPrimaryExprForGLSL(ast->expr))
+    {
+        /* Drop redundant brackets */
+        Visit(ast->expr);
+        return;
+    }
+
     Write("(");
     Visit(ast->expr);
     Write(")");
@@ -1311,19 +2319,25 @@ IMPLEMENT_VISIT_PROC(BracketExpr)
 
 IMPLEMENT_VISIT_PROC(CastExpr)
 {
+    if (WriteConstValue(ast))
+        return;
+
     Visit(ast->typeExpr);
     Write("(");
-    Visit(ast->expr);
+    VisitFullExpr(ast->expr);
     Write(")");
 }
 
 IMPLEMENT_VISIT_PROC(VarAccessExpr)
 {
-    WriteVarIdent(ast->varIdent.get());
+    if (WriteConstValue(ast))
+        return;
+
+    WriteVarIdent(ast->varIdent);
     if (ast->assignExpr)
     {
         Write(" " + ast->assignOp + " ");
-        Visit(ast->assignExpr);
+        VisitFullExpr(ast->assignExpr);
     }
 }
 
@@ -1333,7 +2347,7 @@ IMPLEMENT_VISIT_PROC(InitializerExpr)
         
     for (size_t i = 0; i < ast->exprs.size(); ++i)
     {
-        Visit(ast->exprs[i]);
+        VisitFullExpr(ast->exprs[i]);
         if (i + 1 < ast->exprs.size())
             Write(", ");
     }
@@ -1356,13 +2370,18 @@ IMPLEMENT_VISIT_PROC(VarType)
     if (!ast->baseType.empty())
     {
         /* Write GLSL base type */
-        auto typeName = ast->baseType;
+        auto it = tables_->typeMap.find(ast->baseType);
+        const auto& typeName = (it != tables_->typeMap.end() ? it->second : ast->baseType.Str());
 
-        auto it = typeMap_.find(typeName);
-        if (it != typeMap_.end())
-            typeName = it->second;
+        /* Write precision qualifier of half and minimum precision types */
+        if (IsESSLOut())
+        {
+            auto precision = tables_->precisionMap.find(ast->baseType);
+            if (precision != tables_->precisionMap.end())
+                Write(precision->second + " ");
+        }
 
-        Write(typeName);
+        WriteTypeName(typeName, ast->baseType, ast);
     }
     else if (ast->structType)
         Visit(ast->structType);
@@ -1371,13 +2390,31 @@ IMPLEMENT_VISIT_PROC(VarType)
 IMPLEMENT_VISIT_PROC(VarIdent)
 {
     /* Write single identifier */
-    Write(ast->ident);
+    auto symbolRef = ast->symbolRef;
+
+    if (symbolRef && symbolRef->Type() == AST::Types::VarDecl && HasLocalName(static_cast<VarDecl*>(symbolRef)))
+    {
+        /* Write short name of local variables and parameters */
+        Write(LocalName(static_cast<VarDecl*>(symbolRef)));
+    }
+    else if (symbolRef && symbolRef->Type() == AST::Types::VarDecl && symbolRef->flags(VarDecl::isInsideFunc))
+    {
+        /* Append prefix to local variables */
+        Write(localVarPrefix_ + ast->ident);
+    }
+    else if (symbolRef && symbolRef->Type() == AST::Types::SamplerDecl && texObjectIdent_)
+    {
+        /* Exchange sampler object by its respective texture object */
+        Write(*texObjectIdent_);
+    }
+    else
+        Write(ast->ident);
 
     /* Write array index expressions */
     for (auto& index : ast->arrayIndices)
     {
         Write("[");
-        Visit(index);
+        VisitFullExpr(index);
         Write("]");
     }
 
@@ -1390,22 +2427,29 @@ IMPLEMENT_VISIT_PROC(VarIdent)
 
 IMPLEMENT_VISIT_PROC(VarDecl)
 {
-    if (ast->flags(VarDecl::isInsideFunc))
-        Write(localVarPrefix_);
-    
-    Write(ast->name);
+    if (HasLocalName(ast))
+        Write(LocalName(ast));
+    else if (flattenedStruct_)
+        Write(ResolvedVarName(flattenedStruct_, ast));
+    else
+    {
+        if (ast->flags(VarDecl::isInsideFunc))
+            Write(localVarPrefix_);
+        
+        Write(ast->name);
+    }
 
     for (auto& dim : ast->arrayDims)
     {
         Write("[");
-        Visit(dim);
+        VisitFullExpr(dim);
         Write("]");
     }
 
     if (ast->initializer)
     {
         Write(" = ");
-        Visit(ast->initializer);
+        VisitFullExpr(ast->initializer);
     }
 }
 
@@ -1450,8 +2494,12 @@ void GLSLGenerator::WriteEntryPointParameter(VarDeclStmnt* ast, size_t& writtenP
 {
     /* Get variable declaration */
     if (ast->varDecls.size() != 1)
-        Error("invalid number of variables inside parameter of entry point", ast);
-    auto varDecl = ast->varDecls.front().get();
+        Error(DiagnosticCodes::InvalidEntryPointParamVars, ast);
+    auto varDecl = ast->varDecls.front();
+
+    /* Skip the parameters which are never used (see "DeadCodeEliminator") */
+    if (varDecl->flags(VarDecl::disableCodeGen))
+        return;
 
     /* Check if a structure input is used */
     auto typeRef = ast->varType->symbolRef;
@@ -1472,11 +2520,29 @@ void GLSLGenerator::WriteEntryPointParameter(VarDeclStmnt* ast, size_t& writtenP
             }
             EndLn();
 
-            /* Fill structure members */
+            /* Fill structure members (system values are filled from the GL built-in variables) */
+            const bool isFlattened = IsFlattenedStruct(structType);
+
             for (const auto& member : structType->members)
             {
                 for (const auto& memberVar : member->varDecls)
-                    WriteLn(varDecl->name + "." + memberVar->name + " = " + memberVar->name + ";");
+                {
+                    if (HasSystemValueSemantic(memberVar->semantics))
+                    {
+                        SemanticStage semanticStage;
+                        if (FetchSemantic(memberVar->semantics.front()->semantic, semanticStage) && !semanticStage[shaderTarget_].empty())
+                        {
+                            /* Integral built-in variables (e.g. "gl_VertexID") are signed, but the HLSL system values are unsigned */
+                            auto value = semanticStage[shaderTarget_];
+                            if (member->varType->baseType == "uint" || member->varType->baseType == "dword")
+                                value = "uint(" + value + ")";
+
+                            WriteLn(varDecl->name + "." + memberVar->name + " = " + value + ";");
+                        }
+                    }
+                    else if (!isFlattened || !memberVar->flags(VarDecl::disableCodeGen))
+                        WriteLn(varDecl->name + "." + memberVar->name + " = " + ResolvedVarName(structType, memberVar) + ";");
+                }
             }
 
             ++writtenParamCounter;
@@ -1486,7 +2552,7 @@ void GLSLGenerator::WriteEntryPointParameter(VarDeclStmnt* ast, size_t& writtenP
     {
         /* Get single semantic */
         if (varDecl->semantics.size() != 1)
-            Error("invalid number of semantics inside parameter fo entry point", varDecl);
+            Error(DiagnosticCodes::InvalidEntryPointParamSemantics, varDecl);
         auto semantic = varDecl->semantics.front()->semantic;
 
         /* Map semantic to GL built-in constant */
@@ -1527,19 +2593,105 @@ void GLSLGenerator::WriteEntryPointOutputSemantics(Expr* ast)
         BeginLn();
         {
             Write(outp.singleOutputVariable + " = ");
-            Visit(ast);
+            VisitFullExpr(ast);
             Write(";");
         }
         EndLn();
     }
     else if (outp.returnType->symbolRef)
     {
+        auto structType = dynamic_cast<Structure*>(outp.returnType->symbolRef);
+        if (structType && IsFlattenedStruct(structType) && !structType->aliasName.empty())
+        {
+            /* Copy the returned structure into the flattened output variables */
+            for (const auto& member : structType->members)
+            {
+                for (const auto& memberVar : member->varDecls)
+                {
+                    if (!memberVar->flags(VarDecl::disableCodeGen) && !HasSystemValueSemantic(memberVar->semantics))
+                        WriteLn(ResolvedVarName(structType, memberVar) + " = " + structType->aliasName + "." + memberVar->name + ";");
+                }
+            }
+        }
         
         //!TODO!
         
     }
 }
 
+void GLSLGenerator::VisitGlobalDeclsConcurrent(const std::vector<GlobalDeclPtr>& globalDecls)
+{
+    /* Split declarations into more contiguous chunks than threads, so the work-stealing thread pool can balance large declarations */
+    const auto numThreads   = (numThreads_ > 0 ? numThreads_ : std::max(1u, std::thread::hardware_concurrency()));
+    const auto numChunks    = std::min(globalDecls.size(), static_cast<std::size_t>(numThreads) * 4);
+
+    std::vector<std::string> outputs(numChunks);
+    std::vector<std::exception_ptr> errors(numChunks);
+
+    ParallelFor(
+        numChunks, numThreads,
+        [&](std::size_t chunk)
+        {
+            /* Generate the chunk with a copy of this generator, which writes into the buffer of this chunk */
+            GLSLGenerator generator(*this);
+            generator.writer_.OutputBuffer(outputs[chunk]);
+
+            const auto begin    = globalDecls.size() * chunk / numChunks;
+            const auto end      = globalDecls.size() * (chunk + 1) / numChunks;
+
+            try
+            {
+                for (auto i = begin; i < end; ++i)
+                    generator.Visit(globalDecls[i]);
+            }
+            catch (...)
+            {
+                errors[chunk] = std::current_exception();
+            }
+        }
+    );
+
+    /* Concatenate outputs in source order and stop at the first error (like the sequential code generation) */
+    for (std::size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        Write(outputs[chunk]);
+        if (errors[chunk])
+            std::rethrow_exception(errors[chunk]);
+    }
+}
+
+void GLSLGenerator::VisitGlobalDeclCached(GlobalDecl* ast, DeclOutputCache& outputCache)
+{
+    /* The entry point depends on the input and output semantics of the entire program, so it is always generated */
+    const bool isEntryPoint = (ast->Type() == AST::Types::FunctionDecl && ast->flags(FunctionDecl::isEntryPoint));
+
+    if (!isEntryPoint)
+    {
+        if (auto output = outputCache.CachedOutput(ast))
+        {
+            Write(*output);
+            return;
+        }
+    }
+
+    /* Generate the declaration and pass its output to the cache */
+    const auto begin = writer_.BufferSize();
+
+    Visit(ast);
+
+    if (!isEntryPoint)
+        outputCache.StoreOutput(ast, writer_.Buffer().substr(begin));
+}
+
+void GLSLGenerator::FlushStream()
+{
+    if (isStreaming_)
+    {
+        outputSize_ += writer_.BufferSize();
+        writer_.Flush();
+    }
+}
+
 void GLSLGenerator::WriteFragmentShaderOutput()
 {
     auto& outp = program_->outputSemantics;
@@ -1552,7 +2704,7 @@ void GLSLGenerator::WriteFragmentShaderOutput()
         if (outp.returnType->symbolRef && outp.returnType->symbolRef->Type() == AST::Types::Structure)
             structAST = dynamic_cast<Structure*>(outp.returnType->symbolRef);
         else if (outp.returnType->structType)
-            structAST = outp.returnType->structType.get();
+            structAST = outp.returnType->structType;
 
         if (structAST)
         {
@@ -1588,10 +2740,10 @@ void GLSLGenerator::WriteFragmentShaderOutput()
             else if (semantic.fragment == "gl_FragDepth")
                 outp.singleOutputVariable = semantic.fragment;
             else
-                Error("invalid output semantic for pixel shader: \"" + outp.functionSemantic + "\"");
+                Error(DiagnosticCodes::InvalidPixelShaderOutputSemantic, nullptr, outp.functionSemantic);
         }
         else
-            Error("unknown shader output semantic: \"" + outp.functionSemantic + "\"");
+            Error(DiagnosticCodes::UnknownOutputSemantic, nullptr, outp.functionSemantic);
     }
 
     Blank();
@@ -1606,33 +2758,89 @@ VarIdent* GLSLGenerator::FirstSystemSemanticVarIdent(VarIdent* ast)
 
     /* Search in next var-ident AST node */
     if (ast->next)
-        return FirstSystemSemanticVarIdent(ast->next.get());
+        return FirstSystemSemanticVarIdent(ast->next);
 
     return nullptr;
 }
 
-void GLSLGenerator::WriteVarIdent(VarIdent* ast)
-{
-    /* Find system value semantic in variable identifier */
-    SemanticStage semantic;
-    auto semanticVarIdent = FirstSystemSemanticVarIdent(ast);
+void GLSLGenerator::WriteVarIdent(VarIdent* ast)
+{
+    /* Find system value semantic in variable identifier */
+    SemanticStage semantic;
+    auto semanticVarIdent = FirstSystemSemanticVarIdent(ast);
+
+    if (semanticVarIdent && FetchSemantic(semanticVarIdent->systemSemantic, semantic))
+    {
+        /* Write shader target respective system semantic */
+        Write(semantic[shaderTarget_]);
+
+        if (semanticVarIdent->next)
+        {
+            Write(".");
+            Visit(semanticVarIdent->next);
+        }
+    }
+    else
+    {
+        /* Write default variable identifier */
+        Visit(ast);
+    }
+}
+
+void GLSLGenerator::WriteVarDeclStmnt(VarDeclStmnt* ast, const std::vector<VarDeclPtr>& varDecls)
+{
+    BeginLn();
+
+    /* Write modifiers */
+    if (ast->flags(VarDeclStmnt::isShaderInput) || ast->flags(VarDeclStmnt::isShaderOutput))
+    {
+        auto location = ExplicitLocation(varDecls.front());
+        if (location >= 0)
+            Write("layout(location = " + std::to_string(location) + ") ");
+    }
+
+    /* Interpolation qualifiers precede the storage qualifiers (GLSL ES requires this order) */
+    for (const auto& modifier : ast->storageModifiers)
+    {
+        auto it = tables_->modifierMap.find(modifier);
+        if (it != tables_->modifierMap.end() && !isInsideStructDecl_)
+            Write(it->second + " ");
+    }
 
-    if (semanticVarIdent && FetchSemantic(semanticVarIdent->systemSemantic, semantic))
+    if (ast->flags(VarDeclStmnt::isShaderInput))
+        Write("in ");
+    else if (ast->flags(VarDeclStmnt::isShaderOutput))
+        Write("out ");
+
+    for (const auto& modifier : ast->typeModifiers)
     {
-        /* Write shader target respective system semantic */
-        Write(semantic[shaderTarget_]);
+        if (modifier == "const")
+            Write(modifier + " ");
+    }
 
-        if (semanticVarIdent->next)
-        {
-            Write(".");
-            Visit(semanticVarIdent->next);
-        }
+    /* Write variable type */
+    if (ast->varType->structType)
+    {
+        EndLn();
+        Visit(ast->varType);
+        BeginLn();
     }
     else
     {
-        /* Write default variable identifier */
-        Visit(ast);
+        Visit(ast->varType);
+        Write(" ");
+    }
+
+    /* Write variable declarations */
+    for (size_t i = 0; i < varDecls.size(); ++i)
+    {
+        Visit(varDecls[i]);
+        if (i + 1 < varDecls.size())
+            Write(", ");
     }
+
+    Write(";");
+    EndLn();
 }
 
 void GLSLGenerator::VisitParameter(VarDeclStmnt* ast)
@@ -1653,9 +2861,14 @@ void GLSLGenerator::VisitParameter(VarDeclStmnt* ast)
 
     /* Write parameter identifier */
     if (ast->varDecls.size() == 1)
+    {
+        /* Parameters are renamed like local variables */
+        if (minify_)
+            LocalName(ast->varDecls[0]);
         Visit(ast->varDecls[0]);
+    }
     else
-        Error("invalid number of variables in function parameter", ast);
+        Error(DiagnosticCodes::InvalidParamVars, ast);
 }
 
 void GLSLGenerator::VisitScopedStmnt(Stmnt* ast)
@@ -1673,6 +2886,36 @@ void GLSLGenerator::VisitScopedStmnt(Stmnt* ast)
     }
 }
 
+void GLSLGenerator::VisitFullExpr(Expr* ast)
+{
+    /* Drop redundant outer brackets, but keep them for list expressions (e.g. "f((a, b))") */
+    if (minify_)
+    {
+        while ( ast && ast->Type() == AST::Types::BracketExpr && ast->constValue.type == ConstValue::Types::None &&
+                static_cast<BracketExpr*>(ast)->expr->Type() != AST::Types::ListExpr )
+        {
+            ast = static_cast<BracketExpr*>(ast)->expr;
+        }
+
+        /* Function calls, which are converted into operators, need no brackets around a full expression */
+        if (ast && ast->Type() == AST::Types::FunctionCallExpr)
+        {
+            bool isFullExpr = true;
+            Visit(ast, &isFullExpr);
+            return;
+        }
+    }
+    Visit(ast);
+}
+
+bool GLSLGenerator::WriteConstValue(Expr* ast)
+{
+    if (ast->constValue.type == ConstValue::Types::None)
+        return false;
+    Write(ConstValueToString(ast->constValue));
+    return true;
+}
+
 bool GLSLGenerator::ExprContainsSampler(Expr* ast)
 {
     if (ast)
@@ -1680,19 +2923,24 @@ bool GLSLGenerator::ExprContainsSampler(Expr* ast)
         if (ast->Type() == AST::Types::BracketExpr)
         {
             auto bracketExpr = dynamic_cast<BracketExpr*>(ast);
-            return ExprContainsSampler(bracketExpr->expr.get());
+            return ExprContainsSampler(bracketExpr->expr);
         }
         if (ast->Type() == AST::Types::BinaryExpr)
         {
-            auto binaryExpr = dynamic_cast<BinaryExpr*>(ast);
-            return
-                ExprContainsSampler(binaryExpr->lhsExpr.get()) ||
-                ExprContainsSampler(binaryExpr->rhsExpr.get());
+            /* Search the binary expression chain iteratively */
+            while (ast && ast->Type() == AST::Types::BinaryExpr)
+            {
+                auto binaryExpr = static_cast<BinaryExpr*>(ast);
+                if (ExprContainsSampler(binaryExpr->lhsExpr))
+                    return true;
+                ast = binaryExpr->rhsExpr;
+            }
+            return ExprContainsSampler(ast);
         }
         if (ast->Type() == AST::Types::UnaryExpr)
         {
             auto unaryExpr = dynamic_cast<UnaryExpr*>(ast);
-            return ExprContainsSampler(unaryExpr->expr.get());
+            return ExprContainsSampler(unaryExpr->expr);
         }
         if (ast->Type() == AST::Types::VarAccessExpr)
         {
@@ -1706,8 +2954,8 @@ bool GLSLGenerator::ExprContainsSampler(Expr* ast)
 
 bool GLSLGenerator::VarTypeIsSampler(VarType* ast)
 {
-    auto it = HLSLKeywords().find(ast->baseType);
-    return it != HLSLKeywords().end() && it->second == Token::Types::Sampler;
+    Token::Types type;
+    return FindHLSLKeyword(ast->baseType.c_str(), ast->baseType.size(), type) && type == Token::Types::Sampler;
 }
 
 bool GLSLGenerator::FetchSemantic(std::string semanticName, SemanticStage& semantic) const
@@ -1727,8 +2975,19 @@ bool GLSLGenerator::FetchSemantic(std::string semanticName, SemanticStage& seman
     /* Search for semantic */
     std::transform(semanticName.begin(), semanticName.end(), semanticName.begin(), ::toupper);
 
-    auto it = semanticMap_.find(semanticName);
-    if (it != semanticMap_.end())
+    if (IsVulkanOut())
+    {
+        auto it = tables_->vulkanSemanticMap.find(semanticName);
+        if (it != tables_->vulkanSemanticMap.end())
+        {
+            semantic = it->second;
+            semantic.index = index;
+            return true;
+        }
+    }
+
+    auto it = tables_->semanticMap.find(semanticName);
+    if (it != tables_->semanticMap.end())
     {
         /* Return semantic */
         semantic = it->second;
@@ -1749,13 +3008,238 @@ bool GLSLGenerator::HasSystemValueSemantic(const std::vector<VarSemanticPtr>& se
 {
     for (const auto& varSemantic : semantics)
     {
-        if (IsSystemValueSemantic(varSemantic.get()))
+        if (IsSystemValueSemantic(varSemantic))
             return true;
     }
     return false;
 }
 
 
+/*
+ * Tables structure
+ */
+
+GLSLGenerator::Tables::Tables()
+{
+    typeMap = std::unordered_map<Ident, std::string>
+    {
+        /* Scalar types */
+        { "bool",      "bool"   },
+        { "bool1",     "bool"   },
+        { "bool1x1",   "bool"   },
+        { "int",       "int"    },
+        { "int1",      "int"    },
+        { "int1x1",    "int"    },
+        { "uint",      "uint"   },
+        { "uint1",     "uint"   },
+        { "uint1x1",   "uint"   },
+        { "half",      "float"  },
+        { "half1",     "float"  },
+        { "half1x1",   "float"  },
+        { "float",     "float"  },
+        { "float1",    "float"  },
+        { "float1x1",  "float"  },
+        { "double",    "double" },
+        { "double1",   "double" },
+        { "double1x1", "double" },
+
+        /* Vector types */
+        { "bool2",   "bvec2" },
+        { "bool3",   "bvec3" },
+        { "bool4",   "bvec4" },
+        { "int2",    "ivec2" },
+        { "int3",    "ivec3" },
+        { "int4",    "ivec4" },
+        { "uint2",   "uvec2" },
+        { "uint3",   "uvec3" },
+        { "uint4",   "uvec4" },
+        { "half2",   "vec2"  },
+        { "half3",   "vec3"  },
+        { "half4",   "vec4"  },
+        { "float2",  "vec2"  },
+        { "float3",  "vec3"  },
+        { "float4",  "vec4"  },
+        { "double2", "dvec2" },
+        { "double3", "dvec3" },
+        { "double4", "dvec4" },
+
+        /* Matrix types */
+        { "float2x2",  "mat2"   },
+        { "float2x3",  "mat2x3" },
+        { "float2x4",  "mat2x4" },
+        { "float3x2",  "mat3x2" },
+        { "float3x3",  "mat3"   },
+        { "float3x4",  "mat3x4" },
+        { "float4x2",  "mat4x2" },
+        { "float4x3",  "mat4x3" },
+        { "float4x4",  "mat4"   },
+        { "double2x2", "mat2"   },
+        { "double2x3", "mat2x3" },
+        { "double2x4", "mat2x4" },
+        { "double3x2", "mat3x2" },
+        { "double3x3", "mat3"   },
+        { "double3x4", "mat3x4" },
+        { "double4x2", "mat4x2" },
+        { "double4x3", "mat4x3" },
+        { "double4x4", "mat4"   },
+
+        /* Texture types */
+        { "Texture1D",        "sampler1D"        },
+        { "Texture1DArray",   "sampler1DArray"   },
+        { "Texture2D",        "sampler2D"        },
+        { "Texture2DArray",   "sampler2DArray"   },
+        { "Texture3D",        "sampler3D"        },
+        { "TextureCube",      "samplerCube"      },
+        { "TextureCubeArray", "samplerCubeArray" },
+        { "Texture2DMS",      "sampler2DMS"      },
+        { "Texture2DMSArray", "sampler2DMSArray" },
+        /*{ "RWTexture1D",      "" },
+        { "RWTexture1DArray", "" },
+        { "RWTexture2D",      "" },
+        { "RWTexture2DArray", "" },
+        { "RWTexture3D",      "" },*/
+
+        /* Storage class types */
+        { "groupshared", "shared" },
+    };
+
+    /*
+    The half and minimum precision types are mapped to the full precision types,
+    and their precision is written as qualifier for GLSL ES (see "Options::defaultPrecision")
+    */
+    static const struct
+    {
+        const char* name;
+        const char* scalarType;
+        const char* vectorPrefix;
+        bool        hasMatrices;
+        const char* precision;
+    }
+    lowPrecisionTypes[] =
+    {
+        { "half",       "float", "",  true,  "mediump" },
+        { "min16float", "float", "",  true,  "mediump" },
+        { "min10float", "float", "",  true,  "lowp"    },
+        { "min16int",   "int",   "i", false, "mediump" },
+        { "min12int",   "int",   "i", false, "mediump" },
+        { "min16uint",  "uint",  "u", false, "mediump" },
+    };
+
+    for (const auto& type : lowPrecisionTypes)
+    {
+        const std::string name = type.name;
+
+        for (auto suffix : { "", "1", "1x1" })
+        {
+            const Ident typeName(name + suffix);
+            typeMap.insert({ typeName, type.scalarType });
+            precisionMap[typeName] = type.precision;
+        }
+
+        for (char rows = '2'; rows <= '4'; ++rows)
+        {
+            const Ident vectorTypeName(name + rows);
+            typeMap.insert({ vectorTypeName, std::string(type.vectorPrefix) + "vec" + rows });
+            precisionMap[vectorTypeName] = type.precision;
+
+            if (type.hasMatrices)
+            {
+                for (char cols = '2'; cols <= '4'; ++cols)
+                {
+                    const Ident matrixTypeName(name + rows + 'x' + cols);
+                    typeMap.insert({ matrixTypeName, (rows == cols ? std::string("mat") + rows : std::string("mat") + rows + 'x' + cols) });
+                    precisionMap[matrixTypeName] = type.precision;
+                }
+            }
+        }
+    }
+
+    intrinsicMap = std::unordered_map<Ident, std::string>
+    {
+        { "frac",                            "fract"              },
+        { "rsqrt",                           "inversesqrt"        },
+        { "lerp",                            "mix"                },
+        { "saturate",                        "clamp"              },
+        { "ddx",                             "dFdx"               },
+        { "ddy",                             "dFdy"               },
+        { "ddx_coarse",                      "dFdxCoarse"         },
+        { "ddy_coarse",                      "dFdyCoarse"         },
+        { "ddx_fine",                        "dFdxFine"           },
+        { "ddy_fine",                        "dFdyFine"           },
+        { "atan2",                           "atan"               },
+        { "GroupMemoryBarrier",              "groupMemoryBarrier" },
+        { "GroupMemoryBarrierWithGroupSync", "barrier"            },
+        { "AllMemoryBarrier",                "memoryBarrier"      },
+        { "AllMemoryBarrierWithGroupSync",   "barrier"            },
+    };
+
+    atomicIntrinsicMap = std::unordered_map<Ident, std::string>
+    {
+        { "InterlockedAdd",             "atomicAdd"      },
+        { "InterlockedAnd",             "atomicAnd"      },
+        { "InterlockedOr",              "atomicOr"       },
+        { "InterlockedXor",             "atomicXor"      },
+        { "InterlockedMin",             "atomicMin"      },
+        { "InterlockedMax",             "atomicMax"      },
+        { "InterlockedCompareExchange", "atomicCompSwap" },
+        { "InterlockedExchange",        "atomicExchange" },
+    };
+
+    modifierMap = std::unordered_map<std::string, std::string>
+    {
+        { "linear",          "smooth"        },
+        { "centroid",        "centroid"      },
+        { "nointerpolation", "flat"          },
+        { "noperspective",   "noperspective" },
+        { "sample",          "sample"        },
+    };
+
+    texFuncMap = std::unordered_map<Ident, std::string>
+    {
+        { "GetDimensions ",     "textureSize"   },
+        { "Load",               "texelFetch"    },
+        { "Sample",             "texture"       },
+        { "SampleBias",         "textureOffset" },
+        //{ "SampleCmp", "" },
+        //{ "SampleCmpLevelZero", "" },
+        { "SampleGrad",         "textureGrad"   },
+        { "SampleLevel",        "textureLod"    },
+    };
+
+    semanticMap = std::unordered_map<std::string, SemanticStage>
+    {
+        { "SV_CLIPDISTANCE",            { "gl_ClipDistance"                             } },
+        { "SV_CULLDISTANCE",            { "gl_CullDistance"                             } },
+      //{ "SV_COVERAGE",                { "???"                                         } },
+        { "SV_DEPTH",                   { "gl_FragDepth"                                } },
+        { "SV_DISPATCHTHREADID",        { "gl_GlobalInvocationID"                       } },
+        { "SV_DOMAINLOCATION",          { "gl_TessCoord"                                } },
+        { "SV_GROUPID",                 { "gl_WorkGroupID"                              } },
+        { "SV_GROUPINDEX",              { "gl_LocalInvocationIndex"                     } },
+        { "SV_GROUPTHREADID",           { "gl_LocalInvocationID"                        } },
+        { "SV_GSINSTANCEID",            { "gl_InvocationID"                             } },
+        { "SV_INSIDETESSFACTOR",        { "gl_Position"                                 } },
+        { "SV_ISFRONTFACE",             { "gl_FrontFacing"                              } },
+        { "SV_OUTPUTCONTROLPOINTID",    { "gl_PrimitiveID"                              } },
+        { "SV_POSITION",                { "gl_Position", "", "", "", "gl_FragCoord", "" } },
+      //{ "SV_RENDERTARGETARRAYINDEX",  { "???"                                         } },
+        { "SV_SAMPLEINDEX",             { "gl_SampleID"                                 } },
+        { "SV_TARGET",                  { "gl_FragColor"                                } },
+        { "SV_TESSFACTOR",              { "gl_Position"                                 } },
+        { "SV_VIEWPORTARRAYINDEX",      { "gl_ViewportIndex"                            } },
+        { "SV_INSTANCEID",              { "gl_InstanceID"                               } },
+        { "SV_PRIMITIVEID",             { "gl_PrimitiveID"                              } },
+        { "SV_VERTEXID",                { "gl_VertexID"                                 } },
+    };
+
+    vulkanSemanticMap = std::unordered_map<std::string, SemanticStage>
+    {
+        { "SV_INSTANCEID",              { "gl_InstanceIndex"                            } },
+        { "SV_VERTEXID",                { "gl_VertexIndex"                              } },
+    };
+}
+
+
 /*
  * SemanticStage structure
  */
@@ -1803,7 +3287,7 @@ const std::string& GLSLGenerator::SemanticStage::operator [] (const ShaderTarget
         case ShaderTargets::GLSLComputeShader:
             return compute;
     }
-    throw std::out_of_range("'target' parameter out of range in " __FUNCTION__);
+    throw std::out_of_range(std::string("'target' parameter out of range in ") + __FUNCTION__);
     return vertex;
 }
 
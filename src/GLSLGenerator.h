@@ -11,10 +11,15 @@
 
 #include "HT/Translator.h"
 #include "CodeWriter.h"
+#include "StreamHandler.h"
+#include "DeclOutputCache.h"
 #include "Visitor.h"
 #include "Token.h"
 
+#include <unordered_map>
+#include <unordered_set>
 #include <map>
+#include <memory>
 #include <vector>
 
 
@@ -28,23 +33,6 @@ class GLSLGenerator : private Visitor
     
     public:
         
-        GLSLGenerator(
-            Logger* log = nullptr,
-            IncludeHandler* includeHandler = nullptr,
-            const Options& options = {}
-        );
-
-        bool GenerateCode(
-            Program* program,
-            std::ostream& output,
-            const std::string& entryPoint,
-            const ShaderTargets shaderTarget,
-            const InputShaderVersions versionIn,
-            const OutputShaderVersions versionOut
-        );
-
-    private:
-        
         /* === Structures === */
 
         struct SemanticStage
@@ -72,11 +60,102 @@ class GLSLGenerator : private Visitor
             int         index = 0;      // Semantic index
         };
 
+        /**
+        Immutable lookup tables of the code generator.
+        \remarks These tables are built once and can be shared by any number of generators (also across threads).
+        */
+        struct Tables
+        {
+            Tables();
+
+            std::unordered_map<Ident, std::string>            typeMap;            // <hlsl-type, glsl-type>
+            std::unordered_map<Ident, std::string>            intrinsicMap;       // <hlsl-intrinsic, glsl-intrinsic>
+            std::unordered_map<Ident, std::string>            atomicIntrinsicMap; // <hlsl-interlocked-intrinsic, glsl-atomic-intrinsic>
+            std::unordered_map<std::string, std::string>      modifierMap;        // <hlsl-modifier, glsl-qualifier>
+            std::unordered_map<Ident, std::string>            precisionMap;       // <hlsl-type, glsl-precision> (GLSL ES only)
+            std::unordered_map<Ident, std::string>            texFuncMap;         // <hlsl-function, glsl-function>
+            std::unordered_map<std::string, SemanticStage>    semanticMap;        // <hlsl-semantic, glsl-keyword>
+            std::unordered_map<std::string, SemanticStage>    vulkanSemanticMap;  // <hlsl-semantic, glsl-keyword> (replaces the entries of "semanticMap" for Vulkan GLSL)
+        };
+
+        GLSLGenerator(
+            const Tables& tables,
+            Logger* log = nullptr,
+            IncludeHandler* includeHandler = nullptr,
+            const Options& options = {}
+        );
+
+        //! Generates the GLSL code and writes it to the specified output stream at once (or after each global declaration, see "Options::streamOutput").
+        bool GenerateCode(
+            Program* program,
+            std::ostream& output,
+            const std::string& entryPoint,
+            const ShaderTargets shaderTarget,
+            const InputShaderVersions versionIn,
+            const OutputShaderVersions versionOut
+        );
+
+        //! Generates the GLSL code and appends it to the specified output string.
+        bool GenerateCode(
+            Program* program,
+            std::string& output,
+            const std::string& entryPoint,
+            const ShaderTargets shaderTarget,
+            const InputShaderVersions versionIn,
+            const OutputShaderVersions versionOut
+        );
+
+        //! Returns the number of bytes of the code which has been generated by the previous call to "GenerateCode".
+        inline std::size_t OutputSize() const
+        {
+            return outputSize_;
+        }
+
+        /**
+        Stores the reflection of the code which has been generated by the previous (successful) call to "GenerateCode".
+        \remarks This uses the same rules as the code generation to determine which declarations are written,
+        so it only depends on the decorated AST and not on the number of generator threads.
+        */
+        void Reflect(ShaderReflection& reflection) const;
+
+        /**
+        Sets the handler of a streamed translation, which is notified right before and after the code of each global declaration is generated.
+        By default null.
+        \remarks This is used to parse and decorate each function body right before its code is generated,
+        and to release it afterwards (see "Options::streamOutput"). The global declarations are then always generated by a single thread.
+        */
+        inline void SetStreamHandler(StreamHandler* streamHandler)
+        {
+            streamHandler_ = streamHandler;
+        }
+
+        /**
+        Sets the output cache of an incremental translation, which provides the output of the unchanged global declarations.
+        By default null.
+        
+emarks The entry point is always generated, since it depends on the input and output semantics of the entire program.
+        The cache is not used in the minified mode and with explicit bindings, because the short names and the bindings
+        are numbered across all declarations. The global declarations are then always generated by a single thread.
+        */
+        inline void SetOutputCache(DeclOutputCache* outputCache)
+        {
+            outputCache_ = outputCache;
+        }
+
+    private:
+        
         /* === Functions === */
 
-        void EstablishMaps();
+        //! Generates the GLSL code into the current output of the code writer.
+        bool GenerateCodePrimary(
+            Program* program,
+            const std::string& entryPoint,
+            const ShaderTargets shaderTarget,
+            const InputShaderVersions versionIn,
+            const OutputShaderVersions versionOut
+        );
 
-        void Error(const std::string& msg, const AST* ast = nullptr);
+        void Error(const DiagnosticCodes code, const AST* ast = nullptr, const std::string& arg0 = "", const std::string& arg1 = "");
         void ErrorInvalidNumArgs(const std::string& functionName, const AST* ast = nullptr);
 
         void BeginLn();
@@ -85,6 +164,12 @@ class GLSLGenerator : private Visitor
         void Write(const std::string& text);
         void WriteLn(const std::string& text);
 
+        /**
+        Writes the specified GLSL type name (e.g. "vec4"), which has been mapped from the specified HLSL type name.
+        \remarks For GLSL ES an error is reported for the double precision types, because GLSL ES has no double precision.
+        */
+        void WriteTypeName(const std::string& typeName, const std::string& hlslTypeName, const AST* ast);
+
         void IncTab();
         void DecTab();
         
@@ -128,11 +213,102 @@ class GLSLGenerator : private Visitor
         std::string URegister(const std::string& registerName);
 
         //! Returns true if the specified AST structure must be resolved.
-        bool MustResolveStruct(Structure* ast) const;
+        bool MustResolveStruct(const Structure* ast) const;
+
+        /**
+        Returns true if the specified interface block structure has no members to generate,
+        i.e. all members are disabled or have a system value semantic. GLSL does not allow empty interface blocks.
+        */
+        bool IsEmptyInterfaceBlock(const Structure* ast) const;
 
         //! Returns true if the target version is greater than or equal to the specified version number.
         bool IsVersionOut(int version) const;
 
+        //! Returns true if the target version is a GLSL version for Vulkan (see "OutputShaderVersions::VKSL450").
+        bool IsVulkanOut() const;
+
+        //! Returns true if the target version is a GLSL ES version (see "OutputShaderVersions::ESSL300").
+        bool IsESSLOut() const;
+
+        /* --- GLSL ES output --- */
+
+        /**
+        Returns true if the members of the specified shader input/output structure are written as separate global variables,
+        because GLSL ES has neither vertex output nor fragment input interface blocks.
+        */
+        bool IsFlattenedStruct(const Structure* ast) const;
+
+        //! Returns the name of the global variable, which is written for the specified member of a resolved structure.
+        std::string ResolvedVarName(const Structure* structure, const VarDecl* ast) const;
+
+        //! Writes the default precisions of the floating-point, integer and sampler types (see "Options::defaultPrecision").
+        void WriteDefaultPrecisions(Program* ast);
+
+        /* --- Explicit bindings and locations --- */
+
+        //! Assigns the bindings of all resources and the locations of all shader inputs and outputs (see "Options::explicitBinding").
+        void GenerateExplicitLayout(Program* ast);
+
+        //! Returns the explicit binding of the specified uniform buffer or texture identifier, or -1 if it has no explicit binding.
+        int ExplicitBinding(const AST* ast) const;
+
+        //! Returns the explicit location of the specified shader input/output variable or interface block, or -1 if it has no explicit location.
+        int ExplicitLocation(const AST* ast) const;
+
+        //! Returns the layout qualifier of the specified binding, i.e. "binding = N" (with the descriptor set for Vulkan GLSL).
+        std::string BindingQualifier(const std::string& binding) const;
+
+        //! Returns true if the registers can be written as binding qualifiers (GLSL ES supports them since version 3.10).
+        bool HasBindingQualifiers() const;
+
+        //! Returns true if the specified uniform buffer is written as push constant block (see "Options::pushConstantSize").
+        bool IsPushConstantBuffer(const UniformBufferDecl* ast) const;
+
+        //! Returns the number of locations, which are consumed by the specified variable of the specified type.
+        unsigned int LocationCount(const VarType* typeAST, const VarDecl* ast) const;
+
+        /* --- Minified output --- */
+
+        //! Determines the reserved identifiers and the short names of the functions (see "Options::minify").
+        void GenerateMinifiedNames(Program* ast);
+
+        //! Returns the short name of the specified local variable or parameter, and generates it on the first call.
+        const std::string& LocalName(const VarDecl* ast);
+
+        //! Returns true if the specified variable is a local variable or parameter, which is written with its short name.
+        bool HasLocalName(const VarDecl* ast) const;
+
+        //! Returns the short name of the specified function name, or null if this function keeps its name.
+        const std::string* FunctionName(const Ident& name) const;
+
+        /* --- Reflection --- */
+
+        //! Alignment and size (in bytes) of a type in the "std140" layout.
+        struct Std140Layout
+        {
+            unsigned int align  = 4;
+            unsigned int size   = 4;
+        };
+
+        //! Returns the GLSL type name of the specified type (or the structure name).
+        std::string ReflectTypeName(const VarType* ast) const;
+
+        //! Returns the "std140" layout of the specified type (structures are resolved recursively).
+        Std140Layout ReflectTypeLayout(const VarType* ast) const;
+
+        //! Returns the "std140" layout of the specified variable (including its array dimensions).
+        Std140Layout ReflectVarLayout(const VarType* typeAST, const VarDecl* ast) const;
+
+        //! Returns the binding of the specified uniform buffer or texture identifier (explicit or from its register), or -1 if it has no binding.
+        int ReflectBinding(const AST* ast, const std::string& registerName) const;
+
+        //! Returns the size of the specified uniform buffer in the "std140" layout.
+        unsigned int ReflectUniformBufferSize(const UniformBufferDecl* ast) const;
+
+        void ReflectUniformBuffer(const UniformBufferDecl* ast, ShaderReflection& reflection) const;
+        void ReflectInterface(const Structure* ast, ShaderReflection& reflection) const;
+        void ReflectAttributeNumThreads(const FunctionCall* ast, ShaderReflection& reflection) const;
+
         /* --- Visitor implementation --- */
 
         DECL_VISIT_PROC( Program           );
@@ -194,14 +370,35 @@ class GLSLGenerator : private Visitor
         void WriteEntryPointInputSemantics();
         void WriteEntryPointOutputSemantics(Expr* ast);
 
+        /**
+        Generates the specified global declarations concurrently into separate buffers and appends them in source order.
+        \remarks This only depends on the decorated AST, since all helper functions are written before the global declarations.
+        */
+        void VisitGlobalDeclsConcurrent(const std::vector<GlobalDeclPtr>& globalDecls);
+
+        //! Writes the cached output of the specified global declaration, or generates it and stores it in the output cache.
+        void VisitGlobalDeclCached(GlobalDecl* ast, DeclOutputCache& outputCache);
+
+        //! Writes the code, which has been generated so far, to the output stream (streaming mode only).
+        void FlushStream();
+
         void WriteFragmentShaderOutput();
 
         VarIdent* FirstSystemSemanticVarIdent(VarIdent* ast);
         void WriteVarIdent(VarIdent* ast);
 
+        //! Writes the declaration statement of the specified variables (a subset of the variables of the statement).
+        void WriteVarDeclStmnt(VarDeclStmnt* ast, const std::vector<VarDeclPtr>& varDecls);
+
         void VisitParameter(VarDeclStmnt* ast);
         void VisitScopedStmnt(Stmnt* ast);
 
+        //! Visits the specified expression, which is not part of another expression (e.g. a function argument), so its outer brackets are redundant.
+        void VisitFullExpr(Expr* ast);
+
+        //! Writes the folded constant value of the specified expression (if it has one) and returns true on success.
+        bool WriteConstValue(Expr* ast);
+
         //! Returns true if the specified expression contains a sampler object.
         bool ExprContainsSampler(Expr* ast);
         //! Returns true if the specified variable type is a sampler.
@@ -212,9 +409,30 @@ class GLSLGenerator : private Visitor
         bool IsSystemValueSemantic(const VarSemantic* ast) const;
         bool HasSystemValueSemantic(const std::vector<VarSemanticPtr>& semantics) const;
 
+        /* === Structures === */
+
+        //! Names, which are shared by all generators of a program in the minified mode.
+        struct MinifiedNames
+        {
+            std::unordered_set<std::string>                 reserved;   // Identifiers which must not be used as short names
+            std::unordered_map<Ident, std::string>          functions;  // <function-name, short-name>
+        };
+
+        //! Explicit bindings and locations, which are shared by all generators of a program.
+        struct ExplicitLayout
+        {
+            std::unordered_map<const AST*, int> bindings;   // <uniform-buffer-decl or buffer-decl-ident, binding>
+            std::unordered_map<const AST*, int> locations;  // <var-decl or structure, location>
+            bool                                hasBlockLocations = false; // Locations of interface blocks require GLSL 4.40 or "GL_ARB_enhanced_layouts".
+            const UniformBufferDecl*            pushConstantBuffer = nullptr; // Uniform buffer which is written as push constant block (Vulkan GLSL only).
+        };
+
         /* === Members === */
 
+        const Tables*           tables_                 = nullptr;
+
         CodeWriter              writer_;
+        std::size_t             outputSize_             = 0;
         IncludeHandler*         includeHandler_         = nullptr;
         Logger*                 log_                    = nullptr;
 
@@ -227,16 +445,31 @@ class GLSLGenerator : private Visitor
         std::string             localVarPrefix_;
         bool                    allowBlanks_            = true;
         bool                    allowLineMarks_         = true;
+        bool                    allowTimeStamp_         = true;
+        unsigned int            numThreads_             = 1; //!< Number of threads for the global declarations (0 for the number of hardware threads).
+        bool                    minify_                 = false;
+        bool                    explicitBinding_        = false;
+        bool                    streamOutput_           = false;
+        bool                    isStreaming_            = false; //!< True if the code is written to the output stream after each global declaration.
+        StreamHandler*          streamHandler_          = nullptr;
+        DeclOutputCache*        outputCache_            = nullptr;
+
+        std::shared_ptr<const MinifiedNames>                minifiedNames_;     //!< Reserved and function names (minified mode only).
+        std::unordered_map<const VarDecl*, std::string>     localNames_;        //!< Short names of the current function (minified mode only).
+        std::size_t                                         numLocalNames_  = 0;
+
+        std::map<char, unsigned int>                        bindingOffsets_;    //!< Binding offsets of the register classes (see "Options::bindingOffsets").
+        unsigned int                                        descriptorSet_      = 0;
+        unsigned int                                        pushConstantSize_   = 0;
+        Precisions                                          defaultPrecision_   = Precisions::High;
+        std::shared_ptr<const ExplicitLayout>               explicitLayout_;    //!< Bindings and locations (explicit binding mode only).
 
         bool                    isInsideEntryPoint_     = false; //!< True if AST traversal is currently inside the main entry point (or its sub nodes).
         bool                    isInsideInterfaceBlock_ = false;
+        bool                    isInsideStructDecl_     = false; //!< True if the members of a structure declaration are currently written (they have no interpolation qualifiers).
+        const Structure*        flattenedStruct_        = nullptr; //!< Structure whose members are currently written as global variables (GLSL ES only); may be null.
 
-        std::map<std::string, std::string> typeMap_;            // <hlsl-type, glsl-type>
-        std::map<std::string, std::string> intrinsicMap_;       // <hlsl-intrinsic, glsl-intrinsic>
-        std::map<std::string, std::string> atomicIntrinsicMap_; // <hlsl-interlocked-intrinsic, glsl-atomic-intrinsic>
-        std::map<std::string, std::string> modifierMap_;        // <hlsl-modifier, glsl-qualifier>
-        std::map<std::string, std::string> texFuncMap_;         // <hlsl-function, glsl-function>
-        std::map<std::string, SemanticStage> semanticMap_;      // <hlsl-semantic, glsl-keyword>
+        const Ident*            texObjectIdent_         = nullptr; //!< Texture object identifier of the current texture function (e.g. "tex" in "tex.Sample"); may be null.
 
 };
 
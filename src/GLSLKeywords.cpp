@@ -0,0 +1,106 @@
+/*
+ * GLSLKeywords.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "GLSLKeywords.h"
+
+#include <unordered_set>
+
+
+namespace HTLib
+{
+
+
+static std::unordered_set<std::string> GenerateReservedNames()
+{
+    return
+    {
+        /* --- Keywords --- */
+        "attribute", "const", "uniform", "varying", "buffer", "shared", "coherent", "volatile", "restrict",
+        "readonly", "writeonly", "atomic_uint", "layout", "centroid", "flat", "smooth", "noperspective",
+        "patch", "sample", "break", "continue", "do", "for", "while", "switch", "case", "default", "if",
+        "else", "subroutine", "in", "out", "inout", "true", "false", "invariant", "precise", "discard",
+        "return", "lowp", "mediump", "highp", "precision", "struct", "void",
+
+        /* --- Built-in types --- */
+        "bool", "int", "uint", "float", "double",
+        "bvec2", "bvec3", "bvec4", "ivec2", "ivec3", "ivec4", "uvec2", "uvec3", "uvec4",
+        "vec2", "vec3", "vec4", "dvec2", "dvec3", "dvec4",
+        "mat2", "mat3", "mat4", "mat2x2", "mat2x3", "mat2x4", "mat3x2", "mat3x3", "mat3x4", "mat4x2", "mat4x3", "mat4x4",
+        "dmat2", "dmat3", "dmat4", "dmat2x2", "dmat2x3", "dmat2x4", "dmat3x2", "dmat3x3", "dmat3x4", "dmat4x2", "dmat4x3", "dmat4x4",
+        "sampler1D", "sampler2D", "sampler3D", "samplerCube", "sampler1DShadow", "sampler2DShadow", "samplerCubeShadow",
+        "sampler1DArray", "sampler2DArray", "sampler1DArrayShadow", "sampler2DArrayShadow", "samplerCubeArray", "samplerCubeArrayShadow",
+        "sampler2DRect", "sampler2DRectShadow", "samplerBuffer", "sampler2DMS", "sampler2DMSArray",
+        "isampler1D", "isampler2D", "isampler3D", "isamplerCube", "isampler1DArray", "isampler2DArray", "isamplerCubeArray",
+        "isampler2DRect", "isamplerBuffer", "isampler2DMS", "isampler2DMSArray",
+        "usampler1D", "usampler2D", "usampler3D", "usamplerCube", "usampler1DArray", "usampler2DArray", "usamplerCubeArray",
+        "usampler2DRect", "usamplerBuffer", "usampler2DMS", "usampler2DMSArray",
+        "image1D", "image2D", "image3D", "imageCube", "image1DArray", "image2DArray", "imageCubeArray", "image2DRect",
+        "imageBuffer", "image2DMS", "image2DMSArray",
+        "iimage1D", "iimage2D", "iimage3D", "iimageCube", "iimage1DArray", "iimage2DArray", "iimageCubeArray", "iimage2DRect",
+        "iimageBuffer", "iimage2DMS", "iimage2DMSArray",
+        "uimage1D", "uimage2D", "uimage3D", "uimageCube", "uimage1DArray", "uimage2DArray", "uimageCubeArray", "uimage2DRect",
+        "uimageBuffer", "uimage2DMS", "uimage2DMSArray",
+
+        /* --- Reserved keywords --- */
+        "common", "partition", "active", "asm", "class", "union", "enum", "typedef", "template", "this",
+        "resource", "goto", "inline", "noinline", "public", "static", "extern", "external", "interface",
+        "long", "short", "half", "fixed", "unsigned", "superp", "input", "output",
+        "hvec2", "hvec3", "hvec4", "fvec2", "fvec3", "fvec4", "sampler3DRect", "filter", "sizeof", "cast",
+        "namespace", "using",
+
+        /* --- Built-in functions --- */
+        "radians", "degrees", "sin", "cos", "tan", "asin", "acos", "atan", "sinh", "cosh", "tanh", "asinh", "acosh", "atanh",
+        "pow", "exp", "log", "exp2", "log2", "sqrt", "inversesqrt",
+        "abs", "sign", "floor", "trunc", "round", "roundEven", "ceil", "fract", "mod", "modf", "min", "max", "clamp",
+        "mix", "step", "smoothstep", "isnan", "isinf", "floatBitsToInt", "floatBitsToUint", "intBitsToFloat",
+        "uintBitsToFloat", "fma", "frexp", "ldexp",
+        "packUnorm2x16", "packSnorm2x16", "packUnorm4x8", "packSnorm4x8", "unpackUnorm2x16", "unpackSnorm2x16",
+        "unpackUnorm4x8", "unpackSnorm4x8", "packHalf2x16", "unpackHalf2x16", "packDouble2x32", "unpackDouble2x32",
+        "length", "distance", "dot", "cross", "normalize", "ftransform", "faceforward", "reflect", "refract",
+        "matrixCompMult", "outerProduct", "transpose", "determinant", "inverse",
+        "lessThan", "lessThanEqual", "greaterThan", "greaterThanEqual", "equal", "notEqual", "any", "all", "not",
+        "uaddCarry", "usubBorrow", "umulExtended", "imulExtended", "bitfieldExtract", "bitfieldInsert",
+        "bitfieldReverse", "bitCount", "findLSB", "findMSB",
+        "textureSize", "textureQueryLod", "textureQueryLevels", "textureSamples", "texture", "textureProj",
+        "textureLod", "textureOffset", "texelFetch", "texelFetchOffset", "textureProjOffset", "textureLodOffset",
+        "textureProjLod", "textureProjLodOffset", "textureGrad", "textureGradOffset", "textureProjGrad",
+        "textureProjGradOffset", "textureGather", "textureGatherOffset", "textureGatherOffsets",
+        "texture1D", "texture1DProj", "texture1DLod", "texture1DProjLod", "texture2D", "texture2DProj", "texture2DLod",
+        "texture2DProjLod", "texture3D", "texture3DProj", "texture3DLod", "texture3DProjLod", "textureCube", "textureCubeLod",
+        "shadow1D", "shadow2D", "shadow1DProj", "shadow2DProj", "shadow1DLod", "shadow2DLod", "shadow1DProjLod", "shadow2DProjLod",
+        "atomicCounterIncrement", "atomicCounterDecrement", "atomicCounter",
+        "atomicAdd", "atomicMin", "atomicMax", "atomicAnd", "atomicOr", "atomicXor", "atomicExchange", "atomicCompSwap",
+        "imageSize", "imageSamples", "imageLoad", "imageStore", "imageAtomicAdd", "imageAtomicMin", "imageAtomicMax",
+        "imageAtomicAnd", "imageAtomicOr", "imageAtomicXor", "imageAtomicExchange", "imageAtomicCompSwap",
+        "dFdx", "dFdy", "dFdxFine", "dFdyFine", "dFdxCoarse", "dFdyCoarse", "fwidth", "fwidthFine", "fwidthCoarse",
+        "interpolateAtCentroid", "interpolateAtSample", "interpolateAtOffset", "noise1", "noise2", "noise3", "noise4",
+        "EmitStreamVertex", "EndStreamPrimitive", "EmitVertex", "EndPrimitive",
+        "barrier", "memoryBarrier", "memoryBarrierAtomicCounter", "memoryBarrierBuffer", "memoryBarrierShared",
+        "memoryBarrierImage", "groupMemoryBarrier",
+
+        /* --- Entry point and predefined macros --- */
+        "main", "defined", "__LINE__", "__FILE__", "__VERSION__", "GL_core_profile", "GL_es_profile", "GL_compatibility_profile",
+    };
+}
+
+bool IsGLSLReservedName(const std::string& ident)
+{
+    static const auto reservedNames = GenerateReservedNames();
+
+    /* Identifiers with the prefix "gl_" and identifiers which contain "__" are reserved, too */
+    if (ident.compare(0, 3, "gl_") == 0 || ident.find("__") != std::string::npos)
+        return true;
+
+    return (reservedNames.find(ident) != reservedNames.end());
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,34 @@
+/*
+ * GLSLKeywords.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_GLSL_KEYWORDS_H__
+#define __HT_GLSL_KEYWORDS_H__
+
+
+#include <string>
+
+
+namespace HTLib
+{
+
+
+/**
+Returns true if the specified identifier is reserved in GLSL,
+i.e. it is a keyword (also a reserved one), a built-in type or a built-in function.
+\remarks This is used to avoid name clashes with generated identifiers (see "Options::minify").
+*/
+bool IsGLSLReservedName(const std::string& ident);
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -6,8 +6,10 @@
  */
 
 #include "HLSLAnalyzer.h"
+#include "DiagnosticError.h"
 
 #include <algorithm>
+#include <chrono>
 
 
 namespace HTLib
@@ -30,11 +32,11 @@ static const ARBExt ARBEXT_GL_ARB_shader_image_load_store   { "GL_ARB_shader_ima
  * HLSLAnalyzer class
  */
 
-HLSLAnalyzer::HLSLAnalyzer(Logger* log) :
-    log_        { log        },
+HLSLAnalyzer::HLSLAnalyzer(const Tables& tables, Logger* log) :
+    tables_     { &tables   },
+    log_        { log       },
     refAnalyzer_{ symTable_ }
 {
-    EstablishMaps();
 }
 
 bool HLSLAnalyzer::DecorateAST(
@@ -43,82 +45,86 @@ bool HLSLAnalyzer::DecorateAST(
     const ShaderTargets shaderTarget,
     const InputShaderVersions versionIn,
     const OutputShaderVersions versionOut,
-    const Options& options)
+    const Options& options,
+    StageVaryings* varyings,
+    StreamHandler* streamHandler)
 {
     if (!program)
         return false;
 
     /* Store parameters */
-    entryPoint_     = entryPoint;
-    shaderTarget_   = shaderTarget;
-    versionIn_      = versionIn;
-    versionOut_     = versionOut;
-    localVarPrefix_ = options.prefix;
-    enableWarnings_ = options.warnings;
-
-    /* Decorate program AST */
+    entryPoint_         = entryPoint;
+    shaderTarget_       = shaderTarget;
+    versionIn_          = versionIn;
+    versionOut_         = versionOut;
+    localVarPrefix_     = options.prefix;
+    enableWarnings_     = options.warnings;
+    eliminateDeadCode_  = options.eliminateDeadCode;
+    foldConstants_      = options.foldConstants;
+    varyings_           = varyings;
+    streamHandler_      = streamHandler;
+
+    /* Decorate program AST (remove decorations of a previous pass first) */
     hasErrors_ = false;
     program_ = program;
+    referenceAnalysisTime_ = 0.0;
+    functionExtensions_.clear();
+
+    ResetDecorations(program);
+
+    if (streamHandler_)
+    {
+        /* Each function body is decorated on its own, so the function names must be known before */
+        constantFolder_.CollectFunctionNames(program);
+        deadCodeEliminator_.CollectFunctionNames(program);
+    }
 
     Visit(program);
 
+    streamHandler_ = nullptr;
+
     return !hasErrors_;
 }
 
+void HLSLAnalyzer::BeginRedecoration()
+{
+    /* Messages are only reported once */
+    log_ = nullptr;
+    hasErrors_ = false;
 
-/*
- * ======= Private: =======
- */
+    /* Register all symbols again (in a new symbol table), but keep all other decorations */
+    symTable_ = ASTSymbolTable();
+    program_->inputSemantics.parameters.clear();
+}
 
-void HLSLAnalyzer::EstablishMaps()
+bool HLSLAnalyzer::RedecorateGlobalDecl(GlobalDecl* ast)
 {
-    intrinsicMap_ = std::map<std::string, IntrinsicClasses>
-    {
-        { "InterlockedAdd",             IntrinsicClasses::Interlocked },
-        { "InterlockedAnd",             IntrinsicClasses::Interlocked },
-        { "InterlockedOr",              IntrinsicClasses::Interlocked },
-        { "InterlockedXor",             IntrinsicClasses::Interlocked },
-        { "InterlockedMin",             IntrinsicClasses::Interlocked },
-        { "InterlockedMax",             IntrinsicClasses::Interlocked },
-        { "InterlockedCompareExchange", IntrinsicClasses::Interlocked },
-        { "InterlockedExchange",        IntrinsicClasses::Interlocked },
-    };
-
-    extensionMap_ = std::map<std::string, Program::ARBExtension>
-    {
-        { "ddx_coarse", ARBEXT_GL_ARB_derivative_control },
-        { "ddy_coarse", ARBEXT_GL_ARB_derivative_control },
-        { "ddx_fine",   ARBEXT_GL_ARB_derivative_control },
-        { "ddy_fine",   ARBEXT_GL_ARB_derivative_control },
-    };
+    DecorateGlobalDecl(ast);
+    return !hasErrors_;
 }
 
-void HLSLAnalyzer::Error(const std::string& msg, const AST* ast)
+
+/*
+ * ======= Private: =======
+ */
+
+void HLSLAnalyzer::Error(const DiagnosticCodes code, const AST* ast, const std::string* arg)
 {
     hasErrors_ = true;
     if (log_)
-    {
-        if (ast)
-            log_->Error("context error (" + ast->pos.ToString() + ") : " + msg);
-        else
-            log_->Error("context error : " + msg);
-    }
+        log_->Report(MakeDiagnostic(code, DiagnosticSeverities::Error, (ast ? &(ast->pos) : nullptr), arg));
 }
 
-void HLSLAnalyzer::Warning(const std::string& msg, const AST* ast)
+void HLSLAnalyzer::Warning(const DiagnosticCodes code, const AST* ast, const std::string* arg)
 {
+    /* Warnings are not even created if they are disabled */
     if (log_ && enableWarnings_)
-    {
-        if (ast)
-            log_->Warning("warning (" + ast->pos.ToString() + ") : " + msg);
-        else
-            log_->Warning("warning : " + msg);
-    }
+        log_->Report(MakeDiagnostic(code, DiagnosticSeverities::Warning, (ast ? &(ast->pos) : nullptr), arg));
 }
 
 void HLSLAnalyzer::NotifyUndeclaredIdent(const std::string& ident, const AST* ast)
 {
-    Warning("undeclared identifier \"" + ident + "\"", ast);
+    Warning(DiagnosticCodes::UndeclaredIdent, ast, &ident);
 }
 
 void HLSLAnalyzer::OpenScope()
@@ -131,7 +137,7 @@ void HLSLAnalyzer::CloseScope()
     symTable_.CloseScope();
 }
 
-void HLSLAnalyzer::Register(const std::string& ident, AST* ast, const OnOverrideProc& overrideProc)
+void HLSLAnalyzer::Register(const Ident& ident, AST* ast, const OnOverrideProc& overrideProc)
 {
     try
     {
@@ -139,36 +145,54 @@ void HLSLAnalyzer::Register(const std::string& ident, AST* ast, const OnOverride
     }
     catch (const std::exception& err)
     {
-        Error(err.what(), ast);
+        const std::string msg = err.what();
+        Error(DiagnosticCodes::ContextError, ast, &msg);
     }
 }
 
-AST* HLSLAnalyzer::Fetch(const std::string& ident) const
+AST* HLSLAnalyzer::Fetch(const Ident& ident) const
 {
     return symTable_.Fetch(ident);
 }
 
 AST* HLSLAnalyzer::Fetch(const VarIdentPtr& ident) const
 {
-    auto fullIdent = FullVarIdent(ident);
-    return Fetch(fullIdent);
+    return Fetch(FindFullVarIdent(ident));
 }
 
-void HLSLAnalyzer::ReportNullStmnt(const StmntPtr& ast, const std::string& stmntTypeName)
+void HLSLAnalyzer::ReportNullStmnt(const StmntPtr& ast, const char* stmntTypeName)
 {
-    if (ast && ast->Type() == AST::Types::NullStmnt)
-        Warning("<" + stmntTypeName + "> statement with empty body", ast.get());
+    if (log_ && enableWarnings_ && ast && ast->Type() == AST::Types::NullStmnt)
+    {
+        const std::string typeName = stmntTypeName;
+        Warning(DiagnosticCodes::EmptyStmntBody, ast, &typeName);
+    }
 }
 
 void HLSLAnalyzer::AcquireExtension(const Program::ARBExtension& extension)
 {
-    if (!IsVersionOut(extension.requiredVersion))
-        program_->requiredExtensions.insert(extension.extensionName);
+    /* The ARB extensions are not available for GLSL ES */
+    if (!IsVersionOut(extension.requiredVersion) && !IsESSL(versionOut_))
+    {
+        if (currentFunction_ && shaderTarget_ != ShaderTargets::CommonShader)
+            functionExtensions_[currentFunction_].insert(extension.extensionName);
+        else
+            program_->requiredExtensions.insert(extension.extensionName);
+    }
+}
+
+void HLSLAnalyzer::AcquireReferencedExtensions()
+{
+    for (const auto& it : functionExtensions_)
+    {
+        if (it.first->flags(FunctionDecl::isReferenced))
+            program_->requiredExtensions.insert(it.second.begin(), it.second.end());
+    }
 }
 
 bool HLSLAnalyzer::IsVersionOut(int version) const
 {
-    return static_cast<int>(versionOut_) >= version;
+    return GLSLFeatureVersion(versionOut_) >= version;
 }
 
 FunctionCall* HLSLAnalyzer::CurrentFunction() const
@@ -185,15 +209,47 @@ IMPLEMENT_VISIT_PROC(Program)
 {
     /* Analyze context of the entire program */
     for (auto& globDecl : ast->globalDecls)
-        Visit(globDecl);
+    {
+        if (streamHandler_)
+        {
+            /* Decorate each function body right after it has been parsed, and release it afterwards */
+            if (!streamHandler_->BeginGlobalDecl(globDecl))
+            {
+                hasErrors_ = true;
+                return;
+            }
+            DecorateGlobalDecl(globDecl);
+            streamHandler_->EndGlobalDecl(globDecl);
+        }
+        else
+            Visit(globDecl);
+    }
+
+    /*
+    Fold constant expressions (before the dead code is marked, so that folded conditions are considered).
+    For a streamed translation, only the global declarations are left here
+    */
+    if (foldConstants_)
+        constantFolder_.FoldConstants(ast);
+
+    /* Mark unreachable statements and unused local variables (before the references are marked) */
+    if (eliminateDeadCode_ && !streamHandler_)
+        deadCodeEliminator_.MarkDeadCode(ast, varyings_);
 
     if (shaderTarget_ != ShaderTargets::CommonShader)
     {
         /* Mark all functions used for the target shader */
         if (mainFunction_)
+        {
+            auto startTime = std::chrono::steady_clock::now();
             refAnalyzer_.MarkReferencesFromEntryPoint(mainFunction_, program_);
+            referenceAnalysisTime_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+            /* Only require the extensions of the functions which are reachable from the entry point */
+            AcquireReferencedExtensions();
+        }
         else
-            Error("entry point \"" + entryPoint_ + "\" not found");
+            Error(DiagnosticCodes::EntryPointNotFound, nullptr, &entryPoint_);
     }
 }
 
@@ -209,7 +265,7 @@ IMPLEMENT_VISIT_PROC(CodeBlock)
 
 IMPLEMENT_VISIT_PROC(FunctionCall)
 {
-    auto name = FullVarIdent(ast->name);
+    auto name = FindFullVarIdent(ast->name);
 
     /* Check if a specific intrinsic is used */
     if (name == "mul")
@@ -218,21 +274,21 @@ IMPLEMENT_VISIT_PROC(FunctionCall)
 
         /* Validate number of arguments */
         if (ast->arguments.size() != 2)
-            Error("\"mul\" intrinsic must have exactly 2 arguments", ast);
+            Error(DiagnosticCodes::InvalidNumArgsMul, ast);
     }
     else if (name == "rcp")
         ast->flags << FunctionCall::isRcpFunc;
     else
     {
-        auto it = intrinsicMap_.find(name);
-        if (it != intrinsicMap_.end())
+        auto it = tables_->intrinsicMap.find(name);
+        if (it != tables_->intrinsicMap.end())
         {
             switch (it->second)
             {
                 case IntrinsicClasses::Interlocked:
                     ast->flags << FunctionCall::isAtomicFunc;
                     if (ast->arguments.size() < 2)
-                        Error("interlocked intrinsics must have at least 2 arguments", ast);
+                        Error(DiagnosticCodes::InvalidNumArgsInterlocked, ast);
                     //program_->flags << Program::interlockedIntrinsicsUsed;
                     break;
             }
@@ -253,8 +309,8 @@ IMPLEMENT_VISIT_PROC(FunctionCall)
     }
 
     /* Check if this function requires a specific extension (or GLSL target version) */
-    auto it = extensionMap_.find(name);
-    if (it != extensionMap_.end())
+    auto it = tables_->extensionMap.find(name);
+    if (it != tables_->extensionMap.end())
         AcquireExtension(it->second);
 
     /* Analyze function arguments */
@@ -308,6 +364,8 @@ IMPLEMENT_VISIT_PROC(FunctionDecl)
 {
     const auto isEntryPoint = (ast->name == entryPoint_);
 
+    currentFunction_ = ast;
+
     /* Find previous function forward declarations */
     auto symbol = Fetch(ast->name);
     if (symbol && symbol->Type() == AST::Types::FunctionDecl)
@@ -357,18 +415,18 @@ IMPLEMENT_VISIT_PROC(FunctionDecl)
 
             /* Decorate program's input and output semantics */
             for (auto& param : ast->parameters)
-                program_->inputSemantics.parameters.push_back(param.get());
+                program_->inputSemantics.parameters.push_back(param);
 
-            program_->outputSemantics.returnType = ast->returnType.get();
+            program_->outputSemantics.returnType = ast->returnType;
             program_->outputSemantics.functionSemantic = ast->semantic;
 
             /* Add flags */
             ast->flags << FunctionDecl::isEntryPoint;
 
             /* Add flags to input- and output parameters of the main entry point */
-            DecorateEntryInOut(ast->returnType.get(), false);
+            DecorateEntryInOut(ast->returnType, false);
             for (auto& param : ast->parameters)
-                DecorateEntryInOut(param.get(), true);
+                DecorateEntryInOut(param, true);
 
             /* Check if fragment shader use a slightly different screen space (VPOS vs. SV_Position) */
             if (shaderTarget_ == ShaderTargets::GLSLFragmentShader && versionIn_ <= InputShaderVersions::HLSL3)
@@ -385,6 +443,8 @@ IMPLEMENT_VISIT_PROC(FunctionDecl)
         isInsideFunc_ = false;
     }
     CloseScope();
+
+    currentFunction_ = nullptr;
 }
 
 IMPLEMENT_VISIT_PROC(UniformBufferDecl)
@@ -570,7 +630,7 @@ IMPLEMENT_VISIT_PROC(ReturnStmnt)
     /* Analyze entry point return statement */
     if (isInsideEntryPoint_ && ast->expr->Type() == AST::Types::VarAccessExpr)
     {
-        auto varAccessExpr = dynamic_cast<VarAccessExpr*>(ast->expr.get());
+        auto varAccessExpr = dynamic_cast<VarAccessExpr*>(ast->expr);
         if (varAccessExpr && varAccessExpr->varIdent->symbolRef)
         {
             auto varObject = varAccessExpr->varIdent->symbolRef;
@@ -583,14 +643,17 @@ IMPLEMENT_VISIT_PROC(ReturnStmnt)
                     Variable declaration statement has been found,
                     now find the structure object to add the alias name for the interface block.
                     */
-                    auto varType = varDecl->declStmntRef->varType.get();
+                    auto varType = varDecl->declStmntRef->varType;
                     if (varType->symbolRef && varType->symbolRef->Type() == AST::Types::Structure)
                     {
                         auto structType = dynamic_cast<Structure*>(varType->symbolRef);
                         if (structType)
                         {
                             /* Store alias name for the interface block */
-                            structType->aliasName = varAccessExpr->varIdent->ident;
+                            if (varDecl->flags(VarDecl::isInsideFunc))
+                                structType->aliasName = localVarPrefix_ + varAccessExpr->varIdent->ident;
+                            else
+                                structType->aliasName = varAccessExpr->varIdent->ident;
 
                             /*
                             Don't generate code for this variable declaration,
@@ -632,14 +695,23 @@ IMPLEMENT_VISIT_PROC(TernaryExpr)
 
 IMPLEMENT_VISIT_PROC(BinaryExpr)
 {
-    /* Visit sub expressions */
-    Visit(ast->lhsExpr);
-    Visit(ast->rhsExpr);
+    /* Visit the binary expression chain iteratively (see HLSLParser::ParseExpr) */
+    ExprPtr expr = ast;
+    while (expr && expr->Type() == AST::Types::BinaryExpr)
+    {
+        auto binExpr = static_cast<BinaryExpr*>(expr);
 
-    /* Check if bitwise operators are used -> requires "GL_EXT_gpu_shader4" extensions */
-    const auto& op = ast->op;
-    if (op == "|" || op == "&" || op == "^" || op == "%")
-        AcquireExtension(ARBEXT_GL_EXT_gpu_shader4);
+        /* Visit left-hand-side expression */
+        Visit(binExpr->lhsExpr);
+
+        /* Check if bitwise operators are used -> requires "GL_EXT_gpu_shader4" extensions */
+        const auto& op = binExpr->op;
+        if (op == "|" || op == "&" || op == "^" || op == "%")
+            AcquireExtension(ARBEXT_GL_EXT_gpu_shader4);
+
+        expr = binExpr->rhsExpr;
+    }
+    Visit(expr);
 }
 
 IMPLEMENT_VISIT_PROC(UnaryExpr)
@@ -713,7 +785,7 @@ IMPLEMENT_VISIT_PROC(VarType)
     else if (ast->structType)
         Visit(ast->structType);
     else
-        Error("missing variable type", ast);
+        Error(DiagnosticCodes::MissingVarType, ast);
 }
 
 IMPLEMENT_VISIT_PROC(VarIdent)
@@ -752,6 +824,80 @@ IMPLEMENT_VISIT_PROC(VarDecl)
 
 /* --- Helper functions for context analysis --- */
 
+void HLSLAnalyzer::ResetDecorations(Program* program)
+{
+    /* Reset program decorations */
+    program->flags = Flags();
+    program->requiredExtensions.clear();
+    program->inputSemantics = Program::InputSemantics();
+    program->outputSemantics = Program::OutputSemantics();
+
+    /* Reset decorations of all nodes (the arenas own every node of the program) */
+    ForEachNode(
+        *program,
+        [](AST* node)
+        {
+            node->flags = Flags();
+
+            if (node->Type() >= AST::Types::ListExpr && node->Type() <= AST::Types::InitializerExpr)
+                static_cast<Expr*>(node)->constValue = ConstValue();
+
+            switch (node->Type())
+            {
+                case AST::Types::Structure:
+                {
+                    auto structure = static_cast<Structure*>(node);
+                    structure->aliasName.clear();
+                    structure->systemValuesRef.clear();
+                }
+                break;
+
+                case AST::Types::FunctionDecl:
+                    static_cast<FunctionDecl*>(node)->forwardDeclsRef.clear();
+                    break;
+
+                case AST::Types::VarType:
+                    static_cast<VarType*>(node)->symbolRef = nullptr;
+                    break;
+
+                case AST::Types::VarIdent:
+                {
+                    auto varIdent = static_cast<VarIdent*>(node);
+                    varIdent->symbolRef = nullptr;
+                    varIdent->systemSemantic.clear();
+                }
+                break;
+
+                case AST::Types::VarDecl:
+                    static_cast<VarDecl*>(node)->uniformBufferRef = nullptr;
+                    break;
+
+                default:
+                    break;
+            }
+        }
+    );
+}
+
+void HLSLAnalyzer::DecorateGlobalDecl(GlobalDecl* ast)
+{
+    Visit(ast);
+
+    if (ast->Type() == AST::Types::FunctionDecl)
+    {
+        auto functionDecl = static_cast<FunctionDecl*>(ast);
+        if (functionDecl->codeBlock)
+        {
+            if (foldConstants_)
+                constantFolder_.FoldConstants(functionDecl);
+            if (eliminateDeadCode_)
+                deadCodeEliminator_.MarkDeadCode(functionDecl);
+            if (shaderTarget_ != ShaderTargets::CommonShader)
+                refAnalyzer_.RecordReferences(functionDecl);
+        }
+    }
+}
+
 //!INCOMPLETE!
 void HLSLAnalyzer::DecorateEntryInOut(VarDeclStmnt* ast, bool isInput)
 {
@@ -826,7 +972,7 @@ void HLSLAnalyzer::DecorateVarObject(AST* symbol, VarIdent* varIdent)
                     auto structSymbol = dynamic_cast<Structure*>(varTypeSymbol);
                     if (structSymbol)
                     {
-                        auto ident = varIdent->next.get();
+                        auto ident = varIdent->next;
                         while (ident)
                         {
                             /* Search member in structure */
@@ -835,25 +981,13 @@ void HLSLAnalyzer::DecorateVarObject(AST* symbol, VarIdent* varIdent)
                                 FetchSystemValueSemantic(systemVal->second->semantics, ident->systemSemantic);
 
                             /* Check next identifier */
-                            ident = ident->next.get();
+                            ident = ident->next;
                         }
                     }
                 }
             }
-
-            /* Append prefix to local variables */
-            if (varDecl->flags(VarDecl::isInsideFunc))
-                varIdent->ident = localVarPrefix_ + varIdent->ident;
         }
     }
-    else if (symbol->Type() == AST::Types::SamplerDecl)
-    {
-        /* Exchange sampler object by its respective texture object () */
-        auto samplerDecl = dynamic_cast<SamplerDecl*>(symbol);
-        auto currentFunc = CurrentFunction();
-        if (samplerDecl && currentFunc && currentFunc->flags(FunctionCall::isTexFunc))
-            varIdent->ident = currentFunc->name->ident;
-    }
 }
 
 bool HLSLAnalyzer::FetchSystemValueSemantic(const std::vector<VarSemanticPtr>& varSemantics, std::string& semanticName) const
@@ -885,12 +1019,40 @@ template <typename T> void HLSLAnalyzer::DecorateVarObjectSymbol(T ast)
 {
     auto symbol = Fetch(ast->varIdent->ident);
     if (symbol)
-        DecorateVarObject(symbol, ast->varIdent.get());
+        DecorateVarObject(symbol, ast->varIdent);
     else
         NotifyUndeclaredIdent(ast->varIdent->ident, ast);
 }
 
 
+/*
+ * Tables structure
+ */
+
+HLSLAnalyzer::Tables::Tables()
+{
+    intrinsicMap = std::unordered_map<Ident, IntrinsicClasses>
+    {
+        { "InterlockedAdd",             IntrinsicClasses::Interlocked },
+        { "InterlockedAnd",             IntrinsicClasses::Interlocked },
+        { "InterlockedOr",              IntrinsicClasses::Interlocked },
+        { "InterlockedXor",             IntrinsicClasses::Interlocked },
+        { "InterlockedMin",             IntrinsicClasses::Interlocked },
+        { "InterlockedMax",             IntrinsicClasses::Interlocked },
+        { "InterlockedCompareExchange", IntrinsicClasses::Interlocked },
+        { "InterlockedExchange",        IntrinsicClasses::Interlocked },
+    };
+
+    extensionMap = std::unordered_map<Ident, Program::ARBExtension>
+    {
+        { "ddx_coarse", ARBEXT_GL_ARB_derivative_control },
+        { "ddy_coarse", ARBEXT_GL_ARB_derivative_control },
+        { "ddx_fine",   ARBEXT_GL_ARB_derivative_control },
+        { "ddy_fine",   ARBEXT_GL_ARB_derivative_control },
+    };
+}
+
+
 } // /namespace HTLib
 
 
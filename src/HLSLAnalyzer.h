@@ -11,13 +11,17 @@
 
 #include "HT/Translator.h"
 #include "ReferenceAnalyzer.h"
+#include "DeadCodeEliminator.h"
+#include "ConstantFolder.h"
+#include "StreamHandler.h"
 #include "CodeWriter.h"
 #include "Visitor.h"
 #include "Token.h"
-#include "SymbolTable.h"
+#include "FlatSymbolTable.h"
 #include "HLSLTree.h"
 
-#include <map>
+#include <unordered_map>
+#include <set>
 
 
 namespace HTLib
@@ -30,48 +34,99 @@ class HLSLAnalyzer : private Visitor
     
     public:
         
-        HLSLAnalyzer(Logger* log = nullptr);
+        /* === Enumerations === */
+
+        enum class IntrinsicClasses
+        {
+            Interlocked,
+        };
+
+        /* === Structures === */
+
+        /**
+        Immutable lookup tables of the context analyzer.
+        \remarks These tables are built once and can be shared by any number of analyzers (also across threads).
+        */
+        struct Tables
+        {
+            Tables();
 
+            std::unordered_map<Ident, IntrinsicClasses>               intrinsicMap;
+            std::unordered_map<Ident, Program::ARBExtension>          extensionMap;
+        };
+
+        HLSLAnalyzer(const Tables& tables, Logger* log = nullptr);
+
+        /**
+        Decorates the AST for the specified entry point and shader target.
+        \param[in,out] varyings Optional pointer to the shader interface of a pipeline translation.
+        The unused shader inputs and outputs are removed by the dead code elimination (see "DeadCodeEliminator").
+        \param[in] streamHandler Optional pointer to the handler of a streamed translation, which parses each function body
+        before it is decorated and releases it afterwards (see "Options::streamOutput"). This can not be used together with "varyings".
+        \remarks The decorations of a previous call are removed first, but the tree itself is not modified,
+        so the same program can be decorated (and generated) several times, e.g. once for each shader stage.
+        */
         bool DecorateAST(
             Program* program,
             const std::string& entryPoint,
             const ShaderTargets shaderTarget,
             const InputShaderVersions versionIn,
             const OutputShaderVersions versionOut,
-            const Options& options
+            const Options& options,
+            StageVaryings* varyings = nullptr,
+            StreamHandler* streamHandler = nullptr
         );
 
-    private:
-        
-        typedef ASTSymbolTable::OnOverrideProc OnOverrideProc;
+        /**
+        Begins to decorate the global declarations again, after the AST has been decorated with a stream handler (see "DecorateAST").
+        \remarks The decorations of the entire program are kept, only the symbol table is rebuilt.
+        No more messages are written to the log, since they have all been reported by "DecorateAST".
+        \see RedecorateGlobalDecl
+        */
+        void BeginRedecoration();
 
-        /* === Enumerations === */
+        /**
+        Decorates the specified global declaration again, e.g. a function whose body has been parsed again.
+        \remarks This must be called for all global declarations in their original order (see "BeginRedecoration").
+        The code generator calls this (through the stream handler) right before the code of each global declaration is written.
+        */
+        bool RedecorateGlobalDecl(GlobalDecl* ast);
 
-        enum class IntrinsicClasses
+        //! Returns the time (in seconds) of the reference analysis of the previous call to "DecorateAST".
+        inline double ReferenceAnalysisTime() const
         {
-            Interlocked,
-        };
+            return referenceAnalysisTime_;
+        }
 
-        /* === Functions === */
+    private:
         
-        void EstablishMaps();
+        typedef ASTSymbolTable::OnOverrideProc OnOverrideProc;
+
+        /* === Functions === */
 
-        void Error(const std::string& msg, const AST* ast = nullptr);
-        void Warning(const std::string& msg, const AST* ast = nullptr);
+        void Error(const DiagnosticCodes code, const AST* ast = nullptr, const std::string* arg = nullptr);
+        void Warning(const DiagnosticCodes code, const AST* ast = nullptr, const std::string* arg = nullptr);
         void NotifyUndeclaredIdent(const std::string& ident, const AST* ast = nullptr);
 
         void OpenScope();
         void CloseScope();
 
-        void Register(const std::string& ident, AST* ast, const OnOverrideProc& overrideProc = nullptr);
+        void Register(const Ident& ident, AST* ast, const OnOverrideProc& overrideProc = nullptr);
         
-        AST* Fetch(const std::string& ident) const;
+        AST* Fetch(const Ident& ident) const;
         AST* Fetch(const VarIdentPtr& ident) const;
 
-        void ReportNullStmnt(const StmntPtr& ast, const std::string& stmntTypeName);
+        void ReportNullStmnt(const StmntPtr& ast, const char* stmntTypeName);
 
+        /**
+        Acquires the specified extension for the program or for the current function.
+        \remarks The extensions of a function are only required, if the function is reachable from the entry point.
+        */
         void AcquireExtension(const Program::ARBExtension& extension);
 
+        //! Adds the extensions of all functions, which have been marked by the reference analyzer, to the program.
+        void AcquireReferencedExtensions();
+
         //! Returns true if the target version is greater than or equal to the specified version number.
         bool IsVersionOut(int version) const;
 
@@ -130,6 +185,15 @@ class HLSLAnalyzer : private Visitor
 
         /* --- Helper functions for context analysis --- */
 
+        //! Removes all decorations (flags and DAST references) from the program and all its nodes.
+        void ResetDecorations(Program* program);
+
+        /**
+        Decorates the specified global declaration, and the body of a function declaration with all other passes
+        (constant folding, dead code elimination, and the records of the reference analysis), since the body is released afterwards.
+        */
+        void DecorateGlobalDecl(GlobalDecl* ast);
+
         void DecorateEntryInOut(VarDeclStmnt* ast, bool isInput);
         void DecorateEntryInOut(VarType* ast, bool isInput);
         void DecorateVarObject(AST* symbol, VarIdent* varIdent);
@@ -143,27 +207,35 @@ class HLSLAnalyzer : private Visitor
 
         /* === Members === */
 
-        Logger*                 log_            = nullptr;
+        const Tables*           tables_             = nullptr;
+        Logger*                 log_                = nullptr;
 
-        bool                    hasErrors_      = false;
-        bool                    enableWarnings_ = false;
-        Program*                program_        = nullptr;
-        FunctionDecl*           mainFunction_   = nullptr;
+        bool                    hasErrors_          = false;
+        bool                    enableWarnings_     = false;
+        bool                    eliminateDeadCode_  = false;
+        bool                    foldConstants_      = false;
+        Program*                program_            = nullptr;
+        FunctionDecl*           mainFunction_       = nullptr;
+        FunctionDecl*           currentFunction_    = nullptr;
+        StageVaryings*          varyings_           = nullptr;
+        StreamHandler*          streamHandler_      = nullptr;
 
         std::string             entryPoint_;
-        ShaderTargets           shaderTarget_   = ShaderTargets::GLSLVertexShader;
-        InputShaderVersions     versionIn_      = InputShaderVersions::HLSL5;
-        OutputShaderVersions    versionOut_     = OutputShaderVersions::GLSL330;
+        ShaderTargets           shaderTarget_       = ShaderTargets::GLSLVertexShader;
+        InputShaderVersions     versionIn_          = InputShaderVersions::HLSL5;
+        OutputShaderVersions    versionOut_         = OutputShaderVersions::GLSL330;
         std::string             localVarPrefix_;
 
-        std::map<std::string, IntrinsicClasses> intrinsicMap_;
-        std::map<std::string, Program::ARBExtension> extensionMap_;
-
         std::stack<FunctionCall*>   callStack_;     //!< Function call stack to join arguments with its function call.
         std::vector<Structure*>     structStack_;   //!< Structure stack to collect all members with system value semantic (SV_...).
 
+        std::unordered_map<FunctionDecl*, std::set<std::string>> functionExtensions_; //!< Extensions required by each function.
+
         ASTSymbolTable      symTable_;
         ReferenceAnalyzer   refAnalyzer_;
+        DeadCodeEliminator  deadCodeEliminator_;
+        ConstantFolder      constantFolder_;
+        double              referenceAnalysisTime_ = 0.0;
 
         bool isInsideFunc_          = false; //!< True if AST traversal is currently inside any function.
         bool isInsideEntryPoint_    = false; //!< True if AST traversal is currently inside the main entry point (or its sub nodes).
@@ -7,16 +7,44 @@
 
 #include "HLSLKeywords.h"
 
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
 
 namespace HTLib
 {
 
 
+//! Adds the scalar, vector and matrix types of the HLSL minimum precision types (e.g. "min16float4x4") to the keyword map.
+static void AddMinPrecisionTypes(KeywordMapType& keywords)
+{
+    typedef Token::Types Ty;
+
+    for (auto baseType : { "min16float", "min10float", "min16int", "min12int", "min16uint" })
+    {
+        const std::string name = baseType;
+
+        keywords[name] = Ty::ScalarType;
+        keywords[name + "1"] = Ty::ScalarType;
+        keywords[name + "1x1"] = Ty::ScalarType;
+
+        for (char rows = '2'; rows <= '4'; ++rows)
+        {
+            keywords[name + rows] = Ty::VectorType;
+            for (char cols = '2'; cols <= '4'; ++cols)
+                keywords[name + rows + 'x' + cols] = Ty::MatrixType;
+        }
+    }
+}
+
 static KeywordMapType GenerateKeywordMap()
 {
     typedef Token::Types Ty;
 
-    return
+    KeywordMapType keywords
     {
         { "true",                    Ty::BoolLiteral     },
         { "false",                   Ty::BoolLiteral     },
@@ -194,6 +222,10 @@ static KeywordMapType GenerateKeywordMap()
         { "row_major",               Ty::TypeModifier    },
         { "column_major",            Ty::TypeModifier    },
     };
+
+    AddMinPrecisionTypes(keywords);
+
+    return keywords;
 }
 
 static KeywordMapType keywordMap = GenerateKeywordMap();
@@ -204,6 +236,126 @@ const KeywordMapType& HLSLKeywords()
 }
 
 
+/*
+ * KeywordHashTable class
+ */
+
+//! Perfect hash table of all keywords, i.e. each keyword has its own slot.
+class KeywordHashTable
+{
+    
+    public:
+        
+        KeywordHashTable(const KeywordMapType& keywords);
+
+        bool Find(const char* ident, std::size_t length, Token::Types& type) const;
+
+    private:
+        
+        struct Entry
+        {
+            const char*     ident;
+            std::size_t     length;
+            Token::Types    type;
+        };
+
+        std::uint32_t Hash(const char* ident, std::size_t length) const;
+
+        //! Tries to place all entries with the current seed. Returns false on a collision.
+        bool Generate();
+
+        std::vector<Entry>          entries_;
+        std::vector<std::uint16_t>  slots_;         //!< Indices into "entries_" plus one, or zero for empty slots.
+        std::uint32_t               seed_       = 0;
+        std::uint32_t               mask_       = 0;
+        std::size_t                 maxLength_  = 0;
+
+};
+
+KeywordHashTable::KeywordHashTable(const KeywordMapType& keywords)
+{
+    for (const auto& it : keywords)
+    {
+        entries_.push_back({ it.first.c_str(), it.first.size(), it.second });
+        maxLength_ = std::max(maxLength_, it.first.size());
+    }
+
+    /* Find a seed without collisions, start with a table size of at least eight times the number of keywords */
+    std::size_t tableSize = 1;
+    while (tableSize < entries_.size() * 8)
+        tableSize <<= 1;
+
+    for (; tableSize <= 0x10000; tableSize <<= 1)
+    {
+        mask_ = static_cast<std::uint32_t>(tableSize - 1);
+        for (seed_ = 0; seed_ < 0x10000; ++seed_)
+        {
+            if (Generate())
+                return;
+        }
+    }
+
+    throw std::runtime_error("failed to generate perfect hash table for keywords");
+}
+
+bool KeywordHashTable::Find(const char* ident, std::size_t length, Token::Types& type) const
+{
+    if (length > maxLength_)
+        return false;
+
+    auto index = slots_[Hash(ident, length) & mask_];
+    if (index == 0)
+        return false;
+
+    const auto& entry = entries_[index - 1];
+    if (entry.length != length || std::memcmp(entry.ident, ident, length) != 0)
+        return false;
+
+    type = entry.type;
+    return true;
+}
+
+std::uint32_t KeywordHashTable::Hash(const char* ident, std::size_t length) const
+{
+    /* FNV-1a hash with a seed and a final avalanche step */
+    auto h = (2166136261u ^ seed_) + static_cast<std::uint32_t>(length);
+
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        h ^= static_cast<unsigned char>(ident[i]);
+        h *= 16777619u;
+    }
+
+    h ^= (h >> 15);
+    h *= 0x2C1B3C6Du;
+    h ^= (h >> 12);
+
+    return h;
+}
+
+bool KeywordHashTable::Generate()
+{
+    slots_.assign(mask_ + 1, 0);
+
+    for (std::size_t i = 0; i < entries_.size(); ++i)
+    {
+        auto& slot = slots_[Hash(entries_[i].ident, entries_[i].length) & mask_];
+        if (slot != 0)
+            return false;
+        slot = static_cast<std::uint16_t>(i + 1);
+    }
+
+    return true;
+}
+
+static const KeywordHashTable keywordHashTable(keywordMap);
+
+bool FindHLSLKeyword(const char* ident, std::size_t length, Token::Types& type)
+{
+    return keywordHashTable.Find(ident, length, type);
+}
+
+
 } // /namespace HTLib
 
 
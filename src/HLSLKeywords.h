@@ -13,6 +13,7 @@
 
 #include <map>
 #include <string>
+#include <cstddef>
 
 
 namespace HTLib
@@ -24,6 +25,17 @@ typedef std::map<std::string, Token::Types> KeywordMapType;
 //! Returns the keywords map (which is an exception for identifiers).
 const KeywordMapType& HLSLKeywords();
 
+/**
+Looks up the specified identifier in the keyword table.
+\param[in] ident Pointer to the first character of the identifier. This does not need to be null terminated.
+\param[in] length Specifies the number of characters of the identifier.
+\param[out] type Receives the token type of the keyword.
+\return True if the identifier is a keyword.
+\remarks This uses a perfect hash table, which is generated once from the keywords map.
+A lookup allocates no memory and requires at most one string comparison.
+*/
+bool FindHLSLKeyword(const char* ident, std::size_t length, Token::Types& type);
+
 
 } // /namespace HTLib
 
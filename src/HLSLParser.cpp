@@ -13,6 +13,9 @@ namespace HTLib
 {
 
 
+//! Maximal block size of the body arenas, so that the last block of each function body doesn't waste much memory.
+static const std::size_t bodyArenaBlockSize = 4 * 1024;
+
 HLSLParser::HLSLParser(Logger* log) :
     scanner_{ log },
     log_    { log }
@@ -21,14 +24,66 @@ HLSLParser::HLSLParser(Logger* log) :
 
 ProgramPtr HLSLParser::ParseSource(const std::shared_ptr<SourceCode>& source)
 {
-    if (!scanner_.ScanSource(source))
+    /* The program owns the arena for all other nodes and the string pool for all token spellings */
+    auto program = std::make_shared<Program>(SourcePosition::ignore);
+
+    tokens_ = nullptr;
+    if (!scanner_.ScanSource(source, program->stringPool))
+        return nullptr;
+
+    return ParseProgramPrimary(program);
+}
+
+ProgramPtr HLSLParser::ParseTokens(const std::vector<TokenPtr>& tokens)
+{
+    if (tokens.empty())
+        return nullptr;
+
+    tokens_ = &tokens;
+    tokenIndex_ = 0;
+
+    return ParseProgramPrimary(std::make_shared<Program>(SourcePosition::ignore));
+}
+
+bool HLSLParser::ParseFunctionBody(FunctionDecl* ast, Program& program)
+{
+    if (!ast->HasLazyBody())
+        return true;
+
+    auto& body = *(ast->lazyBody);
+    if (body.offset >= body.source.size() || body.source[body.offset] != '{')
+    {
+        if (log_)
+            log_->Error("invalid lazy body of function \"" + ast->name + "\"");
+        return false;
+    }
+
+    /* Scan the body (from the opening '{') with the source positions of the original source */
+    auto source = std::make_shared<SourceCode>(
+        body.source.data() + body.offset, body.source.size() - body.offset, body.source.data(), body.row
+    );
+
+    tokens_ = nullptr;
+    if (!scanner_.ScanSource(source, program.stringPool))
         return false;
 
+    arena_ = BodyArena(ast, program.arena);
+
     AcceptIt();
 
     try
     {
-        return ParseProgram();
+        auto codeBlock = ParseCodeBlock();
+        if (!Is(Tokens::EndOfStream))
+            ErrorUnexpected();
+
+        ast->codeBlock = codeBlock;
+
+        /* Keep the source if the body can be released, so that it can be parsed again */
+        if (!bodyArenas_)
+            std::string().swap(body.source);
+
+        return true;
     }
     catch (const std::exception& err)
     {
@@ -36,7 +91,12 @@ ProgramPtr HLSLParser::ParseSource(const std::shared_ptr<SourceCode>& source)
             log_->Error(err.what());
     }
 
-    return nullptr;
+    return false;
+}
+
+double HLSLParser::ScanTime() const
+{
+    return std::chrono::duration<double>(scanTime_).count();
 }
 
 
@@ -44,41 +104,99 @@ ProgramPtr HLSLParser::ParseSource(const std::shared_ptr<SourceCode>& source)
  * ======= Private: =======
  */
 
+ProgramPtr HLSLParser::ParseProgramPrimary(const ProgramPtr& program)
+{
+    arena_ = &(program->arena);
+
+    numTokens_ = 0;
+    scanTime_ = std::chrono::steady_clock::duration::zero();
+
+    AcceptIt();
+
+    try
+    {
+        ParseProgram(program.get());
+        return program;
+    }
+    catch (const std::exception& err)
+    {
+        if (log_)
+            log_->Error(err.what());
+    }
+
+    return nullptr;
+}
+
+ASTArena* HLSLParser::BodyArena(FunctionDecl* ast, ASTArena& programArena)
+{
+    if (!bodyArenas_)
+        return &programArena;
+    if (!ast->bodyArena)
+        ast->bodyArena = std::unique_ptr<ASTArena>(new ASTArena(bodyArenaBlockSize));
+    return ast->bodyArena.get();
+}
+
 void HLSLParser::Error(const std::string& msg)
 {
-    throw std::runtime_error("syntax error (" + scanner_.Pos().ToString() + ") : " + msg);
+    throw std::runtime_error("syntax error (" + Pos().ToString() + ") : " + msg);
+}
+
+SourcePosition HLSLParser::Pos() const
+{
+    if (tokens_)
+        return tkn_.Pos();
+    return scanner_.Pos();
 }
 
 void HLSLParser::ErrorUnexpected()
 {
-    Error("unexpected token '" + tkn_->Spell() + "'");
+    Error("unexpected token '" + tkn_.Spell() + "'");
 }
 
 void HLSLParser::ErrorUnexpected(const std::string& hint)
 {
-    Error("unexpected token '" + tkn_->Spell() + "' (" + hint + ")");
+    Error("unexpected token '" + tkn_.Spell() + "' (" + hint + ")");
 }
 
-TokenPtr HLSLParser::Accept(const Tokens type)
+Token HLSLParser::Accept(const Tokens type)
 {
-    if (tkn_->Type() != type)
+    if (tkn_.Type() != type)
         ErrorUnexpected();
     return AcceptIt();
 }
 
-TokenPtr HLSLParser::Accept(const Tokens type, const std::string& spell)
+Token HLSLParser::Accept(const Tokens type, const std::string& spell)
 {
-    if (tkn_->Type() != type)
+    if (tkn_.Type() != type)
         ErrorUnexpected();
-    if (tkn_->Spell() != spell)
-        Error("unexpected token spelling '" + tkn_->Spell() + "' (expected '" + spell + "')");
+    if (tkn_.Spell() != spell)
+        Error("unexpected token spelling '" + tkn_.Spell() + "' (expected '" + spell + "')");
     return AcceptIt();
 }
 
-TokenPtr HLSLParser::AcceptIt()
+Token HLSLParser::AcceptIt()
 {
     auto prevTkn = tkn_;
-    tkn_ = scanner_.Next();
+
+    if (tokens_)
+    {
+        /* Read next preprocessed token (the final 'EndOfStream' token is returned repeatedly) */
+        tkn_ = *(*tokens_)[tokenIndex_];
+        if (tokenIndex_ + 1 < tokens_->size())
+            ++tokenIndex_;
+    }
+    else if (measureScanTime_)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        tkn_ = scanner_.Next();
+        scanTime_ += std::chrono::steady_clock::now() - startTime;
+    }
+    else
+        tkn_ = scanner_.Next();
+
+    if (tkn_.Type() != Tokens::EndOfStream)
+        ++numTokens_;
+
     return prevTkn;
 }
 
@@ -104,14 +222,12 @@ bool HLSLParser::IsPrimaryExpr() const
 
 /* ------- Parse functions ------- */
 
-ProgramPtr HLSLParser::ParseProgram()
+void HLSLParser::ParseProgram(Program* ast)
 {
-    auto ast = Make<Program>();
+    ast->pos = Pos();
 
     while (!Is(Tokens::EndOfStream))
         ast->globalDecls.push_back(ParseGlobalDecl());
-
-    return ast;
 }
 
 CodeBlockPtr HLSLParser::ParseCodeBlock()
@@ -131,7 +247,7 @@ BufferDeclIdentPtr HLSLParser::ParseBufferDeclIdent()
     auto ast = Make<BufferDeclIdent>();
 
     /* Parse identifier and optional register */
-    ast->ident = Accept(Tokens::Ident)->Spell();
+    ast->ident = Accept(Tokens::Ident).SpellIdent();
     if (Is(Tokens::Colon))
         ast->registerName = ParseRegister();
 
@@ -148,7 +264,7 @@ FunctionCallPtr HLSLParser::ParseFunctionCall(VarIdentPtr varIdent)
         if (IsDataType())
         {
             varIdent = Make<VarIdent>();
-            varIdent->ident = AcceptIt()->Spell();
+            varIdent->ident = AcceptIt().SpellIdent();
         }
         else
             varIdent = ParseVarIdent();
@@ -168,7 +284,7 @@ StructurePtr HLSLParser::ParseStructure()
 
     Accept(Tokens::Struct);
 
-    ast->name = Accept(Tokens::Ident)->Spell();
+    ast->name = Accept(Tokens::Ident).SpellIdent();
     ast->members = ParseVarDeclStmntList();
 
     return ast;
@@ -182,11 +298,11 @@ VarDeclStmntPtr HLSLParser::ParseParameter()
     while (Is(Tokens::InputModifier) || Is(Tokens::TypeModifier) || Is(Tokens::StorageModifier))
     {
         if (Is(Tokens::InputModifier))
-            ast->inputModifier = AcceptIt()->Spell();
+            ast->inputModifier = AcceptIt().Spell();
         else if (Is(Tokens::TypeModifier))
-            ast->typeModifiers.push_back(AcceptIt()->Spell());
+            ast->typeModifiers.push_back(AcceptIt().Spell());
         else if (Is(Tokens::StorageModifier))
-            ast->storageModifiers.push_back(AcceptIt()->Spell());
+            ast->storageModifiers.push_back(AcceptIt().Spell());
     }
 
     ast->varType = ParseVarType();
@@ -247,7 +363,7 @@ FunctionDeclPtr HLSLParser::ParseFunctionDecl()
     /* Parse function header */
     ast->attribs = ParseAttributeList();
     ast->returnType = ParseVarType(true);
-    ast->name = Accept(Tokens::Ident)->Spell();
+    ast->name = Accept(Tokens::Ident).SpellIdent();
     ast->parameters = ParseParameterList();
     
     if (Is(Tokens::Colon))
@@ -256,8 +372,27 @@ FunctionDeclPtr HLSLParser::ParseFunctionDecl()
     /* Parse function body */
     if (Is(Tokens::Semicolon))
         AcceptIt();
+    else if (lazyFunctionBodies_ && !tokens_ && Is(Tokens::LCurly))
+    {
+        /* Only store the source of the function body, which will be parsed on demand (see "ParseFunctionBody") */
+        ast->lazyBody = std::unique_ptr<FunctionDecl::LazyBody>(new FunctionDecl::LazyBody());
+        auto& body = *(ast->lazyBody);
+
+        auto startTime = std::chrono::steady_clock::now();
+        scanner_.SkipCodeBlock(body.source, body.offset, body.row, body.calledNames);
+        if (measureScanTime_)
+            scanTime_ += std::chrono::steady_clock::now() - startTime;
+
+        AcceptIt();
+    }
     else
+    {
+        /* Allocate the body in the body arena of this function (if enabled) */
+        auto programArena = arena_;
+        arena_ = BodyArena(ast, *programArena);
         ast->codeBlock = ParseCodeBlock();
+        arena_ = programArena;
+    }
 
     return ast;
 }
@@ -267,8 +402,8 @@ UniformBufferDeclPtr HLSLParser::ParseUniformBufferDecl()
     auto ast = Make<UniformBufferDecl>();
 
     /* Parse buffer header */
-    ast->bufferType = Accept(Tokens::UniformBuffer)->Spell();
-    ast->name = Accept(Tokens::Ident)->Spell();
+    ast->bufferType = Accept(Tokens::UniformBuffer).Spell();
+    ast->name = Accept(Tokens::Ident).SpellIdent();
 
     /* Parse optional register */
     if (Is(Tokens::Colon))
@@ -286,13 +421,13 @@ TextureDeclPtr HLSLParser::ParseTextureDecl()
 {
     auto ast = Make<TextureDecl>();
 
-    ast->textureType = Accept(Tokens::Texture)->Spell();
+    ast->textureType = Accept(Tokens::Texture).SpellIdent();
 
     /* Parse optional generic color type ('<' colorType '>') */
     if (Is(Tokens::BinaryOp, "<"))
     {
         AcceptIt();
-        ast->colorType = Accept(Tokens::ScalarType)->Spell();
+        ast->colorType = Accept(Tokens::ScalarType).Spell();
         Accept(Tokens::BinaryOp, ">");
     }
 
@@ -307,7 +442,7 @@ SamplerDeclPtr HLSLParser::ParseSamplerDecl()
 {
     auto ast = Make<SamplerDecl>();
 
-    ast->samplerType = Accept(Tokens::Sampler)->Spell();
+    ast->samplerType = Accept(Tokens::Sampler).SpellIdent();
     ast->names = ParseBufferDeclIdentList();
 
     Semi();
@@ -329,7 +464,7 @@ DirectiveDeclPtr HLSLParser::ParseDirectiveDecl()
 {
     /* Parse pre-processor directive line */
     auto ast = Make<DirectiveDecl>();
-    ast->line = Accept(Tokens::Directive)->Spell();
+    ast->line = Accept(Tokens::Directive).Spell();
     return ast;
 }
 
@@ -342,7 +477,7 @@ FunctionCallPtr HLSLParser::ParseAttribute()
     Accept(Tokens::LParen);
 
     ast->name = Make<VarIdent>();
-    ast->name->ident = Accept(Tokens::Ident)->Spell();
+    ast->name->ident = Accept(Tokens::Ident).SpellIdent();
 
     if (Is(Tokens::LBracket))
     {
@@ -379,12 +514,12 @@ PackOffsetPtr HLSLParser::ParsePackOffset(bool parseColon)
     Accept(Tokens::PackOffset);
     Accept(Tokens::LBracket);
 
-    ast->registerName = Accept(Tokens::Ident)->Spell();
+    ast->registerName = Accept(Tokens::Ident).Spell();
 
     if (Is(Tokens::Dot))
     {
         AcceptIt();
-        ast->vectorComponent = Accept(Tokens::Ident)->Spell();
+        ast->vectorComponent = Accept(Tokens::Ident).Spell();
     }
 
     Accept(Tokens::RBracket);
@@ -417,7 +552,7 @@ VarSemanticPtr HLSLParser::ParseVarSemantic()
     else if (Is(Tokens::PackOffset))
         ast->packOffset = ParsePackOffset(false);
     else
-        ast->semantic = Accept(Tokens::Ident)->Spell();
+        ast->semantic = Accept(Tokens::Ident).Spell();
 
     return ast;
 }
@@ -427,7 +562,7 @@ VarIdentPtr HLSLParser::ParseVarIdent()
     auto ast = Make<VarIdent>();
 
     /* Parse variable single identifier */
-    ast->ident = Accept(Tokens::Ident)->Spell();
+    ast->ident = Accept(Tokens::Ident).SpellIdent();
     ast->arrayIndices = ParseArrayDimensionList();
     
     if (Is(Tokens::Dot))
@@ -447,12 +582,12 @@ VarTypePtr HLSLParser::ParseVarType(bool parseVoidType)
     if (Is(Tokens::Void))
     {
         if (parseVoidType)
-            ast->baseType = AcceptIt()->Spell();
+            ast->baseType = AcceptIt().SpellIdent();
         else
             Error("'void' type not allowed in this context");
     }
     else if (Is(Tokens::Ident) || IsDataType())
-        ast->baseType = AcceptIt()->Spell();
+        ast->baseType = AcceptIt().SpellIdent();
     else if (Is(Tokens::Struct))
     {
         /*
@@ -460,7 +595,7 @@ VarTypePtr HLSLParser::ParseVarType(bool parseVoidType)
         decorate the VarType AST node with its own structure type
         */
         ast->structType = ParseStructure();
-        ast->symbolRef = ast->structType.get();
+        ast->symbolRef = ast->structType;
     }
     else
         ErrorUnexpected("expected type specifier");
@@ -473,7 +608,7 @@ VarDeclPtr HLSLParser::ParseVarDecl()
     auto ast = Make<VarDecl>();
 
     /* Parse variable declaration */
-    ast->name = Accept(Tokens::Ident)->Spell();
+    ast->name = Accept(Tokens::Ident).SpellIdent();
     ast->arrayDims = ParseArrayDimensionList();
     ast->semantics = ParseVarSemanticList();
 
@@ -545,7 +680,7 @@ DirectiveStmntPtr HLSLParser::ParseDirectiveStmnt()
 {
     /* Parse pre-processor directive statement */
     auto ast = Make<DirectiveStmnt>();
-    ast->line = Accept(Tokens::Directive)->Spell();
+    ast->line = Accept(Tokens::Directive).Spell();
     return ast;
 }
 
@@ -681,7 +816,7 @@ CtrlTransferStmntPtr HLSLParser::ParseCtrlTransferStmnt()
     /* Parse control transfer statement */
     auto ast = Make<CtrlTransferStmnt>();
     
-    ast->instruction = Accept(Tokens::CtrlTransfer)->Spell();
+    ast->instruction = Accept(Tokens::CtrlTransfer).Spell();
     Semi();
 
     return ast;
@@ -696,19 +831,19 @@ VarDeclStmntPtr HLSLParser::ParseVarDeclStmnt()
         if (Is(Tokens::StorageModifier))
         {
             /* Parse storage modifiers */
-            auto ident = AcceptIt()->Spell();
+            auto ident = AcceptIt().Spell();
             ast->storageModifiers.push_back(ident);
         }
         else if (Is(Tokens::TypeModifier))
         {
             /* Parse type modifier (const, row_major, column_major) */
-            auto ident = AcceptIt()->Spell();
+            auto ident = AcceptIt().Spell();
             ast->typeModifiers.push_back(ident);
         }
         else if (Is(Tokens::Ident))
         {
             /* Parse base variable type */
-            auto ident = AcceptIt()->Spell();
+            auto ident = AcceptIt().SpellIdent();
             ast->varType = Make<VarType>();
             ast->varType->baseType = ident;
             break;
@@ -724,7 +859,7 @@ VarDeclStmntPtr HLSLParser::ParseVarDeclStmnt()
         {
             /* Parse base variable type */
             ast->varType = Make<VarType>();
-            ast->varType->baseType = AcceptIt()->Spell();
+            ast->varType->baseType = AcceptIt().SpellIdent();
             break;
         }
         else
@@ -737,7 +872,7 @@ VarDeclStmntPtr HLSLParser::ParseVarDeclStmnt()
 
     /* Decorate variable declarations with this statement AST node */
     for (auto& varDecl : ast->varDecls)
-        varDecl->declStmntRef = ast.get();
+        varDecl->declStmntRef = ast;
 
     return ast;
 }
@@ -827,7 +962,7 @@ StmntPtr HLSLParser::ParseVarDeclOrAssignOrFunctionCallStmnt()
         auto ast = Make<AssignStmnt>();
         
         ast->varIdent = varIdent;
-        ast->op = AcceptIt()->Spell();
+        ast->op = AcceptIt().Spell();
         ast->expr = ParseExpr(true);
         Semi();
 
@@ -851,7 +986,7 @@ StmntPtr HLSLParser::ParseVarDeclOrAssignOrFunctionCallStmnt()
 
         /* Decorate variable declarations with this statement AST node */
         for (auto& varDecl : ast->varDecls)
-            varDecl->declStmntRef = ast.get();
+            varDecl->declStmntRef = ast;
 
         return ast;
     }
@@ -865,59 +1000,81 @@ StmntPtr HLSLParser::ParseVarDeclOrAssignOrFunctionCallStmnt()
 
 ExprPtr HLSLParser::ParseExpr(bool allowComma, const ExprPtr& initExpr)
 {
-    /* Parse primary expression */
+    /*
+    Binary expressions are linked to the right without operator precedence (e.g. "a * b + c" is parsed as "a * (b + c)",
+    but the operators are generated in the same order), and so are list expressions. Such a chain is parsed in a loop instead of a recursion for each operand,
+    so that machine generated expressions with thousands of operands can't exhaust the call stack.
+    The "tail" points to the slot of the chain, which receives the next expression.
+    */
+    ExprPtr chain = nullptr;
+    ExprPtr* tail = &chain;
+
     ExprPtr ast = initExpr;
-    if (!ast)
-        ast = ParsePrimaryExpr();
 
-    /* Parse optional post-unary expression */
-    if (Is(Tokens::UnaryOp))
+    while (true)
     {
-        auto unaryExpr = Make<PostUnaryExpr>();
-        unaryExpr->expr = ast;
-        unaryExpr->op = AcceptIt()->Spell();
-        ast = unaryExpr;
-    }
+        /* Parse primary expression */
+        if (!ast)
+            ast = ParsePrimaryExpr();
 
-    /* Parse optional binary expression */
-    if (Is(Tokens::BinaryOp))
-    {
-        auto binExpr = Make<BinaryExpr>();
+        /* Parse optional post-unary expression */
+        if (Is(Tokens::UnaryOp))
+        {
+            auto unaryExpr = Make<PostUnaryExpr>();
+            unaryExpr->expr = ast;
+            unaryExpr->op = AcceptIt().Spell();
+            ast = unaryExpr;
+        }
 
-        binExpr->lhsExpr = ast;
-        binExpr->op = AcceptIt()->Spell();
-        binExpr->rhsExpr = ParseExpr(allowComma);
+        /* Parse optional binary expression */
+        if (Is(Tokens::BinaryOp))
+        {
+            auto binExpr = Make<BinaryExpr>();
 
-        return binExpr;
-    }
+            binExpr->lhsExpr = ast;
+            binExpr->op = AcceptIt().Spell();
 
-    /* Parse optional ternary expression */
-    if (Is(Tokens::TernaryOp))
-    {
-        auto ternExpr = Make<TernaryExpr>();
+            *tail = binExpr;
+            tail = &(binExpr->rhsExpr);
+            ast = nullptr;
+            continue;
+        }
 
-        ternExpr->condition = ast;
-        AcceptIt();
-        ternExpr->ifExpr = ParseExpr();
-        Accept(Tokens::Colon);
-        ternExpr->elseExpr = ParseExpr();
+        /* Parse optional ternary expression */
+        if (Is(Tokens::TernaryOp))
+        {
+            auto ternExpr = Make<TernaryExpr>();
 
-        return ternExpr;
-    }
+            ternExpr->condition = ast;
+            AcceptIt();
+            ternExpr->ifExpr = ParseExpr();
+            Accept(Tokens::Colon);
+            ternExpr->elseExpr = ParseExpr();
 
-    /* Parse optional list expression */
-    if (allowComma && Is(Tokens::Comma))
-    {
-        AcceptIt();
+            ast = ternExpr;
+            break;
+        }
 
-        auto listExpr = Make<ListExpr>();
-        listExpr->firstExpr = ast;
-        listExpr->nextExpr = ParseExpr(true);
+        /* Parse optional list expression */
+        if (allowComma && Is(Tokens::Comma))
+        {
+            AcceptIt();
 
-        return listExpr;
+            auto listExpr = Make<ListExpr>();
+            listExpr->firstExpr = ast;
+
+            *tail = listExpr;
+            tail = &(listExpr->nextExpr);
+            ast = nullptr;
+            continue;
+        }
+
+        break;
     }
 
-    return ast;
+    *tail = ast;
+
+    return chain;
 }
 
 ExprPtr HLSLParser::ParsePrimaryExpr()
@@ -947,7 +1104,7 @@ LiteralExprPtr HLSLParser::ParseLiteralExpr()
 
     /* Parse literal */
     auto ast = Make<LiteralExpr>();    
-    ast->literal = AcceptIt()->Spell();
+    ast->literal = AcceptIt().Spell();
     return ast;
 }
 
@@ -957,7 +1114,7 @@ ExprPtr HLSLParser::ParseTypeNameOrFunctionCallExpr()
     if (!IsDataType())
         ErrorUnexpected("expected type name or function call expression");
 
-    auto typeName = AcceptIt()->Spell();
+    auto typeName = AcceptIt().SpellIdent();
 
     /* Determine which kind of expression this is */
     if (Is(Tokens::LBracket))
@@ -981,7 +1138,7 @@ UnaryExprPtr HLSLParser::ParseUnaryExpr()
 
     /* Parse unary expression */
     auto ast = Make<UnaryExpr>();
-    ast->op = AcceptIt()->Spell();
+    ast->op = AcceptIt().Spell();
     ast->expr = ParsePrimaryExpr();
     return ast;
 }
@@ -1004,7 +1161,7 @@ ExprPtr HLSLParser::ParseBracketOrCastExpr()
     if ( IsPrimaryExpr() &&
          ( expr->Type() == AST::Types::TypeNameExpr ||
            ( expr->Type() == AST::Types::VarAccessExpr &&
-             dynamic_cast<VarAccessExpr*>(expr.get())->assignExpr == nullptr ) ) )
+             dynamic_cast<VarAccessExpr*>(expr)->assignExpr == nullptr ) ) )
     {
         /* Return cast expression */
         auto ast = Make<CastExpr>();
@@ -1040,7 +1197,7 @@ VarAccessExprPtr HLSLParser::ParseVarAccessExpr(const VarIdentPtr& varIdent)
     /* Parse optional assign expression */
     if (Is(Tokens::AssignOp))
     {
-        ast->assignOp = AcceptIt()->Spell();
+        ast->assignOp = AcceptIt().Spell();
         ast->assignExpr = ParseExpr();
     }
 
@@ -1236,7 +1393,7 @@ std::string HLSLParser::ParseRegister(bool parseColon)
     Accept(Tokens::Register);
     Accept(Tokens::LBracket);
 
-    auto registerName = Accept(Tokens::Ident)->Spell();
+    auto registerName = Accept(Tokens::Ident).Spell();
 
     Accept(Tokens::RBracket);
 
@@ -1246,7 +1403,7 @@ std::string HLSLParser::ParseRegister(bool parseColon)
 std::string HLSLParser::ParseSemantic()
 {
     Accept(Tokens::Colon);
-    return Accept(Tokens::Ident)->Spell();
+    return Accept(Tokens::Ident).Spell();
 }
 
 
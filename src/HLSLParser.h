@@ -13,10 +13,12 @@
 #include "HLSLScanner.h"
 #include "Visitor.h"
 #include "Token.h"
+#include "HLSLTree.h"
 
 #include <vector>
 #include <map>
 #include <string>
+#include <chrono>
 
 
 namespace HTLib
@@ -33,6 +35,59 @@ class HLSLParser
 
         ProgramPtr ParseSource(const std::shared_ptr<SourceCode>& source);
 
+        /**
+        Parses the specified preprocessed token stream.
+        \param[in] tokens Specifies the tokens, which must be terminated by an 'EndOfStream' token.
+        \see HLSLPreprocessor::Process
+        */
+        ProgramPtr ParseTokens(const std::vector<TokenPtr>& tokens);
+
+        /**
+        Parses the body of the specified function, which has been skipped by the parser before.
+        \param[in,out] ast Specifies the function declaration. If the body was parsed successfully, "ast->codeBlock" is set.
+        \param[in] program Specifies the program which owns the function declaration.
+        All new nodes are allocated in its arena, or in the body arena of the function if body arenas are enabled.
+        \return True on success. Otherwise, the errors are written to the log.
+        \see EnableLazyFunctionBodies
+        */
+        bool ParseFunctionBody(FunctionDecl* ast, Program& program);
+
+        /**
+        Enables or disables lazy parsing of function bodies. By default disabled.
+        \remarks If enabled, function bodies are only brace-matched and stored as source code (see "FunctionDecl::lazyBody"),
+        until they are parsed with "ParseFunctionBody". This is only supported if a source is parsed, but not for preprocessed tokens.
+        */
+        inline void EnableLazyFunctionBodies(bool enable)
+        {
+            lazyFunctionBodies_ = enable;
+        }
+
+        /**
+        Enables or disables a separate arena for each function body. By default disabled.
+        \remarks If enabled, the nodes of each function body are owned by "FunctionDecl::bodyArena",
+        so that the body can be released on its own (see "Options::streamOutput"). The source of a skipped body
+        is then kept after it has been parsed, so the body can be parsed again after it has been released.
+        */
+        inline void EnableBodyArenas(bool enable)
+        {
+            bodyArenas_ = enable;
+        }
+
+        //! Enables or disables the measurement of the time which is spent in the scanner. By default disabled.
+        inline void MeasureScanTime(bool enable)
+        {
+            measureScanTime_ = enable;
+        }
+
+        //! Returns the number of tokens of the previously parsed program.
+        inline std::size_t NumTokens() const
+        {
+            return numTokens_;
+        }
+
+        //! Returns the time (in seconds) which has been spent in the scanner for the previously parsed program.
+        double ScanTime() const;
+
     private:
         
         typedef Token::Types Tokens;
@@ -48,13 +103,21 @@ class HLSLParser
 
         /* === Functions === */
 
+        ProgramPtr ParseProgramPrimary(const ProgramPtr& program);
+
+        //! Returns the arena for the body of the specified function, i.e. its own body arena (if enabled) or the program arena.
+        ASTArena* BodyArena(FunctionDecl* ast, ASTArena& programArena);
+
         void Error(const std::string& msg);
+
+        //! Returns the current source position (of the scanner or the preprocessed token).
+        SourcePosition Pos() const;
         void ErrorUnexpected();
         void ErrorUnexpected(const std::string& hint);
 
-        TokenPtr Accept(const Tokens type);
-        TokenPtr Accept(const Tokens type, const std::string& spell);
-        TokenPtr AcceptIt();
+        Token Accept(const Tokens type);
+        Token Accept(const Tokens type, const std::string& spell);
+        Token AcceptIt();
 
         //! Accepts the semicolon token (Accept(Tokens::Semicolon)).
         void Semi();
@@ -66,16 +129,16 @@ class HLSLParser
         //! Returns true if the current token is part of a primary expression.
         bool IsPrimaryExpr() const;
 
-        //! Makes a new shared pointer of the specified AST node class.
-        template <typename T, typename... Args> std::shared_ptr<T> Make(Args&&... args)
+        //! Makes a new AST node of the specified class, which is owned by the arena of the current program.
+        template <typename T, typename... Args> T* Make(Args&&... args)
         {
-            return std::make_shared<T>(scanner_.Pos(), args...);
+            return arena_->New<T>(Pos(), args...);
         }
 
         //! Returns the type of the next token.
         inline Tokens Type() const
         {
-            return tkn_->Type();
+            return tkn_.Type();
         }
 
         //! Returns true if the next token is from the specified type.
@@ -86,12 +149,12 @@ class HLSLParser
         //! Returns true if the next token is from the specified type and has the specified spelling.
         inline bool Is(const Tokens type, const std::string& spell) const
         {
-            return Type() == type && tkn_->Spell() == spell;
+            return Type() == type && tkn_.Spell() == spell;
         }
 
         /* === Parse functions === */
 
-        ProgramPtr                      ParseProgram();
+        void                            ParseProgram(Program* ast);
 
         CodeBlockPtr                    ParseCodeBlock();
         BufferDeclIdentPtr              ParseBufferDeclIdent();
@@ -164,7 +227,18 @@ class HLSLParser
         /* === Members === */
 
         HLSLScanner scanner_;
-        TokenPtr tkn_;
+        Token tkn_; //!< Current token (the only look-ahead token of the parser).
+
+        const std::vector<TokenPtr>* tokens_ = nullptr; //!< Preprocessed token stream (null if the scanner is used).
+        std::size_t tokenIndex_ = 0;
+
+        std::size_t numTokens_ = 0;
+        bool measureScanTime_ = false;
+        bool lazyFunctionBodies_ = false;
+        bool bodyArenas_ = false;
+        std::chrono::steady_clock::duration scanTime_ = std::chrono::steady_clock::duration::zero();
+
+        ASTArena* arena_ = nullptr;
 
         Logger* log_ = nullptr;
 
@@ -0,0 +1,1150 @@
+/*
+ * HLSLPreprocessor.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "HLSLPreprocessor.h"
+#include "HLSLScanner.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <cctype>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+static const std::size_t maxIncludeDepth = 64;
+
+static std::uint64_t ContentHash(const std::string& content)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (auto chr : content)
+        hash = (hash ^ static_cast<unsigned char>(chr)) * 0x100000001b3ull;
+    return hash;
+}
+
+//! Removes all line continuations (i.e. a backslash followed by a new-line character).
+static std::string RemoveLineContinuations(const std::string& text)
+{
+    std::string result;
+    result.reserve(text.size());
+
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '\\')
+        {
+            if (i + 1 < text.size() && text[i + 1] == '\n')
+            {
+                ++i;
+                continue;
+            }
+            if (i + 2 < text.size() && text[i + 1] == '\r' && text[i + 2] == '\n')
+            {
+                i += 2;
+                continue;
+            }
+        }
+        result += text[i];
+    }
+
+    return result;
+}
+
+static void SkipBlanks(const std::string& text, std::size_t& pos)
+{
+    while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos])))
+        ++pos;
+}
+
+static std::string ReadIdent(const std::string& text, std::size_t& pos)
+{
+    auto start = pos;
+    while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_'))
+        ++pos;
+    return text.substr(start, pos - start);
+}
+
+//! Returns true if the specified token has the spelling of an identifier (this includes keywords).
+static bool IsIdentLike(const Token& tkn)
+{
+    const auto& spell = tkn.Spell();
+    return !spell.empty() && (std::isalpha(static_cast<unsigned char>(spell[0])) || spell[0] == '_');
+}
+
+static bool IsPasteOperator(const Token& tkn)
+{
+    return tkn.Type() == Token::Types::Directive && tkn.Spell() == "##";
+}
+
+//! Logger for the scanner, which records the errors together with the index of the next token.
+class LexicalErrorRecorder : public Logger
+{
+    
+    public:
+        
+        LexicalErrorRecorder(SourceTokens& tokens) :
+            tokens_{ tokens }
+        {
+        }
+
+        void Error(const std::string& message) override
+        {
+            tokens_.errors.push_back({ tokens_.tokens.size(), message });
+        }
+
+    private:
+        
+        SourceTokens& tokens_;
+
+};
+
+//! Returns the precedence of the specified binary operator for preprocessor expressions, or 0 if it's not supported.
+static int BinaryOpPrecedence(const std::string& op)
+{
+    if (op == "||")                                         return 1;
+    if (op == "&&")                                         return 2;
+    if (op == "|")                                          return 3;
+    if (op == "^")                                          return 4;
+    if (op == "&")                                          return 5;
+    if (op == "==" || op == "!=")                           return 6;
+    if (op == "<" || op == ">" || op == "<=" || op == ">=") return 7;
+    if (op == "<<" || op == ">>")                           return 8;
+    if (op == "+" || op == "-")                             return 9;
+    if (op == "*" || op == "/" || op == "%")                return 10;
+    return 0;
+}
+
+
+/*
+ * IncludeCache class
+ */
+
+IncludeCache::EntryPtr IncludeCache::Find(const std::string& includeName, std::uint64_t contentHash, std::size_t contentSize) const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+
+    auto it = entries_.find(includeName);
+    if (it != entries_.end() && it->second->contentHash == contentHash && it->second->contentSize == contentSize)
+        return it->second;
+
+    return nullptr;
+}
+
+void IncludeCache::Store(const std::string& includeName, const EntryPtr& entry)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_[includeName] = entry;
+}
+
+std::size_t IncludeCache::Size() const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return entries_.size();
+}
+
+
+/*
+ * HLSLPreprocessor class
+ */
+
+HLSLPreprocessor::HLSLPreprocessor(IncludeHandler* includeHandler, IncludeCache* includeCache, Logger* log) :
+    includeHandler_ { includeHandler },
+    includeCache_   { includeCache   },
+    log_            { log            }
+{
+}
+
+void HLSLPreprocessor::DefineMacro(const std::string& name, const std::string& value)
+{
+    predefinedMacros_.push_back({ name, value });
+}
+
+bool HLSLPreprocessor::Process(const std::shared_ptr<SourceCode>& source, StringPool& stringPool, std::vector<TokenPtr>& tokens)
+{
+    SourceTokens sourceTokens;
+    Tokenize(source, stringPool, sourceTokens);
+    return Process(sourceTokens, stringPool, tokens);
+}
+
+bool HLSLPreprocessor::Process(const SourceTokens& sourceTokens, StringPool& stringPool, std::vector<TokenPtr>& tokens)
+{
+    stringPool_ = &stringPool;
+    output_     = &tokens;
+
+    try
+    {
+        /* Define predefined macros */
+        for (const auto& predefined : predefinedMacros_)
+        {
+            Macro macro;
+            macro.replacementText = predefined.second;
+            TokenizeText(predefined.second, SourcePosition::ignore, macro.replacement, &(macro.lexicalErrors));
+            macros_[predefined.first] = macro;
+        }
+
+        /* Process main source and append the final 'EndOfStream' token */
+        ProcessFile(sourceTokens, "");
+
+        const auto& sourceTokenList = sourceTokens.tokens;
+
+        if (sourceTokenList.empty() || sourceTokenList.back()->Type() != Tokens::EndOfStream)
+            tokens.push_back(std::make_shared<Token>(SourcePosition::ignore, Tokens::EndOfStream));
+        else
+            tokens.push_back(sourceTokenList.back());
+
+        return true;
+    }
+    catch (const std::exception& err)
+    {
+        if (log_)
+            log_->Error(err.what());
+    }
+
+    return false;
+}
+
+void HLSLPreprocessor::Tokenize(const std::shared_ptr<SourceCode>& source, StringPool& stringPool, SourceTokens& tokens)
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    LexicalErrorRecorder errorRecorder(tokens);
+    HLSLScanner scanner(&errorRecorder);
+
+    if (scanner.ScanSource(source, stringPool))
+    {
+        while (true)
+        {
+            auto tkn = std::make_shared<Token>(scanner.Next());
+            tokens.tokens.push_back(tkn);
+            if (tkn->Type() == Tokens::EndOfStream)
+                break;
+        }
+    }
+
+    scanTime_ += std::chrono::steady_clock::now() - startTime;
+}
+
+double HLSLPreprocessor::ScanTime() const
+{
+    return std::chrono::duration<double>(scanTime_).count();
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void HLSLPreprocessor::Error(const std::string& msg, const SourcePosition& pos)
+{
+    throw std::runtime_error("preprocessor error (" + pos.ToString() + ") : " + msg);
+}
+
+void HLSLPreprocessor::ReportLexicalErrors(const std::vector<SourceTokens::LexicalError>& errors)
+{
+    if (log_)
+    {
+        for (const auto& err : errors)
+            log_->Error(err.message);
+    }
+}
+
+void HLSLPreprocessor::TokenizeText(
+    const std::string& text, const SourcePosition& pos, std::vector<TokenPtr>& tokens, std::vector<std::string>* lexicalErrors)
+{
+    SourceTokens textTokens;
+    Tokenize(std::make_shared<SourceCode>(text.data(), text.size()), *stringPool_, textTokens);
+
+    if (lexicalErrors)
+    {
+        for (const auto& err : textTokens.errors)
+            lexicalErrors->push_back(err.message);
+    }
+    else
+        ReportLexicalErrors(textTokens.errors);
+
+    /* Move tokens to the position of the directive (without the final 'EndOfStream' token) */
+    for (const auto& tkn : textTokens.tokens)
+    {
+        if (tkn->Type() != Tokens::EndOfStream)
+            tokens.push_back(std::make_shared<Token>(pos, tkn->Type(), tkn->Spell()));
+    }
+}
+
+void HLSLPreprocessor::ProcessFile(const SourceTokens& sourceTokens, const std::string& filename)
+{
+    const auto& tokens = sourceTokens.tokens;
+    const auto& errors = sourceTokens.errors;
+
+    if (fileStack_.size() >= maxIncludeDepth)
+    {
+        Error(
+            "include depth exceeds " + std::to_string(maxIncludeDepth) + " files (recursive include of \"" + filename + "\"?)",
+            (tokens.empty() ? SourcePosition::ignore : tokens.front()->Pos())
+        );
+    }
+
+    FileState fileState;
+    fileState.filename = filename;
+    fileStack_.push_back(fileState);
+    const auto ifDepth = ifBlocks_.size();
+
+    /* Expand consecutive tokens between directives */
+    std::vector<TokenPtr> tokenRun;
+    std::size_t errorIndex = 0;
+
+    for (std::size_t i = 0; i < tokens.size(); ++i)
+    {
+        const auto& tkn = tokens[i];
+
+        /* Report lexical errors in front of this token only inside active groups */
+        for (; errorIndex < errors.size() && errors[errorIndex].index <= i; ++errorIndex)
+        {
+            if (IsActive() && log_)
+                log_->Error(errors[errorIndex].message);
+        }
+
+        if (tkn->Type() == Tokens::Directive && !IsPasteOperator(*tkn))
+        {
+            ExpandTokens(tokenRun, *output_);
+            tokenRun.clear();
+            ProcessDirective(tkn);
+        }
+        else if (tkn->Type() != Tokens::EndOfStream && IsActive())
+            tokenRun.push_back(tkn);
+    }
+
+    ExpandTokens(tokenRun, *output_);
+
+    for (; errorIndex < errors.size(); ++errorIndex)
+    {
+        if (IsActive() && log_)
+            log_->Error(errors[errorIndex].message);
+    }
+
+    if (ifBlocks_.size() != ifDepth)
+        Error("missing '#endif' directive", (tokens.empty() ? SourcePosition::ignore : tokens.back()->Pos()));
+
+    fileStack_.pop_back();
+}
+
+void HLSLPreprocessor::ProcessDirective(const TokenPtr& tkn)
+{
+    const auto  text    = RemoveLineContinuations(tkn->Spell());
+    const auto& pos     = tkn->Pos();
+
+    /* Read directive name (after the '#' character) */
+    std::size_t i = 1;
+    SkipBlanks(text, i);
+
+    const auto name = ReadIdent(text, i);
+    const auto rest = text.substr(i);
+
+    /* Process conditional directives (also inside inactive blocks) */
+    if (name == "if")
+        ProcessIf(IsActive() && EvaluateCondition(rest, pos));
+    else if (name == "ifdef" || name == "ifndef")
+    {
+        std::size_t j = 0;
+        SkipBlanks(rest, j);
+        auto ident = ReadIdent(rest, j);
+
+        if (ident.empty() && IsActive())
+            Error("missing identifier after '#" + name + "'", pos);
+
+        const auto isDefined = IsDefined(ident);
+        ProcessIf(IsActive() && (name == "ifdef" ? isDefined : !isDefined));
+    }
+    else if (name == "elif")
+        ProcessElif(rest, pos);
+    else if (name == "else")
+        ProcessElse(pos);
+    else if (name == "endif")
+        ProcessEndif(pos);
+    else if (IsActive())
+    {
+        /* Process other directives only inside active blocks */
+        if (name == "define")
+            ProcessDefine(rest, pos);
+        else if (name == "undef")
+            ProcessUndef(rest, pos);
+        else if (name == "include")
+            ProcessInclude(tkn, rest);
+        else if (name == "error")
+            Error("#error" + rest, pos);
+        else if (name == "line")
+            ProcessLine(tkn, rest);
+        else if (name == "pragma")
+            ProcessPragma(tkn, rest);
+        else if (name.empty())
+        {
+            /* Only allow the null directive (a line with a single '#' character) */
+            std::size_t j = 0;
+            SkipBlanks(rest, j);
+            if (j < rest.size())
+                Error("invalid preprocessor directive", pos);
+        }
+        else
+        {
+            /* Pass through all other directives (e.g. "#line" or "#version") */
+            output_->push_back(tkn);
+        }
+    }
+}
+
+void HLSLPreprocessor::ProcessDefine(const std::string& text, const SourcePosition& pos)
+{
+    /* Read macro name */
+    std::size_t i = 0;
+    SkipBlanks(text, i);
+
+    auto name = ReadIdent(text, i);
+    if (name.empty())
+        Error("missing macro name in '#define' directive", pos);
+
+    Macro macro;
+
+    /* Read macro parameters (only if the bracket directly follows the name) */
+    if (i < text.size() && text[i] == '(')
+    {
+        macro.isFunctionLike = true;
+        ++i;
+
+        while (true)
+        {
+            SkipBlanks(text, i);
+
+            if (i < text.size() && text[i] == ')' && macro.parameters.empty())
+                break;
+
+            auto param = ReadIdent(text, i);
+            if (param.empty())
+                Error("invalid parameter list of macro \"" + name + "\"", pos);
+
+            macro.parameters.push_back(param);
+            SkipBlanks(text, i);
+
+            if (i < text.size() && text[i] == ',')
+                ++i;
+            else if (i < text.size() && text[i] == ')')
+                break;
+            else
+                Error("missing ')' in parameter list of macro \"" + name + "\"", pos);
+        }
+
+        ++i;
+    }
+
+    /*
+    Scan macro replacement. Its lexical errors and unsupported operators are only reported when the macro is expanded,
+    because the replacement might be used as include name (e.g. "#define FILE "Shader.h"") or the macro is not used at all
+    */
+    macro.replacementText = text.substr(i);
+    TokenizeText(macro.replacementText, pos, macro.replacement, &(macro.lexicalErrors));
+
+    const auto& replacement = macro.replacement;
+    for (const auto& tkn : replacement)
+    {
+        if (tkn->Type() == Tokens::Directive && !IsPasteOperator(*tkn))
+            macro.hasStringizing = true;
+    }
+
+    if (!replacement.empty() && (IsPasteOperator(*replacement.front()) || IsPasteOperator(*replacement.back())))
+        Error("operator '##' can not appear at either end of a macro replacement (in macro \"" + name + "\")", pos);
+
+    macros_[name] = macro;
+}
+
+void HLSLPreprocessor::ProcessUndef(const std::string& text, const SourcePosition& pos)
+{
+    std::size_t i = 0;
+    SkipBlanks(text, i);
+
+    auto name = ReadIdent(text, i);
+    if (name.empty())
+        Error("missing macro name in '#undef' directive", pos);
+
+    macros_.erase(name);
+}
+
+void HLSLPreprocessor::ProcessInclude(const TokenPtr& tkn, const std::string& text)
+{
+    /* Read include name (or the macro which is replaced by the include name) */
+    std::size_t i = 0;
+    SkipBlanks(text, i);
+
+    if (i < text.size() && (std::isalpha(static_cast<unsigned char>(text[i])) || text[i] == '_'))
+    {
+        /* Continue with the resolved include name (which is also passed through, if the file is not included) */
+        auto includeName = ResolveIncludeMacro(text.substr(i), tkn->Pos());
+        auto resolvedTkn = std::make_shared<Token>(tkn->Pos(), Tokens::Directive, stringPool_->Intern("#include " + includeName));
+        ProcessInclude(resolvedTkn, includeName);
+        return;
+    }
+
+    if (i >= text.size() || (text[i] != '\"' && text[i] != '<'))
+        Error("missing include name in '#include' directive", tkn->Pos());
+
+    const auto terminator = (text[i] == '\"' ? '\"' : '>');
+    auto end = text.find(terminator, i + 1);
+
+    if (end == std::string::npos)
+        Error("missing '" + std::string(1, terminator) + "' in '#include' directive", tkn->Pos());
+
+    const auto originalName = text.substr(i + 1, end - i - 1);
+    auto includeName = originalName;
+
+    /* Read and process include file */
+    auto entry = ReadInclude(includeName);
+
+    if (entry)
+    {
+        if (onceIncludes_.find(includeName) == onceIncludes_.end())
+        {
+            includes_.push_back(entry);
+            ProcessFile(entry->tokens, includeName);
+        }
+    }
+    else if (includeName != originalName)
+    {
+        /* Pass through include directive with modified include name */
+        auto spell = "#include \"" + includeName + "\"";
+        output_->push_back(std::make_shared<Token>(tkn->Pos(), Tokens::Directive, stringPool_->Intern(spell)));
+    }
+    else
+        output_->push_back(tkn);
+}
+
+void HLSLPreprocessor::ProcessLine(const TokenPtr& tkn, const std::string& text)
+{
+    /* Read line number (the optional file name is ignored) */
+    std::size_t i = 0;
+    SkipBlanks(text, i);
+
+    auto start = i;
+    while (i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])))
+        ++i;
+
+    if (i == start)
+        Error("missing line number in '#line' directive", tkn->Pos());
+
+    /* The line number specifies the number of the next source line */
+    try
+    {
+        const auto line = std::stoll(text.substr(start, i - start));
+        fileStack_.back().lineOffset = line - static_cast<long long>(tkn->Pos().Row()) - 1;
+    }
+    catch (const std::exception&)
+    {
+        Error("line number out of range in '#line' directive", tkn->Pos());
+    }
+
+    output_->push_back(tkn);
+}
+
+void HLSLPreprocessor::ProcessPragma(const TokenPtr& tkn, const std::string& text)
+{
+    std::size_t i = 0;
+    SkipBlanks(text, i);
+
+    const auto name = ReadIdent(text, i);
+    const auto& pos = tkn->Pos();
+
+    if (name == "once")
+        onceIncludes_.insert(fileStack_.back().filename);
+    else if (name == "message")
+    {
+        /* Report the message to the log (like the HLSL compiler does), e.g. "#pragma message("Compiling shader")" */
+        auto begin = text.find('(', i);
+        auto end = text.rfind(')');
+
+        if (begin == std::string::npos || end == std::string::npos || end < begin)
+            Error("missing brackets in '#pragma message' directive", pos);
+
+        auto message = text.substr(begin + 1, end - begin - 1);
+        std::size_t j = 0;
+        SkipBlanks(message, j);
+        message = message.substr(j);
+        while (!message.empty() && std::isspace(static_cast<unsigned char>(message.back())))
+            message.pop_back();
+
+        if (message.size() >= 2 && message.front() == '\"' && message.back() == '\"')
+            message = message.substr(1, message.size() - 2);
+
+        if (log_)
+            log_->Info("preprocessor message (" + pos.ToString() + ") : " + message);
+    }
+    else if (name == "pack_matrix")
+    {
+        /* Matrices are always packed in column-major order */
+        if (log_ && text.find("row_major", i) != std::string::npos)
+            log_->Warning("preprocessor warning (" + pos.ToString() + ") : row-major matrix packing is not supported (in '#pragma pack_matrix')");
+    }
+    else if (name == "optimize" || name == "debug" || name == "STDGL")
+    {
+        /* Pass through the pragmas which are also defined in GLSL */
+        output_->push_back(tkn);
+    }
+
+    /* Drop all other pragmas, which are only meant for the HLSL compiler (e.g. "#pragma warning(disable : 3206)") */
+}
+
+std::string HLSLPreprocessor::ResolveIncludeMacro(const std::string& text, const SourcePosition& pos)
+{
+    /*
+    The scanner has no string literals, so the include name is taken from the unscanned replacement
+    of the macro (which may refer to another macro)
+    */
+    std::size_t i = 0;
+    auto name = ReadIdent(text, i);
+
+    SkipBlanks(text, i);
+    if (i < text.size())
+        Error("computed include name must be a single macro (in '#include' directive)", pos);
+
+    /* Follow the macros (the number of steps is limited for cyclic definitions) */
+    for (std::size_t depth = 0; depth <= macros_.size(); ++depth)
+    {
+        auto it = macros_.find(name);
+        if (it == macros_.end() || it->second.isFunctionLike)
+            Error("undefined macro \"" + name + "\" in '#include' directive", pos);
+
+        const auto& replacementText = it->second.replacementText;
+
+        std::size_t j = 0;
+        SkipBlanks(replacementText, j);
+
+        if (j < replacementText.size() && (replacementText[j] == '\"' || replacementText[j] == '<'))
+            return replacementText.substr(j);
+
+        /* Continue with the macro of this replacement */
+        name = ReadIdent(replacementText, j);
+        SkipBlanks(replacementText, j);
+
+        if (name.empty() || j < replacementText.size())
+            break;
+    }
+
+    Error("macro in '#include' directive is not replaced by an include name", pos);
+    return "";
+}
+
+void HLSLPreprocessor::ProcessIf(bool condition)
+{
+    IfBlock block;
+    {
+        block.parentActive  = IsActive();
+        block.active        = condition;
+        block.wasActive     = condition;
+    }
+    ifBlocks_.push_back(block);
+}
+
+void HLSLPreprocessor::ProcessElif(const std::string& text, const SourcePosition& pos)
+{
+    if (ifBlocks_.empty())
+        Error("'#elif' without '#if'", pos);
+
+    auto& block = ifBlocks_.back();
+
+    if (block.hasElse)
+        Error("'#elif' after '#else'", pos);
+
+    if (block.parentActive && !block.wasActive)
+    {
+        block.active    = EvaluateCondition(text, pos);
+        block.wasActive = block.active;
+    }
+    else
+        block.active = false;
+}
+
+void HLSLPreprocessor::ProcessElse(const SourcePosition& pos)
+{
+    if (ifBlocks_.empty())
+        Error("'#else' without '#if'", pos);
+
+    auto& block = ifBlocks_.back();
+
+    if (block.hasElse)
+        Error("'#else' after '#else'", pos);
+
+    block.hasElse   = true;
+    block.active    = (block.parentActive && !block.wasActive);
+    block.wasActive = true;
+}
+
+void HLSLPreprocessor::ProcessEndif(const SourcePosition& pos)
+{
+    if (ifBlocks_.empty())
+        Error("'#endif' without '#if'", pos);
+    ifBlocks_.pop_back();
+}
+
+IncludeCache::EntryPtr HLSLPreprocessor::ReadInclude(std::string& includeName)
+{
+    if (!includeHandler_)
+        return nullptr;
+
+    /* Read include file through the include handler */
+    auto stream = includeHandler_->Include(includeName);
+    if (!stream || !stream->good())
+        return nullptr;
+
+    std::string content { std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>() };
+
+    /* Reuse tokens of the include cache, if the content has not changed */
+    const auto contentHash = ContentHash(content);
+
+    if (includeCache_)
+    {
+        auto entry = includeCache_->Find(includeName, contentHash, content.size());
+        if (entry)
+            return entry;
+    }
+
+    /* Tokenize include file */
+    auto entry = std::make_shared<IncludeCache::Entry>();
+    {
+        entry->contentHash = contentHash;
+        entry->contentSize = content.size();
+        Tokenize(std::make_shared<SourceCode>(content.data(), content.size()), entry->stringPool, entry->tokens);
+    }
+
+    if (includeCache_)
+        includeCache_->Store(includeName, entry);
+
+    return entry;
+}
+
+bool HLSLPreprocessor::IsActive() const
+{
+    return ifBlocks_.empty() || (ifBlocks_.back().parentActive && ifBlocks_.back().active);
+}
+
+bool HLSLPreprocessor::IsDefined(const std::string& name) const
+{
+    return (macros_.find(name) != macros_.end() || name == "__LINE__" || name == "__FILE__");
+}
+
+TokenPtr HLSLPreprocessor::ExpandPredefinedMacro(const Token& tkn)
+{
+    const auto& name = tkn.Spell();
+
+    if (name == "__LINE__")
+    {
+        /* Replace by the row of the token (which is the row of the macro invocation inside a macro replacement) */
+        auto line = static_cast<long long>(tkn.Pos().Row()) + (fileStack_.empty() ? 0 : fileStack_.back().lineOffset);
+        return std::make_shared<Token>(tkn.Pos(), Tokens::IntLiteral, stringPool_->Intern(std::to_string(line)));
+    }
+
+    if (name == "__FILE__")
+    {
+        /* The file name can not be represented, because the translator does not support string literals */
+        Error("predefined macro \"__FILE__\" can not be expanded, because string literals are not supported", tkn.Pos());
+    }
+
+    return nullptr;
+}
+
+void HLSLPreprocessor::ExpandTokens(const std::vector<TokenPtr>& tokens, std::vector<TokenPtr>& output)
+{
+    /*
+    Replacements, which are rescanned before the remaining input tokens (in reverse order).
+    A null token marks the end of a replacement, where its macro is enabled again.
+    */
+    std::vector<TokenPtr> pending;
+    std::size_t i = 0, n = tokens.size();
+
+    auto NextTokenIs = [&](const Tokens type) -> bool
+    {
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+        {
+            if (*it)
+                return ((*it)->Type() == type);
+        }
+        return (i < n && tokens[i]->Type() == type);
+    };
+
+    auto TakeToken = [&]() -> TokenPtr
+    {
+        while (!pending.empty())
+        {
+            auto tkn = std::move(pending.back());
+            pending.pop_back();
+
+            if (tkn)
+                return tkn;
+
+            disabledMacros_.pop_back();
+        }
+        return (i < n ? tokens[i++] : nullptr);
+    };
+
+    while (auto tkn = TakeToken())
+    {
+        /* Find macro (which is not currently expanded) */
+        Macro* macro = nullptr;
+
+        if (IsIdentLike(*tkn))
+        {
+            const auto& name = tkn->Spell();
+            auto it = macros_.find(name);
+            if (it != macros_.end() && std::find(disabledMacros_.begin(), disabledMacros_.end(), name) == disabledMacros_.end())
+                macro = &(it->second);
+        }
+
+        /* Function-like macros are only expanded with an argument list (which may follow the end of a replacement) */
+        if (!macro || (macro->isFunctionLike && !NextTokenIs(Tokens::LBracket)))
+        {
+            auto predefinedTkn = (macro == nullptr && IsIdentLike(*tkn) ? ExpandPredefinedMacro(*tkn) : nullptr);
+            output.push_back(predefinedTkn ? predefinedTkn : tkn);
+            continue;
+        }
+
+        /* Read macro arguments */
+        std::vector<std::vector<TokenPtr>> arguments;
+
+        if (macro->isFunctionLike)
+        {
+            arguments.resize(1);
+            TakeToken();
+
+            for (int depth = 1; true;)
+            {
+                auto argTkn = TakeToken();
+                if (!argTkn)
+                    Error("missing ')' in argument list of macro \"" + tkn->Spell() + "\"", tkn->Pos());
+
+                const auto type = argTkn->Type();
+
+                if (type == Tokens::LBracket)
+                    ++depth;
+                else if (type == Tokens::RBracket && --depth == 0)
+                    break;
+                else if (type == Tokens::Comma && depth == 1)
+                {
+                    arguments.resize(arguments.size() + 1);
+                    continue;
+                }
+
+                arguments.back().push_back(argTkn);
+            }
+
+            if (macro->parameters.empty() && arguments.size() == 1 && arguments.front().empty())
+                arguments.clear();
+
+            if (arguments.size() != macro->parameters.size())
+                Error("invalid number of arguments for macro \"" + tkn->Spell() + "\"", tkn->Pos());
+        }
+
+        /* Report the errors of the macro definition, when the macro is expanded for the first time */
+        if (macro->hasStringizing)
+            Error("stringizing operator '#' is not supported (in macro \"" + tkn->Spell() + "\")", tkn->Pos());
+
+        if (!macro->lexicalErrors.empty())
+        {
+            if (log_)
+            {
+                for (const auto& err : macro->lexicalErrors)
+                    log_->Error(err);
+            }
+            macro->lexicalErrors.clear();
+        }
+
+        /* Substitute macro and rescan the result together with the remaining tokens (without this macro) */
+        std::vector<TokenPtr> replacement;
+        SubstituteMacro(*macro, arguments, tkn->Pos(), replacement);
+
+        disabledMacros_.push_back(tkn->Spell());
+        pending.push_back(nullptr);
+        pending.insert(pending.end(), replacement.rbegin(), replacement.rend());
+    }
+}
+
+void HLSLPreprocessor::SubstituteMacro(
+    const Macro& macro, const std::vector<std::vector<TokenPtr>>& arguments,
+    const SourcePosition& pos, std::vector<TokenPtr>& output)
+{
+    const auto& replacement = macro.replacement;
+
+    auto ParameterIndex = [&macro](const Token& tkn) -> std::size_t
+    {
+        if (IsIdentLike(tkn))
+        {
+            auto it = std::find(macro.parameters.begin(), macro.parameters.end(), tkn.Spell());
+            if (it != macro.parameters.end())
+                return static_cast<std::size_t>(it - macro.parameters.begin());
+        }
+        return ~0u;
+    };
+
+    auto Append = [&output, &pos](const TokenPtr& tkn)
+    {
+        output.push_back(std::make_shared<Token>(pos, tkn->Type(), tkn->Spell()));
+    };
+
+    for (std::size_t i = 0; i < replacement.size(); ++i)
+    {
+        const auto& tkn = replacement[i];
+
+        if (IsPasteOperator(*tkn))
+        {
+            /* Paste previous token with the next token (or the first token of the next argument) */
+            const auto& nextTkn = replacement[++i];
+            auto paramIndex = ParameterIndex(*nextTkn);
+
+            std::vector<TokenPtr> rhs;
+            if (paramIndex < arguments.size())
+                rhs = arguments[paramIndex];
+            else
+                rhs.push_back(nextTkn);
+
+            if (!rhs.empty())
+            {
+                std::size_t j = 0;
+
+                if (!output.empty())
+                {
+                    output.back() = PasteTokens(output.back(), rhs.front(), pos);
+                    ++j;
+                }
+
+                for (; j < rhs.size(); ++j)
+                    Append(rhs[j]);
+            }
+        }
+        else
+        {
+            auto paramIndex = ParameterIndex(*tkn);
+
+            if (paramIndex < arguments.size())
+            {
+                /* Arguments are expanded before substitution, unless they are an operand of '##' */
+                if (i + 1 < replacement.size() && IsPasteOperator(*replacement[i + 1]))
+                {
+                    for (const auto& argTkn : arguments[paramIndex])
+                        Append(argTkn);
+                }
+                else
+                {
+                    std::vector<TokenPtr> expandedArg;
+                    ExpandTokens(arguments[paramIndex], expandedArg);
+
+                    for (const auto& argTkn : expandedArg)
+                        Append(argTkn);
+                }
+            }
+            else
+                Append(tkn);
+        }
+    }
+}
+
+TokenPtr HLSLPreprocessor::PasteTokens(const TokenPtr& lhs, const TokenPtr& rhs, const SourcePosition& pos)
+{
+    /* Scan pasted spelling again, which must result in a single token */
+    std::vector<TokenPtr> tokens;
+    TokenizeText(lhs->Spell() + rhs->Spell(), pos, tokens);
+
+    if (tokens.size() != 1)
+        Error("pasting \"" + lhs->Spell() + "\" and \"" + rhs->Spell() + "\" does not give a valid token", pos);
+
+    return tokens.front();
+}
+
+bool HLSLPreprocessor::EvaluateCondition(const std::string& text, const SourcePosition& pos)
+{
+    std::vector<TokenPtr> tokens;
+    TokenizeText(text, pos, tokens);
+
+    /* Resolve "defined" operators before the macros are expanded */
+    std::vector<TokenPtr> resolvedTokens;
+
+    for (std::size_t i = 0; i < tokens.size(); ++i)
+    {
+        if (tokens[i]->Spell() == "defined")
+        {
+            auto isBracket = (i + 1 < tokens.size() && tokens[i + 1]->Type() == Tokens::LBracket);
+            if (isBracket)
+                ++i;
+
+            if (i + 1 >= tokens.size() || !IsIdentLike(*tokens[i + 1]))
+                Error("missing identifier after 'defined'", pos);
+
+            auto isDefined = IsDefined(tokens[++i]->Spell());
+
+            if (isBracket)
+            {
+                if (i + 1 >= tokens.size() || tokens[i + 1]->Type() != Tokens::RBracket)
+                    Error("missing ')' after 'defined'", pos);
+                ++i;
+            }
+
+            resolvedTokens.push_back(std::make_shared<Token>(pos, Tokens::IntLiteral, stringPool_->Intern(isDefined ? "1" : "0")));
+        }
+        else
+            resolvedTokens.push_back(tokens[i]);
+    }
+
+    /* Expand macros and evaluate expression */
+    std::vector<TokenPtr> exprTokens;
+    ExpandTokens(resolvedTokens, exprTokens);
+
+    if (exprTokens.empty())
+        Error("missing expression in conditional directive", pos);
+
+    std::size_t index = 0;
+    auto value = EvaluateExpr(exprTokens, index, 0, pos);
+
+    if (index < exprTokens.size())
+        Error("unexpected token '" + exprTokens[index]->Spell() + "' in preprocessor expression", pos);
+
+    return (value != 0);
+}
+
+long long HLSLPreprocessor::EvaluateExpr(const std::vector<TokenPtr>& tokens, std::size_t& index, int minPrecedence, const SourcePosition& pos)
+{
+    auto lhs = EvaluatePrimaryExpr(tokens, index, pos);
+
+    /* Evaluate binary operators (precedence climbing) */
+    while (index < tokens.size() && tokens[index]->Type() == Tokens::BinaryOp)
+    {
+        const auto& op = tokens[index]->Spell();
+        const auto precedence = BinaryOpPrecedence(op);
+
+        if (precedence == 0)
+            Error("invalid operator '" + op + "' in preprocessor expression", pos);
+        if (precedence < minPrecedence)
+            break;
+
+        ++index;
+        auto rhs = EvaluateExpr(tokens, index, precedence + 1, pos);
+
+        if ((op == "/" || op == "%") && rhs == 0)
+            Error("division by zero in preprocessor expression", pos);
+
+        if      (op == "||") lhs = (lhs || rhs);
+        else if (op == "&&") lhs = (lhs && rhs);
+        else if (op == "|" ) lhs = (lhs | rhs);
+        else if (op == "^" ) lhs = (lhs ^ rhs);
+        else if (op == "&" ) lhs = (lhs & rhs);
+        else if (op == "==") lhs = (lhs == rhs);
+        else if (op == "!=") lhs = (lhs != rhs);
+        else if (op == "<" ) lhs = (lhs < rhs);
+        else if (op == ">" ) lhs = (lhs > rhs);
+        else if (op == "<=") lhs = (lhs <= rhs);
+        else if (op == ">=") lhs = (lhs >= rhs);
+        else if (op == "<<") lhs = static_cast<long long>(static_cast<unsigned long long>(lhs) << (rhs & 63));
+        else if (op == ">>") lhs = (lhs >> (rhs & 63));
+        else if (op == "+" ) lhs = (lhs + rhs);
+        else if (op == "-" ) lhs = (lhs - rhs);
+        else if (op == "*" ) lhs = (lhs * rhs);
+        else if (op == "/" ) lhs = (lhs / rhs);
+        else if (op == "%" ) lhs = (lhs % rhs);
+    }
+
+    /* Evaluate ternary operator (with the lowest precedence) */
+    if (minPrecedence == 0 && index < tokens.size() && tokens[index]->Type() == Tokens::TernaryOp)
+    {
+        ++index;
+        auto ifValue = EvaluateExpr(tokens, index, 0, pos);
+
+        if (index >= tokens.size() || tokens[index]->Type() != Tokens::Colon)
+            Error("missing ':' in ternary preprocessor expression", pos);
+
+        ++index;
+        auto elseValue = EvaluateExpr(tokens, index, 0, pos);
+
+        return (lhs != 0 ? ifValue : elseValue);
+    }
+
+    return lhs;
+}
+
+long long HLSLPreprocessor::EvaluatePrimaryExpr(const std::vector<TokenPtr>& tokens, std::size_t& index, const SourcePosition& pos)
+{
+    if (index >= tokens.size())
+        Error("unexpected end of preprocessor expression", pos);
+
+    const auto& tkn = tokens[index++];
+    const auto& spell = tkn->Spell();
+
+    switch (tkn->Type())
+    {
+        case Tokens::UnaryOp:
+        case Tokens::BinaryOp:
+        {
+            /* Evaluate unary operator */
+            auto value = EvaluatePrimaryExpr(tokens, index, pos);
+
+            if (spell == "!")
+                return !value;
+            if (spell == "~")
+                return ~value;
+            if (spell == "-")
+                return -value;
+            if (spell == "+")
+                return value;
+        }
+        break;
+
+        case Tokens::LBracket:
+        {
+            auto value = EvaluateExpr(tokens, index, 0, pos);
+
+            if (index >= tokens.size() || tokens[index]->Type() != Tokens::RBracket)
+                Error("missing ')' in preprocessor expression", pos);
+            ++index;
+
+            return value;
+        }
+        break;
+
+        case Tokens::IntLiteral:
+        {
+            try
+            {
+                return std::stoll(spell);
+            }
+            catch (const std::exception&)
+            {
+                Error("integer literal '" + spell + "' out of range in preprocessor expression", pos);
+            }
+        }
+        break;
+
+        case Tokens::BoolLiteral:
+            return (spell == "true" ? 1 : 0);
+
+        case Tokens::FloatLiteral:
+            Error("floating-point literal '" + spell + "' in preprocessor expression", pos);
+            break;
+
+        default:
+        {
+            /* Identifiers, which are not defined as macros, are replaced by 0 */
+            if (IsIdentLike(*tkn))
+                return 0;
+        }
+        break;
+    }
+
+    Error("unexpected token '" + spell + "' in preprocessor expression", pos);
+    return 0;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,258 @@
+/*
+ * HLSLPreprocessor.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_HLSL_PREPROCESSOR_H__
+#define __HT_HLSL_PREPROCESSOR_H__
+
+
+#include "HT/Translator.h"
+#include "SourceCode.h"
+#include "StringPool.h"
+#include "Token.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <chrono>
+
+
+namespace HTLib
+{
+
+
+/**
+Tokens of a source file (including the final 'EndOfStream' token) and its lexical errors.
+\remarks The lexical errors are not reported while the source is scanned, because they might be inside an inactive
+conditional group (e.g. an apostrophe inside an "#if 0" block). The preprocessor reports them, when it reaches them inside an active group.
+*/
+struct SourceTokens
+{
+    struct LexicalError
+    {
+        std::size_t index;      //!< Index of the first token after the erroneous characters.
+        std::string message;
+    };
+
+    std::vector<TokenPtr>       tokens;
+    std::vector<LexicalError>   errors;
+};
+
+
+/**
+Cache of tokenized include files.
+\remarks The cache is synchronized, so it can be shared by several preprocessors (also across threads).
+An entry is only reused if the content of the include file has not changed,
+i.e. the include files are still read through the include handler, but they are only tokenized once.
+*/
+class IncludeCache
+{
+    
+    public:
+        
+        //! Tokenized include file. The token spellings are interned in the own string pool of this entry.
+        struct Entry
+        {
+            std::uint64_t           contentHash = 0;
+            std::size_t             contentSize = 0;
+            StringPool              stringPool;
+            SourceTokens            tokens;
+        };
+
+        typedef std::shared_ptr<const Entry> EntryPtr;
+
+        //! Returns the entry for the specified include file, or null if there is no entry for this content.
+        EntryPtr Find(const std::string& includeName, std::uint64_t contentHash, std::size_t contentSize) const;
+
+        //! Stores the specified entry (and replaces the previous entry for this include file).
+        void Store(const std::string& includeName, const EntryPtr& entry);
+
+        //! Returns the number of cached include files.
+        std::size_t Size() const;
+
+    private:
+        
+        mutable std::mutex                          mutex_;
+        std::unordered_map<std::string, EntryPtr>   entries_;
+
+};
+
+
+/**
+HLSL preprocessor.
+\remarks The preprocessor works on the token stream of the scanner and resolves all macros,
+conditionals ('#if', '#ifdef', '#ifndef', '#elif', '#else', '#endif') and include directives.
+The predefined macro "__LINE__" is replaced by the current line (which can be changed with '#line').
+All other directives (e.g. '#line' or '#version') are passed through as directive tokens,
+which are written to the output code by the generator. Only the pragmas which are also valid in GLSL are passed through,
+all HLSL compiler pragmas (e.g. "#pragma pack_matrix" or "#pragma warning") are dropped.
+Include directives, for which the include handler does not return a stream, are also passed through.
+*/
+class HLSLPreprocessor
+{
+    
+    public:
+        
+        HLSLPreprocessor(IncludeHandler* includeHandler = nullptr, IncludeCache* includeCache = nullptr, Logger* log = nullptr);
+
+        //! Defines the specified macro before the source is processed (like "#define name value").
+        void DefineMacro(const std::string& name, const std::string& value);
+
+        /**
+        Preprocesses the specified source code.
+        \param[in] stringPool Specifies the string pool for the token spellings of the source code and all macros.
+        \param[out] tokens Receives the preprocessed token stream (which is terminated by an 'EndOfStream' token).
+        The tokens must only be used as long as this preprocessor and the string pool exist.
+        \return True on success.
+        */
+        bool Process(const std::shared_ptr<SourceCode>& source, StringPool& stringPool, std::vector<TokenPtr>& tokens);
+
+        /**
+        Preprocesses the specified tokenized source code.
+        \param[in] sourceTokens Specifies the tokens of the source code (see "Tokenize").
+        \remarks This can be used to preprocess the same source several times (e.g. with different macros) but scan it only once.
+        \see Tokenize
+        */
+        bool Process(const SourceTokens& sourceTokens, StringPool& stringPool, std::vector<TokenPtr>& tokens);
+
+        //! Scans all tokens of the specified source (including the final 'EndOfStream' token). Lexical errors are recorded, but not reported.
+        void Tokenize(const std::shared_ptr<SourceCode>& source, StringPool& stringPool, SourceTokens& tokens);
+
+        //! Returns the time (in seconds) which has been spent in the scanner (for all calls to "Tokenize").
+        double ScanTime() const;
+
+    private:
+        
+        typedef Token::Types Tokens;
+
+        /* === Structures === */
+
+        struct Macro
+        {
+            bool                        isFunctionLike  = false;
+            std::vector<std::string>    parameters;
+            std::vector<TokenPtr>       replacement;
+            std::string                 replacementText;    //!< Replacement before it's scanned (for computed include names).
+            std::vector<std::string>    lexicalErrors;      //!< Lexical errors of the replacement, which are reported when the macro is expanded.
+            bool                        hasStringizing  = false;
+        };
+
+        struct FileState
+        {
+            std::string filename;
+            long long   lineOffset  = 0;    //!< Offset which is added to the source row for the value of "__LINE__" (see '#line').
+        };
+
+        struct IfBlock
+        {
+            bool parentActive   = true;     //!< True if the enclosing block is active.
+            bool active         = true;     //!< True if the current branch is active.
+            bool wasActive      = false;    //!< True if any branch of this block has been active.
+            bool hasElse        = false;    //!< True if the '#else' branch has been reached.
+        };
+
+        /* === Functions === */
+
+        void Error(const std::string& msg, const SourcePosition& pos);
+
+        //! Reports the specified lexical errors (as logged by the scanner).
+        void ReportLexicalErrors(const std::vector<SourceTokens::LexicalError>& errors);
+
+        /**
+        Scans all tokens of the specified text of a directive and moves them to the specified position.
+        \param[out] lexicalErrors Optional output for the lexical errors. If this is null, the errors are reported immediately.
+        */
+        void TokenizeText(
+            const std::string& text, const SourcePosition& pos, std::vector<TokenPtr>& tokens,
+            std::vector<std::string>* lexicalErrors = nullptr
+        );
+
+        void ProcessFile(const SourceTokens& tokens, const std::string& filename);
+        void ProcessDirective(const TokenPtr& tkn);
+
+        void ProcessDefine(const std::string& text, const SourcePosition& pos);
+        void ProcessUndef(const std::string& text, const SourcePosition& pos);
+        void ProcessInclude(const TokenPtr& tkn, const std::string& text);
+        void ProcessLine(const TokenPtr& tkn, const std::string& text);
+        void ProcessPragma(const TokenPtr& tkn, const std::string& text);
+
+        //! Returns the include name (with quotes or angle brackets) of a computed include directive (e.g. "#include FILE").
+        std::string ResolveIncludeMacro(const std::string& text, const SourcePosition& pos);
+        void ProcessIf(bool condition);
+        void ProcessElif(const std::string& text, const SourcePosition& pos);
+        void ProcessElse(const SourcePosition& pos);
+        void ProcessEndif(const SourcePosition& pos);
+
+        IncludeCache::EntryPtr ReadInclude(std::string& includeName);
+
+        bool IsActive() const;
+
+        //! Returns true if the specified macro is defined (including the predefined macros, e.g. "__LINE__").
+        bool IsDefined(const std::string& name) const;
+
+        /**
+        Returns the replacement of the specified predefined macro (e.g. "__LINE__"), or null if the token is no predefined macro.
+        emarks Predefined macros can be overridden by '#define' (their names are reserved in HLSL, but this is not checked).
+        */
+        TokenPtr ExpandPredefinedMacro(const Token& tkn);
+
+        /**
+        Expands all macros of the specified tokens and appends the result to the output.
+        \remarks The replacement of a macro is rescanned together with the remaining tokens,
+        so a function-like macro may take its arguments from the tokens after the replacement (e.g. "#define G F" and "G(1, 2)").
+        */
+        void ExpandTokens(const std::vector<TokenPtr>& tokens, std::vector<TokenPtr>& output);
+
+        //! Returns the replacement of the specified macro (with the substituted arguments and pasted tokens).
+        void SubstituteMacro(
+            const Macro& macro, const std::vector<std::vector<TokenPtr>>& arguments,
+            const SourcePosition& pos, std::vector<TokenPtr>& output
+        );
+
+        //! Pastes the two specified tokens into a single token (operator '##').
+        TokenPtr PasteTokens(const TokenPtr& lhs, const TokenPtr& rhs, const SourcePosition& pos);
+
+        //! Evaluates the specified condition of an '#if' or '#elif' directive.
+        bool EvaluateCondition(const std::string& text, const SourcePosition& pos);
+
+        long long EvaluateExpr(const std::vector<TokenPtr>& tokens, std::size_t& index, int minPrecedence, const SourcePosition& pos);
+        long long EvaluatePrimaryExpr(const std::vector<TokenPtr>& tokens, std::size_t& index, const SourcePosition& pos);
+
+        /* === Members === */
+
+        IncludeHandler*                         includeHandler_ = nullptr;
+        IncludeCache*                           includeCache_   = nullptr;
+        Logger*                                 log_            = nullptr;
+
+        StringPool*                             stringPool_     = nullptr;
+        std::vector<TokenPtr>*                  output_         = nullptr;
+
+        std::vector<std::pair<std::string, std::string>> predefinedMacros_;
+
+        std::unordered_map<std::string, Macro>  macros_;
+        std::vector<std::string>                disabledMacros_;    //!< Macros which are currently expanded (they are not expanded recursively).
+        std::vector<IfBlock>                    ifBlocks_;
+        std::vector<FileState>                  fileStack_;
+        std::set<std::string>                   onceIncludes_;      //!< Include files with '#pragma once'.
+        std::vector<IncludeCache::EntryPtr>     includes_;          //!< Keeps the tokens of all included files alive.
+
+        std::chrono::steady_clock::duration     scanTime_           = std::chrono::steady_clock::duration::zero();
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -7,8 +7,9 @@
 
 #include "HLSLScanner.h"
 #include "HLSLKeywords.h"
+#include "CharScan.h"
 
-#include <cctype>
+#include <algorithm>
 
 
 namespace HTLib
@@ -20,19 +21,20 @@ HLSLScanner::HLSLScanner(Logger* log) :
 {
 }
 
-bool HLSLScanner::ScanSource(const std::shared_ptr<SourceCode>& source)
+bool HLSLScanner::ScanSource(const std::shared_ptr<SourceCode>& source, StringPool& stringPool)
 {
     if (source && source->IsValid())
     {
         /* Store source stream and take first character */
         source_ = source;
+        stringPool_ = &stringPool;
         TakeIt();
         return true;
     }
     return false;
 }
 
-TokenPtr HLSLScanner::Next()
+Token HLSLScanner::Next()
 {
     while (true)
     {
@@ -87,8 +89,6 @@ TokenPtr HLSLScanner::Next()
                 log_->Error(err.what());
         }
     }
-
-    return nullptr;
 }
 
 SourcePosition HLSLScanner::Pos() const
@@ -96,6 +96,77 @@ SourcePosition HLSLScanner::Pos() const
     return source_ != nullptr ? source_->Pos() : SourcePosition::ignore;
 }
 
+void HLSLScanner::SkipCodeBlock(std::string& source, std::size_t& offset, unsigned int& row, std::vector<Ident>& calledNames)
+{
+    /* The current character follows the opening '{' */
+    auto blockBegin = source_->Current() - 2;
+    if (blockBegin < source_->Begin() || *blockBegin != '{')
+        Error("code block can only be skipped after its opening '{'");
+
+    auto lineBegin = source_->LineBegin();
+    row = Pos().Row();
+
+    const char* blockEnd = nullptr;
+
+    for (int depth = 1; depth > 0;)
+    {
+        if (Is(0))
+            ErrorEOF();
+
+        if (Is('/'))
+        {
+            /* Skip commentaries */
+            TakeIt();
+            if (Is('/'))
+                IgnoreCommentLine();
+            else if (Is('*'))
+                IgnoreCommentBlock();
+        }
+        else if (Is('#'))
+        {
+            /* Skip directive (including the following lines after a backslash) */
+            bool takeNextLine = false;
+            while (!Is(0) && (!Is('\n') || takeNextLine))
+            {
+                takeNextLine = Is('\\');
+                TakeIt();
+            }
+        }
+        else if (CharClass::IsIdentBegin(chr_))
+        {
+            /* Skip identifier and store it, if it's followed by '(' */
+            auto identBegin = source_->Current() - 1;
+            auto identEnd = SkipIdentChars(source_->Current(), source_->End());
+
+            TakeFrom(identEnd);
+
+            IgnoreWhiteSpaces();
+            if (Is('('))
+                calledNames.push_back(Ident(identBegin, static_cast<std::size_t>(identEnd - identBegin)));
+        }
+        else if (CharClass::IsDigit(chr_))
+        {
+            /* Skip number (including suffixes and exponents, so they are not taken as identifiers) */
+            while (CharClass::IsIdent(chr_) || Is('.'))
+                TakeFrom(SkipIdentChars(source_->Current(), source_->End()));
+        }
+        else
+        {
+            if (Is('{'))
+                ++depth;
+            else if (Is('}') && --depth == 0)
+                blockEnd = source_->Current();
+            TakeIt();
+        }
+    }
+
+    source.assign(lineBegin, blockEnd);
+    offset = static_cast<std::size_t>(blockBegin - lineBegin);
+
+    std::sort(calledNames.begin(), calledNames.end());
+    calledNames.erase(std::unique(calledNames.begin(), calledNames.end()), calledNames.end());
+}
+
 
 /*
  * ======= Private: =======
@@ -143,70 +214,73 @@ void HLSLScanner::ErrorLetterInNumber()
     Error("letter '" + std::string(1, chr_) + "' is not allowed within a number");
 }
 
-void HLSLScanner::Ignore(const std::function<bool (char)>& pred)
+void HLSLScanner::TakeFrom(const char* pos)
 {
-    while (pred(chr_))
-        TakeIt();
+    source_->SkipTo(pos);
+    TakeIt();
 }
 
 void HLSLScanner::IgnoreWhiteSpaces()
 {
-    Ignore([](char chr) { return std::isspace(static_cast<unsigned char>(chr)) != 0; });
+    /* Skip the run of white spaces inside the buffer (the final new-line character at the end is not inside the buffer) */
+    while (CharClass::IsSpace(chr_))
+        TakeFrom(SkipSpaces(source_->Current(), source_->End()));
 }
 
 void HLSLScanner::IgnoreCommentLine()
 {
-    Ignore([](char chr) { return chr != '\n'; });
+    /* Skip up to the next new-line character (which is not ignored) */
+    if (!Is('\n') && !Is(0))
+        TakeFrom(FindChar(source_->Current(), source_->End(), '\n'));
 }
 
 void HLSLScanner::IgnoreCommentBlock()
 {
-    while (true)
-    {
-        if (Is(0))
-            return;
+    /* The current character is the '*' of the opening comment delimiter (which can already be part of the closing delimiter) */
+    auto begin = source_->Current();
+    auto end = source_->End();
 
-        /* Scan comment block ending */
-        if (Is('*'))
+    for (auto pos = begin; (pos = FindChar(pos, end, '/')) != end; ++pos)
+    {
+        if (*(pos - 1) == '*')
         {
-            TakeIt();
-            if (Is('/'))
-            {
-                TakeIt();
-                return;
-            }
+            TakeFrom(pos + 1);
+            return;
         }
+    }
 
+    /* Comment block is not closed until the end of the source */
+    TakeFrom(end);
+    while (!Is(0))
         TakeIt();
-    }
 }
 
-TokenPtr HLSLScanner::Make(const Token::Types& type, bool takeChr)
+Token HLSLScanner::Make(const Token::Types& type, bool takeChr)
 {
     if (takeChr)
     {
         std::string spell;
         spell += TakeIt();
-        return std::make_shared<Token>(Pos(), type, std::move(spell));
+        return Token(Pos(), type, stringPool_->Intern(spell));
     }
-    return std::make_shared<Token>(Pos(), type);
+    return Token(Pos(), type);
 }
 
-TokenPtr HLSLScanner::Make(const Token::Types& type, std::string& spell, bool takeChr)
+Token HLSLScanner::Make(const Token::Types& type, std::string& spell, bool takeChr)
 {
     if (takeChr)
         spell += TakeIt();
-    return std::make_shared<Token>(Pos(), type, std::move(spell));
+    return Token(Pos(), type, stringPool_->Intern(spell));
 }
 
-TokenPtr HLSLScanner::Make(const Token::Types& type, std::string& spell, const SourcePosition& pos, bool takeChr)
+Token HLSLScanner::Make(const Token::Types& type, std::string& spell, const SourcePosition& pos, bool takeChr)
 {
     if (takeChr)
         spell += TakeIt();
-    return std::make_shared<Token>(pos, type, std::move(spell));
+    return Token(pos, type, stringPool_->Intern(spell));
 }
 
-TokenPtr HLSLScanner::ScanToken()
+Token HLSLScanner::ScanToken()
 {
     std::string spell;
 
@@ -215,11 +289,11 @@ TokenPtr HLSLScanner::ScanToken()
         return ScanDirective();
 
     /* Scan identifier */
-    if (std::isalpha(UChr()) || Is('_'))
+    if (CharClass::IsIdentBegin(chr_))
         return ScanIdentifier();
 
     /* Scan number */
-    if (std::isdigit(UChr()))
+    if (CharClass::IsDigit(chr_))
         return ScanNumber();
 
     /* Scan operators */
@@ -326,14 +400,19 @@ TokenPtr HLSLScanner::ScanToken()
 
     ErrorUnexpected();
 
-    return nullptr;
+    return Token();
 }
 
-TokenPtr HLSLScanner::ScanDirective()
+Token HLSLScanner::ScanDirective()
 {
     std::string spell;
     bool takeNextLine = false;
 
+    /* Scan token-pasting operator '##' (only used inside macro definitions) */
+    spell += TakeIt();
+    if (Is('#'))
+        return Make(Token::Types::Directive, spell, true);
+
     while (!Is('\n') || takeNextLine)
     {
         takeNextLine = false;
@@ -345,25 +424,24 @@ TokenPtr HLSLScanner::ScanDirective()
     return Make(Token::Types::Directive, spell);
 }
 
-TokenPtr HLSLScanner::ScanIdentifier()
+Token HLSLScanner::ScanIdentifier()
 {
-    /* Scan identifier string */
-    std::string spell;
-    spell += TakeIt();
-
-    while (std::isalnum(UChr()) || Is('_'))
-        spell += TakeIt();
+    /* Scan identifier string (the current character is the first character of the identifier inside the buffer) */
+    auto identBegin = source_->Current() - 1;
+    auto identEnd = SkipIdentChars(source_->Current(), source_->End());
 
     /* Scan reserved words */
-    auto it = HLSLKeywords().find(spell);
-    if (it != HLSLKeywords().end())
-        return Make(it->second, spell);
+    Token::Types type = Token::Types::Ident;
+    FindHLSLKeyword(identBegin, static_cast<std::size_t>(identEnd - identBegin), type);
 
-    /* Return as identifier */
-    return Make(Token::Types::Ident, spell);
+    /* Intern the identifier directly from the source buffer */
+    Ident ident(identBegin, static_cast<std::size_t>(identEnd - identBegin));
+    TakeFrom(identEnd);
+
+    return Token(Pos(), type, ident);
 }
 
-TokenPtr HLSLScanner::ScanAssignShiftRelationOp(const char chr)
+Token HLSLScanner::ScanAssignShiftRelationOp(const char chr)
 {
     std::string spell;
     spell += TakeIt();
@@ -384,7 +462,7 @@ TokenPtr HLSLScanner::ScanAssignShiftRelationOp(const char chr)
     return Make(Token::Types::BinaryOp, spell);
 }
 
-TokenPtr HLSLScanner::ScanPlusOp()
+Token HLSLScanner::ScanPlusOp()
 {
     std::string spell;
     spell += TakeIt();
@@ -397,7 +475,7 @@ TokenPtr HLSLScanner::ScanPlusOp()
     return Make(Token::Types::BinaryOp, spell);
 }
 
-TokenPtr HLSLScanner::ScanMinusOp()
+Token HLSLScanner::ScanMinusOp()
 {
     std::string spell;
     spell += TakeIt();
@@ -410,9 +488,9 @@ TokenPtr HLSLScanner::ScanMinusOp()
     return Make(Token::Types::BinaryOp, spell);
 }
 
-TokenPtr HLSLScanner::ScanNumber()
+Token HLSLScanner::ScanNumber()
 {
-    if (!std::isdigit(UChr()))
+    if (!CharClass::IsDigit(chr_))
         Error("expected digit");
     
     /* Take first number (literals like ".0" are not allowed) */
@@ -430,7 +508,7 @@ TokenPtr HLSLScanner::ScanNumber()
     {
         spell += TakeIt();
         
-        if (std::isdigit(UChr()))
+        if (CharClass::IsDigit(chr_))
             ScanDecimalLiteral(spell);
         else
             Error("floating-point literals must have a decimal on both sides of the dot (e.g. '0.0' but not '0.' or '.0')");
@@ -441,7 +519,7 @@ TokenPtr HLSLScanner::ScanNumber()
     if (Is('f') || Is('F'))
         TakeIt();
 
-    if (std::isalpha(UChr()) || Is('.'))
+    if (CharClass::Is(chr_, CharClass::Letter) || Is('.'))
         ErrorLetterInNumber();
 
     /* Create number token */
@@ -450,8 +528,14 @@ TokenPtr HLSLScanner::ScanNumber()
 
 void HLSLScanner::ScanDecimalLiteral(std::string& spell)
 {
-    while (std::isdigit(UChr()))
-        spell += TakeIt();
+    if (CharClass::IsDigit(chr_))
+    {
+        auto digitsBegin = source_->Current() - 1;
+        auto digitsEnd = SkipDigits(source_->Current(), source_->End());
+
+        spell.append(digitsBegin, digitsEnd);
+        TakeFrom(digitsEnd);
+    }
 }
 
 
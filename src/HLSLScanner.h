@@ -10,12 +10,13 @@
 
 
 #include "SourceCode.h"
+#include "StringPool.h"
 #include "SourcePosition.h"
 #include "Token.h"
 #include "HT/Logger.h"
 
 #include <string>
-#include <functional>
+#include <vector>
 
 
 namespace HTLib
@@ -30,13 +31,27 @@ class HLSLScanner
         
         HLSLScanner(Logger* log = nullptr);
 
-        bool ScanSource(const std::shared_ptr<SourceCode>& source);
+        /**
+        Starts scanning the specified source code.
+        \param[in] stringPool Specifies the string pool for all token spellings. It must outlive all scanned tokens.
+        */
+        bool ScanSource(const std::shared_ptr<SourceCode>& source, StringPool& stringPool);
 
-        //! Scanns the next token.
-        TokenPtr Next();
+        //! Scanns the next token. Tokens are returned by value, so no memory is allocated for them.
+        Token Next();
 
         SourcePosition Pos() const;
 
+        /**
+        Skips the rest of a code block, whose opening '{' has just been scanned (i.e. it was the last token), up to the matching '}'.
+        \param[out] source Receives the source from the beginning of the line of the opening '{' up to and including the closing '}'.
+        \param[out] offset Receives the offset of the opening '{' within "source".
+        \param[out] row Receives the row of the opening '{'.
+        \param[out] calledNames Receives all identifiers inside the code block which are followed by '(' (sorted and without duplicates).
+        \remarks Comments and directives are skipped, but no tokens are made. Use "Next" to continue scanning after the closing '}'.
+        */
+        void SkipCodeBlock(std::string& source, std::size_t& offset, unsigned int& row, std::vector<Ident>& calledNames);
+
         inline SourceCode* Source() const
         {
             return source_.get();
@@ -55,25 +70,28 @@ class HLSLScanner
         void ErrorEOF();
         void ErrorLetterInNumber();
 
-        //! Ignores all characters which comply the specified predicate.
-        void Ignore(const std::function<bool (char)>& pred);
+        /**
+        Skips all characters before the specified position inside the source buffer and takes the character at that position.
+        \see SourceCode::SkipTo
+        */
+        void TakeFrom(const char* pos);
 
         void IgnoreWhiteSpaces();
         void IgnoreCommentLine();
         void IgnoreCommentBlock();
 
-        TokenPtr Make(const Token::Types& type, bool takeChr = false);
-        TokenPtr Make(const Token::Types& type, std::string& spell, bool takeChr = false);
-        TokenPtr Make(const Token::Types& type, std::string& spell, const SourcePosition& pos, bool takeChr = false);
+        Token Make(const Token::Types& type, bool takeChr = false);
+        Token Make(const Token::Types& type, std::string& spell, bool takeChr = false);
+        Token Make(const Token::Types& type, std::string& spell, const SourcePosition& pos, bool takeChr = false);
 
-        TokenPtr ScanToken();
+        Token ScanToken();
 
-        TokenPtr ScanDirective();
-        TokenPtr ScanIdentifier();
-        TokenPtr ScanAssignShiftRelationOp(const char Chr);
-        TokenPtr ScanPlusOp();
-        TokenPtr ScanMinusOp();
-        TokenPtr ScanNumber();
+        Token ScanDirective();
+        Token ScanIdentifier();
+        Token ScanAssignShiftRelationOp(const char Chr);
+        Token ScanPlusOp();
+        Token ScanMinusOp();
+        Token ScanNumber();
 
         void ScanDecimalLiteral(std::string& spell);
 
@@ -82,15 +100,12 @@ class HLSLScanner
             return chr_ == chr;
         }
 
-        inline unsigned char UChr() const
-        {
-            return static_cast<unsigned char>(chr_);
-        }
-
         /* === Members === */
 
         std::shared_ptr<SourceCode> source_;
-        char                        chr_ = 0;
+        char                        chr_        = 0;
+
+        StringPool*                 stringPool_ = nullptr;
 
         Logger*                     log_ = nullptr;
 
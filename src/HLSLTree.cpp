@@ -32,9 +32,69 @@ std::string FullVarIdent(const VarIdentPtr& varIdent)
     return name;
 }
 
+Ident FindFullVarIdent(const VarIdentPtr& varIdent)
+{
+    /* Only a composed identifier (e.g. "tex.Sample") must be looked up */
+    return (varIdent->next ? Ident::Find(FullVarIdent(varIdent)) : varIdent->ident);
+}
+
 VarIdent* LastVarIdent(VarIdent* varIdent)
 {
-    return (varIdent && varIdent->next) ? LastVarIdent(varIdent->next.get()) : varIdent;
+    return (varIdent && varIdent->next) ? LastVarIdent(varIdent->next) : varIdent;
+}
+
+const char* ASTTypeToString(const AST::Types type)
+{
+    switch (type)
+    {
+        case AST::Types::Program: return "Program";
+        case AST::Types::CodeBlock: return "CodeBlock";
+        case AST::Types::BufferDeclIdent: return "BufferDeclIdent";
+        case AST::Types::FunctionCall: return "FunctionCall";
+        case AST::Types::Structure: return "Structure";
+        case AST::Types::FunctionDecl: return "FunctionDecl";
+        case AST::Types::UniformBufferDecl: return "UniformBufferDecl";
+        case AST::Types::StorageBufferDecl: return "StorageBufferDecl";
+        case AST::Types::TextureDecl: return "TextureDecl";
+        case AST::Types::SamplerDecl: return "SamplerDecl";
+        case AST::Types::StructDecl: return "StructDecl";
+        case AST::Types::DirectiveDecl: return "DirectiveDecl";
+        case AST::Types::NullStmnt: return "NullStmnt";
+        case AST::Types::DirectiveStmnt: return "DirectiveStmnt";
+        case AST::Types::CodeBlockStmnt: return "CodeBlockStmnt";
+        case AST::Types::ForLoopStmnt: return "ForLoopStmnt";
+        case AST::Types::WhileLoopStmnt: return "WhileLoopStmnt";
+        case AST::Types::DoWhileLoopStmnt: return "DoWhileLoopStmnt";
+        case AST::Types::IfStmnt: return "IfStmnt";
+        case AST::Types::ElseStmnt: return "ElseStmnt";
+        case AST::Types::SwitchStmnt: return "SwitchStmnt";
+        case AST::Types::VarDeclStmnt: return "VarDeclStmnt";
+        case AST::Types::AssignStmnt: return "AssignStmnt";
+        case AST::Types::ExprStmnt: return "ExprStmnt";
+        case AST::Types::FunctionCallStmnt: return "FunctionCallStmnt";
+        case AST::Types::ReturnStmnt: return "ReturnStmnt";
+        case AST::Types::StructDeclStmnt: return "StructDeclStmnt";
+        case AST::Types::CtrlTransferStmnt: return "CtrlTransferStmnt";
+        case AST::Types::ListExpr: return "ListExpr";
+        case AST::Types::LiteralExpr: return "LiteralExpr";
+        case AST::Types::TypeNameExpr: return "TypeNameExpr";
+        case AST::Types::TernaryExpr: return "TernaryExpr";
+        case AST::Types::BinaryExpr: return "BinaryExpr";
+        case AST::Types::UnaryExpr: return "UnaryExpr";
+        case AST::Types::PostUnaryExpr: return "PostUnaryExpr";
+        case AST::Types::FunctionCallExpr: return "FunctionCallExpr";
+        case AST::Types::BracketExpr: return "BracketExpr";
+        case AST::Types::CastExpr: return "CastExpr";
+        case AST::Types::VarAccessExpr: return "VarAccessExpr";
+        case AST::Types::InitializerExpr: return "InitializerExpr";
+        case AST::Types::SwitchCase: return "SwitchCase";
+        case AST::Types::PackOffset: return "PackOffset";
+        case AST::Types::VarSemantic: return "VarSemantic";
+        case AST::Types::VarType: return "VarType";
+        case AST::Types::VarIdent: return "VarIdent";
+        case AST::Types::VarDecl: return "VarDecl";
+    }
+    return "<unknown>";
 }
 
 
@@ -12,6 +12,8 @@
 #include "Token.h"
 #include "Visitor.h"
 #include "Flags.h"
+#include "ASTArena.h"
+#include "StringPool.h"
 
 #include <vector>
 #include <string>
@@ -129,10 +131,35 @@ struct AST
 struct GlobalDecl : public AST {};
 
 //! Statement base class.
-struct Stmnt : public AST {};
+struct Stmnt : public AST
+{
+    FLAG_ENUM
+    {
+        FLAG( isDeadCode, 0 ), // This statement can never be executed (e.g. after a 'return' statement); see "DeadCodeEliminator".
+    };
+};
+
+//! Constant value of a folded expression (see "ConstantFolder").
+struct ConstValue
+{
+    enum class Types
+    {
+        None,   // Not a constant.
+        Bool,
+        Int,
+        UInt,
+        Float,
+    };
+
+    Types               type = Types::None;
+    std::vector<double> components; // One component for scalars, 2-4 components for vectors.
+};
 
 //! Expression base class.
-struct Expr : public AST {};
+struct Expr : public AST
+{
+    ConstValue constValue; // Folded constant value for DAST; the type is 'None' if this expression is not folded.
+};
 
 //! Program AST root.
 struct Program : public AST
@@ -170,6 +197,11 @@ struct Program : public AST
     std::set<std::string>       requiredExtensions; // Required GLSL extensions for the DAST
     InputSemantics              inputSemantics;     // Input semantics for the DAST
     OutputSemantics             outputSemantics;    // Output semantics for the DAST
+
+    ASTArena                    arena;              // Allocator for all nodes of this program
+    StringPool                  stringPool;         // Interned spellings of all tokens of this program
+
+    std::vector<ProgramPtr>     linkedPrograms;     // Programs which own the nodes of global declarations that have been linked into this program
 };
 
 //! Code block.
@@ -189,7 +221,7 @@ struct BufferDeclIdent : public AST
         FLAG( isReferenced, 0 ), // This buffer is referenced (or rather used) at least once (use-count >= 1).
     };
 
-    std::string ident;
+    Ident       ident;
     std::string registerName; // May be empty
 };
 
@@ -206,7 +238,7 @@ struct FunctionCall : public AST
         FLAG( isAtomicFunc, 3 ), // This is an atomic (or rather interlocked) function (e.g. "InterlockedAdd").
     };
 
-    VarIdentPtr             name;
+    VarIdentPtr             name = nullptr;
     std::vector<ExprPtr>    arguments;
 };
 
@@ -223,7 +255,7 @@ struct Structure : public AST
         FLAG( isShaderOutput,   3 ), // This structure is used as shader output.
     };
 
-    std::string                     name;
+    Ident                           name;
     std::vector<VarDeclStmntPtr>    members;
     std::string                     aliasName;          // Alias name for input and output interface blocks of the DAST.
     std::map<std::string, VarDecl*> systemValuesRef;    // List of members with system value semantic (SV_...).
@@ -243,15 +275,56 @@ struct FunctionDecl : public GlobalDecl
         FLAG( isEntryPoint, 2 ), // This function is the main entry point.
     };
     
+    //! Function body which has been skipped by the parser (see "Options::lazyFunctionBodies").
+    struct LazyBody
+    {
+        std::string                 source;         // Source from the beginning of the line of the opening '{' up to the closing '}'; cleared when the body is parsed (unless it can be released).
+        std::size_t                 offset = 0;     // Offset of the opening '{' within the source.
+        unsigned int                row = 0;        // Row of the opening '{'.
+        std::vector<Ident>          calledNames;    // Identifiers inside the body which are followed by '(' (a superset of all called functions).
+    };
+
     std::vector<FunctionCallPtr>    attribs;            // Attribute list
-    VarTypePtr                      returnType;
-    std::string                     name;
+    VarTypePtr                      returnType = nullptr;
+    Ident                           name;
     std::vector<VarDeclStmntPtr>    parameters;
     std::string                     semantic;           // May be empty
-    CodeBlockPtr                    codeBlock;          // May be null (if this AST node is a forward declaration).
+    CodeBlockPtr                    codeBlock = nullptr; // May be null (if this AST node is a forward declaration or the body has not been parsed yet).
+    std::unique_ptr<LazyBody>       lazyBody;           // Non-null if the body has been skipped by the parser.
     std::vector<FunctionDecl*>      forwardDeclsRef;    // List of forward declarations to this function.
+    std::unique_ptr<ASTArena>       bodyArena;          // Non-null if the nodes of the body are owned by their own arena (see "HLSLParser::EnableBodyArenas").
+
+    //! Returns true if this function has a body, which has not been parsed yet.
+    inline bool HasLazyBody() const
+    {
+        return (!codeBlock && lazyBody && !lazyBody->source.empty());
+    }
 };
 
+/**
+Calls the specified function for each node of the specified program,
+i.e. for all nodes of its own arena, of the body arenas of its functions, and of the arenas of all linked programs.
+\see Program::linkedPrograms
+\see FunctionDecl::bodyArena
+*/
+template <typename Func> void ForEachNode(const Program& program, Func func)
+{
+    for (auto node : program.arena.Nodes())
+    {
+        func(node);
+        if (node->Type() == AST::Types::FunctionDecl)
+        {
+            if (auto bodyArena = static_cast<const FunctionDecl*>(node)->bodyArena.get())
+            {
+                for (auto bodyNode : bodyArena->Nodes())
+                    func(bodyNode);
+            }
+        }
+    }
+    for (const auto& linkedProgram : program.linkedPrograms)
+        ForEachNode(*linkedProgram, func);
+}
+
 //! Uniform buffer (cbuffer, tbuffer) declaration.
 struct UniformBufferDecl : public GlobalDecl
 {
@@ -264,7 +337,7 @@ struct UniformBufferDecl : public GlobalDecl
     };
     
     std::string                     bufferType;
-    std::string                     name;
+    Ident                           name;
     std::string                     registerName; // May be empty
     std::vector<VarDeclStmntPtr>    members;
 };
@@ -279,7 +352,7 @@ struct TextureDecl : public GlobalDecl
         FLAG( isReferenced, 0 ), // This texture is referenced (or rather used) at least once (use-count >= 1).
     };
 
-    std::string                     textureType;
+    Ident                           textureType;
     std::string                     colorType;
     std::vector<BufferDeclIdentPtr> names;
 };
@@ -288,7 +361,13 @@ struct TextureDecl : public GlobalDecl
 struct SamplerDecl : public GlobalDecl
 {
     AST_INTERFACE(SamplerDecl);
-    std::string                     samplerType;
+
+    FLAG_ENUM
+    {
+        FLAG( isReferenced, 0 ), // This sampler is referenced (or rather used) at least once (use-count >= 1).
+    };
+
+    Ident                           samplerType;
     std::vector<BufferDeclIdentPtr> names;
 };
 
@@ -296,7 +375,7 @@ struct SamplerDecl : public GlobalDecl
 struct StructDecl : public GlobalDecl
 {
     AST_INTERFACE(StructDecl);
-    StructurePtr structure;
+    StructurePtr structure = nullptr;
 };
 
 //! Direvtive declaration.
@@ -321,7 +400,7 @@ struct VarSemantic : public AST
 {
     AST_INTERFACE(VarSemantic);
     std::string     semantic;
-    PackOffsetPtr   packOffset;
+    PackOffsetPtr   packOffset = nullptr;
     std::string     registerName; // May be empty
 };
 
@@ -329,8 +408,8 @@ struct VarSemantic : public AST
 struct VarType : public AST
 {
     AST_INTERFACE(VarType);
-    std::string     baseType;               // Either this ...
-    StructurePtr    structType;             // ... or this is used.
+    Ident           baseType;               // Either this ...
+    StructurePtr    structType = nullptr;   // ... or this is used.
     AST*            symbolRef = nullptr;    // Symbol reference for DAST to the type definition; may be null.
 };
 
@@ -338,9 +417,9 @@ struct VarType : public AST
 struct VarIdent : public AST
 {
     AST_INTERFACE(VarIdent);
-    std::string             ident;
+    Ident                   ident;
     std::vector<ExprPtr>    arrayIndices;
-    VarIdentPtr             next;
+    VarIdentPtr             next = nullptr;
     AST*                    symbolRef = nullptr;    // Symbol reference for DAST to the variable object; may be null.
     std::string             systemSemantic;         // System semantic (SV_...) for DAST; may be empty.
 };
@@ -356,10 +435,10 @@ struct VarDecl : public AST
         FLAG( disableCodeGen,   1 ), // Disables the code generation for this variable declaration.
     };
 
-    std::string                 name;
+    Ident                       name;
     std::vector<ExprPtr>        arrayDims;
     std::vector<VarSemanticPtr> semantics;
-    ExprPtr                     initializer;
+    ExprPtr                     initializer = nullptr;
     UniformBufferDecl*          uniformBufferRef = nullptr; // Uniform buffer reference for DAST; may be null
     VarDeclStmnt*               declStmntRef = nullptr;     // Reference to its declaration statement; may be null
 };
@@ -383,7 +462,7 @@ struct DirectiveStmnt : public Stmnt
 struct CodeBlockStmnt : public Stmnt
 {
     AST_INTERFACE(CodeBlockStmnt);
-    CodeBlockPtr codeBlock;
+    CodeBlockPtr codeBlock = nullptr;
 };
 
 //! 'for'-loop statemnet.
@@ -391,10 +470,10 @@ struct ForLoopStmnt : public Stmnt
 {
     AST_INTERFACE(ForLoopStmnt);
     std::vector<FunctionCallPtr>    attribs; // Attribute list
-    StmntPtr                        initSmnt;
-    ExprPtr                         condition;
-    ExprPtr                         iteration;
-    StmntPtr                        bodyStmnt;
+    StmntPtr                        initSmnt = nullptr;
+    ExprPtr                         condition = nullptr;
+    ExprPtr                         iteration = nullptr;
+    StmntPtr                        bodyStmnt = nullptr;
 };
 
 //! 'while'-loop statement.
@@ -402,8 +481,8 @@ struct WhileLoopStmnt : public Stmnt
 {
     AST_INTERFACE(WhileLoopStmnt);
     std::vector<FunctionCallPtr>    attribs; // Attribute list
-    ExprPtr                         condition;
-    StmntPtr                        bodyStmnt;
+    ExprPtr                         condition = nullptr;
+    StmntPtr                        bodyStmnt = nullptr;
 };
 
 //! 'do/while'-loop statement.
@@ -411,25 +490,32 @@ struct DoWhileLoopStmnt : public Stmnt
 {
     AST_INTERFACE(DoWhileLoopStmnt);
     std::vector<FunctionCallPtr>    attribs; // Attribute list
-    StmntPtr                        bodyStmnt;
-    ExprPtr                         condition;
+    StmntPtr                        bodyStmnt = nullptr;
+    ExprPtr                         condition = nullptr;
 };
 
 //! 'if' statement.
 struct IfStmnt : public Stmnt
 {
     AST_INTERFACE(IfStmnt);
+
+    FLAG_ENUM
+    {
+        FLAG( isConstTrue,  1 ), // The condition is always true -> only the 'if' branch is generated.
+        FLAG( isConstFalse, 2 ), // The condition is always false -> only the 'else' branch (if any) is generated.
+    };
+
     std::vector<FunctionCallPtr>    attribs;    // Attribute list
-    ExprPtr                         condition;
-    StmntPtr                        bodyStmnt;
-    ElseStmntPtr                    elseStmnt;  // May be null
+    ExprPtr                         condition = nullptr;
+    StmntPtr                        bodyStmnt = nullptr;
+    ElseStmntPtr                    elseStmnt = nullptr; // May be null
 };
 
 //! 'else' statement.
 struct ElseStmnt : public Stmnt
 {
     AST_INTERFACE(ElseStmnt);
-    StmntPtr bodyStmnt;
+    StmntPtr bodyStmnt = nullptr;
 };
 
 //! 'switch' statement.
@@ -437,7 +523,7 @@ struct SwitchStmnt : public Stmnt
 {
     AST_INTERFACE(SwitchStmnt);
     std::vector<FunctionCallPtr>    attribs; // Attribute list
-    ExprPtr                         selector;
+    ExprPtr                         selector = nullptr;
     std::vector<SwitchCasePtr>      cases;
 };
 
@@ -455,7 +541,7 @@ struct VarDeclStmnt : public Stmnt
     std::string                 inputModifier;      // in, out, inout, uniform
     std::vector<std::string>    storageModifiers;   // extern, nointerpolation, precise, shared, groupshared, static, volatile
     std::vector<std::string>    typeModifiers;      // const, row_major, column_major
-    VarTypePtr                  varType;
+    VarTypePtr                  varType = nullptr;
     std::vector<VarDeclPtr>     varDecls;
 };
 
@@ -463,37 +549,37 @@ struct VarDeclStmnt : public Stmnt
 struct AssignStmnt : public Stmnt
 {
     AST_INTERFACE(AssignStmnt);
-    VarIdentPtr varIdent;
+    VarIdentPtr varIdent = nullptr;
     std::string op;
-    ExprPtr     expr;
+    ExprPtr     expr = nullptr;
 };
 
 //! Arbitrary expression statement.
 struct ExprStmnt : public Stmnt
 {
     AST_INTERFACE(ExprStmnt);
-    ExprPtr expr;
+    ExprPtr expr = nullptr;
 };
 
 //! Function call statement.
 struct FunctionCallStmnt : public Stmnt
 {
     AST_INTERFACE(FunctionCallStmnt);
-    FunctionCallPtr call;
+    FunctionCallPtr call = nullptr;
 };
 
 //! Returns statement.
 struct ReturnStmnt : public Stmnt
 {
     AST_INTERFACE(ReturnStmnt);
-    ExprPtr expr; // may be null
+    ExprPtr expr = nullptr; // may be null
 };
 
 //! Structure declaration statement.
 struct StructDeclStmnt : public Stmnt
 {
     AST_INTERFACE(StructDeclStmnt);
-    StructurePtr structure;
+    StructurePtr structure = nullptr;
 };
 
 //! Control transfer statement.
@@ -509,8 +595,8 @@ struct CtrlTransferStmnt : public Stmnt
 struct ListExpr : public Expr
 {
     AST_INTERFACE(ListExpr);
-    ExprPtr firstExpr;
-    ExprPtr nextExpr;
+    ExprPtr firstExpr = nullptr;
+    ExprPtr nextExpr = nullptr;
 };
 
 //! Literal expression.
@@ -524,25 +610,25 @@ struct LiteralExpr : public Expr
 struct TypeNameExpr : public Expr
 {
     AST_INTERFACE(TypeNameExpr);
-    std::string typeName;
+    Ident typeName;
 };
 
 //! Ternary expression.
 struct TernaryExpr : public Expr
 {
     AST_INTERFACE(TernaryExpr);
-    ExprPtr condition;  // Condition expression
-    ExprPtr ifExpr;     // <if> case expression
-    ExprPtr elseExpr;   // <else> case expression
+    ExprPtr condition = nullptr; // Condition expression
+    ExprPtr ifExpr = nullptr; // <if> case expression
+    ExprPtr elseExpr = nullptr; // <else> case expression
 };
 
 //! Binary expressions.
 struct BinaryExpr : public Expr
 {
     AST_INTERFACE(BinaryExpr);
-    ExprPtr     lhsExpr;    // Left-hand-side expression
+    ExprPtr     lhsExpr = nullptr; // Left-hand-side expression
     std::string op;         // Binary operator
-    ExprPtr     rhsExpr;    // Right-hand-side expression
+    ExprPtr     rhsExpr = nullptr; // Right-hand-side expression
 };
 
 //! (Pre-) Unary expressions.
@@ -550,14 +636,14 @@ struct UnaryExpr : public Expr
 {
     AST_INTERFACE(UnaryExpr);
     std::string op;
-    ExprPtr     expr;
+    ExprPtr     expr = nullptr;
 };
 
 //! Post unary expressions.
 struct PostUnaryExpr : public Expr
 {
     AST_INTERFACE(PostUnaryExpr);
-    ExprPtr     expr;
+    ExprPtr     expr = nullptr;
     std::string op;
 };
 
@@ -565,31 +651,31 @@ struct PostUnaryExpr : public Expr
 struct FunctionCallExpr : public Expr
 {
     AST_INTERFACE(FunctionCallExpr);
-    FunctionCallPtr call;
+    FunctionCallPtr call = nullptr;
 };
 
 //! Bracket expression.
 struct BracketExpr : public Expr
 {
     AST_INTERFACE(BracketExpr);
-    ExprPtr expr; // Inner expression
+    ExprPtr expr = nullptr; // Inner expression
 };
 
 //! Cast expression.
 struct CastExpr : public Expr
 {
     AST_INTERFACE(CastExpr);
-    ExprPtr typeExpr;
-    ExprPtr expr;
+    ExprPtr typeExpr = nullptr;
+    ExprPtr expr = nullptr;
 };
 
 //! Variable access expression.
 struct VarAccessExpr : public Expr
 {
     AST_INTERFACE(VarAccessExpr);
-    VarIdentPtr varIdent;
+    VarIdentPtr varIdent = nullptr;
     std::string assignOp;   // May be empty
-    ExprPtr     assignExpr; // May be null
+    ExprPtr     assignExpr = nullptr; // May be null
 };
 
 //! Initializer list expression.
@@ -605,7 +691,7 @@ struct InitializerExpr : public Expr
 struct SwitchCase : public AST
 {
     AST_INTERFACE(SwitchCase);
-    ExprPtr                 expr; // If null -> default case
+    ExprPtr                 expr = nullptr; // If null -> default case
     std::vector<StmntPtr>   stmnts;
 };
 
@@ -618,8 +704,12 @@ struct SwitchCase : public AST
 
 //! Returns the full variabel identifier name.
 std::string FullVarIdent(const VarIdentPtr& varIdent);
+//! Returns the full variable identifier name as identifier, or the empty identifier if it has never been interned (see Ident::Find).
+Ident FindFullVarIdent(const VarIdentPtr& varIdent);
 //! Returns the last identifier AST node.
 VarIdent* LastVarIdent(VarIdent* varIdent);
+//! Returns the name of the specified AST node type (e.g. "FunctionDecl").
+const char* ASTTypeToString(const AST::Types type);
 
 
 } // /namespace HTLib
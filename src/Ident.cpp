@@ -0,0 +1,116 @@
+/*
+ * Ident.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "Ident.h"
+
+#include <mutex>
+#include <cstring>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal classes
+ */
+
+/**
+Process-wide identifier pool.
+\remarks The pool is split into several shards with their own lock,
+so the parsers of a concurrent parse (see "Options::parserThreads") rarely wait for each other.
+Each thread also caches its recently interned identifiers, so most identifiers are interned without any lock.
+*/
+class IdentPool
+{
+
+    public:
+
+        static IdentPool& Instance()
+        {
+            /* The pool is intentionally never destroyed, so identifiers stay valid during the destruction of other static objects */
+            static IdentPool* instance = new IdentPool();
+            return *instance;
+        }
+
+        const std::string& Intern(const char* str, std::size_t length)
+        {
+            /* Look up the identifier in the cache of this thread first, to avoid the lock for recurring identifiers */
+            const auto hash = StringPool::Hash(str, length);
+            auto& cached = cache_[hash % cacheSize];
+
+            if (cached != nullptr && cached->size() == length && std::memcmp(cached->data(), str, length) == 0)
+                return *cached;
+
+            auto& shard = GetShard(hash);
+            std::lock_guard<std::mutex> guard(shard.lock);
+
+            const auto& interned = shard.pool.Intern(str, length);
+            cached = &interned;
+
+            return interned;
+        }
+
+        const std::string* Find(const char* str, std::size_t length)
+        {
+            auto& shard = GetShard(StringPool::Hash(str, length));
+            std::lock_guard<std::mutex> guard(shard.lock);
+            return shard.pool.Find(str, length);
+        }
+
+    private:
+
+        static const std::size_t numShards = 16;
+        static const std::size_t cacheSize = 1024;
+
+        struct Shard
+        {
+            std::mutex  lock;
+            StringPool  pool;
+        };
+
+        Shard& GetShard(std::uint32_t hash)
+        {
+            /* Use the upper bits of the hash, the lower bits select the slot within the pool of the shard */
+            return shards_[(hash >> 28) % numShards];
+        }
+
+        Shard shards_[numShards];
+
+        static thread_local const std::string* cache_[cacheSize]; //!< Direct mapped cache of the recently interned identifiers of each thread.
+
+};
+
+
+thread_local const std::string* IdentPool::cache_[IdentPool::cacheSize];
+
+
+/*
+ * Ident class
+ */
+
+Ident::Ident(const char* str, std::size_t length) :
+    str_{ length > 0 ? &(IdentPool::Instance().Intern(str, length)) : &StringPool::Empty() }
+{
+}
+
+Ident Ident::Find(const char* str, std::size_t length)
+{
+    if (length > 0)
+    {
+        if (auto interned = IdentPool::Instance().Find(str, length))
+            return Ident(interned);
+    }
+    return Ident();
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
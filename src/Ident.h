@@ -0,0 +1,237 @@
+/*
+ * Ident.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_IDENT_H__
+#define __HT_IDENT_H__
+
+
+#include "StringPool.h"
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <functional>
+
+
+namespace HTLib
+{
+
+
+/**
+Handle to an interned identifier (e.g. the name of a variable, function, structure or type).
+\remarks All identifiers are interned in a single process-wide pool, so two identifiers are equal
+if and only if their handles are equal, even if they belong to different programs (e.g. the linked programs
+of a concurrent parse, or a program which has been read from a serialized buffer).
+Thus the symbol tables and the lookup tables of the analyzer and generator only compare and hash the handles.
+\note The pool is never released, i.e. the memory grows with the number of distinct identifiers
+which have ever been interned by the process (and not with the number of translations).
+*/
+class Ident
+{
+
+    public:
+
+        //! Constructs the empty identifier.
+        inline Ident() :
+            str_{ &StringPool::Empty() }
+        {
+        }
+
+        //! Interns the specified character range.
+        Ident(const char* str, std::size_t length);
+
+        //! Interns the specified string (explicitly, so a computed string is not interned by accident, see "Find").
+        inline explicit Ident(const std::string& str) :
+            Ident{ str.data(), str.size() }
+        {
+        }
+
+        //! Interns the specified null-terminated string.
+        inline Ident(const char* str) :
+            Ident{ str, std::strlen(str) }
+        {
+        }
+
+        /**
+        Returns the identifier of the specified character range if it has already been interned, or the empty identifier otherwise.
+        \remarks This is used to look up a computed string (e.g. a full variable identifier "a.b.c") without interning it,
+        because a string which has never been interned can not be the key of any table.
+        */
+        static Ident Find(const char* str, std::size_t length);
+
+        static inline Ident Find(const std::string& str)
+        {
+            return Find(str.data(), str.size());
+        }
+
+        //! Returns the interned string.
+        inline const std::string& Str() const
+        {
+            return *str_;
+        }
+
+        inline operator const std::string& () const
+        {
+            return *str_;
+        }
+
+        inline bool empty() const
+        {
+            return str_->empty();
+        }
+
+        inline std::size_t size() const
+        {
+            return str_->size();
+        }
+
+        inline const char* c_str() const
+        {
+            return str_->c_str();
+        }
+
+        inline char operator [] (std::size_t index) const
+        {
+            return (*str_)[index];
+        }
+
+        //! Returns the handle of this identifier (a unique key within the process).
+        inline const void* Handle() const
+        {
+            return str_;
+        }
+
+    private:
+
+        friend class Token;
+
+        //! Constructs the identifier from the specified string, which must already be interned in the identifier pool.
+        inline explicit Ident(const std::string* str) :
+            str_{ str }
+        {
+        }
+
+        const std::string* str_;
+
+};
+
+/* --- Global operators --- */
+
+inline bool operator == (const Ident& lhs, const Ident& rhs)
+{
+    return (lhs.Handle() == rhs.Handle());
+}
+
+inline bool operator != (const Ident& lhs, const Ident& rhs)
+{
+    return (lhs.Handle() != rhs.Handle());
+}
+
+//! Orders the identifiers alphabetically (like "std::string"), so an ordered output does not depend on the interning order.
+inline bool operator < (const Ident& lhs, const Ident& rhs)
+{
+    return (lhs.Handle() != rhs.Handle() && lhs.Str() < rhs.Str());
+}
+
+inline bool operator == (const Ident& lhs, const std::string& rhs)
+{
+    return (lhs.Str() == rhs);
+}
+
+inline bool operator == (const std::string& lhs, const Ident& rhs)
+{
+    return (lhs == rhs.Str());
+}
+
+inline bool operator != (const Ident& lhs, const std::string& rhs)
+{
+    return (lhs.Str() != rhs);
+}
+
+inline bool operator != (const std::string& lhs, const Ident& rhs)
+{
+    return (lhs != rhs.Str());
+}
+
+inline bool operator == (const Ident& lhs, const char* rhs)
+{
+    return (lhs.Str() == rhs);
+}
+
+inline bool operator != (const Ident& lhs, const char* rhs)
+{
+    return (lhs.Str() != rhs);
+}
+
+inline bool operator == (const char* lhs, const Ident& rhs)
+{
+    return (lhs == rhs.Str());
+}
+
+inline bool operator != (const char* lhs, const Ident& rhs)
+{
+    return (lhs != rhs.Str());
+}
+
+inline std::string operator + (const Ident& lhs, const Ident& rhs)
+{
+    return (lhs.Str() + rhs.Str());
+}
+
+inline std::string operator + (const Ident& lhs, const std::string& rhs)
+{
+    return (lhs.Str() + rhs);
+}
+
+inline std::string operator + (const std::string& lhs, const Ident& rhs)
+{
+    return (lhs + rhs.Str());
+}
+
+inline std::string operator + (const Ident& lhs, const char* rhs)
+{
+    return (lhs.Str() + rhs);
+}
+
+inline std::string operator + (const char* lhs, const Ident& rhs)
+{
+    return (lhs + rhs.Str());
+}
+
+inline std::string operator + (const Ident& lhs, char rhs)
+{
+    return (lhs.Str() + rhs);
+}
+
+inline std::string operator + (char lhs, const Ident& rhs)
+{
+    return (lhs + rhs.Str());
+}
+
+
+} // /namespace HTLib
+
+
+namespace std
+{
+
+template <> struct hash<HTLib::Ident>
+{
+    inline std::size_t operator () (const HTLib::Ident& ident) const
+    {
+        return std::hash<const void*>()(ident.Handle());
+    }
+};
+
+} // /namespace std
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,616 @@
+/*
+ * IncrementalTranslator.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "HT/IncrementalTranslator.h"
+#include "HT/TranslationCache.h"
+#include "HLSLParser.h"
+#include "HLSLTree.h"
+#include "SourceCode.h"
+#include "DeclSplitter.h"
+#include "DeclOutputCache.h"
+#include "CharScan.h"
+
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+static double ElapsedTime(const std::chrono::steady_clock::time_point& startTime)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+//! Moves the source positions of all nodes of the specified program by the specified number of rows.
+static void MoveSourcePositions(const Program& program, int rowOffset)
+{
+    ForEachNode(
+        program,
+        [rowOffset](AST* ast)
+        {
+            if (ast->pos.IsValid())
+                ast->pos = SourcePosition(static_cast<unsigned int>(static_cast<int>(ast->pos.Row()) + rowOffset), ast->pos.Column());
+
+            /* Move the source position of a function body, which has not been parsed yet */
+            if (ast->Type() == AST::Types::FunctionDecl)
+            {
+                auto functionDecl = static_cast<FunctionDecl*>(ast);
+                if (functionDecl->lazyBody)
+                    functionDecl->lazyBody->row = static_cast<unsigned int>(static_cast<int>(functionDecl->lazyBody->row) + rowOffset);
+            }
+        }
+    );
+}
+
+/**
+Returns all identifiers of the specified source (also inside comments); each identifier only once.
+This is a superset of all names, which the source refers to.
+*/
+static std::vector<Ident> CollectIdents(const char* source, std::size_t size)
+{
+    std::vector<Ident> idents;
+
+    const auto end = source + size;
+    for (auto s = source; s != end;)
+    {
+        if (CharClass::IsIdentBegin(*s))
+        {
+            auto identEnd = SkipIdentChars(s + 1, end);
+            idents.push_back(Ident(s, static_cast<std::size_t>(identEnd - s)));
+            s = identEnd;
+        }
+        else if (CharClass::IsDigit(*s))
+        {
+            /* Skip number literals with their suffixes (e.g. "1.0f" or "0x1F") */
+            s = SkipIdentChars(s + 1, end);
+        }
+        else
+            ++s;
+    }
+
+    auto handleOrder = [](const Ident& lhs, const Ident& rhs)
+    {
+        return std::less<const void*>()(lhs.Handle(), rhs.Handle());
+    };
+
+    std::sort(idents.begin(), idents.end(), handleOrder);
+    idents.erase(std::unique(idents.begin(), idents.end()), idents.end());
+
+    return idents;
+}
+
+//! Returns the names of the functions, structures, uniform buffers (and their members), textures and samplers of the specified program.
+static std::vector<Ident> CollectDeclaredNames(const Program& program)
+{
+    std::vector<Ident> names;
+
+    for (auto globDecl : program.globalDecls)
+    {
+        switch (globDecl->Type())
+        {
+            case AST::Types::FunctionDecl:
+                names.push_back(static_cast<const FunctionDecl*>(globDecl)->name);
+                break;
+
+            case AST::Types::UniformBufferDecl:
+            {
+                auto bufferDecl = static_cast<const UniformBufferDecl*>(globDecl);
+                names.push_back(bufferDecl->name);
+                for (const auto& member : bufferDecl->members)
+                {
+                    for (const auto& varDecl : member->varDecls)
+                        names.push_back(varDecl->name);
+                }
+            }
+            break;
+
+            case AST::Types::TextureDecl:
+                for (const auto& name : static_cast<const TextureDecl*>(globDecl)->names)
+                    names.push_back(name->ident);
+                break;
+
+            case AST::Types::SamplerDecl:
+                for (const auto& name : static_cast<const SamplerDecl*>(globDecl)->names)
+                    names.push_back(name->ident);
+                break;
+
+            case AST::Types::StructDecl:
+                names.push_back(static_cast<const StructDecl*>(globDecl)->structure->name);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return names;
+}
+
+//! Appends the specified value to the specified FNV-1a hash.
+static void AppendHash(std::uint64_t& hash, std::uint64_t value)
+{
+    hash = (hash ^ value) * 0x100000001b3ull;
+}
+
+/**
+Returns a hash of those decorations of the nodes of the specified program, which may also be changed by the context analysis
+of other declarations, e.g. the reference flags (functions which are not reachable from the entry point are not generated)
+or the shader input and output flags of the structures.
+*/
+static std::uint64_t DecorationHash(const Program& program)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+
+    ForEachNode(
+        program,
+        [&hash](AST* ast)
+        {
+            AppendHash(hash, static_cast<unsigned int>(ast->flags));
+
+            if (ast->Type() == AST::Types::Structure)
+            {
+                auto structure = static_cast<const Structure*>(ast);
+                AppendHash(hash, std::hash<std::string>()(structure->aliasName));
+                AppendHash(hash, structure->systemValuesRef.size());
+            }
+            else if (ast->Type() == AST::Types::VarIdent)
+                AppendHash(hash, std::hash<std::string>()(static_cast<const VarIdent*>(ast)->systemSemantic));
+        }
+    );
+
+    return hash;
+}
+
+
+/*
+ * IncrementalTranslator class
+ */
+
+//! Output of the global declarations of a parsed declaration, and everything it depends on.
+struct DeclOutput
+{
+    std::unordered_map<const GlobalDecl*, std::string>  chunks;             // Output of each generated global declaration
+    std::size_t                                         contextId       = 0;
+    std::uint64_t                                       dependencyHash  = 0;
+    std::uint64_t                                       decorationHash  = 0;
+    unsigned int                                        row             = 1;
+};
+
+//! Program of a single parsed declaration.
+struct ParsedDecl
+{
+    ProgramPtr                  program;
+    unsigned int                row             = 1;
+    std::size_t                 id              = 0;    // Unique number of this parsed declaration.
+    std::vector<Ident>          usedNames;              // All identifiers of the source of this declaration (see "CollectIdents").
+    std::vector<Ident>          declaredNames;          // Names which are declared by this declaration (see "CollectDeclaredNames").
+    std::unique_ptr<DeclOutput> output;                 // Output of the last successful translation; may be null.
+};
+
+using ParsedDeclPtr = std::shared_ptr<ParsedDecl>;
+
+/**
+Output cache of a single incremental translation.
+emarks The output of a declaration is re-used, if its own decorations and the declarations of all names which the declaration uses
+(i.e. their source and their order relative to this declaration) are the same as for the previous output,
+and if the same holds for all declarations it depends on (transitively). So an edited declaration invalidates the output of itself
+and of all declarations which refer to it directly or indirectly, e.g. the callers of an edited function, but not of any other declaration.
+*/
+class IncrementalOutputCache : public DeclOutputCache
+{
+
+    public:
+
+        IncrementalOutputCache(const std::vector<ParsedDeclPtr>& decls, std::size_t contextId, bool lineMarks) :
+            decls_      { decls     },
+            contextId_  { contextId },
+            lineMarks_  { lineMarks }
+        {
+            for (std::size_t i = 0; i < decls_.size(); ++i)
+            {
+                for (auto globDecl : decls_[i]->program->globalDecls)
+                    declIndices_[globDecl] = i;
+            }
+        }
+
+        const std::string* CachedOutput(const GlobalDecl* ast) override
+        {
+            /* The decorations are only complete after the context analysis, i.e. right before the first declaration is generated */
+            if (valid_.empty())
+                Validate();
+
+            auto index = declIndices_.at(ast);
+            if (valid_[index])
+            {
+                auto it = decls_[index]->output->chunks.find(ast);
+                if (it != decls_[index]->output->chunks.end())
+                {
+                    ++numReusedOutputs_;
+                    return &(it->second);
+                }
+            }
+
+            return nullptr;
+        }
+
+        void StoreOutput(const GlobalDecl* ast, std::string&& output) override
+        {
+            if (valid_.empty())
+                Validate();
+
+            auto index = declIndices_.at(ast);
+            auto& newOutput = newOutputs_[index];
+
+            if (!newOutput)
+            {
+                newOutput = std::unique_ptr<DeclOutput>(new DeclOutput());
+                newOutput->contextId        = contextId_;
+                newOutput->dependencyHash   = dependencyHashes_[index];
+                newOutput->decorationHash   = decorationHashes_[index];
+                newOutput->row              = decls_[index]->row;
+            }
+
+            newOutput->chunks[ast] = std::move(output);
+            ++numGeneratedOutputs_;
+        }
+
+        //! Replaces the outputs of all generated declarations (after a successful translation).
+        void Commit()
+        {
+            for (std::size_t i = 0; i < newOutputs_.size(); ++i)
+            {
+                if (!newOutputs_[i])
+                    continue;
+
+                /* Keep the re-used chunks of a valid output (e.g. if only its previous entry point has been generated) */
+                if (valid_[i])
+                {
+                    for (auto& chunk : newOutputs_[i]->chunks)
+                        decls_[i]->output->chunks[chunk.first] = std::move(chunk.second);
+                }
+                else
+                    decls_[i]->output = std::move(newOutputs_[i]);
+            }
+        }
+
+        inline std::size_t NumReusedOutputs() const
+        {
+            return numReusedOutputs_;
+        }
+
+        inline std::size_t NumGeneratedOutputs() const
+        {
+            return numGeneratedOutputs_;
+        }
+
+    private:
+
+        //! Determines which declarations can re-use their output.
+        void Validate()
+        {
+            const auto numDecls = decls_.size();
+
+            valid_.resize(numDecls);
+            dependencyHashes_.resize(numDecls);
+            decorationHashes_.resize(numDecls);
+            newOutputs_.resize(numDecls);
+
+            /* Find the declarations of each name */
+            std::unordered_map<Ident, std::vector<std::size_t>> declsByName;
+
+            for (std::size_t i = 0; i < numDecls; ++i)
+            {
+                for (const auto& name : decls_[i]->declaredNames)
+                {
+                    auto& indices = declsByName[name];
+                    if (indices.empty() || indices.back() != i)
+                        indices.push_back(i);
+                }
+            }
+
+            /* Compare the dependencies and decorations of each declaration with those of its previous output */
+            std::vector<std::vector<std::size_t>> dependents(numDecls);
+
+            for (std::size_t i = 0; i < numDecls; ++i)
+            {
+                const auto& decl = *decls_[i];
+
+                std::uint64_t dependencyHash = 0xcbf29ce484222325ull;
+
+                for (const auto& name : decl.usedNames)
+                {
+                    auto it = declsByName.find(name);
+                    if (it != declsByName.end())
+                    {
+                        for (auto j : it->second)
+                        {
+                            AppendHash(dependencyHash, decls_[j]->id);
+                            AppendHash(dependencyHash, (j < i ? 1 : 0));
+                            if (j != i)
+                                dependents[j].push_back(i);
+                        }
+                    }
+                }
+
+                dependencyHashes_[i] = dependencyHash;
+                decorationHashes_[i] = DecorationHash(*decl.program);
+
+                /* Line marks contain the rows of the declaration */
+                valid_[i] =
+                (
+                    decl.output                                         &&
+                    decl.output->contextId      == contextId_           &&
+                    decl.output->dependencyHash == dependencyHash       &&
+                    decl.output->decorationHash == decorationHashes_[i] &&
+                    (!lineMarks_ || decl.output->row == decl.row)
+                );
+            }
+
+            /* Invalidate the outputs of all declarations, which depend on an invalid declaration */
+            std::vector<std::size_t> invalidDecls;
+
+            for (std::size_t i = 0; i < numDecls; ++i)
+            {
+                if (!valid_[i])
+                    invalidDecls.push_back(i);
+            }
+
+            while (!invalidDecls.empty())
+            {
+                auto j = invalidDecls.back();
+                invalidDecls.pop_back();
+
+                for (auto i : dependents[j])
+                {
+                    if (valid_[i])
+                    {
+                        valid_[i] = false;
+                        invalidDecls.push_back(i);
+                    }
+                }
+            }
+        }
+
+        const std::vector<ParsedDeclPtr>&                   decls_;
+        std::size_t                                         contextId_              = 0;
+        bool                                                lineMarks_              = false;
+
+        std::unordered_map<const GlobalDecl*, std::size_t>  declIndices_;           // <global-decl, index of its parsed declaration>
+        std::vector<bool>                                   valid_;
+        std::vector<std::uint64_t>                          dependencyHashes_;
+        std::vector<std::uint64_t>                          decorationHashes_;
+        std::vector<std::unique_ptr<DeclOutput>>            newOutputs_;
+
+        std::size_t                                         numReusedOutputs_       = 0;
+        std::size_t                                         numGeneratedOutputs_    = 0;
+
+};
+
+struct IncrementalTranslator::State
+{
+    /*
+    Parsed declarations by their key (the start column and the source text of the declaration).
+    Several declarations may have the same text, but each of them must have its own nodes.
+    */
+    std::unordered_map<std::string, std::vector<ParsedDeclPtr>> decls;
+
+    std::size_t nextDeclId = 1;
+
+    //! Key of the translation parameters (entry point, shader target and versions, and options) of the outputs.
+    std::string contextKey;
+    std::size_t contextId = 0;
+
+    std::size_t numReusedDecls      = 0;
+    std::size_t numParsedDecls      = 0;
+    std::size_t numReusedOutputs    = 0;
+    std::size_t numGeneratedOutputs = 0;
+};
+
+IncrementalTranslator::IncrementalTranslator() :
+    state_ { new State() }
+{
+}
+
+IncrementalTranslator::~IncrementalTranslator()
+{
+}
+
+bool IncrementalTranslator::Translate(
+    const Translator&                       translator,
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    std::string&                            output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats)
+{
+    state_->numReusedDecls      = 0;
+    state_->numParsedDecls      = 0;
+    state_->numReusedOutputs    = 0;
+    state_->numGeneratedOutputs = 0;
+
+    /* Macros and conditionals can affect all declarations after them, so the entire source must be translated */
+    if (options.preprocess)
+    {
+        Clear();
+        return translator.Translate(
+            inputSource, inputSourceSize, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion,
+            includeHandler, options, log, stats
+        );
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    /* Split source into its top-level declarations */
+    std::vector<DeclSpan> spans;
+    SplitGlobalDecls(inputSource, inputSourceSize, spans);
+
+    /* Find previous declarations with the same text, or parse the new declarations */
+    std::vector<std::string> keys(spans.size());
+    std::vector<ParsedDeclPtr> decls(spans.size());
+    std::unordered_map<std::string, std::size_t> numUsedDecls;
+
+    std::size_t numReusedDecls = 0, numTokens = 0;
+    double scanTime = 0.0;
+
+    for (std::size_t i = 0; i < spans.size(); ++i)
+    {
+        const auto& span = spans[i];
+        auto& key = keys[i];
+        auto& decl = decls[i];
+
+        key = std::to_string(span.column) + ':';
+        key.append(inputSource + span.begin, span.end - span.begin);
+
+        auto it = state_->decls.find(key);
+        if (it != state_->decls.end())
+        {
+            auto& index = numUsedDecls[key];
+            if (index < it->second.size())
+            {
+                decl = it->second[index++];
+                ++numReusedDecls;
+                continue;
+            }
+        }
+
+        /* Parse the declaration at its original source position (for exact source positions in the nodes and log messages) */
+        HLSLParser parser(log);
+        parser.MeasureScanTime(stats != nullptr);
+        parser.EnableLazyFunctionBodies(options.lazyFunctionBodies);
+
+        decl = std::make_shared<ParsedDecl>();
+        decl->program = parser.ParseSource(
+            std::make_shared<SourceCode>(
+                inputSource + span.begin, span.end - span.begin, inputSource + span.lineBegin, span.row
+            )
+        );
+        decl->row = span.row;
+
+        if (!decl->program)
+        {
+            if (log)
+                log->Error("parsing input code failed");
+            return false;
+        }
+
+        decl->id            = state_->nextDeclId++;
+        decl->usedNames     = CollectIdents(inputSource + span.begin, span.end - span.begin);
+        decl->declaredNames = CollectDeclaredNames(*decl->program);
+
+        scanTime += parser.ScanTime();
+        numTokens += parser.NumTokens();
+    }
+
+    /* Link all declarations into a new program, and keep them for the next translation */
+    auto program = std::make_shared<Program>(SourcePosition::ignore);
+    std::unordered_map<std::string, std::vector<ParsedDeclPtr>> nextDecls;
+
+    for (std::size_t i = 0; i < decls.size(); ++i)
+    {
+        auto& decl = *decls[i];
+
+        if (decl.row != spans[i].row)
+        {
+            MoveSourcePositions(*decl.program, static_cast<int>(spans[i].row) - static_cast<int>(decl.row));
+            decl.row = spans[i].row;
+        }
+
+        program->globalDecls.insert(
+            program->globalDecls.end(), decl.program->globalDecls.begin(), decl.program->globalDecls.end()
+        );
+        program->linkedPrograms.push_back(decl.program);
+
+        nextDecls[keys[i]].push_back(decls[i]);
+    }
+
+    state_->decls           = std::move(nextDecls);
+    state_->numReusedDecls  = numReusedDecls;
+    state_->numParsedDecls  = decls.size() - numReusedDecls;
+
+    if (stats)
+    {
+        stats->scanTime         = scanTime;
+        stats->preprocessTime   = 0.0;
+        stats->parseTime        = ElapsedTime(startTime) - scanTime;
+        stats->numTokens        = numTokens;
+    }
+
+    /* The outputs of the previous translations can only be re-used with the same translation parameters */
+    auto contextKey = TranslationCache(std::string()).Key(
+        "", 0, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, nullptr, options
+    );
+
+    if (state_->contextKey != contextKey)
+    {
+        state_->contextKey = std::move(contextKey);
+        ++state_->contextId;
+    }
+
+    /* Analyze the entire program, and only generate the declarations whose output can not be re-used */
+    IncrementalOutputCache outputCache(decls, state_->contextId, options.lineMarks);
+
+    auto result = translator.GenerateCached(
+        *program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, &outputCache
+    );
+
+    if (result)
+        outputCache.Commit();
+
+    state_->numReusedOutputs    = outputCache.NumReusedOutputs();
+    state_->numGeneratedOutputs = outputCache.NumGeneratedOutputs();
+
+    return result;
+}
+
+void IncrementalTranslator::Clear()
+{
+    state_->decls.clear();
+    state_->contextKey.clear();
+}
+
+std::size_t IncrementalTranslator::NumReusedDecls() const
+{
+    return state_->numReusedDecls;
+}
+
+std::size_t IncrementalTranslator::NumParsedDecls() const
+{
+    return state_->numParsedDecls;
+}
+
+std::size_t IncrementalTranslator::NumReusedOutputs() const
+{
+    return state_->numReusedOutputs;
+}
+
+std::size_t IncrementalTranslator::NumGeneratedOutputs() const
+{
+    return state_->numGeneratedOutputs;
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -25,6 +25,18 @@ void ReferenceAnalyzer::MarkReferencesFromEntryPoint(FunctionDecl* ast, Program*
     Visit(ast);
 }
 
+void ReferenceAnalyzer::RecordReferences(FunctionDecl* ast)
+{
+    auto& idents = recordedIdents_[ast];
+    idents.clear();
+
+    recordingIdents_ = &idents;
+    {
+        Visit(ast->codeBlock);
+    }
+    recordingIdents_ = nullptr;
+}
+
 
 /*
  * ======= Private: =======
@@ -44,44 +56,19 @@ IMPLEMENT_VISIT_PROC(Program)
 IMPLEMENT_VISIT_PROC(CodeBlock)
 {
     for (auto& stmnt : ast->stmnts)
-        Visit(stmnt);
+    {
+        if (!stmnt->flags(Stmnt::isDeadCode))
+            Visit(stmnt);
+    }
 }
 
 IMPLEMENT_VISIT_PROC(FunctionCall)
 {
     /* Mark this function to be referenced */
-    const auto& name = ast->name->ident;
-    auto symbol = symTable_->Fetch(name);
-
-    if (symbol)
-    {
-        if (symbol->Type() == AST::Types::FunctionDecl)
-        {
-            auto functionDecl = dynamic_cast<FunctionDecl*>(symbol);
-            if (functionDecl)
-            {
-                /* Mark all forward declarations to this function */
-                for (auto& forwardDecl : functionDecl->forwardDeclsRef)
-                    forwardDecl->flags << FunctionDecl::isReferenced;
-            }
-
-            /* Mark this function and visit the entire function body */
-            symbol->flags << FunctionDecl::isReferenced;
-            Visit(symbol);
-        }
-        else if (symbol->Type() == AST::Types::TextureDecl)
-            MarkTextureReference(symbol, name);
-    }
+    if (recordingIdents_)
+        recordingIdents_->insert({ IdentKinds::FunctionCall, ast->name->ident });
     else
-    {
-        /* Check for intrinsic usage */
-        if (name == "rcp")
-            program_->flags << Program::rcpIntrinsicUsed;
-        else if (name == "sincos")
-            program_->flags << Program::sinCosIntrinsicUsed;
-        else if (name == "clip")
-            program_->flags << Program::clipIntrinsicUsed;
-    }
+        Visit(MarkFunctionCall(ast->name->ident));
 
     /* Visit arguments */
     for (auto& arg : ast->arguments)
@@ -107,7 +94,10 @@ IMPLEMENT_VISIT_PROC(SwitchCase)
 {
     Visit(ast->expr);
     for (auto& stmnt : ast->stmnts)
-        Visit(stmnt);
+    {
+        if (!stmnt->flags(Stmnt::isDeadCode))
+            Visit(stmnt);
+    }
 }
 
 /* --- Global declarations --- */
@@ -123,7 +113,10 @@ IMPLEMENT_VISIT_PROC(FunctionDecl)
     Visit(ast->returnType);
     for (auto& param : ast->parameters)
         Visit(param);
-    Visit(ast->codeBlock);
+
+    /* Mark the recorded identifiers instead of the body, if the body has already been released */
+    if (!MarkRecordedIdents(ast))
+        Visit(ast->codeBlock);
 }
 
 IMPLEMENT_VISIT_PROC(UniformBufferDecl)
@@ -174,9 +167,17 @@ IMPLEMENT_VISIT_PROC(DoWhileLoopStmnt)
 
 IMPLEMENT_VISIT_PROC(IfStmnt)
 {
-    Visit(ast->condition);
-    Visit(ast->bodyStmnt);
-    Visit(ast->elseStmnt);
+    /* Only visit the branch which will be generated, if the condition is constant */
+    if (ast->flags(IfStmnt::isConstTrue))
+        Visit(ast->bodyStmnt);
+    else if (ast->flags(IfStmnt::isConstFalse))
+        Visit(ast->elseStmnt);
+    else
+    {
+        Visit(ast->condition);
+        Visit(ast->bodyStmnt);
+        Visit(ast->elseStmnt);
+    }
 }
 
 IMPLEMENT_VISIT_PROC(ElseStmnt)
@@ -224,8 +225,15 @@ IMPLEMENT_VISIT_PROC(ListExpr)
 
 IMPLEMENT_VISIT_PROC(BinaryExpr)
 {
-    Visit(ast->lhsExpr);
-    Visit(ast->rhsExpr);
+    /* Visit the binary expression chain iteratively (see HLSLParser::ParseExpr) */
+    ExprPtr expr = ast;
+    while (expr && expr->Type() == AST::Types::BinaryExpr)
+    {
+        auto binExpr = static_cast<BinaryExpr*>(expr);
+        Visit(binExpr->lhsExpr);
+        expr = binExpr->rhsExpr;
+    }
+    Visit(expr);
 }
 
 IMPLEMENT_VISIT_PROC(UnaryExpr)
@@ -240,6 +248,10 @@ IMPLEMENT_VISIT_PROC(PostUnaryExpr)
 
 IMPLEMENT_VISIT_PROC(FunctionCallExpr)
 {
+    /* Skip folded constant expressions (they don't reference any function) */
+    if (ast->constValue.type != ConstValue::Types::None)
+        return;
+
     Visit(ast->call);
 }
 
@@ -255,19 +267,11 @@ IMPLEMENT_VISIT_PROC(CastExpr)
 
 IMPLEMENT_VISIT_PROC(VarAccessExpr)
 {
-    /* Mark texture reference */
-    auto symbol = symTable_->Fetch(ast->varIdent->ident);
-    if (symbol)
-    {
-        if (symbol->Type() == AST::Types::TextureDecl)
-            MarkTextureReference(symbol, ast->varIdent->ident);
-        else if (symbol->Type() == AST::Types::VarDecl)
-        {
-            auto varDecl = dynamic_cast<VarDecl*>(symbol);
-            if (varDecl && varDecl->uniformBufferRef)
-                Visit(varDecl->uniformBufferRef);
-        }
-    }
+    /* Mark texture and sampler reference */
+    if (recordingIdents_)
+        recordingIdents_->insert({ IdentKinds::VarAccess, ast->varIdent->ident });
+    else
+        Visit(MarkVarAccess(ast->varIdent->ident));
 
     Visit(ast->assignExpr);
 }
@@ -284,9 +288,10 @@ IMPLEMENT_VISIT_PROC(VarType)
 {
     if (!ast->baseType.empty())
     {
-        auto symbol = symTable_->Fetch(ast->baseType);
-        if (symbol)
-            Visit(symbol);
+        if (recordingIdents_)
+            recordingIdents_->insert({ IdentKinds::VarType, ast->baseType });
+        else
+            Visit(MarkVarType(ast->baseType));
     }
     else if (ast->structType)
         Visit(ast->structType);
@@ -310,7 +315,96 @@ IMPLEMENT_VISIT_PROC(VarDecl)
 
 /* --- Helper functions for analysis --- */
 
-void ReferenceAnalyzer::MarkTextureReference(AST* ast, const std::string& texIdent)
+bool ReferenceAnalyzer::MarkRecordedIdents(const FunctionDecl* ast)
+{
+    auto it = recordedIdents_.find(ast);
+    if (it == recordedIdents_.end())
+        return false;
+
+    for (const auto& ident : it->second)
+        MarkIdent(ident.first, ident.second);
+
+    return true;
+}
+
+void ReferenceAnalyzer::MarkIdent(const IdentKinds kind, const Ident& ident)
+{
+    switch (kind)
+    {
+        case IdentKinds::FunctionCall:
+            Visit(MarkFunctionCall(ident));
+            break;
+        case IdentKinds::VarAccess:
+            Visit(MarkVarAccess(ident));
+            break;
+        case IdentKinds::VarType:
+            Visit(MarkVarType(ident));
+            break;
+    }
+}
+
+AST* ReferenceAnalyzer::MarkFunctionCall(const Ident& ident)
+{
+    auto symbol = symTable_->Fetch(ident);
+
+    if (symbol)
+    {
+        if (symbol->Type() == AST::Types::FunctionDecl)
+        {
+            auto functionDecl = dynamic_cast<FunctionDecl*>(symbol);
+            if (functionDecl)
+            {
+                /* Mark all forward declarations to this function */
+                for (auto& forwardDecl : functionDecl->forwardDeclsRef)
+                    forwardDecl->flags << FunctionDecl::isReferenced;
+            }
+
+            /* Mark this function and visit the entire function body */
+            symbol->flags << FunctionDecl::isReferenced;
+            return symbol;
+        }
+        else if (symbol->Type() == AST::Types::TextureDecl)
+            MarkTextureReference(symbol, ident);
+    }
+    else
+    {
+        /* Check for intrinsic usage */
+        if (ident == "rcp")
+            program_->flags << Program::rcpIntrinsicUsed;
+        else if (ident == "sincos")
+            program_->flags << Program::sinCosIntrinsicUsed;
+        else if (ident == "clip")
+            program_->flags << Program::clipIntrinsicUsed;
+    }
+
+    return nullptr;
+}
+
+AST* ReferenceAnalyzer::MarkVarAccess(const Ident& ident)
+{
+    auto symbol = symTable_->Fetch(ident);
+    if (symbol)
+    {
+        if (symbol->Type() == AST::Types::TextureDecl)
+            MarkTextureReference(symbol, ident);
+        else if (symbol->Type() == AST::Types::SamplerDecl)
+            MarkSamplerReference(symbol, ident);
+        else if (symbol->Type() == AST::Types::VarDecl)
+        {
+            auto varDecl = dynamic_cast<VarDecl*>(symbol);
+            if (varDecl)
+                return varDecl->uniformBufferRef;
+        }
+    }
+    return nullptr;
+}
+
+AST* ReferenceAnalyzer::MarkVarType(const Ident& ident)
+{
+    return symTable_->Fetch(ident);
+}
+
+void ReferenceAnalyzer::MarkTextureReference(AST* ast, const Ident& texIdent)
 {
     ast->flags << TextureDecl::isReferenced;
 
@@ -329,6 +423,25 @@ void ReferenceAnalyzer::MarkTextureReference(AST* ast, const std::string& texIde
     }
 }
 
+void ReferenceAnalyzer::MarkSamplerReference(AST* ast, const Ident& samplerIdent)
+{
+    ast->flags << SamplerDecl::isReferenced;
+
+    auto samplerDecl = dynamic_cast<SamplerDecl*>(ast);
+    if (samplerDecl)
+    {
+        /* Mark individual sampler identifier to be used */
+        for (auto& sampler : samplerDecl->names)
+        {
+            if (sampler->ident == samplerIdent)
+            {
+                sampler->flags << BufferDeclIdent::isReferenced;
+                break;
+            }
+        }
+    }
+}
+
 
 } // /namespace HTLib
 
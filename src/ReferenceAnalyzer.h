@@ -11,7 +11,11 @@
 
 #include "Visitor.h"
 #include "Token.h"
-#include "SymbolTable.h"
+#include "FlatSymbolTable.h"
+
+#include <set>
+#include <string>
+#include <unordered_map>
 
 
 namespace HTLib
@@ -19,7 +23,7 @@ namespace HTLib
 
 
 //! AST symbol table type.
-typedef SymbolTable<AST> ASTSymbolTable;
+typedef FlatSymbolTable<AST> ASTSymbolTable;
 
 /**
 Object reference analyzer.
@@ -36,9 +40,26 @@ class ReferenceAnalyzer : private Visitor
 
         void MarkReferencesFromEntryPoint(FunctionDecl* ast, Program* program);
 
+        /**
+        Records the identifiers of the body of the specified function, which are only looked up when the references are marked.
+        \remarks This is used for the streamed translation (see "Options::streamOutput"), where each function body
+        is released before the references are marked. The local structures of the body are marked right away.
+        */
+        void RecordReferences(FunctionDecl* ast);
+
     private:
         
-        typedef SymbolTable<AST>::OnOverrideProc OnOverrideProc;
+        typedef ASTSymbolTable::OnOverrideProc OnOverrideProc;
+
+        //! Kinds of identifiers, which are recorded in a function body (see "RecordReferences").
+        enum class IdentKinds
+        {
+            FunctionCall,   //!< Name of a called function.
+            VarAccess,      //!< Identifier of an accessed variable.
+            VarType,        //!< Base type name of a variable type.
+        };
+
+        typedef std::set<std::pair<IdentKinds, Ident>> IdentSet;
 
         /* === Visitor implementation === */
 
@@ -80,13 +101,31 @@ class ReferenceAnalyzer : private Visitor
 
         /* --- Helper functions for analysis --- */
 
-        void MarkTextureReference(AST* ast, const std::string& texIdent);
+        //! Marks the recorded identifiers of the specified function (see "RecordReferences"). Returns false if there are none.
+        bool MarkRecordedIdents(const FunctionDecl* ast);
+
+        //! Marks the symbol of the specified (recorded) identifier as referenced.
+        void MarkIdent(const IdentKinds kind, const Ident& ident);
+
+        /**
+        Marks the symbol of the specified identifier as referenced and returns the declaration which must be visited next (or null).
+        \remarks The declaration is visited by the caller, to keep the stack depth low for deep call graphs.
+        */
+        AST* MarkFunctionCall(const Ident& ident);
+        AST* MarkVarAccess(const Ident& ident);
+        AST* MarkVarType(const Ident& ident);
+
+        void MarkTextureReference(AST* ast, const Ident& texIdent);
+        void MarkSamplerReference(AST* ast, const Ident& samplerIdent);
 
         /* === Members === */
 
         Program*                program_    = nullptr;
         const ASTSymbolTable*   symTable_   = nullptr;
 
+        std::unordered_map<const FunctionDecl*, IdentSet>   recordedIdents_;            //!< Recorded identifiers of each function body (see "RecordReferences").
+        IdentSet*                                           recordingIdents_ = nullptr; //!< Identifiers of the function body which is currently recorded (or null).
+
 };
 
 
@@ -0,0 +1,448 @@
+/*
+ * Reflection.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "HT/Reflection.h"
+
+#include <unordered_map>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdio>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! Magic number at the beginning of each serialized reflection.
+static const char formatMagic[8] = { 'H', 'T', 'R', 'E', 'F', 'L', '\0', '\0' };
+
+//! Version of the binary format. This must be increased whenever the reflection structures change.
+static const std::uint32_t formatVersion = 2;
+
+//! Maps signed integers to unsigned integers (see ASTSerializer.cpp), so that a missing binding (-1) takes only one byte.
+static std::uint32_t ZigZagEncode(std::int32_t value)
+{
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+static std::int32_t ZigZagDecode(std::uint32_t value)
+{
+    return static_cast<std::int32_t>(value >> 1) ^ -static_cast<std::int32_t>(value & 1);
+}
+
+/* --- Field transfer functions (used for reading and writing) --- */
+
+template <typename A> void TransferFields(A& ar, ReflectionUniform& obj)
+{
+    ar.String(obj.name);
+    ar.String(obj.type);
+    ar.UInt(obj.arraySize);
+    ar.UInt(obj.offset);
+    ar.UInt(obj.size);
+    ar.String(obj.packOffset);
+}
+
+template <typename A> void TransferFields(A& ar, ReflectionUniformBuffer& obj)
+{
+    ar.String(obj.name);
+    ar.Int(obj.binding);
+    ar.UInt(obj.size);
+    ar.Bool(obj.pushConstant);
+    ar.List(obj.members);
+}
+
+template <typename A> void TransferFields(A& ar, ReflectionResource& obj)
+{
+    ar.String(obj.name);
+    ar.String(obj.type);
+    ar.Int(obj.binding);
+}
+
+template <typename A> void TransferFields(A& ar, ReflectionAttribute& obj)
+{
+    ar.String(obj.name);
+    ar.String(obj.type);
+    ar.String(obj.semantic);
+    ar.Int(obj.location);
+}
+
+template <typename A> void TransferFields(A& ar, ShaderReflection& obj)
+{
+    ar.List(obj.uniformBuffers);
+    ar.List(obj.textures);
+    ar.List(obj.samplers);
+    ar.List(obj.inputs);
+    ar.List(obj.outputs);
+    for (auto& n : obj.numThreads)
+        ar.UInt(n);
+}
+
+/* --- JSON output --- */
+
+static void WriteJSONString(std::string& output, const std::string& str)
+{
+    output += '\"';
+
+    for (auto chr : str)
+    {
+        switch (chr)
+        {
+            case '\"':
+                output += "\\\"";
+                break;
+            case '\\':
+                output += "\\\\";
+                break;
+            case '\n':
+                output += "\\n";
+                break;
+            case '\t':
+                output += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(chr) < 0x20)
+                {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(chr)));
+                    output += buf;
+                }
+                else
+                    output += chr;
+                break;
+        }
+    }
+
+    output += '\"';
+}
+
+static void WriteJSONResource(std::string& output, const ReflectionResource& obj)
+{
+    output += "{ \"name\": ";
+    WriteJSONString(output, obj.name);
+    output += ", \"type\": ";
+    WriteJSONString(output, obj.type);
+    output += ", \"binding\": " + std::to_string(obj.binding) + " }";
+}
+
+static void WriteJSONAttribute(std::string& output, const ReflectionAttribute& obj)
+{
+    output += "{ \"name\": ";
+    WriteJSONString(output, obj.name);
+    output += ", \"type\": ";
+    WriteJSONString(output, obj.type);
+    output += ", \"semantic\": ";
+    WriteJSONString(output, obj.semantic);
+    output += ", \"location\": " + std::to_string(obj.location) + " }";
+}
+
+static void WriteJSONUniform(std::string& output, const ReflectionUniform& obj)
+{
+    output += "{ \"name\": ";
+    WriteJSONString(output, obj.name);
+    output += ", \"type\": ";
+    WriteJSONString(output, obj.type);
+    output += ", \"arraySize\": " + std::to_string(obj.arraySize);
+    output += ", \"offset\": " + std::to_string(obj.offset);
+    output += ", \"size\": " + std::to_string(obj.size);
+    output += ", \"packOffset\": ";
+    WriteJSONString(output, obj.packOffset);
+    output += " }";
+}
+
+static void WriteJSONUniformBuffer(std::string& output, const ReflectionUniformBuffer& obj)
+{
+    output += "{\n      \"name\": ";
+    WriteJSONString(output, obj.name);
+    output += ",\n      \"binding\": " + std::to_string(obj.binding);
+    output += ",\n      \"size\": " + std::to_string(obj.size);
+    output += ",\n      \"pushConstant\": ";
+    output += (obj.pushConstant ? "true" : "false");
+    output += ",\n      \"members\": [";
+
+    for (std::size_t i = 0; i < obj.members.size(); ++i)
+    {
+        output += (i > 0 ? ",\n        " : "\n        ");
+        WriteJSONUniform(output, obj.members[i]);
+    }
+
+    output += (obj.members.empty() ? "]\n    }" : "\n      ]\n    }");
+}
+
+//! Writes a JSON array with one object per line, by using the specified function for each element.
+template <typename T, typename Func> void WriteJSONArray(std::string& output, const char* name, const std::vector<T>& objs, Func func)
+{
+    output += "  \"";
+    output += name;
+    output += "\": [";
+
+    for (std::size_t i = 0; i < objs.size(); ++i)
+    {
+        output += (i > 0 ? ",\n    " : "\n    ");
+        func(output, objs[i]);
+    }
+
+    output += (objs.empty() ? "],\n" : "\n  ],\n");
+}
+
+
+/*
+ * Internal classes
+ */
+
+//! Binary writer for the "TransferFields" functions.
+class ReflectionWriter
+{
+
+    public:
+
+        void WriteReflection(const ShaderReflection& reflection, std::string& output)
+        {
+            /* Write fields into a temporary buffer first (to collect all strings for the string table) */
+            std::string fields;
+            output_ = &fields;
+
+            /* The writer does not modify any fields, they are only passed as non-const references to share the transfer functions with the reader */
+            TransferFields(*this, const_cast<ShaderReflection&>(reflection));
+
+            /* Write header, string table and fields */
+            output_ = &output;
+            output.append(formatMagic, sizeof(formatMagic));
+            WriteUInt(formatVersion);
+
+            WriteUInt(static_cast<std::uint32_t>(strings_.size()));
+            for (auto str : strings_)
+            {
+                WriteUInt(static_cast<std::uint32_t>(str->size()));
+                output.append(*str);
+            }
+
+            output.append(fields);
+            output_ = nullptr;
+        }
+
+        void UInt(unsigned int value)
+        {
+            WriteUInt(value);
+        }
+
+        void Int(int value)
+        {
+            WriteUInt(ZigZagEncode(value));
+        }
+
+        void Bool(bool value)
+        {
+            WriteUInt(value ? 1 : 0);
+        }
+
+        void String(const std::string& str)
+        {
+            auto it = stringIndices_.find(str);
+            if (it == stringIndices_.end())
+            {
+                auto index = static_cast<std::uint32_t>(strings_.size());
+                it = stringIndices_.insert({ str, index }).first;
+                strings_.push_back(&(it->first));
+            }
+            WriteUInt(it->second);
+        }
+
+        template <typename T> void List(std::vector<T>& objs)
+        {
+            WriteUInt(static_cast<std::uint32_t>(objs.size()));
+            for (auto& obj : objs)
+                TransferFields(*this, obj);
+        }
+
+    private:
+
+        void WriteUInt(std::uint32_t value)
+        {
+            /* Write variable-length integer (see ASTWriter::WriteUInt) */
+            while (value >= 0x80)
+            {
+                output_->push_back(static_cast<char>((value & 0x7f) | 0x80));
+                value >>= 7;
+            }
+            output_->push_back(static_cast<char>(value));
+        }
+
+        std::string*                                    output_ = nullptr;
+        std::unordered_map<std::string, std::uint32_t>  stringIndices_;
+        std::vector<const std::string*>                 strings_;
+
+};
+
+//! Binary reader for the "TransferFields" functions. Throws "std::runtime_error" if the data is invalid.
+class ReflectionReader
+{
+
+    public:
+
+        void ReadReflection(const char* data, std::size_t size, ShaderReflection& reflection)
+        {
+            data_ = data;
+            size_ = size;
+            pos_ = 0;
+
+            /* Read header */
+            if (size_ < sizeof(formatMagic) || std::string(data_, sizeof(formatMagic)) != std::string(formatMagic, sizeof(formatMagic)))
+                Error("invalid magic number");
+            pos_ = sizeof(formatMagic);
+
+            if (ReadUInt() != formatVersion)
+                Error("unsupported format version");
+
+            /* Read string table */
+            strings_.resize(ReadCount());
+            for (auto& str : strings_)
+            {
+                auto length = ReadUInt();
+                if (length > size_ - pos_)
+                    Error("string out of range");
+                str.assign(data_ + pos_, length);
+                pos_ += length;
+            }
+
+            /* Read fields */
+            TransferFields(*this, reflection);
+
+            if (pos_ != size_)
+                Error("unexpected data after the end of the reflection");
+        }
+
+        void UInt(unsigned int& value)
+        {
+            value = ReadUInt();
+        }
+
+        void Int(int& value)
+        {
+            value = ZigZagDecode(ReadUInt());
+        }
+
+        void Bool(bool& value)
+        {
+            auto n = ReadUInt();
+            if (n > 1)
+                Error("boolean out of range");
+            value = (n != 0);
+        }
+
+        void String(std::string& str)
+        {
+            auto index = ReadUInt();
+            if (index >= strings_.size())
+                Error("string index out of range");
+            str = strings_[index];
+        }
+
+        template <typename T> void List(std::vector<T>& objs)
+        {
+            objs.clear();
+            objs.resize(ReadCount());
+            for (auto& obj : objs)
+                TransferFields(*this, obj);
+        }
+
+    private:
+
+        void Error(const std::string& msg)
+        {
+            throw std::runtime_error("invalid serialized reflection (at byte " + std::to_string(pos_) + ") : " + msg);
+        }
+
+        std::uint32_t ReadUInt()
+        {
+            /* Read variable-length integer (see ReflectionWriter::WriteUInt) */
+            std::uint32_t value = 0;
+
+            for (int shift = 0; shift < 32; shift += 7)
+            {
+                if (pos_ >= size_)
+                    Error("unexpected end of data");
+
+                auto byte = static_cast<unsigned char>(data_[pos_++]);
+                value |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                    return value;
+            }
+
+            Error("integer out of range");
+            return 0;
+        }
+
+        std::uint32_t ReadCount()
+        {
+            /* Each element takes at least one byte, so larger counts can only come from a corrupted buffer */
+            auto count = ReadUInt();
+            if (count > size_ - pos_)
+                Error("element count out of range");
+            return count;
+        }
+
+        const char*                 data_   = nullptr;
+        std::size_t                 size_   = 0;
+        std::size_t                 pos_    = 0;
+
+        std::vector<std::string>    strings_;
+
+};
+
+
+/*
+ * Global functions
+ */
+
+void WriteReflectionJSON(const ShaderReflection& reflection, std::string& output)
+{
+    output += "{\n";
+
+    WriteJSONArray(output, "uniformBuffers", reflection.uniformBuffers, WriteJSONUniformBuffer);
+    WriteJSONArray(output, "textures", reflection.textures, WriteJSONResource);
+    WriteJSONArray(output, "samplers", reflection.samplers, WriteJSONResource);
+    WriteJSONArray(output, "inputs", reflection.inputs, WriteJSONAttribute);
+    WriteJSONArray(output, "outputs", reflection.outputs, WriteJSONAttribute);
+
+    output += "  \"numThreads\": [ ";
+    output += std::to_string(reflection.numThreads[0]) + ", ";
+    output += std::to_string(reflection.numThreads[1]) + ", ";
+    output += std::to_string(reflection.numThreads[2]) + " ]\n";
+
+    output += "}\n";
+}
+
+void WriteReflectionBinary(const ShaderReflection& reflection, std::string& output)
+{
+    ReflectionWriter writer;
+    writer.WriteReflection(reflection, output);
+}
+
+bool ReadReflectionBinary(const char* data, std::size_t size, ShaderReflection& reflection)
+{
+    try
+    {
+        ReflectionReader reader;
+        reader.ReadReflection(data, size, reflection);
+        return true;
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -7,44 +7,125 @@
 
 #include "SourceCode.h"
 
+#include <iterator>
+#include <cstring>
+
 
 namespace HTLib
 {
 
 
-SourceCode::SourceCode(const std::shared_ptr<std::istream>& stream) :
-    stream_{ stream }
+SourceCode::SourceCode(const std::shared_ptr<std::istream>& stream)
+{
+    if (stream != nullptr && stream->good())
+    {
+        /* Read entire stream into the buffer */
+        buffer_.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+        SetBuffer(buffer_.data(), buffer_.size());
+    }
+}
+
+SourceCode::SourceCode(const char* data, std::size_t size)
+{
+    if (data != nullptr)
+        SetBuffer(data, size);
+}
+
+SourceCode::SourceCode(const char* data, std::size_t size, const char* lineBegin, unsigned int row)
 {
+    if (data != nullptr)
+    {
+        SetBuffer(data, size);
+        lineBegin_  = lineBegin;
+        row_        = row;
+    }
 }
 
 bool SourceCode::IsValid() const
 {
-    return stream_ != nullptr && stream_->good();
+    return begin_ != nullptr;
+}
+
+SourcePosition SourceCode::Pos() const
+{
+    /* Nothing has been read yet */
+    if (cur_ == begin_)
+        return SourcePosition();
+
+    UpdatePos();
+
+    return SourcePosition(row_, static_cast<unsigned int>(cur_ - lineBegin_));
+}
+
+const char* SourceCode::LineBegin() const
+{
+    UpdatePos();
+    return lineBegin_;
 }
 
-char SourceCode::Next()
+std::string SourceCode::Line() const
 {
     if (!IsValid())
-        return 0;
+        return "";
+
+    UpdatePos();
 
-    /* Check if reader is at end-of-line */
-    while (pos_.Column() >= line_.size())
+    /* Find end of current line */
+    auto lineEnd = static_cast<const char*>(std::memchr(lineBegin_, '\n', static_cast<std::size_t>(end_ - lineBegin_)));
+    if (lineEnd == nullptr)
+        return std::string(lineBegin_, end_) + '\n';
+
+    return std::string(lineBegin_, lineEnd + 1);
+}
+
+
+/*
+ * ======= Protected: =======
+ */
+
+void SourceCode::SetBuffer(const char* data, std::size_t size)
+{
+    begin_      = data;
+    end_        = data + size;
+    cur_        = data;
+    posCur_     = data;
+    lineBegin_  = data;
+    row_        = 1;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+char SourceCode::NextAtEnd()
+{
+    /* Always terminate the last line with a new-line character */
+    if (!finalNewLine_ && begin_ != end_ && *(end_ - 1) != '\n')
     {
-        /* Read new line in source file */
-        std::getline(*stream_, line_);
-        line_ += '\n';
-        pos_.IncRow();
-
-        /* Check if end-of-file is reached */
-        if (stream_->eof())
-            return 0;
+        finalNewLine_ = true;
+        return '\n';
     }
+    return 0;
+}
 
-    /* Increment column and return current character */
-    auto chr = line_[pos_.Column()];
-    pos_.IncColumn();
+void SourceCode::UpdatePos() const
+{
+    /* Count new-line characters before the last character which has been read */
+    auto last = (cur_ > begin_ ? cur_ - 1 : cur_);
 
-    return chr;
+    while (posCur_ < last)
+    {
+        auto lineEnd = static_cast<const char*>(std::memchr(posCur_, '\n', static_cast<std::size_t>(last - posCur_)));
+        if (lineEnd == nullptr)
+        {
+            posCur_ = last;
+            break;
+        }
+        ++row_;
+        posCur_ = lineEnd + 1;
+        lineBegin_ = posCur_;
+    }
 }
 
 
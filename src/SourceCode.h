@@ -14,24 +14,51 @@
 #include <istream>
 #include <string>
 #include <memory>
+#include <cstddef>
 
 
 namespace HTLib
 {
 
 
+/**
+Source code reader which walks over a contiguous character buffer.
+\remarks The buffer is either owned by this object (when it's constructed from an input stream),
+or it's provided by the caller (e.g. an in-memory string or a memory mapped file),
+in which case it must remain valid as long as this source code object is used.
+The current position and line are only computed on demand (e.g. for tokens and diagnostics).
+*/
 class SourceCode
 {
     
     public:
         
+        //! Reads the entire input stream into an internal buffer.
         SourceCode(const std::shared_ptr<std::istream>& stream);
 
+        //! Uses the specified caller-owned buffer. This does not need to be null terminated.
+        SourceCode(const char* data, std::size_t size);
+
+        /**
+        Uses the specified range of a caller-owned buffer, which begins inside the specified row.
+        \param[in] lineBegin Specifies the beginning of that row inside the same buffer, i.e. "lineBegin <= data".
+        \remarks This is used to read a part of a larger source with the source positions of the entire source.
+        */
+        SourceCode(const char* data, std::size_t size, const char* lineBegin, unsigned int row);
+
+        SourceCode(const SourceCode&) = delete;
+        SourceCode& operator = (const SourceCode&) = delete;
+
         //! Returns true if this is a valid source code stream.
         bool IsValid() const;
 
-        //! Returns the next character from the source.
-        char Next();
+        //! Returns the next character from the source, or 0 if the end of the source has been reached.
+        inline char Next()
+        {
+            if (cur_ < end_)
+                return *(cur_++);
+            return NextAtEnd();
+        }
 
         //! Ignores the current character.
         inline void Ignore()
@@ -39,24 +66,75 @@ class SourceCode
             Next();
         }
 
-        //! Returns the current source position.
-        inline const SourcePosition& Pos() const
+        //! Returns a pointer to the beginning of the character buffer.
+        inline const char* Begin() const
+        {
+            return begin_;
+        }
+
+        //! Returns the size (in bytes) of the character buffer.
+        inline std::size_t Size() const
+        {
+            return static_cast<std::size_t>(end_ - begin_);
+        }
+
+        //! Returns a pointer to the next character inside the buffer, i.e. the character after the last character returned by "Next".
+        inline const char* Current() const
+        {
+            return cur_;
+        }
+
+        //! Returns a pointer to the end of the character buffer.
+        inline const char* End() const
         {
-            return pos_;
+            return end_;
         }
-        //! Returns the current source line.
-        inline const std::string& Line() const
+
+        /**
+        Skips all characters up to (but not including) the specified position, so the next call to "Next" returns the character at that position.
+        \param[in] pos Specifies the new position, which must be in the range ["Current()", "End()"].
+        \remarks The source position is still computed correctly, since new-line characters are only counted on demand.
+        */
+        inline void SkipTo(const char* pos)
         {
-            return line_;
+            cur_ = pos;
         }
 
+        //! Returns a pointer to the beginning of the line of the last character returned by "Next".
+        const char* LineBegin() const;
+
+        //! Returns the current source position, i.e. the position of the last character returned by "Next".
+        SourcePosition Pos() const;
+
+        //! Returns the current source line (including the new-line character).
+        std::string Line() const;
+
     protected:
         
         SourceCode() = default;
 
-        std::shared_ptr<std::istream>   stream_;
-        std::string                     line_;
-        SourcePosition                  pos_;
+        //! Sets the range of the character buffer.
+        void SetBuffer(const char* data, std::size_t size);
+
+    private:
+        
+        //! Returns a final new-line character, if the buffer does not end with one, and 0 otherwise.
+        char NextAtEnd();
+
+        //! Updates the row counter and the begin of the current line up to the current character.
+        void UpdatePos() const;
+
+        std::string         buffer_;                //!< Buffer for the source code of an input stream.
+
+        const char*         begin_      = nullptr;
+        const char*         end_        = nullptr;
+        const char*         cur_        = nullptr;
+        bool                finalNewLine_ = false;  //!< True if the final new-line character has been returned.
+
+        /* Lazily computed source position */
+        mutable const char* posCur_     = nullptr;  //!< Pointer up to which new-line characters have been counted.
+        mutable const char* lineBegin_  = nullptr;
+        mutable unsigned int row_       = 1;
 
 };
 
@@ -0,0 +1,51 @@
+/*
+ * StreamHandler.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_STREAM_HANDLER_H__
+#define __HT_STREAM_HANDLER_H__
+
+
+#include "Visitor.h"
+
+
+namespace HTLib
+{
+
+
+/**
+Stream handler interface for the streamed translation (see "Options::streamOutput").
+The context analyzer and the code generator notify this handler right before and after they process each global declaration,
+so that each function body only exists while it is decorated or generated.
+\see HLSLAnalyzer::DecorateAST
+\see GLSLGenerator::SetStreamHandler
+*/
+class StreamHandler
+{
+
+    public:
+
+        virtual ~StreamHandler()
+        {
+        }
+
+        //! Prepares the specified global declaration, e.g. parses its function body. Returns false on failure (the errors are written to the log).
+        virtual bool BeginGlobalDecl(GlobalDecl* ast) = 0;
+
+        //! Releases the specified global declaration after it has been processed, e.g. its function body.
+        virtual void EndGlobalDecl(GlobalDecl* ast) = 0;
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
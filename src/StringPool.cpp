@@ -0,0 +1,118 @@
+/*
+ * StringPool.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "StringPool.h"
+
+#include <cstring>
+
+
+namespace HTLib
+{
+
+
+StringPool::StringPool() :
+    slots_( 256 )
+{
+}
+
+const std::string& StringPool::Intern(const char* str, std::size_t length)
+{
+    const auto hash = Hash(str, length);
+    const auto mask = slots_.size() - 1;
+
+    /* Search string in hash table */
+    for (auto i = hash & mask; ; i = (i + 1) & mask)
+    {
+        auto& slot = slots_[i];
+
+        if (slot.str == nullptr)
+        {
+            /* Insert new string */
+            strings_.emplace_back(str, length);
+            slot.hash   = hash;
+            slot.str    = &(strings_.back());
+
+            const auto& interned = *slot.str;
+
+            /* Keep load factor below 1/2 */
+            if (strings_.size() * 2 > slots_.size())
+                Grow();
+
+            return interned;
+        }
+
+        if (slot.hash == hash && slot.str->size() == length && std::memcmp(slot.str->data(), str, length) == 0)
+            return *slot.str;
+    }
+}
+
+const std::string* StringPool::Find(const char* str, std::size_t length) const
+{
+    const auto hash = Hash(str, length);
+    const auto mask = slots_.size() - 1;
+
+    for (auto i = hash & mask; slots_[i].str != nullptr; i = (i + 1) & mask)
+    {
+        const auto& slot = slots_[i];
+        if (slot.hash == hash && slot.str->size() == length && std::memcmp(slot.str->data(), str, length) == 0)
+            return slot.str;
+    }
+
+    return nullptr;
+}
+
+const std::string& StringPool::Empty()
+{
+    static const std::string empty;
+    return empty;
+}
+
+
+std::uint32_t StringPool::Hash(const char* str, std::size_t length)
+{
+    /* FNV-1a hash */
+    std::uint32_t h = 2166136261u;
+
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        h ^= static_cast<unsigned char>(str[i]);
+        h *= 16777619u;
+    }
+
+    return h;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void StringPool::Grow()
+{
+    std::vector<Slot> slots(slots_.size() * 2);
+    const auto mask = slots.size() - 1;
+
+    for (const auto& slot : slots_)
+    {
+        if (slot.str != nullptr)
+        {
+            auto i = slot.hash & mask;
+            while (slots[i].str != nullptr)
+                i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+
+    slots_ = std::move(slots);
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -0,0 +1,87 @@
+/*
+ * StringPool.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_STRING_POOL_H__
+#define __HT_STRING_POOL_H__
+
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace HTLib
+{
+
+
+/**
+String interner: stores each distinct string only once.
+\remarks The references returned by "Intern" stay valid for the lifetime of the pool,
+and two interned strings are equal if and only if they have the same address.
+Interning a string which is already in the pool does not allocate any memory.
+\see Ident
+*/
+class StringPool
+{
+    
+    public:
+        
+        StringPool();
+
+        StringPool(const StringPool&) = delete;
+        StringPool& operator = (const StringPool&) = delete;
+
+        //! Returns the interned string of the specified character range.
+        const std::string& Intern(const char* str, std::size_t length);
+
+        //! Returns the interned string of the specified string.
+        inline const std::string& Intern(const std::string& str)
+        {
+            return Intern(str.data(), str.size());
+        }
+
+        //! Returns the interned string of the specified character range, or null if the string is not in this pool.
+        const std::string* Find(const char* str, std::size_t length) const;
+
+        //! Returns the number of distinct strings in this pool.
+        inline std::size_t Size() const
+        {
+            return strings_.size();
+        }
+
+        //! Returns the interned empty string.
+        static const std::string& Empty();
+
+        //! Returns the hash of the specified character range, which is used by the pool.
+        static std::uint32_t Hash(const char* str, std::size_t length);
+
+    private:
+        
+        struct Slot
+        {
+            std::uint32_t       hash    = 0;
+            const std::string*  str     = nullptr;
+        };
+
+        void Grow();
+
+        std::deque<std::string> strings_;   //!< Storage of all strings (a deque never moves its elements).
+        std::vector<Slot>       slots_;     //!< Open addressing hash table with linear probing.
+
+};
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
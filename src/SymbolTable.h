@@ -9,11 +9,14 @@
 #define __HT_SYMBOL_TABLE_H__
 
 
-#include <map>
+#include "Ident.h"
+
+#include <unordered_map>
 #include <string>
 #include <stack>
 #include <vector>
 #include <functional>
+#include <stdexcept>
 
 
 namespace HTLib
@@ -68,7 +71,7 @@ template <typename SymbolType> class SymbolTable
         Registers the specified symbol in the current scope.
         At least one scope must be open before symbols can be registered!
         */
-        void Register(const std::string& ident, SymbolType* symbol, const OnOverrideProc& overrideProc = nullptr)
+        void Register(const Ident& ident, SymbolType* symbol, const OnOverrideProc& overrideProc = nullptr)
         {
             /* Validate input parameters */
             if (scopeStack_.empty())
@@ -103,7 +106,7 @@ template <typename SymbolType> class SymbolTable
         Returns the symbol with the specified identifer which is in
         the deepest scope, or null if there is no such symbol.
         */
-        SymbolType* Fetch(const std::string& ident) const
+        SymbolType* Fetch(const Ident& ident) const
         {
             auto it = symTable_.find(ident);
             if (it != symTable_.end() && !it->second.empty())
@@ -126,13 +129,13 @@ template <typename SymbolType> class SymbolTable
         };
 
         //! Stores the scope stack for all identifiers.
-        std::map<std::string, std::stack<Symbol>> symTable_;
+        std::unordered_map<Ident, std::stack<Symbol>> symTable_;
 
         /**
         Stores all identifiers for the current stack.
         All these identifiers will be removed from "symTable_" when a scope will be closed.
         */
-        std::stack<std::vector<std::string>> scopeStack_;
+        std::stack<std::vector<Ident>> scopeStack_;
 
 };
 
@@ -0,0 +1,200 @@
+/*
+ * ThreadPool.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+
+namespace HTLib
+{
+
+
+ThreadPool::ThreadPool(unsigned int numThreads) :
+    nextQueue_      { 0 },
+    pendingTasks_   { 0 }
+{
+    if (numThreads == 0)
+    {
+        auto hwThreads = std::thread::hardware_concurrency();
+        numThreads = (hwThreads > 1 ? hwThreads - 1 : 1);
+    }
+
+    /* Create one queue per worker and one for external threads */
+    for (unsigned int i = 0; i <= numThreads; ++i)
+        queues_.emplace_back(new Queue());
+
+    for (unsigned int i = 0; i < numThreads; ++i)
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this, static_cast<std::size_t>(i));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex_);
+        quit_ = true;
+    }
+    wakeUp_.notify_all();
+
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t index)>& func)
+{
+    if (count == 0)
+        return;
+
+    Group group;
+    group.remaining = count;
+
+    /* Register tasks before they are queued, so the counter never underflows */
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex_);
+        pendingTasks_ += count;
+    }
+
+    /* Distribute tasks over all worker queues */
+    const auto numQueues = queues_.size();
+    auto queueIndex = nextQueue_.fetch_add(1) % numQueues;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto& queue = *queues_[(queueIndex + i) % numQueues];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        queue.tasks.push_back({ &group, &func, i });
+    }
+
+    wakeUp_.notify_all();
+
+    /* Execute tasks on the calling thread until all tasks of this group have been finished */
+    const auto externalQueue = numQueues - 1;
+
+    while (group.remaining > 0)
+    {
+        Task task;
+        if (TakeTask(externalQueue, task))
+            RunTask(task);
+        else
+        {
+            std::unique_lock<std::mutex> lock(group.mutex);
+            group.finished.wait(lock, [&group]() { return group.remaining == 0; });
+        }
+    }
+
+    /* Wait until the last task has released the group lock, then forward the first exception */
+    std::lock_guard<std::mutex> guard(group.mutex);
+    if (group.exception)
+        std::rethrow_exception(group.exception);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ThreadPool::WorkerLoop(std::size_t queueIndex)
+{
+    while (true)
+    {
+        Task task;
+        if (TakeTask(queueIndex, task))
+            RunTask(task);
+        else
+        {
+            /* Wait for new tasks */
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            wakeUp_.wait(lock, [this]() { return quit_ || pendingTasks_ > 0; });
+            if (quit_)
+                return;
+        }
+    }
+}
+
+bool ThreadPool::TakeTask(std::size_t queueIndex, Task& task)
+{
+    const auto numQueues = queues_.size();
+
+    for (std::size_t i = 0; i < numQueues; ++i)
+    {
+        auto& queue = *queues_[(queueIndex + i) % numQueues];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+
+        if (!queue.tasks.empty())
+        {
+            /* Take own tasks from the back, but steal tasks from the front */
+            if (i == 0)
+            {
+                task = queue.tasks.back();
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = queue.tasks.front();
+                queue.tasks.pop_front();
+            }
+            --pendingTasks_;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::RunTask(const Task& task)
+{
+    auto group = task.group;
+
+    try
+    {
+        (*task.func)(task.index);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(group->mutex);
+        if (!group->exception)
+            group->exception = std::current_exception();
+    }
+
+    /* Notify the waiting thread if this was the last task of its group */
+    std::lock_guard<std::mutex> guard(group->mutex);
+    if (--group->remaining == 0)
+        group->finished.notify_all();
+}
+
+
+/*
+ * Global functions
+ */
+
+void ParallelFor(std::size_t count, unsigned int numThreads, const std::function<void(std::size_t index)>& func)
+{
+    /* Determine number of threads (never more than tasks) */
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    if (numThreads > count)
+        numThreads = static_cast<unsigned int>(count);
+
+    if (numThreads <= 1)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            func(i);
+    }
+    else
+    {
+        /* Use a work-stealing thread pool (the calling thread also executes tasks) */
+        ThreadPool threadPool(numThreads - 1);
+        threadPool.ParallelFor(count, func);
+    }
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
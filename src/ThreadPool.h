@@ -0,0 +1,121 @@
+/*
+ * ThreadPool.h
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef __HT_THREAD_POOL_H__
+#define __HT_THREAD_POOL_H__
+
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+#include <cstddef>
+
+
+namespace HTLib
+{
+
+
+/**
+Work-stealing thread pool.
+\remarks Each worker thread has its own task queue. A worker takes new tasks from the back of its own queue
+and steals tasks from the front of the other queues when its own queue is empty.
+The thread which calls "ParallelFor" also executes tasks while it waits,
+so "ParallelFor" can be nested (i.e. called from within a task) without dead locks.
+*/
+class ThreadPool
+{
+    
+    public:
+        
+        /**
+        Creates the thread pool.
+        \param[in] numThreads Specifies the number of worker threads.
+        If this is 0, the number of hardware threads (minus one for the calling thread) is used.
+        */
+        explicit ThreadPool(unsigned int numThreads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        /**
+        Calls the specified function for all indices in the range [0, count) and waits until all calls have returned.
+        \throws The first exception, which has been thrown by any of the function calls.
+        */
+        void ParallelFor(std::size_t count, const std::function<void(std::size_t index)>& func);
+
+        //! Returns the number of worker threads (not including the calling thread).
+        inline std::size_t NumThreads() const
+        {
+            return workers_.size();
+        }
+
+    private:
+        
+        //! State of a single "ParallelFor" call.
+        struct Group
+        {
+            std::atomic<std::size_t>    remaining;
+            std::mutex                  mutex;
+            std::condition_variable     finished;
+            std::exception_ptr          exception;
+        };
+
+        struct Task
+        {
+            Group*                                          group;
+            const std::function<void(std::size_t index)>*   func;
+            std::size_t                                     index;
+        };
+
+        struct Queue
+        {
+            std::mutex          mutex;
+            std::deque<Task>    tasks;
+        };
+
+        void WorkerLoop(std::size_t queueIndex);
+
+        //! Takes a task from the specified queue (from the back) or steals one from any other queue (from the front).
+        bool TakeTask(std::size_t queueIndex, Task& task);
+
+        void RunTask(const Task& task);
+
+        std::vector<std::thread>                workers_;
+        std::vector<std::unique_ptr<Queue>>     queues_;        //!< One queue for each worker plus one for external threads.
+        std::atomic<std::size_t>                nextQueue_;
+
+        std::mutex                              sleepMutex_;
+        std::condition_variable                 wakeUp_;
+        std::atomic<std::size_t>                pendingTasks_;
+        bool                                    quit_           = false;
+
+};
+
+
+/**
+Calls the specified function for all indices in the range [0, count) on the calling thread and (if more than one thread is used) a temporary thread pool.
+\param[in] numThreads Specifies the total number of threads (including the calling thread). If this is 0, the number of hardware threads is used.
+\throws The first exception, which has been thrown by any of the function calls.
+*/
+void ParallelFor(std::size_t count, unsigned int numThreads, const std::function<void(std::size_t index)>& func);
+
+
+} // /namespace HTLib
+
+
+#endif
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -6,34 +6,38 @@
  */
 
 #include "Token.h"
+#include "StringPool.h"
 
 
 namespace HTLib
 {
 
 
-Token::Token(Token&& other) :
-    type_   { other.type_             },
-    pos_    { other.pos_              },
-    spell_  { std::move(other.spell_) }
+Token::Token() :
+    type_   { Types::__Unknown__    },
+    spell_  { &StringPool::Empty()  }
 {
 }
 
 Token::Token(const SourcePosition& pos, const Types type) :
-    type_   { type },
-    pos_    { pos  }
+    type_   { type                  },
+    pos_    { pos                   },
+    spell_  { &StringPool::Empty()  }
 {
 }
+
 Token::Token(const SourcePosition& pos, const Types type, const std::string& spell) :
-    type_   { type  },
-    pos_    { pos   },
-    spell_  { spell }
+    type_   { type   },
+    pos_    { pos    },
+    spell_  { &spell }
 {
 }
-Token::Token(const SourcePosition& pos, const Types type, std::string&& spell) :
-    type_   { type             },
-    pos_    { pos              },
-    spell_  { std::move(spell) }
+
+Token::Token(const SourcePosition& pos, const Types type, const Ident& ident) :
+    type_       { type          },
+    pos_        { pos           },
+    spell_      { &ident.Str()  },
+    isIdent_    { true          }
 {
 }
 
@@ -10,6 +10,7 @@
 
 
 #include "SourcePosition.h"
+#include "Ident.h"
 
 #include <string>
 #include <memory>
@@ -19,7 +20,10 @@ namespace HTLib
 {
 
 
-//! Token classes used by the scanner and parser.
+/**
+Token classes used by the scanner and parser.
+\remarks Tokens are small value types (the spelling is an interned string), so they can be copied without any allocation.
+*/
 class Token
 {
     
@@ -111,11 +115,20 @@ class Token
             EndOfStream,
         };
 
-        Token(Token&& other);
+        //! Constructs an unknown token with an empty spelling.
+        Token();
 
         Token(const SourcePosition& pos, const Types type);
+
+        /**
+        Constructs the token with the specified spelling.
+        \param[in] spell Specifies the token spelling. This is not copied, so it must be an interned string
+        (see StringPool), which outlives this token.
+        */
         Token(const SourcePosition& pos, const Types type, const std::string& spell);
-        Token(const SourcePosition& pos, const Types type, std::string&& spell);
+
+        //! Constructs the token with the spelling of the specified identifier (see Ident).
+        Token(const SourcePosition& pos, const Types type, const Ident& ident);
 
         //! Returns the token type.
         inline Types Type() const
@@ -130,17 +143,28 @@ class Token
         //! Returns the token spelling.
         inline const std::string& Spell() const
         {
-            return spell_;
+            return *spell_;
+        }
+        /**
+        Returns the token spelling as identifier.
+        \remarks This does not intern the spelling again, if the token has been constructed with an identifier
+        (i.e. for all identifiers and keywords of the scanner).
+        */
+        inline Ident SpellIdent() const
+        {
+            return (isIdent_ ? Ident(spell_) : Ident(*spell_));
         }
 
     private:
 
-        Types           type_;  //!< Type of this token.
-        SourcePosition  pos_;  //!< Source area of this token.
-        std::string     spell_; //!< Token spelling.
+        Types               type_;  //!< Type of this token.
+        SourcePosition      pos_;   //!< Source area of this token.
+        const std::string*  spell_; //!< Interned token spelling.
+        bool                isIdent_ = false; //!< Specifies whether the spelling is interned in the identifier pool.
 
 };
 
+//! Shared token (used for the preprocessed token streams, which are shared between several translations).
 typedef std::shared_ptr<Token> TokenPtr;
 
 
@@ -0,0 +1,482 @@
+/*
+ * TranslationCache.cpp
+ * 
+ * This file is part of the "HLSL Translator" (Copyright (c) 2014 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "HT/TranslationCache.h"
+#include "HT/Version.h"
+
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <map>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+#include <cstdint>
+#include <cctype>
+
+
+namespace HTLib
+{
+
+
+/*
+ * Internal functions
+ */
+
+//! 128-bit hash from two independent 64-bit FNV-1a style hashes.
+class KeyHash
+{
+    
+    public:
+        
+        void Append(const void* data, std::size_t size)
+        {
+            auto bytes = reinterpret_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                h0_ = (h0_ ^ bytes[i]) * 0x100000001b3ull;
+                h1_ = (h1_ ^ bytes[i]) * 0x9e3779b97f4a7c15ull;
+                h1_ ^= (h1_ >> 29);
+            }
+        }
+
+        //! Appends the size and the content of the specified string (so that consecutive strings can not be confused).
+        void Append(const std::string& str)
+        {
+            Append(static_cast<std::uint64_t>(str.size()));
+            Append(str.data(), str.size());
+        }
+
+        void Append(std::uint64_t value)
+        {
+            unsigned char bytes[8];
+            for (int i = 0; i < 8; ++i)
+                bytes[i] = static_cast<unsigned char>(value >> (i*8));
+            Append(bytes, sizeof(bytes));
+        }
+
+        std::string HexString() const
+        {
+            static const char* digits = "0123456789abcdef";
+
+            std::string str(32, '0');
+            for (int i = 0; i < 16; ++i)
+            {
+                str[15 - i] = digits[(h0_ >> (i*4)) & 0xf];
+                str[31 - i] = digits[(h1_ >> (i*4)) & 0xf];
+            }
+
+            return str;
+        }
+
+    private:
+        
+        std::uint64_t h0_ = 0xcbf29ce484222325ull;
+        std::uint64_t h1_ = 0x84222325cbf29ce4ull;
+
+};
+
+//! Include directives and macro definitions of a source, which determine the included files.
+struct IncludeDirectives
+{
+    std::vector<std::string>                            names;          // Names of "#include" directives with a quoted or bracketed name
+    std::vector<std::string>                            macroNames;     // Macro identifiers of "#include MACRO" directives
+    std::multimap<std::string, std::string>             definitions;    // <macro-name, replacement> of all object-like macros
+};
+
+static bool IsIdentChar(char chr)
+{
+    return (std::isalnum(static_cast<unsigned char>(chr)) != 0 || chr == '_');
+}
+
+//! Appends the "#include" directives and the macro definitions of the specified source.
+static void FindIncludes(const char* source, std::size_t size, IncludeDirectives& directives)
+{
+    auto end = source + size;
+
+    auto SkipBlanks = [end](const char*& s)
+    {
+        while (s < end && (*s == ' ' || *s == '\t'))
+            ++s;
+    };
+
+    auto ReadKeyword = [end](const char*& s, const std::string& keyword)
+    {
+        if (static_cast<std::size_t>(end - s) > keyword.size() && std::string(s, keyword.size()) == keyword && !IsIdentChar(s[keyword.size()]))
+        {
+            s += keyword.size();
+            return true;
+        }
+        return false;
+    };
+
+    auto ReadIdent = [end](const char*& s)
+    {
+        auto identBegin = s;
+        while (s < end && IsIdentChar(*s))
+            ++s;
+        return std::string(identBegin, s);
+    };
+
+    for (auto s = source; s < end;)
+    {
+        /* Find directive at the beginning of the current line */
+        SkipBlanks(s);
+
+        if (s < end && *s == '#')
+        {
+            ++s;
+            SkipBlanks(s);
+
+            if (ReadKeyword(s, "include"))
+            {
+                SkipBlanks(s);
+
+                if (s < end && (*s == '\"' || *s == '<'))
+                {
+                    const auto terminator = (*s == '\"' ? '\"' : '>');
+                    auto nameBegin = ++s;
+
+                    while (s < end && *s != terminator && *s != '\n')
+                        ++s;
+
+                    if (s < end && *s == terminator)
+                        directives.names.push_back(std::string(nameBegin, s));
+                }
+                else
+                {
+                    /* Include name is determined by a macro */
+                    auto ident = ReadIdent(s);
+                    if (!ident.empty())
+                        directives.macroNames.push_back(ident);
+                }
+            }
+            else if (ReadKeyword(s, "define"))
+            {
+                SkipBlanks(s);
+                auto ident = ReadIdent(s);
+
+                /* Store the replacement of object-like macros (function-like macros can not name an include file on their own) */
+                if (!ident.empty() && (s >= end || *s != '('))
+                {
+                    SkipBlanks(s);
+                    auto valueBegin = s;
+                    while (s < end && *s != '\n')
+                        ++s;
+
+                    auto valueEnd = s;
+                    while (valueEnd > valueBegin && std::isspace(static_cast<unsigned char>(valueEnd[-1])))
+                        --valueEnd;
+
+                    directives.definitions.insert({ ident, std::string(valueBegin, valueEnd) });
+                }
+            }
+        }
+
+        /* Move to next line */
+        while (s < end && *s != '\n')
+            ++s;
+        if (s < end)
+            ++s;
+    }
+}
+
+/**
+Appends the include names, which the specified macro may be replaced with, to the list.
+\remarks Conditional definitions are not evaluated, so all definitions of the macro are used (also through other macros).
+Thus a cache entry may be invalidated by a file which is not actually included, but never misses a file which is included.
+*/
+static void ResolveMacroInclude(
+    const std::string& macroName, const IncludeDirectives& directives, std::set<std::string>& visitedMacros, std::vector<std::string>& names)
+{
+    if (!visitedMacros.insert(macroName).second)
+        return;
+
+    auto range = directives.definitions.equal_range(macroName);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const auto& value = it->second;
+        if (value.empty())
+            continue;
+
+        if (value.front() == '\"' || value.front() == '<')
+        {
+            const auto terminator = (value.front() == '\"' ? '\"' : '>');
+            auto end = value.find(terminator, 1);
+            if (end != std::string::npos)
+                names.push_back(value.substr(1, end - 1));
+        }
+        else if (IsIdentChar(value.front()))
+        {
+            std::size_t n = 0;
+            while (n < value.size() && IsIdentChar(value[n]))
+                ++n;
+            ResolveMacroInclude(value.substr(0, n), directives, visitedMacros, names);
+        }
+    }
+}
+
+//! Appends the contents of all (recursively) included files to the hash.
+static void AppendIncludes(
+    KeyHash& hash, const std::vector<std::string>& includes, IncludeHandler* includeHandler,
+    IncludeDirectives& directives, std::set<std::string>& visited)
+{
+    for (auto includeName : includes)
+    {
+        /* Include each file only once */
+        if (!visited.insert(includeName).second)
+            continue;
+
+        hash.Append(includeName);
+
+        /* Read included file through the include handler (which may modify the include name) */
+        auto stream = (includeHandler != nullptr ? includeHandler->Include(includeName) : nullptr);
+
+        if (stream && stream->good())
+        {
+            std::string content { std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>() };
+
+            hash.Append(includeName);
+            hash.Append(content);
+
+            IncludeDirectives fileDirectives;
+            FindIncludes(content.data(), content.size(), fileDirectives);
+
+            directives.macroNames.insert(directives.macroNames.end(), fileDirectives.macroNames.begin(), fileDirectives.macroNames.end());
+            directives.definitions.insert(fileDirectives.definitions.begin(), fileDirectives.definitions.end());
+
+            AppendIncludes(hash, fileDirectives.names, includeHandler, directives, visited);
+        }
+        else
+            hash.Append(std::string("<unresolved>"));
+    }
+}
+
+/**
+Appends the contents of all files to the hash, which are included by the specified source (directly or through other files).
+\remarks If the preprocessor is used, the names of "#include MACRO" directives are resolved with the macro definitions
+of all visited files and the predefined macros, until no more files are found.
+*/
+static void AppendAllIncludes(
+    KeyHash& hash, const char* source, std::size_t size, IncludeHandler* includeHandler, const Options& options)
+{
+    IncludeDirectives directives;
+    FindIncludes(source, size, directives);
+
+    std::set<std::string> visited;
+    AppendIncludes(hash, directives.names, includeHandler, directives, visited);
+
+    if (!options.preprocess)
+        return;
+
+    for (const auto& macro : options.macros)
+        directives.definitions.insert(macro);
+
+    for (std::size_t i = 0; i < directives.macroNames.size(); ++i)
+    {
+        std::set<std::string> visitedMacros;
+        std::vector<std::string> names;
+        ResolveMacroInclude(directives.macroNames[i], directives, visitedMacros, names);
+
+        hash.Append(directives.macroNames[i]);
+        AppendIncludes(hash, names, includeHandler, directives, visited);
+    }
+}
+
+
+/*
+ * TranslationCache class
+ */
+
+TranslationCache::TranslationCache(const std::string& directory) :
+    directory_{ directory }
+{
+    if (!directory_.empty() && directory_.back() != '/' && directory_.back() != '\\')
+        directory_ += '/';
+}
+
+bool TranslationCache::Translate(
+    const Translator&                       translator,
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    bool*                                   cacheHit,
+    TranslationStats*                       stats) const
+{
+    auto key = Key(
+        inputSource, inputSourceSize, entryPoint, shaderTarget,
+        inputShaderVersion, outputShaderVersion, includeHandler, options
+    );
+
+    /* Try to load output from the cache */
+    std::string cachedOutput;
+    if (Load(key, cachedOutput))
+    {
+        if (cacheHit)
+            *cacheHit = true;
+        if (stats)
+        {
+            *stats = TranslationStats();
+            stats->outputBytes = cachedOutput.size();
+        }
+        output.write(cachedOutput.data(), cachedOutput.size());
+        return true;
+    }
+
+    if (cacheHit)
+        *cacheHit = false;
+
+    /* Translate shader and store the output in the cache */
+    std::string translatedOutput;
+
+    auto result = translator.Translate(
+        inputSource, inputSourceSize, translatedOutput, entryPoint, shaderTarget,
+        inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats
+    );
+
+    if (result)
+        Store(key, translatedOutput);
+
+    output.write(translatedOutput.data(), translatedOutput.size());
+
+    return result;
+}
+
+std::string TranslationCache::Key(
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options) const
+{
+    KeyHash hash;
+
+    /* Append translator version, so that a new version invalidates all entries */
+    hash.Append(std::string(__HT_VERSION__));
+
+    /* Append shader source and all included files */
+    hash.Append(static_cast<std::uint64_t>(inputSourceSize));
+    hash.Append(inputSource, inputSourceSize);
+
+    AppendAllIncludes(hash, inputSource, inputSourceSize, includeHandler, options);
+
+    /* Append translation parameters */
+    hash.Append(entryPoint);
+    hash.Append(static_cast<std::uint64_t>(shaderTarget));
+    hash.Append(static_cast<std::uint64_t>(inputShaderVersion));
+    hash.Append(static_cast<std::uint64_t>(outputShaderVersion));
+
+    /* Append all options */
+    hash.Append(options.indent);
+    hash.Append(options.prefix);
+    hash.Append(static_cast<std::uint64_t>(options.warnings));
+    hash.Append(static_cast<std::uint64_t>(options.blanks));
+    hash.Append(static_cast<std::uint64_t>(options.lineMarks));
+    hash.Append(static_cast<std::uint64_t>(options.dumpAST));
+    hash.Append(static_cast<std::uint64_t>(options.timeStamp));
+    hash.Append(static_cast<std::uint64_t>(options.preprocess));
+    hash.Append(static_cast<std::uint64_t>(options.eliminateDeadCode));
+    hash.Append(static_cast<std::uint64_t>(options.foldConstants));
+    hash.Append(static_cast<std::uint64_t>(options.lazyFunctionBodies));
+    hash.Append(static_cast<std::uint64_t>(options.minify));
+    hash.Append(static_cast<std::uint64_t>(options.explicitBinding));
+    hash.Append(static_cast<std::uint64_t>(options.descriptorSet));
+    hash.Append(static_cast<std::uint64_t>(options.pushConstantSize));
+    hash.Append(static_cast<std::uint64_t>(options.defaultPrecision));
+
+    hash.Append(static_cast<std::uint64_t>(options.bindingOffsets.size()));
+    for (const auto& offset : options.bindingOffsets)
+    {
+        hash.Append(static_cast<std::uint64_t>(offset.first));
+        hash.Append(static_cast<std::uint64_t>(offset.second));
+    }
+
+    hash.Append(static_cast<std::uint64_t>(options.macros.size()));
+    for (const auto& macro : options.macros)
+    {
+        hash.Append(macro.first);
+        hash.Append(macro.second);
+    }
+
+    return hash.HexString();
+}
+
+bool TranslationCache::Load(const std::string& key, std::string& output) const
+{
+    std::ifstream file(EntryFilename(key), std::ios_base::binary);
+    if (!file.good())
+        return false;
+
+    output.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    return !file.bad();
+}
+
+bool TranslationCache::Store(const std::string& key, const std::string& output) const
+{
+    const auto filename = EntryFilename(key);
+
+    /* Write entry into a unique temporary file first */
+    const auto uniqueID =
+        std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+        static_cast<std::size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    const auto tempFilename = filename + "." + std::to_string(uniqueID) + ".tmp";
+
+    {
+        std::ofstream file(tempFilename, std::ios_base::binary);
+        if (!file.good())
+            return false;
+
+        file.write(output.data(), output.size());
+
+        if (!file.good())
+        {
+            file.close();
+            std::remove(tempFilename.c_str());
+            return false;
+        }
+    }
+
+    /* Replace entry by the temporary file (this fails on some platforms, if another process has already stored this entry) */
+    if (std::rename(tempFilename.c_str(), filename.c_str()) != 0)
+    {
+        std::remove(tempFilename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+std::string TranslationCache::EntryFilename(const std::string& key) const
+{
+    return directory_ + key + ".glsl";
+}
+
+
+} // /namespace HTLib
+
+
+
+// ================================================================================
\ No newline at end of file
@@ -6,17 +6,796 @@
  */
 
 #include "HT/Translator.h"
+#include "HT/DiagnosticBuffer.h"
 #include "HLSLParser.h"
+#include "HLSLPreprocessor.h"
 #include "HLSLAnalyzer.h"
 #include "GLSLGenerator.h"
 #include "ASTPrinter.h"
+#include "ThreadPool.h"
+#include "ASTSerializer.h"
+#include "DeclSplitter.h"
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <sstream>
+#include <iterator>
+#include <chrono>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <stdexcept>
+#include <cctype>
 
 
 namespace HTLib
 {
 
 
-_HT_EXPORT_ bool TranslateHLSLtoGLSL(
+/*
+ * Internal classes
+ */
+
+//! Logger which records all messages, so that they can be written to another log later (e.g. in a determined order).
+class BufferedLog : public Logger
+{
+    
+    public:
+        
+        void Info(const std::string& message) override
+        {
+            entries_.push_back({ EntryTypes::Info, message });
+        }
+
+        void Warning(const std::string& message) override
+        {
+            entries_.push_back({ EntryTypes::Warning, message });
+        }
+
+        void Error(const std::string& message) override
+        {
+            entries_.push_back({ EntryTypes::Error, message });
+        }
+
+        void IncIndent() override
+        {
+            entries_.push_back({ EntryTypes::IncIndent, "" });
+        }
+
+        void DecIndent() override
+        {
+            entries_.push_back({ EntryTypes::DecIndent, "" });
+        }
+
+        void Report(const Diagnostic& diagnostic) override
+        {
+            entries_.push_back({ EntryTypes::Report, "" });
+            reports_.Report(diagnostic);
+        }
+
+        //! Returns true if no message has been recorded.
+        inline bool Empty() const
+        {
+            return entries_.empty();
+        }
+
+        //! Writes all recorded messages to the specified log.
+        void Replay(Logger& log) const
+        {
+            auto report = reports_.Records().begin();
+            for (const auto& entry : entries_)
+            {
+                switch (entry.type)
+                {
+                    case EntryTypes::Info:      log.Info(entry.message);    break;
+                    case EntryTypes::Warning:   log.Warning(entry.message); break;
+                    case EntryTypes::Error:     log.Error(entry.message);   break;
+                    case EntryTypes::IncIndent: log.IncIndent();            break;
+                    case EntryTypes::DecIndent: log.DecIndent();            break;
+                    case EntryTypes::Report:    log.Report(reports_.GetDiagnostic(*(report++))); break;
+                }
+            }
+        }
+
+    private:
+        
+        enum class EntryTypes
+        {
+            Info,
+            Warning,
+            Error,
+            IncIndent,
+            DecIndent,
+            Report,
+        };
+
+        struct Entry
+        {
+            EntryTypes  type;
+            std::string message;
+        };
+
+        std::vector<Entry>  entries_;
+        DiagnosticBuffer    reports_;
+
+};
+
+//! Logger which records all messages in a diagnostic buffer and forwards them to another (optional) log.
+class RecordingLog : public Logger
+{
+    
+    public:
+        
+        RecordingLog(DiagnosticBuffer& buffer, Logger* log) :
+            buffer_ { buffer },
+            log_    { log    }
+        {
+        }
+
+        void Info(const std::string& message) override
+        {
+            buffer_.Info(message);
+            if (log_)
+                log_->Info(message);
+        }
+
+        void Warning(const std::string& message) override
+        {
+            buffer_.Warning(message);
+            if (log_)
+                log_->Warning(message);
+        }
+
+        void Error(const std::string& message) override
+        {
+            buffer_.Error(message);
+            if (log_)
+                log_->Error(message);
+        }
+
+        void Report(const Diagnostic& diagnostic) override
+        {
+            buffer_.Report(diagnostic);
+            if (log_)
+                log_->Report(diagnostic);
+        }
+
+        void IncIndent() override
+        {
+            if (log_)
+                log_->IncIndent();
+        }
+
+        void DecIndent() override
+        {
+            if (log_)
+                log_->DecIndent();
+        }
+
+    private:
+        
+        DiagnosticBuffer&   buffer_;
+        Logger*             log_    = nullptr;
+
+};
+
+//! Synchronized include handler, which requests each include file only once from the actual include handler.
+class SharedIncludeHandler : public IncludeHandler
+{
+    
+    public:
+        
+        SharedIncludeHandler(IncludeHandler* includeHandler) :
+            includeHandler_{ includeHandler }
+        {
+        }
+
+        std::shared_ptr<std::istream> Include(std::string& includeName) override
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+
+            auto it = includes_.find(includeName);
+            if (it == includes_.end())
+            {
+                /* Request include file and store its content */
+                Entry entry;
+                entry.name = includeName;
+
+                auto stream = includeHandler_->Include(entry.name);
+                if (stream && stream->good())
+                {
+                    entry.found = true;
+                    entry.content.assign(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+                }
+
+                it = includes_.insert({ includeName, entry }).first;
+            }
+
+            const auto& entry = it->second;
+            includeName = entry.name;
+
+            if (entry.found)
+                return std::make_shared<std::istringstream>(entry.content);
+
+            return nullptr;
+        }
+
+    private:
+        
+        struct Entry
+        {
+            std::string name;           //!< Include name, which has (possibly) been modified by the include handler.
+            bool        found = false;
+            std::string content;
+        };
+
+        IncludeHandler*                 includeHandler_ = nullptr;
+        std::mutex                      mutex_;
+        std::map<std::string, Entry>    includes_;
+
+};
+
+
+/*
+ * Internal functions
+ */
+
+//! Returns a hash of the type, spelling, and (optionally) position of all specified tokens.
+static std::pair<std::uint64_t, std::uint64_t> TokenStreamHash(const std::vector<TokenPtr>& tokens, bool hashPositions)
+{
+    std::uint64_t hash0 = 0xcbf29ce484222325ull;
+    std::uint64_t hash1 = 0x84222325cbf29ce4ull;
+
+    auto AppendBytes = [&](const char* data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            auto byte = static_cast<unsigned char>(data[i]);
+            hash0 = (hash0 ^ byte) * 0x100000001b3ull;
+            hash1 = ((hash1 ^ byte) * 0x100000001b3ull) ^ (hash1 >> 29);
+        }
+    };
+
+    auto Append = [&](std::uint64_t value)
+    {
+        char bytes[8];
+        for (int i = 0; i < 8; ++i, value >>= 8)
+            bytes[i] = static_cast<char>(value & 0xff);
+        AppendBytes(bytes, sizeof(bytes));
+    };
+
+    for (const auto& tkn : tokens)
+    {
+        const auto& spell = tkn->Spell();
+
+        Append(static_cast<std::uint64_t>(tkn->Type()));
+        Append(spell.size());
+        AppendBytes(spell.data(), spell.size());
+
+        if (hashPositions)
+            Append((static_cast<std::uint64_t>(tkn->Pos().Row()) << 32) | tkn->Pos().Column());
+    }
+
+    return { hash0, hash1 };
+}
+
+
+//! Returns the time (in seconds) which has elapsed since the specified start time.
+static double ElapsedTime(const std::chrono::steady_clock::time_point& startTime)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+/**
+Returns true if the function bodies are parsed, decorated and generated one after another (see "Options::streamOutput").
+This requires skipped function bodies (i.e. no preprocessor), and all bodies must be known for the minified names and the AST dump.
+*/
+static bool IsFunctionBodyStreamed(const Options& options)
+{
+    return (options.streamOutput && !options.preprocess && !options.minify && !options.dumpAST);
+}
+
+//! Adds the memory usage of the arenas of the specified program (including the body arenas of its functions) and all its linked programs.
+static void AccumulateArenaStats(const Program& program, TranslationStats& stats)
+{
+    stats.arenaBytes            += program.arena.UsedBytes();
+    stats.arenaReservedBytes    += program.arena.ReservedBytes();
+
+    for (auto node : program.arena.Nodes())
+    {
+        if (node->Type() == AST::Types::FunctionDecl)
+        {
+            if (auto bodyArena = static_cast<const FunctionDecl*>(node)->bodyArena.get())
+            {
+                stats.arenaBytes            += bodyArena->UsedBytes();
+                stats.arenaReservedBytes    += bodyArena->ReservedBytes();
+            }
+        }
+    }
+
+    for (const auto& linkedProgram : program.linkedPrograms)
+        AccumulateArenaStats(*linkedProgram, stats);
+}
+
+//! Records the number of AST nodes (by type) and the memory usage of the arenas of the specified program.
+static void RecordProgramStats(const Program& program, TranslationStats& stats)
+{
+    stats.numNodes = 0;
+    stats.numNodesByType.clear();
+
+    ForEachNode(
+        program,
+        [&stats](AST* ast)
+        {
+            ++stats.numNodes;
+            ++stats.numNodesByType[ASTTypeToString(ast->Type())];
+        }
+    );
+
+    stats.arenaBytes            = 0;
+    stats.arenaReservedBytes    = 0;
+    AccumulateArenaStats(program, stats);
+}
+
+//! Minimal size (in bytes) of the source chunks which are parsed concurrently.
+static const std::size_t minParseChunkSize = 32 * 1024;
+
+/**
+Scans and parses the top-level declarations of the specified source concurrently (in chunks of whole declarations),
+and links all chunks into a single program. The messages of the chunk parsers are not reported.
+\param[out] scanTime Specifies the share of the scanner in the elapsed time (the threads spend their time concurrently).
+\return Null pointer if the source is too small to be split, or if any chunk could not be parsed or reported any message
+(e.g. a lexical error, after which the parser continues), so the source must be parsed again by a single thread.
+*/
+static ProgramPtr ParseSourceConcurrent(
+    const SourceCode& source, const Options& options, bool measureScanTime, double& scanTime, std::size_t& numTokens)
+{
+    auto numThreads = options.parserThreads;
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    /* Use more chunks than threads, so the work-stealing thread pool can balance large declarations */
+    const auto data         = source.Begin();
+    const auto size         = source.Size();
+    const auto numChunks    = std::min(static_cast<std::size_t>(numThreads) * 4, size / minParseChunkSize);
+
+    if (numThreads < 2 || numChunks < 2)
+        return nullptr;
+
+    /* Group the top-level declarations into chunks of roughly the same size */
+    std::vector<DeclSpan> spans;
+    SplitGlobalDecls(data, size, spans);
+
+    const auto chunkSize = size / numChunks;
+    std::vector<DeclSpan> chunks;
+
+    for (const auto& span : spans)
+    {
+        if (chunks.empty() || chunks.back().end - chunks.back().begin >= chunkSize)
+            chunks.push_back(span);
+        else
+            chunks.back().end = span.end;
+    }
+
+    if (chunks.size() < 2)
+        return nullptr;
+
+    /* Parse each chunk at its original source position */
+    struct ChunkResult
+    {
+        ProgramPtr          program;
+        DiagnosticBuffer    log;                //!< Messages of the chunk parser (they are reported by the single-threaded parser).
+        double              scanTime    = 0.0;
+        double              totalTime   = 0.0;
+        std::size_t         numTokens   = 0;
+    };
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<ChunkResult> results(chunks.size());
+
+    ParallelFor(
+        chunks.size(), numThreads,
+        [&](std::size_t i)
+        {
+            const auto& chunk = chunks[i];
+            auto chunkStartTime = std::chrono::steady_clock::now();
+
+            HLSLParser parser(&(results[i].log));
+            parser.MeasureScanTime(measureScanTime);
+            parser.EnableLazyFunctionBodies(options.lazyFunctionBodies || IsFunctionBodyStreamed(options));
+            parser.EnableBodyArenas(IsFunctionBodyStreamed(options));
+
+            results[i].program = parser.ParseSource(
+                std::make_shared<SourceCode>(data + chunk.begin, chunk.end - chunk.begin, data + chunk.lineBegin, chunk.row)
+            );
+            results[i].scanTime     = parser.ScanTime();
+            results[i].totalTime    = ElapsedTime(chunkStartTime);
+            results[i].numTokens    = parser.NumTokens();
+        }
+    );
+
+    const auto elapsedTime = ElapsedTime(startTime);
+
+    /* Link the declarations of all chunks into a single program */
+    auto program = std::make_shared<Program>(SourcePosition::ignore);
+
+    double chunkScanTime = 0.0, chunkTotalTime = 0.0;
+    numTokens = 0;
+
+    for (const auto& result : results)
+    {
+        if (!result.program || !result.log.Records().empty())
+            return nullptr;
+
+        program->globalDecls.insert(
+            program->globalDecls.end(), result.program->globalDecls.begin(), result.program->globalDecls.end()
+        );
+        program->linkedPrograms.push_back(result.program);
+
+        chunkScanTime   += result.scanTime;
+        chunkTotalTime  += result.totalTime;
+        numTokens       += result.numTokens;
+    }
+
+    scanTime = (chunkTotalTime > 0.0 ? elapsedTime * chunkScanTime / chunkTotalTime : 0.0);
+
+    program->pos = results.front().program->pos;
+
+    return program;
+}
+
+
+//! Returns the filename of the specified '#include' directive line, or an empty string if the line is no include directive.
+static std::string IncludeDirectiveFilename(const std::string& line)
+{
+    auto IsSpace = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+
+    static const std::string keyword = "include";
+
+    /* Skip '#' and white spaces, then compare the directive keyword */
+    std::size_t pos = 1;
+    while (pos < line.size() && IsSpace(line[pos]))
+        ++pos;
+
+    if (line.compare(pos, keyword.size(), keyword) != 0)
+        return "";
+    pos += keyword.size();
+
+    while (pos < line.size() && IsSpace(line[pos]))
+        ++pos;
+
+    /* Extract filename between '"' or '<' and '>' */
+    if (pos >= line.size() || (line[pos] != '\"' && line[pos] != '<'))
+        return "";
+
+    auto endChar = (line[pos] == '<' ? '>' : '\"');
+    auto end = line.find(endChar, pos + 1);
+    if (end == std::string::npos)
+        return "";
+
+    return line.substr(pos + 1, end - pos - 1);
+}
+
+/*
+Appends the global declarations of the specified program to the output program,
+and replaces each include directive of a module by the declarations of that module.
+*/
+static void LinkGlobalDecls(
+    const Program& program, const std::map<std::string, ProgramPtr>& modules,
+    std::set<const Program*>& linkedModules, Program& output)
+{
+    for (auto globalDecl : program.globalDecls)
+    {
+        if (globalDecl->Type() == AST::Types::DirectiveDecl)
+        {
+            auto filename = IncludeDirectiveFilename(static_cast<DirectiveDecl*>(globalDecl)->line);
+            if (!filename.empty())
+            {
+                auto it = modules.find(filename);
+                if (it != modules.end() && it->second)
+                {
+                    /* Link module only once (like an include guard) */
+                    const auto& module = it->second;
+                    if (linkedModules.insert(module.get()).second)
+                    {
+                        LinkGlobalDecls(*module, modules, linkedModules, output);
+                        output.linkedPrograms.push_back(module);
+                    }
+                    continue;
+                }
+            }
+        }
+        output.globalDecls.push_back(globalDecl);
+    }
+}
+
+//! Maps each function declaration to the program which owns it (i.e. the program whose arena holds the declaration).
+static void MapFunctionDeclOwners(Program& program, std::unordered_map<const FunctionDecl*, Program*>& owners)
+{
+    /*
+    Linked programs are mapped first, because a program which links other programs
+    also lists their global declarations without owning them
+    */
+    for (const auto& linkedProgram : program.linkedPrograms)
+        MapFunctionDeclOwners(*linkedProgram, owners);
+
+    for (auto globalDecl : program.globalDecls)
+    {
+        if (globalDecl->Type() == AST::Types::FunctionDecl)
+            owners.insert({ static_cast<FunctionDecl*>(globalDecl), &program });
+    }
+}
+
+/*
+Collects all functions whose bodies can be reached from the entry point (see "Options::lazyFunctionBodies").
+Functions are followed by name (i.e. all overloads of a called function are collected), so this is a superset of the functions
+which are marked by the "ReferenceAnalyzer". Returns false if all function bodies are required,
+i.e. for the common shader, or if the called names of a body are unknown, because it has not been skipped by the parser.
+*/
+static bool CollectReachableFunctions(
+    const Program& program, const std::string& entryPoint, const ShaderTargets shaderTarget,
+    std::unordered_set<const FunctionDecl*>& reachedFunctions)
+{
+    /* All functions are generated for the common shader */
+    if (shaderTarget == ShaderTargets::CommonShader)
+        return false;
+
+    /* Collect all functions by name */
+    std::unordered_map<Ident, std::vector<const FunctionDecl*>> functionDecls;
+
+    for (auto globalDecl : program.globalDecls)
+    {
+        if (globalDecl->Type() == AST::Types::FunctionDecl)
+        {
+            auto functionDecl = static_cast<const FunctionDecl*>(globalDecl);
+            functionDecls[functionDecl->name].push_back(functionDecl);
+        }
+    }
+
+    /* Follow all called names, beginning with the entry point */
+    const auto entryIdent = Ident::Find(entryPoint);
+
+    std::unordered_set<Ident> reachedNames { entryIdent };
+    std::vector<Ident> pendingNames { entryIdent };
+
+    while (!pendingNames.empty())
+    {
+        auto it = functionDecls.find(pendingNames.back());
+        pendingNames.pop_back();
+
+        if (it == functionDecls.end())
+            continue;
+
+        for (auto functionDecl : it->second)
+        {
+            if (!functionDecl->codeBlock && !functionDecl->lazyBody)
+                continue; // forward declaration
+
+            /* The called names of bodies, which have not been skipped by the parser, are unknown */
+            if (!functionDecl->lazyBody)
+                return false;
+
+            reachedFunctions.insert(functionDecl);
+
+            for (const auto& name : functionDecl->lazyBody->calledNames)
+            {
+                if (reachedNames.insert(name).second)
+                    pendingNames.push_back(name);
+            }
+        }
+    }
+
+    return true;
+}
+
+/*
+Parses the skipped bodies of all functions which can be reached from the entry point (see "CollectReachableFunctions"),
+or of all functions if "parseAllBodies" is true, e.g. if the bodies have only been skipped for a streamed translation.
+*/
+static bool ParseReachableFunctionBodies(
+    Program& program, const std::string& entryPoint, const ShaderTargets shaderTarget, bool parseAllBodies, HLSLParser& parser,
+    std::vector<FunctionDecl*>* parsedFunctions = nullptr)
+{
+    bool hasLazyBodies = false;
+
+    for (auto globalDecl : program.globalDecls)
+    {
+        if (globalDecl->Type() == AST::Types::FunctionDecl && static_cast<FunctionDecl*>(globalDecl)->HasLazyBody())
+        {
+            hasLazyBodies = true;
+            break;
+        }
+    }
+
+    if (!hasLazyBodies)
+        return true;
+
+    std::unordered_set<const FunctionDecl*> reachedFunctions;
+    if (!parseAllBodies && !CollectReachableFunctions(program, entryPoint, shaderTarget, reachedFunctions))
+        parseAllBodies = true;
+
+    std::unordered_map<const FunctionDecl*, Program*> owners;
+    MapFunctionDeclOwners(program, owners);
+
+    bool result = true;
+
+    for (auto globalDecl : program.globalDecls)
+    {
+        if (globalDecl->Type() != AST::Types::FunctionDecl)
+            continue;
+
+        auto functionDecl = static_cast<FunctionDecl*>(globalDecl);
+        if (parseAllBodies || reachedFunctions.count(functionDecl) != 0)
+        {
+            if (functionDecl->HasLazyBody())
+            {
+                if (parser.ParseFunctionBody(functionDecl, *owners[functionDecl]))
+                {
+                    if (parsedFunctions)
+                        parsedFunctions->push_back(functionDecl);
+                }
+                else
+                    result = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+//! Releases the body of the specified function, which has been parsed into its own arena, so it can be parsed again.
+static void ReleaseFunctionBody(FunctionDecl* ast)
+{
+    /* Keep the signature, which is still referenced by function calls and the reflection */
+    if (ast->bodyArena)
+    {
+        ast->codeBlock = nullptr;
+        ast->bodyArena.reset();
+    }
+}
+
+
+/*
+ * TemporaryFunctionBodies class
+ */
+
+/**
+Skipped function bodies, which have been parsed for a single translation of a program that is used for several translations.
+\remarks The bodies are released when this object is destroyed, so each translation only decorates and generates the functions,
+which can be reached from its own entry point (e.g. the required extensions of a fragment shader would otherwise depend on
+whether the bodies of a compute shader of the same program have been parsed before).
+*/
+class TemporaryFunctionBodies
+{
+
+    public:
+
+        ~TemporaryFunctionBodies()
+        {
+            for (auto functionDecl : functions)
+                ReleaseFunctionBody(functionDecl);
+        }
+
+        std::vector<FunctionDecl*> functions;
+
+};
+
+
+/*
+ * FunctionBodyStream class
+ */
+
+/**
+Stream handler of a streamed translation (see "Options::streamOutput").
+Each function body is parsed right before it is decorated or generated, and it is released right afterwards.
+\remarks The bodies are parsed twice: once for the context analysis of the entire program,
+and once for the code generation, which decorates each global declaration again right before its code is written.
+Only the functions which can be reached from the entry point are parsed (see "CollectReachableFunctions"),
+unless all bodies are required, and only the referenced functions are parsed again for the code generation.
+*/
+class FunctionBodyStream : public StreamHandler
+{
+
+    public:
+
+        FunctionBodyStream(
+            Program& program, const std::string& entryPoint, const ShaderTargets shaderTarget,
+            bool parseAllBodies, bool measureScanTime, Logger* log) :
+                parser_         { log                                       },
+                isCommonShader_ { shaderTarget == ShaderTargets::CommonShader }
+        {
+            parser_.MeasureScanTime(measureScanTime);
+            parser_.EnableBodyArenas(true);
+
+            MapFunctionDeclOwners(program, owners_);
+            parseAllBodies_ = (parseAllBodies || !CollectReachableFunctions(program, entryPoint, shaderTarget, reachedFunctions_));
+        }
+
+        //! Decorates each global declaration again right before its code is generated (see "HLSLAnalyzer::RedecorateGlobalDecl").
+        void BeginGeneration(HLSLAnalyzer& analyzer)
+        {
+            analyzer_ = &analyzer;
+            analyzer_->BeginRedecoration();
+        }
+
+        bool BeginGlobalDecl(GlobalDecl* ast) override
+        {
+            if (ast->Type() == AST::Types::FunctionDecl)
+            {
+                auto functionDecl = static_cast<FunctionDecl*>(ast);
+                if (functionDecl->HasLazyBody() && IsBodyRequired(functionDecl))
+                {
+                    if (!parser_.ParseFunctionBody(functionDecl, *owners_[functionDecl]))
+                    {
+                        parsingFailed_ = true;
+                        return false;
+                    }
+                }
+            }
+            return (analyzer_ == nullptr || analyzer_->RedecorateGlobalDecl(ast));
+        }
+
+        void EndGlobalDecl(GlobalDecl* ast) override
+        {
+            if (ast->Type() == AST::Types::FunctionDecl)
+                ReleaseFunctionBody(static_cast<FunctionDecl*>(ast));
+        }
+
+        //! Returns the parser of the function bodies (e.g. for the number of tokens).
+        inline const HLSLParser& Parser() const
+        {
+            return parser_;
+        }
+
+        //! Returns true if a function body could not be parsed.
+        inline bool HasParsingFailed() const
+        {
+            return parsingFailed_;
+        }
+
+    private:
+
+        //! Returns true if the body of the specified function is required for the context analysis or the code generation.
+        bool IsBodyRequired(const FunctionDecl* ast) const
+        {
+            /* Only the referenced functions are generated */
+            if (analyzer_ && !isCommonShader_ && !ast->flags(FunctionDecl::isReferenced))
+                return false;
+            return (parseAllBodies_ || reachedFunctions_.count(ast) != 0);
+        }
+
+        HLSLParser                                          parser_;
+        HLSLAnalyzer*                                       analyzer_       = nullptr;
+        bool                                                isCommonShader_ = false;
+        bool                                                parseAllBodies_ = false;
+        bool                                                parsingFailed_  = false;
+        std::unordered_set<const FunctionDecl*>             reachedFunctions_;
+        std::unordered_map<const FunctionDecl*, Program*>   owners_;
+
+};
+
+/*
+ * Translator class
+ */
+
+struct Translator::Tables
+{
+    HLSLAnalyzer::Tables    analyzer;
+    GLSLGenerator::Tables   generator;
+    IncludeCache            includeCache;
+};
+
+Translator::Translator() :
+    tables_{ new Tables() }
+{
+}
+
+Translator::~Translator()
+{
+}
+
+bool Translator::Translate(
     const std::shared_ptr<std::istream>&    input,
     std::ostream&                           output,
     const std::string&                      entryPoint,
@@ -25,48 +804,730 @@ _HT_EXPORT_ bool TranslateHLSLtoGLSL(
     const OutputShaderVersions              outputShaderVersion,
     IncludeHandler*                         includeHandler,
     const Options&                          options,
-    Logger*                                 log)
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection) const
 {
-    /* Parse HLSL input code */
-    HLSLParser parser(log);
-    auto program = parser.ParseSource(std::make_shared<SourceCode>(input));
+    return Translate(
+        std::make_shared<SourceCode>(input), output, entryPoint, shaderTarget,
+        inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, reflection
+    );
+}
 
+bool Translator::Translate(
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection) const
+{
+    return Translate(
+        std::make_shared<SourceCode>(inputSource, inputSourceSize), output, entryPoint, shaderTarget,
+        inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, reflection
+    );
+}
+
+bool Translator::Translate(
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    std::string&                            output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection) const
+{
+    auto program = Parse(std::make_shared<SourceCode>(inputSource, inputSourceSize), includeHandler, options, log, stats);
     if (!program)
+        return false;
+
+    return GenerateOutput(
+        *program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, reflection, nullptr, nullptr, true
+    );
+}
+
+std::shared_ptr<Program> Translator::Parse(const std::shared_ptr<std::istream>& input, Logger* log) const
+{
+    return Parse(std::make_shared<SourceCode>(input), nullptr, Options(), log, nullptr);
+}
+
+std::shared_ptr<Program> Translator::Parse(const char* inputSource, std::size_t inputSourceSize, Logger* log) const
+{
+    return Parse(std::make_shared<SourceCode>(inputSource, inputSourceSize), nullptr, Options(), log, nullptr);
+}
+
+std::shared_ptr<Program> Translator::Parse(
+    const std::shared_ptr<std::istream>& input, IncludeHandler* includeHandler, const Options& options, Logger* log) const
+{
+    return Parse(std::make_shared<SourceCode>(input), includeHandler, options, log, nullptr);
+}
+
+std::shared_ptr<Program> Translator::Parse(
+    const char* inputSource, std::size_t inputSourceSize, IncludeHandler* includeHandler, const Options& options, Logger* log) const
+{
+    return Parse(std::make_shared<SourceCode>(inputSource, inputSourceSize), includeHandler, options, log, nullptr);
+}
+
+bool Translator::Generate(
+    Program&                                program,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection) const
+{
+    return GenerateOutput(
+        program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, reflection, nullptr, nullptr, false
+    );
+}
+
+bool Translator::Generate(
+    Program&                                program,
+    std::string&                            output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection) const
+{
+    return GenerateOutput(
+        program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, reflection, nullptr, nullptr, false
+    );
+}
+
+void Translator::WriteProgram(const Program& program, std::string& data) const
+{
+    ASTWriter writer;
+    writer.WriteProgram(program, data);
+}
+
+std::shared_ptr<Program> Translator::ReadProgram(const char* data, std::size_t size, Logger* log) const
+{
+    try
+    {
+        ASTReader reader;
+        return reader.ReadProgram(data, size);
+    }
+    catch (const std::exception& err)
     {
         if (log)
-            log->Error("parsing input code failed");
+            log->Error(err.what());
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Program> Translator::LinkPrograms(
+    const std::shared_ptr<Program>&                         program,
+    const std::map<std::string, std::shared_ptr<Program>>&  modules) const
+{
+    auto linkedProgram = std::make_shared<Program>(SourcePosition::ignore);
+
+    std::set<const Program*> linkedModules { program.get() };
+    LinkGlobalDecls(*program, modules, linkedModules, *linkedProgram);
+
+    linkedProgram->linkedPrograms.push_back(program);
+
+    return linkedProgram;
+}
+
+std::vector<TranslationResult> Translator::TranslateBatch(
+    const std::vector<TranslationJob>&      jobs,
+    unsigned int                            numThreads) const
+{
+    std::vector<TranslationResult> results(jobs.size());
+
+    auto translateJob = [&](std::size_t index)
+    {
+        const auto& job = jobs[index];
+        auto& result = results[index];
+
+        RecordingLog jobLog(result.messages, job.log);
+
+        result.succeeded = Translate(
+            job.source.data(), job.source.size(), result.output, job.entryPoint, job.shaderTarget,
+            job.inputShaderVersion, job.outputShaderVersion, job.includeHandler, job.options, &jobLog, &(result.stats), &(result.reflection)
+        );
+    };
+
+    ParallelFor(jobs.size(), numThreads, translateJob);
+
+    return results;
+}
+
+std::vector<TranslationResult> Translator::TranslatePermutations(
+    const char*                                         inputSource,
+    std::size_t                                         inputSourceSize,
+    const std::vector<std::map<std::string, std::string>>& macroSets,
+    const std::string&                                  entryPoint,
+    const ShaderTargets                                 shaderTarget,
+    const InputShaderVersions                           inputShaderVersion,
+    const OutputShaderVersions                          outputShaderVersion,
+    IncludeHandler*                                     includeHandler,
+    const Options&                                      options,
+    Logger*                                             log,
+    unsigned int                                        numThreads) const
+{
+    std::vector<TranslationResult> results(macroSets.size());
+
+    /* Scan source code only once (lexical errors are reported by each permutation, which reaches them) */
+    StringPool sourceStringPool;
+    SourceTokens sourceTokens;
+    {
+        HLSLPreprocessor scanner;
+        scanner.Tokenize(std::make_shared<SourceCode>(inputSource, inputSourceSize), sourceStringPool, sourceTokens);
+    }
+
+    /* Request each include file only once */
+    std::unique_ptr<SharedIncludeHandler> sharedIncludeHandler;
+    if (includeHandler)
+        sharedIncludeHandler = std::unique_ptr<SharedIncludeHandler>(new SharedIncludeHandler(includeHandler));
+
+    struct Permutation
+    {
+        BufferedLog                             preprocessLog;
+        BufferedLog                             generateLog;
+        bool                                    preprocessed    = false;
+        std::pair<std::uint64_t, std::uint64_t> tokenHash;
+        std::pair<std::uint64_t, std::uint64_t> positionHash;           //!< Hash of the token stream including the source positions.
+        std::size_t                             representative  = 0;    //!< Index of the first permutation with the same token stream (and source positions, if it reports messages).
+        std::unique_ptr<HLSLPreprocessor>       preprocessor;           //!< Keeps the tokens of the include files alive.
+        std::unique_ptr<StringPool>             stringPool;
+        std::vector<TokenPtr>                   tokens;                 //!< Preprocessed tokens (only kept for the representatives).
+    };
+
+    std::vector<Permutation> permutations(macroSets.size());
+
+    auto DefineMacros = [&](HLSLPreprocessor& preprocessor, std::size_t index)
+    {
+        auto macros = options.macros;
+        for (const auto& macro : macroSets[index])
+            macros[macro.first] = macro.second;
+
+        for (const auto& macro : macros)
+            preprocessor.DefineMacro(macro.first, macro.second);
+    };
+
+    /* Preprocess all permutations and determine the ones with equal token streams */
+    ParallelFor(
+        macroSets.size(), numThreads,
+        [&](std::size_t index)
+        {
+            auto& permutation = permutations[index];
+
+            permutation.preprocessor = std::unique_ptr<HLSLPreprocessor>(
+                new HLSLPreprocessor(sharedIncludeHandler.get(), &(tables_->includeCache), &(permutation.preprocessLog))
+            );
+            permutation.stringPool = std::unique_ptr<StringPool>(new StringPool());
+
+            DefineMacros(*permutation.preprocessor, index);
+
+            if (permutation.preprocessor->Process(sourceTokens, *permutation.stringPool, permutation.tokens))
+            {
+                permutation.preprocessed    = true;
+                permutation.tokenHash       = TokenStreamHash(permutation.tokens, options.lineMarks);
+                permutation.positionHash    = (options.lineMarks ? permutation.tokenHash : TokenStreamHash(permutation.tokens, true));
+            }
+        }
+    );
+
+    std::vector<std::size_t> uniquePermutations;
+    std::map<std::pair<std::uint64_t, std::uint64_t>, std::size_t> tokenHashes;
+
+    for (std::size_t i = 0; i < permutations.size(); ++i)
+    {
+        auto& permutation = permutations[i];
+        if (permutation.preprocessed)
+        {
+            permutation.representative = tokenHashes.insert({ permutation.tokenHash, i }).first->second;
+            if (permutation.representative == i)
+                uniquePermutations.push_back(i);
+        }
+
+        /*
+        Only keep the tokens of the representatives, and of the permutations whose tokens have other source positions
+        (they are translated on their own, if the messages of their representative refer to these positions)
+        */
+        if ( !permutation.preprocessed ||
+             ( permutation.representative != i && permutation.positionHash == permutations[permutation.representative].positionHash ) )
+        {
+            permutation.tokens.clear();
+            permutation.stringPool.reset();
+            permutation.preprocessor.reset();
+        }
+    }
+
+    auto TranslatePermutation = [&](std::size_t index)
+    {
+        auto& permutation = permutations[index];
+        auto& result = results[index];
+
+        /* Parse the tokens of the first pass */
+        auto startTime = std::chrono::steady_clock::now();
+
+        HLSLParser parser(&(permutation.generateLog));
+        auto program = parser.ParseTokens(permutation.tokens);
+
+        result.stats.parseTime = ElapsedTime(startTime);
+        result.stats.numTokens = parser.NumTokens();
+
+        if (!program)
+        {
+            permutation.generateLog.Error("parsing input code failed");
+            return;
+        }
+
+        result.succeeded = GenerateOutput(
+            *program, result.output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion,
+            sharedIncludeHandler.get(), options, &(permutation.generateLog), &(result.stats), &(result.reflection), nullptr, nullptr, false
+        );
+    };
+
+    /* Parse and generate each distinct token stream only once */
+    ParallelFor(
+        uniquePermutations.size(), numThreads,
+        [&](std::size_t uniqueIndex)
+        {
+            TranslatePermutation(uniquePermutations[uniqueIndex]);
+        }
+    );
+
+    /*
+    Translate the permutations with other source positions on their own, if their representative has reported any message
+    (and only once for each distinct token stream with its source positions)
+    */
+    std::vector<std::size_t> movedPermutations;
+    std::map<std::pair<std::uint64_t, std::uint64_t>, std::size_t> positionHashes;
+
+    for (std::size_t i = 0; i < permutations.size(); ++i)
+    {
+        auto& permutation = permutations[i];
+        if ( permutation.preprocessed && permutation.representative != i &&
+             permutation.positionHash != permutations[permutation.representative].positionHash )
+        {
+            if (!permutations[permutation.representative].generateLog.Empty())
+            {
+                permutation.representative = positionHashes.insert({ permutation.positionHash, i }).first->second;
+                if (permutation.representative == i)
+                {
+                    movedPermutations.push_back(i);
+                    continue;
+                }
+            }
+
+            permutation.tokens.clear();
+            permutation.stringPool.reset();
+            permutation.preprocessor.reset();
+        }
+    }
+
+    ParallelFor(
+        movedPermutations.size(), numThreads,
+        [&](std::size_t movedIndex)
+        {
+            TranslatePermutation(movedPermutations[movedIndex]);
+        }
+    );
+
+    /* Copy results of equal permutations and write all messages in the order of the permutations */
+    for (std::size_t i = 0; i < permutations.size(); ++i)
+    {
+        const auto& permutation = permutations[i];
+
+        if (permutation.preprocessed && permutation.representative != i)
+        {
+            results[i] = results[permutation.representative];
+            results[i].messages.Clear();
+        }
+
+        RecordingLog permutationLog(results[i].messages, log);
+
+        permutation.preprocessLog.Replay(permutationLog);
+        if (permutation.preprocessed)
+            permutations[permutation.representative].generateLog.Replay(permutationLog);
+        else
+            permutationLog.Error("parsing input code failed");
+    }
+
+    return results;
+}
+
+std::vector<TranslationResult> Translator::TranslatePipeline(
+    const char*                                         inputSource,
+    std::size_t                                         inputSourceSize,
+    const std::vector<PipelineStage>&                   stages,
+    const InputShaderVersions                           inputShaderVersion,
+    const OutputShaderVersions                          outputShaderVersion,
+    IncludeHandler*                                     includeHandler,
+    const Options&                                      options,
+    Logger*                                             log) const
+{
+    std::vector<TranslationResult> results(stages.size());
+
+    /* Parse source code only once for all stages */
+    auto program = Parse(std::make_shared<SourceCode>(inputSource, inputSourceSize), includeHandler, options, log, nullptr);
+    if (!program)
+        return results;
+
+    /* Unused varyings and their computations are removed by the dead code elimination */
+    auto pipelineOptions = options;
+    pipelineOptions.eliminateDeadCode = true;
+
+    /* Generate the stages in reverse order, so that the inputs of the next stage are known */
+    std::set<std::string> nextStageInputs;
+
+    for (auto i = stages.size(); i-- > 0;)
+    {
+        const auto& stage = stages[i];
+        auto& result = results[i];
+
+        StageVaryings varyings;
+        {
+            varyings.nextStageInputs    = (i + 1 < stages.size() ? &nextStageInputs : nullptr);
+            varyings.pruneInputs        = (i > 0);
+        }
+
+        RecordingLog stageLog(result.messages, log);
+
+        result.succeeded = GenerateOutput(
+            *program, result.output, stage.entryPoint, stage.shaderTarget, inputShaderVersion, outputShaderVersion,
+            includeHandler, pipelineOptions, &stageLog, &(result.stats), &(result.reflection), &varyings, nullptr, false
+        );
+
+        if (!result.succeeded)
+            break;
+
+        nextStageInputs = std::move(varyings.inputs);
+    }
+
+    return results;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+template <typename Output> bool Translator::GenerateOutput(
+    Program&                                program,
+    Output&                                 output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection,
+    StageVaryings*                          varyings,
+    DeclOutputCache*                        outputCache,
+    bool                                    releaseFunctionBodies) const
+{
+    /* Decorate and generate one function body after another, if the program is only used for this translation */
+    std::unique_ptr<FunctionBodyStream> bodyStream;
+    if (releaseFunctionBodies && !varyings && IsFunctionBodyStreamed(options))
+    {
+        bodyStream = std::unique_ptr<FunctionBodyStream>(
+            new FunctionBodyStream(program, entryPoint, shaderTarget, !options.lazyFunctionBodies, stats != nullptr, log)
+        );
+    }
+
+    /* Release the skipped bodies after this translation, if the program is used for further translations */
+    std::unique_ptr<TemporaryFunctionBodies> temporaryBodies;
+    if (!releaseFunctionBodies)
+        temporaryBodies = std::unique_ptr<TemporaryFunctionBodies>(new TemporaryFunctionBodies());
+
+    HLSLAnalyzer analyzer(tables_->analyzer, log);
+    if (!Analyze(
+            analyzer, program, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion,
+            options, log, stats, varyings, bodyStream.get(), temporaryBodies.get()))
+    {
         return false;
     }
 
-    /* Small context analysis */
-    HLSLAnalyzer analyzer(log);
-    if (!analyzer.DecorateAST(program.get(), entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, options))
+    /* Generate GLSL output code */
+    auto startTime = std::chrono::steady_clock::now();
+
+    GLSLGenerator generator(tables_->generator, log, includeHandler, options);
+    if (bodyStream)
+    {
+        bodyStream->BeginGeneration(analyzer);
+        generator.SetStreamHandler(bodyStream.get());
+    }
+    generator.SetOutputCache(outputCache);
+
+    auto result = generator.GenerateCode(&program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion);
+
+    if (stats)
+    {
+        stats->generateTime = ElapsedTime(startTime);
+        stats->outputBytes  = generator.OutputSize();
+    }
+
+    if (!result)
     {
         if (log)
-            log->Error("analyzing input code failed");
+            log->Error("generating output code failed");
         return false;
     }
 
-    /* Print debug output */
-    if (options.dumpAST && log)
+    if (reflection)
+        generator.Reflect(*reflection);
+
+    return true;
+}
+
+bool Translator::GenerateCached(
+    Program&                                program,
+    std::string&                            output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    DeclOutputCache*                        outputCache) const
+{
+    return GenerateOutput(
+        program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, nullptr, nullptr, outputCache, false
+    );
+}
+
+bool Translator::Translate(
+    const std::shared_ptr<SourceCode>&      source,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    ShaderReflection*                       reflection) const
+{
+    auto program = Parse(source, includeHandler, options, log, stats);
+    if (!program)
+        return false;
+
+    return GenerateOutput(
+        *program, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log, stats, reflection, nullptr, nullptr, true
+    );
+}
+
+std::shared_ptr<Program> Translator::Parse(
+    const std::shared_ptr<SourceCode>&      source,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats) const
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    /* Parse HLSL input code (optionally with the preprocessor) */
+    HLSLParser parser(log);
+    parser.MeasureScanTime(stats != nullptr);
+    parser.EnableLazyFunctionBodies(options.lazyFunctionBodies || IsFunctionBodyStreamed(options));
+    parser.EnableBodyArenas(IsFunctionBodyStreamed(options));
+
+    ProgramPtr program;
+    double scanTime = 0.0, preprocessTime = 0.0;
+    std::size_t numTokens = 0;
+
+    if (options.preprocess)
     {
-        ASTPrinter dumper;
-        dumper.DumpAST(program.get(), *log);
+        HLSLPreprocessor preprocessor(includeHandler, &(tables_->includeCache), log);
+
+        for (const auto& macro : options.macros)
+            preprocessor.DefineMacro(macro.first, macro.second);
+
+        StringPool stringPool;
+        std::vector<TokenPtr> tokens;
+
+        if (preprocessor.Process(source, stringPool, tokens))
+        {
+            scanTime        = preprocessor.ScanTime();
+            preprocessTime  = ElapsedTime(startTime) - scanTime;
+            program         = parser.ParseTokens(tokens);
+            numTokens       = parser.NumTokens();
+        }
     }
+    else
+    {
+        /* Parse large sources concurrently, but parse the entire source again if any chunk failed (for the same log) */
+        if (options.parserThreads != 1)
+            program = ParseSourceConcurrent(*source, options, stats != nullptr, scanTime, numTokens);
 
-    /* Generate GLSL output code */
-    GLSLGenerator generator(log, includeHandler, options);
-    if (!generator.GenerateCode(program.get(), output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion))
+        if (!program)
+        {
+            program     = parser.ParseSource(source);
+            scanTime    = parser.ScanTime();
+            numTokens   = parser.NumTokens();
+        }
+    }
+
+    if (stats)
+    {
+        stats->scanTime         = scanTime;
+        stats->preprocessTime   = preprocessTime;
+        stats->parseTime        = ElapsedTime(startTime) - scanTime - preprocessTime;
+        stats->numTokens        = numTokens;
+    }
+
+    if (!program && log)
+        log->Error("parsing input code failed");
+
+    return program;
+}
+
+bool Translator::Analyze(
+    HLSLAnalyzer&                           analyzer,
+    Program&                                program,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    const Options&                          options,
+    Logger*                                 log,
+    TranslationStats*                       stats,
+    StageVaryings*                          varyings,
+    FunctionBodyStream*                     bodyStream,
+    TemporaryFunctionBodies*                temporaryBodies) const
+{
+    /*
+    Parse all function bodies which are reachable from the entry point (if they have been skipped by the parser),
+    or all of them, if they have only been skipped for a streamed translation, which parses them during the analysis instead
+    */
+    auto startTime = std::chrono::steady_clock::now();
+
+    if (!bodyStream)
+    {
+        HLSLParser parser(log);
+        parser.MeasureScanTime(stats != nullptr);
+
+        /* Temporary bodies are parsed into their own arenas and keep their source, so they can be released and parsed again */
+        parser.EnableBodyArenas(temporaryBodies != nullptr);
+
+        const bool parseAllBodies = (!options.lazyFunctionBodies && IsFunctionBodyStreamed(options));
+        if (!ParseReachableFunctionBodies(
+                program, entryPoint, shaderTarget, parseAllBodies, parser,
+                (temporaryBodies != nullptr ? &(temporaryBodies->functions) : nullptr)))
+        {
+            if (log)
+                log->Error("parsing function bodies failed");
+            return false;
+        }
+
+        if (stats)
+        {
+            auto scanTime = parser.ScanTime();
+            stats->scanTime     += scanTime;
+            stats->parseTime    += ElapsedTime(startTime) - scanTime;
+            stats->numTokens    += parser.NumTokens();
+        }
+    }
+
+    if (stats)
+        RecordProgramStats(program, *stats);
+
+    /* Small context analysis */
+    startTime = std::chrono::steady_clock::now();
+
+    auto result = analyzer.DecorateAST(&program, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, options, varyings, bodyStream);
+
+    if (stats)
+    {
+        stats->referenceTime    = analyzer.ReferenceAnalysisTime();
+        stats->analyzeTime      = ElapsedTime(startTime) - stats->referenceTime;
+        if (bodyStream)
+            stats->numTokens += bodyStream->Parser().NumTokens();
+    }
+
+    if (!result)
     {
         if (log)
-            log->Error("generating output code failed");
+            log->Error(bodyStream && bodyStream->HasParsingFailed() ? "parsing function bodies failed" : "analyzing input code failed");
         return false;
     }
 
+    /* Print debug output */
+    if (options.dumpAST && log)
+    {
+        ASTPrinter dumper;
+        dumper.DumpAST(&program, *log);
+    }
+
     return true;
 }
 
 
+/*
+ * Global functions
+ */
+
+static const Translator& GlobalTranslator()
+{
+    static const Translator translator;
+    return translator;
+}
+
+_HT_EXPORT_ bool TranslateHLSLtoGLSL(
+    const std::shared_ptr<std::istream>&    input,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log)
+{
+    return GlobalTranslator().Translate(
+        input, output, entryPoint, shaderTarget, inputShaderVersion, outputShaderVersion, includeHandler, options, log
+    );
+}
+
+_HT_EXPORT_ bool TranslateHLSLtoGLSL(
+    const char*                             inputSource,
+    std::size_t                             inputSourceSize,
+    std::ostream&                           output,
+    const std::string&                      entryPoint,
+    const ShaderTargets                     shaderTarget,
+    const InputShaderVersions               inputShaderVersion,
+    const OutputShaderVersions              outputShaderVersion,
+    IncludeHandler*                         includeHandler,
+    const Options&                          options,
+    Logger*                                 log)
+{
+    return GlobalTranslator().Translate(
+        inputSource, inputSourceSize, output, entryPoint, shaderTarget,
+        inputShaderVersion, outputShaderVersion, includeHandler, options, log
+    );
+}
+
+
 } // /namespace HTLib
 
 
@@ -16,18 +16,24 @@ namespace HTLib
 {
 
 
-// Declare all AST node classes
+/*
+Declare all AST node classes.
+All nodes (except the program root) are allocated by the "ASTArena" of their program,
+so the node pointers are non-owning raw pointers.
+*/
 
 #define DECL_PTR(className)                             \
     struct className;                                   \
-    typedef std::shared_ptr<className> className##Ptr
+    typedef className* className##Ptr
 
 DECL_PTR( AST               );
 DECL_PTR( GlobalDecl        );
 DECL_PTR( Stmnt             );
 DECL_PTR( Expr              );
 
-DECL_PTR( Program           );
+struct Program;
+typedef std::shared_ptr<Program> ProgramPtr;
+
 DECL_PTR( CodeBlock         );
 DECL_PTR( BufferDeclIdent   );
 DECL_PTR( FunctionCall      );
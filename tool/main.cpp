@@ -9,7 +9,18 @@
 #include <fstream>
 #include <iostream>
 #include <vector>
+#include <iterator>
+#include <sstream>
+#include <cstdio>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <cctype>
 #include <HT/Translator.h>
+#include <HT/TranslationCache.h>
 
 
 using namespace HTLib;
@@ -49,37 +60,37 @@ class OutputLog : public Logger
                 indent_.resize(indent_.size() - indentTab_.size());
         }
 
-        void Report()
+        void Report(std::ostream& out, std::ostream& err)
         {
             for (const auto& msg : infos_)
-                std::cout << msg << std::endl;
+                out << msg << std::endl;
             infos_.clear();
             
             if (!warnings_.empty())
             {
-                PrintHead(std::to_string(warnings_.size()) + " WARNING(S)");
+                PrintHead(out, std::to_string(warnings_.size()) + " WARNING(S)");
 
                 for (const auto& msg : warnings_)
-                    std::cout << msg << std::endl;
+                    out << msg << std::endl;
                 warnings_.clear();
             }
 
             if (!errors_.empty())
             {
-                PrintHead(std::to_string(errors_.size()) + " ERROR(S)");
+                PrintHead(out, std::to_string(errors_.size()) + " ERROR(S)");
 
                 for (const auto& msg : errors_)
-                    std::cerr << msg << std::endl;
+                    err << msg << std::endl;
                 errors_.clear();
             }
         }
 
     private:
 
-        void PrintHead(const std::string& head)
+        void PrintHead(std::ostream& out, const std::string& head)
         {
-            std::cout << head << std::endl;
-            std::cout << std::string(head.size(), '-') << std::endl;
+            out << head << std::endl;
+            out << std::string(head.size(), '-') << std::endl;
         }
         
         std::vector<std::string> infos_;
@@ -104,14 +115,29 @@ class IncludeStreamHandler : public IncludeHandler
 };
 
 
+//! Translation settings of the command line or of a server request.
+struct Settings
+{
+    std::string entry;
+    std::string target;
+    std::string shaderIn    = "HLSL5";
+    std::string shaderOut   = "GLSL330";
+    std::string output;
+    std::string cacheDir;
+    Options     options;
+    bool        printStats  = false;
+    bool        reflect     = false;
+
+    //! Entry points and targets (e.g. "vertex") of a pipeline translation; empty for a single translation.
+    std::vector<std::pair<std::string, std::string>> pipeline;
+};
+
+
 /* --- Globals --- */
 
-std::string entry;
-std::string target;
-std::string shaderIn = "HLSL5";
-std::string shaderOut = "GLSL330";
-std::string output;
-Options options;
+std::string statsFile;
+std::vector<std::string> statsRecords;
+std::mutex statsMutex;
 
 
 /* --- Functions --- */
@@ -141,7 +167,8 @@ static void ShowHelp()
             "    HLSL3, HLSL4, HLSL5",
             "  -shaderout VERSION ..... GLSL version; default is GLSL330; valid values:",
             "    GLSL110, GLSL120, GLSL130, GLSL140, GLSL150, GLSL330,",
-            "    GLSL400, GLSL410, GLSL420, GLSL430, GLSL440, GLSL450",
+            "    GLSL400, GLSL410, GLSL420, GLSL430, GLSL440, GLSL450,",
+            "    VKSL450 (GLSL for Vulkan), ESSL300, ESSL310 (GLSL ES)",
             "  -indent INDENT ......... Code indentation string; by default 4 spaces",
             "  -prefix PREFIX ......... Prefix for local variables (use \"<none>\" to disable); by default '_'",
             "  -output FILE ........... GLSL output file; default is '<FILE>.<ENTRY>.glsl'",
@@ -149,6 +176,37 @@ static void ShowHelp()
             "  -blanks [on|off] ....... Enables/disables generation of blank lines between declarations; by default on",
             "  -line-marks [on|off] ... Enables/disables generation of line marks (e.g. '#line 30'); by default off",
             "  -dump-ast [on|off] ..... Enables/disables debug output for the entire abstract syntax tree (AST)",
+            "  -time-stamp [on|off] ... Enables/disables the time stamp in the header comment; by default on",
+            "  -cache DIR ............. Caches translations in the existing directory DIR (use with '-time-stamp off')",
+            "  -preprocess [on|off] ... Enables/disables the built-in preprocessor for macros and includes; by default off",
+            "  -D NAME[=VALUE] ........ Defines the macro NAME (with VALUE or 1) for the preprocessor",
+            "  -dce [on|off] .......... Enables/disables dead code elimination (unused locals, unreachable code); by default off",
+            "  -fold [on|off] ......... Enables/disables constant folding and propagation of constant local variables; by default off",
+            "  -lazy [on|off] ......... Enables/disables parsing of function bodies only if they are reachable from the entry point; by default off",
+            "  -minify [on|off] ....... Enables/disables minified output (no comments and white spaces, short local names); by default off",
+            "  -reflect [on|off] ...... Enables/disables writing the reflection (bindings, uniform offsets, inputs, outputs) into",
+            "                           '<OUTPUT>.json' and '<OUTPUT>.refl' (binary), where OUTPUT has no extension;",
+            "                           translations with reflection bypass the cache; by default off",
+            "  -explicit-binding [on|off] Enables/disables explicit bindings and locations for GLSL420 and above; by default off",
+            "  -binding-offset C=N .... Adds N to the bindings of the register class C (b or t), e.g. '-binding-offset t=8'",
+            "  -descriptor-set N ...... Descriptor set of all resources for VKSL450; by default 0",
+            "  -push-constant-size N .. Writes the first uniform buffer with at most N bytes as push constants for VKSL450;",
+            "                           by default 0 (disabled)",
+            "  -precision P ........... Default precision (low, medium or high) of the types without a precision qualifier",
+            "                           for ESSL300 and ESSL310; by default high",
+            "  -pipeline E:T[,E:T]* ... Translates the entry points E with the targets T of the next file as one pipeline",
+            "                           (in pipeline order) and removes the varyings which are not read by the next stage,",
+            "                           e.g. '-pipeline VS:vertex,PS:fragment'; writes '<FILE>.<T>.glsl' for each stage",
+            "  -parse-threads N ....... Number of threads for the parsing of a single large shader (0 for the number of cores); by default 1",
+            "  -gen-threads N ......... Number of threads for the code generation of a single shader (0 for the number of cores); by default 1",
+            "  -stream [on|off] ....... Enables/disables parsing, analyzing and generating one function body at a time and writing",
+            "                           the output after each declaration (for huge shaders); by default off",
+            "  -stats [on|off] ........ Enables/disables printing of the translation statistics (timings and sizes); by default off",
+            "  -stats-json FILE ....... Writes the statistics of all translations as JSON array into FILE",
+            "  -server ................ Runs as server, which reads one translation request per line from stdin",
+            "                           (with the same options and files as the command line) and writes framed responses",
+            "                           (\"@begin ID\" ... \"@end ID ok|failed\") to stdout; the request ID counts from 1",
+            "  -server-threads N ...... Number of threads for concurrent server requests; by default the number of cores",
             "  --help, help, -h ....... Prints this help reference",
             "  --version, -v .......... Prints the version information",
             "Example:",
@@ -216,6 +274,9 @@ static OutputShaderVersions OutputVersionFromString(const std::string& version)
     CHECK_OUT_VER(GLSL430);
     CHECK_OUT_VER(GLSL440);
     CHECK_OUT_VER(GLSL450);
+    CHECK_OUT_VER(VKSL450);
+    CHECK_OUT_VER(ESSL300);
+    CHECK_OUT_VER(ESSL310);
 
     #undef CHECK_OUT_VER
 
@@ -223,16 +284,29 @@ static OutputShaderVersions OutputVersionFromString(const std::string& version)
     return OutputShaderVersions::GLSL110;
 }
 
-static std::string NextArg(int& i, int argc, char** argv, const std::string& flag)
+static Precisions PrecisionFromString(const std::string& precision)
+{
+    if (precision == "low")
+        return Precisions::Low;
+    if (precision == "medium")
+        return Precisions::Medium;
+    if (precision == "high")
+        return Precisions::High;
+
+    throw std::runtime_error("invalid precision \"" + precision + "\" (must be 'low', 'medium' or 'high')");
+    return Precisions::High;
+}
+
+static std::string NextArg(std::size_t& i, const std::vector<std::string>& args, const std::string& flag)
 {
-    if (i + 1 >= argc)
+    if (i + 1 >= args.size())
         throw std::runtime_error("missing next argument after flag \"" + flag + "\"");
-    return argv[++i];
+    return args[++i];
 }
 
-static bool BoolArg(int& i, int argc, char** argv, const std::string& flag)
+static bool BoolArg(std::size_t& i, const std::vector<std::string>& args, const std::string& flag)
 {
-    auto arg = NextArg(i, argc, argv, flag);
+    auto arg = NextArg(i, args, flag);
     
     if (arg == "on")
         return true;
@@ -249,8 +323,223 @@ static std::string ExtractFilename(const std::string& filename)
     return pos == std::string::npos ? filename : filename.substr(0, pos);
 }
 
-static void Translate(const std::string& filename)
+static std::string JSONString(const std::string& str)
+{
+    std::string result = "\"";
+
+    for (auto chr : str)
+    {
+        switch (chr)
+        {
+            case '\"': result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(chr) < 0x20)
+                {
+                    char hex[8];
+                    std::snprintf(hex, sizeof(hex), "\\u%04x", static_cast<unsigned char>(chr));
+                    result += hex;
+                }
+                else
+                    result += chr;
+                break;
+        }
+    }
+
+    return result + "\"";
+}
+
+static void PrintStats(std::ostream& out, const TranslationStats& stats)
+{
+    auto PrintTime = [&out](const std::string& name, double seconds)
+    {
+        out << "  " << name << std::string(name.size() < 20 ? 20 - name.size() : 1, ' ') << (seconds * 1000.0) << " ms" << std::endl;
+    };
+
+    out << "statistics:" << std::endl;
+
+    PrintTime("scan", stats.scanTime);
+    PrintTime("preprocess", stats.preprocessTime);
+    PrintTime("parse", stats.parseTime);
+    PrintTime("analyze", stats.analyzeTime);
+    PrintTime("reference analysis", stats.referenceTime);
+    PrintTime("generate", stats.generateTime);
+
+    out << "  tokens              " << stats.numTokens << std::endl;
+    out << "  AST nodes           " << stats.numNodes << std::endl;
+    out << "  arena               " << stats.arenaBytes << " bytes used, " << stats.arenaReservedBytes << " bytes reserved" << std::endl;
+    out << "  output              " << stats.outputBytes << " bytes" << std::endl;
+
+    for (const auto& nodes : stats.numNodesByType)
+        out << "    " << nodes.first << std::string(nodes.first.size() < 20 ? 20 - nodes.first.size() : 1, ' ') << nodes.second << std::endl;
+}
+
+static std::string StatsToJSON(const Settings& settings, const std::string& filename, bool result, bool cacheHit, const TranslationStats& stats)
 {
+    std::ostringstream json;
+
+    json << "  {" << std::endl;
+    json << "    \"file\": " << JSONString(filename) << "," << std::endl;
+    json << "    \"entry\": " << JSONString(settings.entry) << "," << std::endl;
+    json << "    \"target\": " << JSONString(settings.target) << "," << std::endl;
+    json << "    \"succeeded\": " << (result ? "true" : "false") << "," << std::endl;
+    json << "    \"cacheHit\": " << (cacheHit ? "true" : "false") << "," << std::endl;
+    json << "    \"scanTime\": " << stats.scanTime << "," << std::endl;
+    json << "    \"preprocessTime\": " << stats.preprocessTime << "," << std::endl;
+    json << "    \"parseTime\": " << stats.parseTime << "," << std::endl;
+    json << "    \"analyzeTime\": " << stats.analyzeTime << "," << std::endl;
+    json << "    \"referenceTime\": " << stats.referenceTime << "," << std::endl;
+    json << "    \"generateTime\": " << stats.generateTime << "," << std::endl;
+    json << "    \"numTokens\": " << stats.numTokens << "," << std::endl;
+    json << "    \"numNodes\": " << stats.numNodes << "," << std::endl;
+    json << "    \"arenaBytes\": " << stats.arenaBytes << "," << std::endl;
+    json << "    \"arenaReservedBytes\": " << stats.arenaReservedBytes << "," << std::endl;
+    json << "    \"outputBytes\": " << stats.outputBytes << "," << std::endl;
+    json << "    \"numNodesByType\": {";
+
+    for (auto it = stats.numNodesByType.begin(); it != stats.numNodesByType.end(); ++it)
+        json << (it == stats.numNodesByType.begin() ? " " : ", ") << JSONString(it->first) << ": " << it->second;
+
+    json << " }" << std::endl;
+    json << "  }";
+
+    return json.str();
+}
+
+static void WriteStatsFile()
+{
+    std::ofstream file(statsFile);
+    if (!file.good())
+    {
+        std::cerr << "failed to write statistics file \"" << statsFile << "\"" << std::endl;
+        return;
+    }
+
+    file << "[" << std::endl;
+
+    for (std::size_t i = 0; i < statsRecords.size(); ++i)
+        file << statsRecords[i] << (i + 1 < statsRecords.size() ? "," : "") << std::endl;
+
+    file << "]" << std::endl;
+}
+
+//! Writes the reflection as JSON and in the binary format next to the specified output file.
+static void WriteReflectionFiles(const std::string& output, const ShaderReflection& reflection, std::ostream& err)
+{
+    const auto filename = ExtractFilename(output);
+
+    std::string json;
+    WriteReflectionJSON(reflection, json);
+
+    std::string binary;
+    WriteReflectionBinary(reflection, binary);
+
+    std::ofstream jsonFile(filename + ".json");
+    jsonFile << json;
+
+    std::ofstream binaryFile(filename + ".refl", std::ios::binary);
+    binaryFile.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+
+    if (!jsonFile.good() || !binaryFile.good())
+        err << "failed to write reflection of \"" << output << "\"" << std::endl;
+}
+
+//! Returns the translator, which (with its include cache) is shared by all translations, also by concurrent server requests.
+static const Translator& SharedTranslator()
+{
+    static const Translator translator;
+    return translator;
+}
+
+//! Translates the specified file for all stages of the pipeline in the specified settings, and returns true on success.
+static bool TranslatePipeline(const std::string& filename, Settings settings, std::ostream& out, std::ostream& err)
+{
+    auto& options = settings.options;
+
+    if (options.prefix == "<none>")
+        options.prefix.clear();
+
+    std::vector<PipelineStage> stages;
+    std::vector<std::string> outputs;
+
+    for (const auto& stage : settings.pipeline)
+    {
+        PipelineStage pipelineStage;
+        {
+            pipelineStage.entryPoint    = stage.first;
+            pipelineStage.shaderTarget  = TargetFromString(stage.second);
+        }
+        stages.push_back(pipelineStage);
+        outputs.push_back(ExtractFilename(filename) + "." + stage.second + ".glsl");
+    }
+
+    out << "translate pipeline from " << filename << std::endl;
+
+    std::ifstream inputStream(filename);
+    std::string source { std::istreambuf_iterator<char>(inputStream), std::istreambuf_iterator<char>() };
+
+    OutputLog log;
+    IncludeStreamHandler includeHandler;
+
+    auto results = SharedTranslator().TranslatePipeline(
+        source.data(),
+        source.size(),
+        stages,
+        InputVersionFromString(settings.shaderIn),
+        OutputVersionFromString(settings.shaderOut),
+        &includeHandler,
+        options,
+        &log
+    );
+
+    log.Report(out, err);
+
+    bool result = true;
+
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        if (results[i].succeeded)
+        {
+            out << "translation of " << stages[i].entryPoint << " to " << outputs[i] << " successful" << std::endl;
+
+            std::ofstream outputStream(outputs[i]);
+            outputStream << results[i].output;
+
+            if (settings.reflect)
+                WriteReflectionFiles(outputs[i], results[i].reflection, err);
+            if (settings.printStats)
+                PrintStats(out, results[i].stats);
+        }
+        else
+            result = false;
+    }
+
+    return result;
+}
+
+//! Translates the specified file with the specified settings, and returns true on success.
+static bool Translate(const std::string& filename, Settings settings, std::ostream& out, std::ostream& err)
+{
+    if (!settings.pipeline.empty())
+    {
+        try
+        {
+            return TranslatePipeline(filename, settings, out, err);
+        }
+        catch (const std::exception& e)
+        {
+            err << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    auto& output = settings.output;
+    auto& entry = settings.entry;
+    auto& target = settings.target;
+    auto& options = settings.options;
+
     if (output.empty())
     {
         /* Set default output filename */
@@ -271,7 +560,7 @@ static void Translate(const std::string& filename)
     }
 
     /* Translate HLSL file into GLSL */
-    std::cout << "translate from " << filename << " to " << output << std::endl;
+    out << "translate from " << filename << " to " << output << std::endl;
 
     auto inputStream = std::make_shared<std::ifstream>(filename);
     std::ofstream outputStream(output);
@@ -279,29 +568,351 @@ static void Translate(const std::string& filename)
     OutputLog log;
     IncludeStreamHandler includeHandler;
 
+    const auto& translator = SharedTranslator();
+
+    const bool measureStats = (settings.printStats || !statsFile.empty());
+    TranslationStats stats;
+    ShaderReflection reflection;
+
+    bool result = false;
+
     try
     {
-        auto result = TranslateHLSLtoGLSL(
-            inputStream,
-            outputStream,
-            entry,
-            TargetFromString(target),
-            InputVersionFromString(shaderIn),
-            OutputVersionFromString(shaderOut),
-            &includeHandler,
-            options,
-            &log
-        );
-
-        log.Report();
+        bool cacheHit = false;
+
+        if (!settings.cacheDir.empty() && !settings.reflect)
+        {
+            /* Translate with translation cache (which does not store the reflection) */
+            TranslationCache cache(settings.cacheDir);
+
+            std::string source { std::istreambuf_iterator<char>(*inputStream), std::istreambuf_iterator<char>() };
+
+            result = cache.Translate(
+                translator,
+                source.data(),
+                source.size(),
+                outputStream,
+                entry,
+                TargetFromString(target),
+                InputVersionFromString(settings.shaderIn),
+                OutputVersionFromString(settings.shaderOut),
+                &includeHandler,
+                options,
+                &log,
+                &cacheHit,
+                (measureStats ? &stats : nullptr)
+            );
+
+            if (cacheHit)
+                out << "loaded from cache" << std::endl;
+        }
+        else
+        {
+            result = translator.Translate(
+                inputStream,
+                outputStream,
+                entry,
+                TargetFromString(target),
+                InputVersionFromString(settings.shaderIn),
+                OutputVersionFromString(settings.shaderOut),
+                &includeHandler,
+                options,
+                &log,
+                (measureStats ? &stats : nullptr),
+                (settings.reflect ? &reflection : nullptr)
+            );
+        }
+
+        log.Report(out, err);
 
         if (result)
-            std::cout << "translation successful" << std::endl;
+        {
+            out << "translation successful" << std::endl;
+            if (settings.reflect)
+                WriteReflectionFiles(output, reflection, err);
+        }
+
+        if (settings.printStats)
+            PrintStats(out, stats);
+
+        if (!statsFile.empty())
+        {
+            std::lock_guard<std::mutex> guard(statsMutex);
+            statsRecords.push_back(StatsToJSON(settings, filename, result, cacheHit, stats));
+        }
+    }
+    catch (const std::exception& e)
+    {
+        err << e.what() << std::endl;
+        result = false;
+    }
+
+    return result;
+}
+
+/**
+Parses the translation setting at the specified argument index.
+\return False if the argument is not a translation setting (i.e. it's a filename or a command line flag).
+*/
+static bool ParseSettingArg(std::size_t& i, const std::vector<std::string>& args, Settings& settings)
+{
+    const auto& arg = args[i];
+    auto& options = settings.options;
+
+    if (arg == "-warn")
+        options.warnings = BoolArg(i, args, arg);
+    else if (arg == "-blanks")
+        options.blanks = BoolArg(i, args, arg);
+    else if (arg == "-line-marks")
+        options.lineMarks = BoolArg(i, args, arg);
+    else if (arg == "-dump-ast")
+        options.dumpAST = BoolArg(i, args, arg);
+    else if (arg == "-time-stamp")
+        options.timeStamp = BoolArg(i, args, arg);
+    else if (arg == "-cache")
+        settings.cacheDir = NextArg(i, args, arg);
+    else if (arg == "-stats")
+        settings.printStats = BoolArg(i, args, arg);
+    else if (arg == "-preprocess")
+        options.preprocess = BoolArg(i, args, arg);
+    else if (arg == "-dce")
+        options.eliminateDeadCode = BoolArg(i, args, arg);
+    else if (arg == "-fold")
+        options.foldConstants = BoolArg(i, args, arg);
+    else if (arg == "-lazy")
+        options.lazyFunctionBodies = BoolArg(i, args, arg);
+    else if (arg == "-minify")
+        options.minify = BoolArg(i, args, arg);
+    else if (arg == "-reflect")
+        settings.reflect = BoolArg(i, args, arg);
+    else if (arg == "-explicit-binding")
+        options.explicitBinding = BoolArg(i, args, arg);
+    else if (arg == "-binding-offset")
+    {
+        auto offset = NextArg(i, args, arg);
+        auto assignPos = offset.find('=');
+
+        if (assignPos == 1)
+            options.bindingOffsets[offset[0]] = static_cast<unsigned int>(std::atoi(offset.c_str() + 2));
+        else
+            throw std::runtime_error("invalid binding offset \"" + offset + "\" (expected CLASS=N, e.g. t=8)");
+    }
+    else if (arg == "-descriptor-set")
+        options.descriptorSet = static_cast<unsigned int>(std::atoi(NextArg(i, args, arg).c_str()));
+    else if (arg == "-push-constant-size")
+        options.pushConstantSize = static_cast<unsigned int>(std::atoi(NextArg(i, args, arg).c_str()));
+    else if (arg == "-precision")
+        options.defaultPrecision = PrecisionFromString(NextArg(i, args, arg));
+    else if (arg == "-pipeline")
+    {
+        /* Parse comma separated list of "ENTRY:TARGET" pairs */
+        std::istringstream list(NextArg(i, args, arg));
+        std::string stage;
+
+        settings.pipeline.clear();
+
+        while (std::getline(list, stage, ','))
+        {
+            auto colonPos = stage.find(':');
+            if (colonPos == std::string::npos || colonPos == 0 || colonPos + 1 == stage.size())
+                throw std::runtime_error("invalid pipeline stage \"" + stage + "\" (expected ENTRY:TARGET, e.g. VS:vertex)");
+            settings.pipeline.push_back({ stage.substr(0, colonPos), stage.substr(colonPos + 1) });
+        }
+    }
+    else if (arg == "-parse-threads")
+        options.parserThreads = static_cast<unsigned int>(std::atoi(NextArg(i, args, arg).c_str()));
+    else if (arg == "-gen-threads")
+        options.generatorThreads = static_cast<unsigned int>(std::atoi(NextArg(i, args, arg).c_str()));
+    else if (arg == "-stream")
+        options.streamOutput = BoolArg(i, args, arg);
+    else if (arg == "-D")
+    {
+        auto macro = NextArg(i, args, arg);
+        auto assignPos = macro.find('=');
+
+        if (assignPos != std::string::npos)
+            options.macros[macro.substr(0, assignPos)] = macro.substr(assignPos + 1);
+        else
+            options.macros[macro] = "1";
+    }
+    else if (arg == "-entry")
+        settings.entry = NextArg(i, args, arg);
+    else if (arg == "-target")
+        settings.target = NextArg(i, args, arg);
+    else if (arg == "-shaderin")
+        settings.shaderIn = NextArg(i, args, arg);
+    else if (arg == "-shaderout")
+        settings.shaderOut = NextArg(i, args, arg);
+    else if (arg == "-indent")
+        options.indent = NextArg(i, args, arg);
+    else if (arg == "-prefix")
+        options.prefix = NextArg(i, args, arg);
+    else if (arg == "-output")
+        settings.output = NextArg(i, args, arg);
+    else
+        return false;
+
+    return true;
+}
+
+//! Resets the settings which only apply to the next file.
+static void ResetFileSettings(Settings& settings)
+{
+    settings.output.clear();
+    settings.target.clear();
+    settings.entry.clear();
+    settings.pipeline.clear();
+}
+
+//! Splits the specified request line into its arguments (arguments with spaces can be enclosed in double quotes).
+static std::vector<std::string> SplitArgs(const std::string& line)
+{
+    std::vector<std::string> args;
+    std::string arg;
+    bool hasArg = false, quoted = false;
+
+    for (auto chr : line)
+    {
+        if (chr == '\"')
+        {
+            quoted = !quoted;
+            hasArg = true;
+        }
+        else if (!quoted && std::isspace(static_cast<unsigned char>(chr)))
+        {
+            if (hasArg)
+                args.push_back(arg);
+            arg.clear();
+            hasArg = false;
+        }
+        else
+        {
+            arg += chr;
+            hasArg = true;
+        }
+    }
+
+    if (hasArg)
+        args.push_back(arg);
+
+    return args;
+}
+
+//! Processes a single server request and returns true if all translations of this request succeeded.
+static bool ProcessRequest(const std::string& line, const Settings& defaultSettings, std::ostream& out)
+{
+    auto args = SplitArgs(line);
+    auto settings = defaultSettings;
+    bool result = true;
+    int translationCounter = 0;
+
+    try
+    {
+        for (std::size_t i = 0; i < args.size(); ++i)
+        {
+            if (!ParseSettingArg(i, args, settings))
+            {
+                result = (Translate(args[i], settings, out, out) && result);
+                ResetFileSettings(settings);
+                ++translationCounter;
+            }
+        }
     }
     catch (const std::exception& err)
     {
-        std::cerr << err.what() << std::endl;
+        out << err.what() << std::endl;
+        return false;
+    }
+
+    if (translationCounter == 0)
+    {
+        out << "no input file in request" << std::endl;
+        return false;
+    }
+
+    return result;
+}
+
+/**
+Runs the translator as server: each line of stdin is a request with the same options and files as the command line.
+The requests are processed concurrently, and the output of each request is written as one frame to stdout.
+The server runs until the end of stdin or until the request "quit".
+*/
+static void RunServer(const Settings& defaultSettings, unsigned int numThreads)
+{
+    struct Request
+    {
+        std::size_t id;
+        std::string line;
+    };
+
+    std::deque<Request> requests;
+    std::mutex requestMutex;
+    std::condition_variable requestAvailable;
+    bool finished = false;
+
+    std::mutex outputMutex;
+
+    auto WorkerLoop = [&]()
+    {
+        while (true)
+        {
+            Request request;
+
+            {
+                std::unique_lock<std::mutex> lock(requestMutex);
+                requestAvailable.wait(lock, [&]() { return finished || !requests.empty(); });
+
+                if (requests.empty())
+                    return;
+
+                request = std::move(requests.front());
+                requests.pop_front();
+            }
+
+            std::ostringstream frame;
+            auto result = ProcessRequest(request.line, defaultSettings, frame);
+
+            /* Write the entire response as one frame */
+            std::lock_guard<std::mutex> guard(outputMutex);
+            std::cout << "@begin " << request.id << std::endl;
+            std::cout << frame.str();
+            std::cout << "@end " << request.id << (result ? " ok" : " failed") << std::endl;
+        }
+    };
+
+    if (numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < numThreads; ++i)
+        workers.emplace_back(WorkerLoop);
+
+    /* Read requests line by line */
+    std::size_t requestCounter = 0;
+    std::string line;
+
+    while (std::getline(std::cin, line))
+    {
+        if (line == "quit")
+            break;
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+
+        std::lock_guard<std::mutex> guard(requestMutex);
+        requests.push_back({ ++requestCounter, line });
+        requestAvailable.notify_one();
+    }
+
+    /* Process remaining requests and stop the workers */
+    {
+        std::lock_guard<std::mutex> guard(requestMutex);
+        finished = true;
     }
+    requestAvailable.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
 }
 
 
@@ -312,50 +923,37 @@ int main(int argc, char** argv)
     int translationCounter = 0;
     bool showHelp = false;
     bool showVersion = false;
+    bool runServer = false;
+    unsigned int serverThreads = 0;
+
+    Settings settings;
+    std::vector<std::string> args(argv + 1, argv + argc);
 
     /* Parse program arguments */
-    for (int i = 1; i < argc; ++i)
+    for (std::size_t i = 0; i < args.size(); ++i)
     {
         try
         {
-            auto arg = std::string(argv[i]);
+            const auto& arg = args[i];
 
             if (arg == "help" || arg == "--help" || arg == "-h")
                 showHelp = true;
             else if (arg == "--version" || arg == "-v")
                 showVersion = true;
-            else if (arg == "-warn")
-                options.warnings = BoolArg(i, argc, argv, arg);
-            else if (arg == "-blanks")
-                options.blanks = BoolArg(i, argc, argv, arg);
-            else if (arg == "-line-marks")
-                options.lineMarks = BoolArg(i, argc, argv, arg);
-            else if (arg == "-dump-ast")
-                options.dumpAST = BoolArg(i, argc, argv, arg);
-            else if (arg == "-entry")
-                entry = NextArg(i, argc, argv, arg);
-            else if (arg == "-target")
-                target = NextArg(i, argc, argv, arg);
-            else if (arg == "-shaderin")
-                shaderIn = NextArg(i, argc, argv, arg);
-            else if (arg == "-shaderout")
-                shaderOut = NextArg(i, argc, argv, arg);
-            else if (arg == "-indent")
-                options.indent = NextArg(i, argc, argv, arg);
-            else if (arg == "-prefix")
-                options.prefix = NextArg(i, argc, argv, arg);
-            else if (arg == "-output")
-                output = NextArg(i, argc, argv, arg);
-            else
+            else if (arg == "-stats-json")
+                statsFile = NextArg(i, args, arg);
+            else if (arg == "-server")
+                runServer = true;
+            else if (arg == "-server-threads")
+                serverThreads = static_cast<unsigned int>(std::atoi(NextArg(i, args, arg).c_str()));
+            else if (!ParseSettingArg(i, args, settings))
             {
                 /* Translate input code */
-                Translate(arg);
+                Translate(arg, settings, std::cout, std::cerr);
                 ++translationCounter;
 
                 /* Reset translation options */
-                output.clear();
-                target.clear();
-                entry.clear();
+                ResetFileSettings(settings);
             }
         }
         catch (const std::exception& err)
@@ -365,13 +963,20 @@ int main(int argc, char** argv)
         }
     }
 
+    /* Run server with the options of the command line as default settings */
+    if (runServer)
+        RunServer(settings, serverThreads);
+
+    if (!statsFile.empty())
+        WriteStatsFile();
+
     /* Evaluate arguemnts */
     if (showHelp)
         ShowHelp();
     if (showVersion)
         ShowVersion();
 
-    if (translationCounter == 0 && !showHelp && !showVersion)
+    if (translationCounter == 0 && !showHelp && !showVersion && !runServer)
         ShowHint();
 
     return 0;